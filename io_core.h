@@ -26,7 +26,6 @@
  * Persistent storage of io_values
  * Additional io language support for Javascript and Python
  * A ms windows io cpu
- * A linux io cpu
  *
  */
 #ifndef io_core_H_
@@ -740,7 +739,8 @@ struct io_encoding_implementation {
 			struct PACK_STRUCTURE {\
 				uint16_t requires_time:1;\
 				uint16_t has_time:1;\
-				uint16_t :14;\
+				uint16_t read_only:1;\
+				uint16_t :13;\
 			} flag;\
 		} bit;\
 	} tag;\
@@ -756,6 +756,14 @@ struct PACK_STRUCTURE io_encoding {
 #define io_encoding_implementation(e)		(e)->implementation
 #define io_encoding_reference_count(e)		(e)->tag.bit.reference_count
 
+//
+// a read only encoding refuses every change to its bytes, it is set
+// while the bytes are shared
+//
+#define io_encoding_is_read_only(e)			((e)->tag.bit.flag.read_only != 0)
+#define io_encoding_set_read_only(e)		(e)->tag.bit.flag.read_only = 1
+#define io_encoding_clear_read_only(e)		(e)->tag.bit.flag.read_only = 0
+
 bool	io_encoding_has_implementation (io_encoding_t const*,io_encoding_implementation_t const*);
 io_encoding_t*	reference_io_encoding (io_encoding_t*);
 void	unreference_io_encoding (io_encoding_t*);
@@ -1036,6 +1044,289 @@ vref_t io_x70_decoder (io_encoding_t*,io_value_memory_t*);
 void io_x70_encoding_append_uint_value (io_encoding_t*,uint32_t);
 
 #define X70_UINT_VALUE_BYTE	'U'
+#define X70_UINT_MAXIMUM_LENGTH	5
+
+//
+// x70 version 2 (compact): int64 values are written as zigzag varints
+// and float64 values as float32 when that is lossless.  The compact
+// forms use their own implementation names so a decoder accepts both
+// versions in the same stream.
+//
+#define X70_ENCODING_VERSION_1				1
+#define X70_ENCODING_VERSION_2				2
+#define X70_VARINT64_MAXIMUM_LENGTH		10
+
+INLINE_FUNCTION io_encoding_t*
+mk_io_x70_compact_encoding (io_byte_memory_t *bm) {
+	extern EVENT_DATA io_encoding_implementation_t io_x70_compact_encoding_implementation;
+	return io_x70_compact_encoding_implementation.make_encoding(bm);
+}
+
+INLINE_FUNCTION bool
+is_io_x70_compact_encoding (io_encoding_t const *encoding) {
+	extern EVENT_DATA io_encoding_implementation_t io_x70_compact_encoding_implementation;
+	return io_encoding_has_implementation (
+		encoding,&io_x70_compact_encoding_implementation
+	);
+}
+
+INLINE_FUNCTION uint32_t
+io_x70_encoding_version (io_encoding_t const *encoding) {
+	return is_io_x70_compact_encoding (encoding) ? X70_ENCODING_VERSION_2 : X70_ENCODING_VERSION_1;
+}
+
+INLINE_FUNCTION uint64_t
+io_x70_zigzag_encode (int64_t value) {
+	return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+INLINE_FUNCTION int64_t
+io_x70_zigzag_decode (uint64_t value) {
+	return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+void io_x70_encoding_append_varint64 (io_encoding_t*,uint64_t);
+int32_t io_x70_encoding_take_varint64 (const uint8_t*,const uint8_t*,uint64_t*);
+
+//
+// x70 dictionary mode
+//
+// A dictionary encoding is a compact encoding that writes each
+// distinct text value once, later copies become a "ref" value holding
+// the index of the first.  Indices count the full text values in the
+// message so the decoder rebuilds the same table as it goes and a
+// ref decodes to the value that was already made.
+//
+// The table belongs to one message: a dictionary encoding clears it on
+// reset, io_x70_decoder uses a fresh table for each call and a streaming
+// decoder clears its table as each top level value is emitted.  The table
+// being decoded against is passed down to each value's decode in an
+// io_x70_decode_context_t, so separate decodes share no state.  The
+// context also counts the vectors being decoded so that nesting is
+// limited to IO_X70_STREAM_DECODER_STACK_DEPTH, as when streaming.
+//
+#define IO_X70_DICTIONARY_LIMIT	32
+
+typedef struct PACK_STRUCTURE io_x70_dictionary_entry {
+	uint32_t offset;
+	uint32_t length;
+} io_x70_dictionary_entry_t;
+
+typedef struct PACK_STRUCTURE io_x70_dictionary_encoding {
+	IO_BINARY_ENCODING_STRUCT_MEMBERS
+	uint32_t number_of_entries;
+	io_x70_dictionary_entry_t entries[IO_X70_DICTIONARY_LIMIT];
+} io_x70_dictionary_encoding_t;
+
+INLINE_FUNCTION io_encoding_t*
+mk_io_x70_dictionary_encoding (io_byte_memory_t *bm) {
+	extern EVENT_DATA io_encoding_implementation_t io_x70_dictionary_encoding_implementation;
+	return io_x70_dictionary_encoding_implementation.make_encoding(bm);
+}
+
+INLINE_FUNCTION bool
+is_io_x70_dictionary_encoding (io_encoding_t const *encoding) {
+	extern EVENT_DATA io_encoding_implementation_t io_x70_dictionary_encoding_implementation;
+	return io_encoding_has_implementation (
+		encoding,&io_x70_dictionary_encoding_implementation
+	);
+}
+
+int32_t io_x70_dictionary_encoding_find (io_encoding_t*,uint8_t const*,uint32_t);
+void io_x70_dictionary_encoding_add (io_encoding_t*,uint32_t,uint32_t);
+
+typedef struct PACK_STRUCTURE io_x70_dictionary {
+	uint32_t count;
+	vref_t entries[IO_X70_DICTIONARY_LIMIT];
+} io_x70_dictionary_t;
+
+typedef struct PACK_STRUCTURE io_x70_decode_context {
+	io_x70_dictionary_t *dictionary;
+	io_encoding_t *source;
+	uint32_t depth;
+} io_x70_decode_context_t;
+
+void io_x70_decode_dictionary_add (io_x70_decode_context_t*,vref_t);
+vref_t io_x70_decode_dictionary_entry (io_x70_decode_context_t*,uint32_t);
+void io_x70_dictionary_clear (io_x70_dictionary_t*);
+
+//
+// zero-copy x70 decoding
+//
+// io_x70_zero_copy_decoder makes binary and text values that point into
+// the encoding's bytes instead of copying them.  Each of these values
+// references the encoding until the value is freed, so the caller should:
+//
+//   hold the encoding with reference_io_encoding and let go of it with
+//   unreference_io_encoding (never io_encoding_free),
+//
+//   not append to or reset the encoding while decoded values remain.
+//
+// Values decoded from anything else (e.g. the streaming decoder) are
+// always copied.
+//
+vref_t io_x70_zero_copy_decoder (io_encoding_t*,io_value_memory_t*);
+io_encoding_t* io_x70_decode_source_containing (io_x70_decode_context_t*,uint8_t const*,uint32_t);
+
+vref_t io_x70_decode_value (io_value_memory_t*,io_x70_decode_context_t*,uint8_t const**,const uint8_t*);
+
+//
+// how a value's x70 payload follows its implementation name, this
+// lets a decoder find the end of a value without decoding it
+//
+typedef enum {
+	IO_X70_FRAMING_NONE = 0,	// no payload
+	IO_X70_FRAMING_FIXED,		// framing.size bytes
+	IO_X70_FRAMING_SIZED,		// uint value n then n bytes
+	IO_X70_FRAMING_VALUES,		// uint value n then n values (a vector)
+	IO_X70_FRAMING_VARINT,		// bytes up to one with the top bit clear
+} io_x70_framing_type_t;
+
+typedef struct PACK_STRUCTURE io_x70_framing {
+	uint8_t type;
+	uint8_t size;
+} io_x70_framing_t;
+
+#define def_io_x70_framing(T,S)	{.type = T,.size = S}
+
+//
+// streaming x70 decoder
+//
+// Bytes are pushed in chunks of any size and each top-level value
+// is emitted as soon as its last byte arrives.  Only the payload of
+// the current leaf value is buffered and the nesting depth is bounded,
+// so memory use does not depend on the length of the stream.
+//
+//   decoder = mk_io_x70_stream_decoder (bm,vm,emit,user_value);
+//   io_x70_stream_decoder_push (decoder,bytes,size);
+//   ...
+//   free_io_x70_stream_decoder (decoder);
+//
+// Emitted values are not referenced by the decoder.  The arity of a
+// vector is read from the stream so it is bounded before any memory
+// is allocated for its elements.
+//
+#define IO_X70_STREAM_DECODER_STACK_DEPTH		8
+#define IO_X70_STREAM_DECODER_NAME_LIMIT		32
+#define IO_X70_STREAM_DECODER_ARITY_LIMIT		256
+
+typedef void (*io_x70_stream_decoder_emit_t) (vref_t,void*);
+
+typedef enum {
+	X70_STREAM_EXPECT_VALUE = 0,
+	X70_STREAM_NAME_LENGTH,
+	X70_STREAM_NAME,
+	X70_STREAM_SIZE_BYTE,
+	X70_STREAM_SIZE,
+	X70_STREAM_PAYLOAD,
+	X70_STREAM_ARITY_BYTE,
+	X70_STREAM_ARITY,
+	X70_STREAM_VARINT,
+	X70_STREAM_ERROR,
+} io_x70_stream_decoder_state_t;
+
+typedef struct PACK_STRUCTURE io_x70_stream_frame {
+	vref_t *values;
+	uint32_t arity;
+	uint32_t count;
+} io_x70_stream_frame_t;
+
+typedef struct PACK_STRUCTURE io_x70_stream_decoder {
+	io_byte_memory_t *bm;
+	io_value_memory_t *vm;
+	io_x70_stream_decoder_emit_t emit;
+	void *user_value;
+	io_value_implementation_t const *implementation;
+	uint8_t state;
+	uint8_t shift;
+	uint32_t uint_value;
+	uint32_t remaining;
+	uint8_t *scratch;
+	uint32_t scratch_length;
+	uint32_t scratch_size;
+	uint32_t name_length;
+	uint32_t name_cursor;
+	char name[IO_X70_STREAM_DECODER_NAME_LIMIT];
+	io_x70_stream_frame_t *top;
+	io_x70_stream_frame_t stack[IO_X70_STREAM_DECODER_STACK_DEPTH];
+	io_x70_dictionary_t dictionary;
+} io_x70_stream_decoder_t;
+
+io_x70_stream_decoder_t* mk_io_x70_stream_decoder (io_byte_memory_t*,io_value_memory_t*,io_x70_stream_decoder_emit_t,void*);
+void free_io_x70_stream_decoder (io_x70_stream_decoder_t*);
+void io_x70_stream_decoder_reset (io_x70_stream_decoder_t*);
+bool io_x70_stream_decoder_push (io_x70_stream_decoder_t*,uint8_t const*,uint32_t);
+bool io_x70_stream_decoder_push_pipe (io_x70_stream_decoder_t*,io_byte_pipe_t*);
+
+#define io_x70_stream_decoder_has_error(d)	((d)->state == X70_STREAM_ERROR)
+
+//
+// true if the decoder is between top-level values
+//
+INLINE_FUNCTION bool
+io_x70_stream_decoder_is_idle (io_x70_stream_decoder_t const *this) {
+	return this->state == X70_STREAM_EXPECT_VALUE && this->top == NULL;
+}
+
+//
+// streaming x70 encoder
+//
+// Serialises a value tree incrementally so a large value can be
+// sent as a sequence of socket mtu sized messages without first being
+// encoded in full.  Buffered memory is one mtu plus the header of the
+// current value, the bytes of binary and text values are copied directly
+// from the value.
+//
+//   encoder = mk_io_x70_stream_encoder (bm);
+//   io_x70_stream_encoder_begin (encoder,r_value);
+//   io_x70_stream_encoder_send (encoder,socket);
+//
+// and then on each of the socket's transmit available events:
+//
+//   if (io_x70_stream_encoder_send (encoder,socket)) {
+//      ... the value has been sent
+//   } else if (io_x70_stream_encoder_has_error (encoder)) {
+//      ... the value cannot be sent
+//   }
+//
+#define IO_X70_STREAM_ENCODER_STACK_DEPTH		IO_X70_STREAM_DECODER_STACK_DEPTH
+
+typedef struct PACK_STRUCTURE io_x70_stream_encoder_frame {
+	vref_t const *cursor;
+	vref_t const *end;
+} io_x70_stream_encoder_frame_t;
+
+typedef struct PACK_STRUCTURE io_x70_stream_encoder {
+	io_byte_memory_t *bm;
+	vref_t r_value;
+	io_encoding_t *header;
+	uint32_t header_cursor;
+	uint8_t const *body;
+	uint32_t body_remaining;
+	uint8_t *chunk;
+	uint32_t chunk_size;
+	uint32_t chunk_length;
+	bool error;
+	io_x70_stream_encoder_frame_t *top;
+	io_x70_stream_encoder_frame_t stack[IO_X70_STREAM_ENCODER_STACK_DEPTH];
+} io_x70_stream_encoder_t;
+
+io_x70_stream_encoder_t* mk_io_x70_stream_encoder (io_byte_memory_t*);
+void free_io_x70_stream_encoder (io_x70_stream_encoder_t*);
+bool io_x70_stream_encoder_begin (io_x70_stream_encoder_t*,vref_t);
+void io_x70_stream_encoder_reset (io_x70_stream_encoder_t*);
+uint32_t io_x70_stream_encoder_read (io_x70_stream_encoder_t*,uint8_t*,uint32_t);
+bool io_x70_stream_encoder_send (io_x70_stream_encoder_t*,io_socket_t*);
+
+#define io_x70_stream_encoder_has_error(e)	((e)->error)
+
+//
+// true when every byte of the value has been read or sent
+//
+INLINE_FUNCTION bool
+io_x70_stream_encoder_is_complete (io_x70_stream_encoder_t const *this) {
+	return vref_is_invalid (this->r_value) && this->chunk_length == 0;
+}
 
 //
 // int64 encoding
@@ -1414,6 +1705,88 @@ bool	io_cpu_clock_iterate_outputs_nop (io_cpu_clock_pointer_t,bool (*) (io_cpu_c
 
 extern EVENT_DATA io_cpu_clock_implementation_t io_cpu_clock_function_implementation;
 
+//
+// clock scaler: a function clock whose frequency is its input frequency
+// multiplied and divided by a selected setting, for plls and prescalers.
+// The setting is kept in ram so the clock itself can be constant and it
+// caches the expected frequency.
+//
+typedef struct PACK_STRUCTURE io_cpu_clock_scaler_setting {
+	uint16_t multiplier;
+	uint16_t divider;
+	float64_t frequency;		// zero when not known
+} io_cpu_clock_scaler_setting_t;
+
+#define IO_CPU_CLOCK_SCALER_STRUCT_MEMBERS \
+	IO_CPU_CLOCK_FUNCTION_STRUCT_MEMBERS \
+	io_cpu_clock_scaler_setting_t *setting; \
+	uint16_t minimum_multiplier; \
+	uint16_t maximum_multiplier; \
+	uint16_t minimum_divider; \
+	uint16_t maximum_divider; \
+	float64_t maximum_frequency; \
+	/**/
+
+typedef struct PACK_STRUCTURE io_cpu_clock_scaler {
+	IO_CPU_CLOCK_SCALER_STRUCT_MEMBERS
+} io_cpu_clock_scaler_t;
+
+float64_t io_cpu_clock_scaler_get_expected_frequency (io_cpu_clock_pointer_t);
+bool io_cpu_clock_scaler_select (io_cpu_clock_pointer_t,uint16_t,uint16_t);
+void io_cpu_clock_invalidate_frequency (io_cpu_clock_pointer_t);
+
+#define SPECIALISE_IO_CPU_CLOCK_SCALER_IMPLEMENTATION(S) \
+	SPECIALISE_IO_CPU_CLOCK_FUNCTION_IMPLEMENTATION(S) \
+	.get_expected_frequency = io_cpu_clock_scaler_get_expected_frequency, \
+	.iterate_outputs = io_cpu_clock_function_iterate_outputs, \
+	/**/
+
+extern EVENT_DATA io_cpu_clock_implementation_t io_cpu_clock_scaler_implementation;
+
+INLINE_FUNCTION io_cpu_clock_scaler_t const*
+cast_to_io_cpu_clock_scaler (io_cpu_clock_pointer_t clock) {
+	if (
+			!io_cpu_clock_is_null (clock)
+		&&	io_cpu_clock_has_implementation (clock,&io_cpu_clock_scaler_implementation)
+	) {
+		return (io_cpu_clock_scaler_t const*) io_cpu_clock_ro_pointer (clock);
+	} else {
+		return NULL;
+	}
+}
+
+//
+// clock planner: searches the settings of the scalers between each target
+// clock and its source for frequencies within the targets' ranges at the
+// lowest total cost, the default cost is the sum of scaler frequencies
+//
+typedef struct io_cpu_clock_target {
+	io_cpu_clock_pointer_t clock;
+	float64_t minimum;
+	float64_t maximum;
+} io_cpu_clock_target_t;
+
+typedef float64_t (*io_cpu_clock_cost_t) (io_cpu_clock_pointer_t,float64_t);
+
+#define IO_CPU_CLOCK_PLAN_MAXIMUM_SCALERS	8
+
+typedef struct io_cpu_clock_plan {
+	io_cpu_clock_target_t const *targets;
+	uint32_t number_of_targets;
+	io_cpu_clock_cost_t cost;
+	io_cpu_clock_scaler_t const *scaler[IO_CPU_CLOCK_PLAN_MAXIMUM_SCALERS];
+	io_cpu_clock_scaler_setting_t best[IO_CPU_CLOCK_PLAN_MAXIMUM_SCALERS];
+	uint32_t number_of_scalers;
+	float64_t best_cost;
+	uint32_t evaluations;
+	bool found;
+} io_cpu_clock_plan_t;
+
+bool plan_io_cpu_clocks (io_cpu_clock_plan_t*,io_cpu_clock_target_t const*,uint32_t,io_cpu_clock_cost_t);
+
+#define io_cpu_clock_plan_cost(p)			(p)->best_cost
+#define io_cpu_clock_plan_evaluations(p)	(p)->evaluations
+
 //
 // address
 //
@@ -1421,7 +1794,8 @@ extern EVENT_DATA io_cpu_clock_implementation_t io_cpu_clock_function_implementa
 
 typedef struct PACK_STRUCTURE io_address {
 	struct PACK_STRUCTURE {
-		uint32_t size:31;
+		uint32_t size:30;
+		uint32_t is_view:1;
 		uint32_t is_volatile:1;
 	} tag;
 	union PACK_STRUCTURE {
@@ -1438,6 +1812,7 @@ typedef struct PACK_STRUCTURE io_address {
 
 #define io_address_size(a)				(a).tag.size
 #define io_address_is_volatile(a)	(a).tag.is_volatile
+#define io_address_is_view(a)			(a).tag.is_view
 #define io_address_rw_bytes(a)		(a).value.rw_bytes
 #define io_address_ro_bytes(a)		(a).value.ro_bytes
 #define get_pointer_to_io_address_value(a)	((io_address_size(a) > 4) ? io_address_rw_bytes(a) : &io_u8_address_value(a))
@@ -1457,10 +1832,76 @@ typedef struct PACK_STRUCTURE io_address {
 #define io_u32_address_value(a)	(a).value.u32
 
 io_address_t	mk_io_address(io_byte_memory_t*,uint32_t,uint8_t const*);
-int32_t			compare_io_addresses (io_address_t,io_address_t);
+int32_t			compare_io_long_addresses (io_address_t,io_address_t);
+uint32_t			io_long_address_hash (io_address_t);
 io_address_t	duplicate_io_address (io_byte_memory_t*,io_address_t);
 uint32_t			write_le_io_address (uint8_t*,uint32_t,io_address_t);
 uint32_t			read_le_io_address (io_byte_memory_t*,uint8_t const*,uint32_t,io_address_t*);
+uint32_t			read_le_io_address_view (uint8_t const*,uint32_t,io_address_t*);
+
+//
+// 1, 2 and 4 byte addresses hold their value in the address
+//
+#define io_address_is_inline(a)	(\
+		io_address_size(a) == 1 \
+	||	io_address_size(a) == 2 \
+	||	io_address_size(a) == 4 \
+)
+
+INLINE_FUNCTION uint32_t
+io_inline_address_value (io_address_t a) {
+	switch (io_address_size(a)) {
+		case 1:
+			return io_u8_address_value(a);
+		case 2:
+			return io_u16_address_value(a);
+		default:
+			return io_u32_address_value(a);
+	}
+}
+
+//
+// compare as little endian big numbers, so addresses of different
+// sizes with the same value are equal
+//
+INLINE_FUNCTION int32_t
+compare_io_addresses (io_address_t a,io_address_t b) {
+	if (io_address_is_inline(a) && io_address_is_inline(b)) {
+		uint32_t va = io_inline_address_value (a);
+		uint32_t vb = io_inline_address_value (b);
+		return (va > vb) - (va < vb);
+	} else if (io_address_is_invalid(b)) {
+		return (io_address_is_invalid(a)) ? 0 : -1;
+	} else if (io_address_is_invalid(a)) {
+		return 1;
+	} else {
+		return compare_io_long_addresses (a,b);
+	}
+}
+
+#define IO_ADDRESS_HASH_BASIS		2166136261UL
+#define IO_ADDRESS_HASH_PRIME		16777619UL
+
+//
+// FNV-1a of the value bytes without high zero bytes, equal addresses
+// have equal hashes
+//
+INLINE_FUNCTION uint32_t
+io_address_hash (io_address_t a) {
+	if (io_address_is_inline(a)) {
+		uint32_t v = io_inline_address_value (a);
+		uint32_t h = IO_ADDRESS_HASH_BASIS;
+		while (v) {
+			h = (h ^ (v & 0xff)) * IO_ADDRESS_HASH_PRIME;
+			v >>= 8;
+		}
+		return h;
+	} else if (io_address_is_invalid(a)) {
+		return 0;
+	} else {
+		return io_long_address_hash (a);
+	}
+}
 
 INLINE_FUNCTION io_address_t
 io_long_address (io_byte_memory_t *bm,uint32_t size,uint8_t const *bytes) {
@@ -1518,7 +1959,8 @@ initialise_io_interrupt_handler (
 //
 // Io
 //
-// the model for io computation is a single cpu core per io_t instance
+// the model for io computation is a single cpu core per io_t instance,
+// io_t instances on different cores exchange messages through channels
 //
 typedef struct PACK_STRUCTURE io_implementation {
 	string_hash_table_t *value_implementation_map;
@@ -1572,6 +2014,8 @@ typedef struct PACK_STRUCTURE io_implementation {
 	io_time_t (*get_time) (io_t*);
 	void (*enqueue_alarm) (io_t*,io_alarm_t*);
 	void (*dequeue_alarm) (io_t*,io_alarm_t*);
+	void (*set_wakeup_time) (io_t*,io_time_t);
+	void (*sleep) (io_t*);
 	//
 	// interrupts
 	//
@@ -1614,11 +2058,25 @@ typedef enum {
 	IO_DETAIL_LOG_LEVEL,
 } io_log_level_t;
 
+//
+// event loop instrumentation is compiled in by defining
+// WITH_IO_EVENT_INSTRUMENTATION in configure_io_build.h
+//
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+typedef struct io_event_instrumentation io_event_instrumentation_t;
+# define IO_EVENT_INSTRUMENTATION_STRUCT_MEMBERS \
+	io_event_instrumentation_t *instrumentation;\
+	/**/
+#else
+# define IO_EVENT_INSTRUMENTATION_STRUCT_MEMBERS
+#endif
+
 #define IO_STRUCT_MEMBERS \
 	io_implementation_t const *implementation;\
 	io_event_t *events; \
 	io_alarm_t *alarms; \
 	uint32_t log_level;\
+	IO_EVENT_INSTRUMENTATION_STRUCT_MEMBERS \
 	/**/
 
 struct PACK_STRUCTURE io {
@@ -1628,6 +2086,10 @@ struct PACK_STRUCTURE io {
 void	enqueue_io_event (io_t*,io_event_t*);
 void	dequeue_io_event (io_t*,io_event_t*);
 bool	do_next_io_event (io_t*);
+void	enqueue_io_alarm (io_t*,io_alarm_t*);
+void	dequeue_io_alarm (io_t*,io_alarm_t*);
+uint32_t	do_due_io_alarms (io_t*);
+void	tickless_wait_for_io_event (io_t*);
 void io_log_startup_message (io_t*,io_log_level_t);
 
 int io_printf (io_t*,const char *fmt,...);
@@ -1862,6 +2324,23 @@ io_dequeue_alarm (io_t *io,io_alarm_t *a) {
 	io->implementation->dequeue_alarm (io,a);
 }
 
+//
+// program a single wake up at t, a time of LLONG_MAX cancels the wake up
+//
+INLINE_FUNCTION void
+io_set_wakeup_time (io_t *io,io_time_t t) {
+	io->implementation->set_wakeup_time (io,t);
+}
+
+//
+// sleep until the wake up time or an interrupt, called in a critical
+// section and must return when an interrupt is pending
+//
+INLINE_FUNCTION void
+io_sleep (io_t *io) {
+	io->implementation->sleep (io);
+}
+
 INLINE_FUNCTION void
 io_sha256_start (io_t *io,io_sha256_context_t *ctx) {
 	io->implementation->sha256_start (ctx);
@@ -1912,6 +2391,8 @@ bool in_not_in_event_thread (io_t*);
 void io_no_wait_for_event_pending (io_t*);
 io_time_t io_get_time_zero (io_t*);
 void io_no_enqueue_alarm (io_t*,io_alarm_t*);
+void io_no_set_wakeup_time (io_t*,io_time_t);
+void io_no_sleep (io_t*);
 bool io_no_enter_critical_section (io_t*);
 void io_no_exit_critical_section (io_t*,bool);
 void io_no_register_interrupt_handler (io_t*,int32_t,io_interrupt_action_t,void*);
@@ -1951,6 +2432,8 @@ void io_default_panic (io_t*,int);
 	.get_time = io_get_time_zero, \
 	.enqueue_alarm = io_no_enqueue_alarm, \
 	.dequeue_alarm = io_no_enqueue_alarm, \
+	.set_wakeup_time = io_no_set_wakeup_time, \
+	.sleep = io_no_sleep, \
 	.enter_critical_section = io_no_enter_critical_section, \
 	.exit_critical_section = io_no_exit_critical_section, \
 	.register_interrupt_handler = io_no_register_interrupt_handler, \
@@ -1970,6 +2453,20 @@ void io_default_panic (io_t*,int);
 	/**/
 	
 
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+#define ENTER_CRITICAL_SECTION(E)	\
+	{	\
+		bool __critical_handle = enter_io_critical_section(E); \
+		io_time_t __critical_begin = io_instrument_critical_section_enter (E,__critical_handle);
+
+#define EXIT_CRITICAL_SECTION(E) \
+		io_instrument_critical_section_exit (E,__critical_handle,__critical_begin); \
+		exit_io_critical_section (E,__critical_handle);	\
+	}
+
+#define SLEEP_IN_CRITICAL_SECTION(E) \
+		__critical_begin = io_instrument_critical_section_sleep (E,__critical_handle,__critical_begin);
+#else
 #define ENTER_CRITICAL_SECTION(E)	\
 	{	\
 		bool __critical_handle = enter_io_critical_section(E);
@@ -1979,6 +2476,10 @@ void io_default_panic (io_t*,int);
 		exit_io_critical_section (E,__critical_handle);	\
 	}
 
+#define SLEEP_IN_CRITICAL_SECTION(E) \
+		io_sleep (E);
+#endif
+
 enum {
 	IO_PANIC_UNRECOVERABLE_ERROR = 1,
 	IO_PANIC_SOMETHING_BAD_HAPPENED,
@@ -2009,6 +2510,212 @@ io_enqueue_event (io_t *io,io_event_t *ev) {
 	}
 }
 
+//
+// channels between io
+//
+// A channel carries values and encodings from a sending io to a receiving
+// io that may run on another core.  Each direction is a single producer
+// single consumer ring so neither side takes a lock to move a message.
+//
+// Ownership: a message is lent, not given.  Sending takes a reference on
+// the sender's core, the receiver may read the message until it calls
+// io_channel_release, which passes it back to the sender where the
+// reference is dropped.  Reference counts and memory are therefore only
+// ever changed on the core that owns them.  The receiver must not
+// reference, modify or keep a message after releasing it.
+//
+// The receiving io is woken by enqueuing receive_event on it, so the
+// receiver's critical section must exclude other cores.
+//
+// The ring is not packed, its indices are naturally aligned so they can
+// be loaded and stored atomically by the two cores.
+//
+typedef struct PACK_STRUCTURE io_channel_message {
+	vref_t value;
+	io_encoding_t *encoding;
+} io_channel_message_t;
+
+typedef struct io_channel_ring {
+	uint16_t size_of_ring;
+	uint16_t write_index;
+	uint16_t read_index;
+	io_channel_message_t *ring;
+} io_channel_ring_t;
+
+typedef struct PACK_STRUCTURE io_channel {
+	io_t *sender;
+	io_t *receiver;
+	io_event_t *receive_event;
+	io_event_t release_event;
+	io_channel_ring_t *forward;
+	io_channel_ring_t *returned;
+	uint32_t lent;
+	uint32_t signals;
+} io_channel_t;
+
+io_channel_t*	mk_io_channel (io_t*,io_t*,io_event_t*,uint16_t);
+void	free_io_channel (io_channel_t*);
+bool	io_channel_send_value (io_channel_t*,vref_t);
+bool	io_channel_send_encoding (io_channel_t*,io_encoding_t*);
+bool	io_channel_receive (io_channel_t*,io_channel_message_t*);
+void	io_channel_release (io_channel_t*,io_channel_message_t const*);
+void	io_channel_collect_released (io_channel_t*);
+
+#define io_channel_is_readable(c)		io_channel_ring_is_readable ((c)->forward)
+
+INLINE_FUNCTION bool
+io_channel_ring_is_readable (io_channel_ring_t const *this) {
+	return (
+			__atomic_load_n (&this->read_index,__ATOMIC_RELAXED)
+		!=	__atomic_load_n (&this->write_index,__ATOMIC_ACQUIRE)
+	);
+}
+#define io_channel_messages_lent(c)		(c)->lent
+#define io_channel_signals(c)				(c)->signals
+
+//
+// stackless coroutines
+//
+// A coroutine is an event handler that suspends and resumes in place.
+// Only the resume point is saved, so a suspension costs no stack and no
+// heap.  Anything that must survive an await belongs in the structure
+// that embeds the coroutine rather than in locals, a switch statement
+// cannot enclose an await and there can only be one await per line.
+// The resume point is the line number of the await so awaits must be on
+// lines below IO_COROUTINE_FINISHED, one beyond it fails to compile.
+//
+// The coroutine is resumed by its resume event, pass io_coroutine_event
+// to whatever should wake it.
+//
+//		IO_COROUTINE_BEGIN(co);
+//		IO_AWAIT_TIME(co,millisecond_time (10));
+//		IO_AWAIT_UNTIL(co,io_byte_pipe_is_readable (pipe));
+//		IO_COROUTINE_END(co);
+//
+typedef struct io_coroutine io_coroutine_t;
+typedef void (*io_coroutine_body_t) (io_coroutine_t*);
+
+struct PACK_STRUCTURE io_coroutine {
+	io_t *io;
+	io_coroutine_body_t body;
+	void *user_value;
+	io_event_t resume;
+	io_alarm_t alarm;
+	uint16_t resume_point;
+	bool timed_out;
+};
+
+#define IO_COROUTINE_FINISHED		0xffff
+
+//
+// the line of the await, the array size is negative if it would alias
+// a finished coroutine
+//
+#define IO_COROUTINE_RESUME_POINT \
+	(__LINE__ + 0 * sizeof (char [(__LINE__ < IO_COROUTINE_FINISHED) ? 1 : -1]))
+
+//
+// awaits that test a condition fall through into their case label
+//
+#if defined(__has_attribute)
+# if __has_attribute(fallthrough)
+#  define IO_COROUTINE_FALL_THROUGH	__attribute__((fallthrough))
+# endif
+#endif
+#ifndef IO_COROUTINE_FALL_THROUGH
+# define IO_COROUTINE_FALL_THROUGH	do {} while (0)
+#endif
+
+void	initialise_io_coroutine (io_coroutine_t*,io_t*,io_coroutine_body_t,void*);
+void	start_io_coroutine (io_coroutine_t*);
+void	stop_io_coroutine (io_coroutine_t*);
+
+#define io_coroutine_event(co)				(&(co)->resume)
+#define io_coroutine_user_value(co)			(co)->user_value
+#define io_coroutine_timed_out(co)			(co)->timed_out
+#define io_coroutine_is_finished(co)		((co)->resume_point == IO_COROUTINE_FINISHED)
+
+INLINE_FUNCTION void
+io_coroutine_set_alarm (io_coroutine_t *co,io_time_t delay) {
+	if (is_io_alarm_active (&co->alarm)) {
+		io_dequeue_alarm (co->io,&co->alarm);
+	}
+	set_alarm_delay_time (co->io,&co->alarm,delay);
+	io_enqueue_alarm (co->io,&co->alarm);
+}
+
+INLINE_FUNCTION void
+io_coroutine_cancel_alarm (io_coroutine_t *co) {
+	if (is_io_alarm_active (&co->alarm)) {
+		io_dequeue_alarm (co->io,&co->alarm);
+	}
+}
+
+#define IO_COROUTINE_BEGIN(co) \
+	switch ((co)->resume_point) { \
+		case 0: \
+		/**/
+
+#define IO_COROUTINE_END(co) \
+	} \
+	(co)->resume_point = IO_COROUTINE_FINISHED; \
+	return; \
+	/**/
+
+#define IO_COROUTINE_EXIT(co) \
+	do { \
+		(co)->resume_point = IO_COROUTINE_FINISHED; \
+		return; \
+	} while (0)
+
+//
+// suspend until the resume event is next delivered
+//
+#define IO_AWAIT_EVENT(co) \
+	(co)->resume_point = IO_COROUTINE_RESUME_POINT; \
+	return; \
+	case __LINE__: \
+	/**/
+
+//
+// let other events run before continuing
+//
+#define IO_COROUTINE_YIELD(co) \
+	io_enqueue_event ((co)->io,&(co)->resume); \
+	IO_AWAIT_EVENT(co)
+
+//
+// the condition is tested each time the coroutine is resumed
+//
+#define IO_AWAIT_UNTIL(co,cond) \
+	(co)->resume_point = IO_COROUTINE_RESUME_POINT; \
+	IO_COROUTINE_FALL_THROUGH; \
+	case __LINE__: \
+	if (!(cond)) return; \
+	/**/
+
+#define IO_AWAIT_TIME(co,delay) \
+	io_coroutine_set_alarm (co,delay); \
+	IO_AWAIT_UNTIL(co,!is_io_alarm_active (&(co)->alarm))
+
+//
+// io_coroutine_timed_out() tells which one ended the wait
+//
+#define IO_AWAIT_UNTIL_OR_TIME(co,cond,delay) \
+	io_coroutine_set_alarm (co,delay); \
+	(co)->resume_point = IO_COROUTINE_RESUME_POINT; \
+	IO_COROUTINE_FALL_THROUGH; \
+	case __LINE__: \
+	if (cond) { \
+		(co)->timed_out = false; \
+	} else if (is_io_alarm_active (&(co)->alarm)) { \
+		return; \
+	} else { \
+		(co)->timed_out = true; \
+	} \
+	io_coroutine_cancel_alarm (co); \
+	/**/
+
 //
 // dma
 //
@@ -2080,6 +2787,9 @@ struct  PACK_STRUCTURE io_dma_channel_implementation {
 	void (*initialise) (io_dma_channel_t*);
 	void (*transfer_from_peripheral) (io_dma_channel_t*,void*,uint32_t);
 	void (*transfer_to_peripheral) (io_dma_channel_t*,void const*,uint32_t);
+	void (*transfer_memory_to_memory) (io_dma_channel_t*,void*,void const*,uint32_t);
+	void (*transfer_from_peripheral_circular) (io_dma_channel_t*,void*,uint32_t);
+	uint32_t (*transfer_position) (io_dma_channel_t const*);
 	void (*transfer_complete) (io_t*,io_dma_channel_t*);
 };
 
@@ -2088,6 +2798,8 @@ extern io_dma_channel_t null_dma_channel;
 void io_dma_channel_initialise_nop (io_dma_channel_t*);
 void io_dma_channel_no_transfer_from_peripheral (io_dma_channel_t*,void*,uint32_t);
 void io_dma_channel_no_transfer_to_peripheral (io_dma_channel_t*,void const*,uint32_t);
+void io_dma_channel_no_transfer_memory_to_memory (io_dma_channel_t*,void*,void const*,uint32_t);
+uint32_t io_dma_channel_no_transfer_position (io_dma_channel_t const*);
 void io_dma_channel_transfer_complete_nop (io_t*,io_dma_channel_t*);
 
 #define SPECIALISE_IO_DMA_CHANNEL_IMPLEMENTATION(S) \
@@ -2095,12 +2807,16 @@ void io_dma_channel_transfer_complete_nop (io_t*,io_dma_channel_t*);
 	.initialise = io_dma_channel_initialise_nop,\
 	.transfer_from_peripheral = io_dma_channel_no_transfer_from_peripheral,\
 	.transfer_to_peripheral = io_dma_channel_no_transfer_to_peripheral,\
+	.transfer_memory_to_memory = io_dma_channel_no_transfer_memory_to_memory,\
+	.transfer_from_peripheral_circular = io_dma_channel_no_transfer_from_peripheral,\
+	.transfer_position = io_dma_channel_no_transfer_position,\
 	.transfer_complete = io_dma_channel_transfer_complete_nop,\
 	/**/
 
 #define IO_DMA_CHANNEL_STRUCT_MEMBERS	\
 	io_dma_channel_implementation_t const *implementation;\
 	io_event_t complete;	\
+	io_event_t half_complete;	\
 	io_event_t error;	\
 	io_dma_channel_t *next_channel;\
 	/**/
@@ -2131,27 +2847,222 @@ io_dma_transfer_to_peripheral (io_dma_channel_t *channel,void const *src,uint32_
 }
 
 INLINE_FUNCTION void
-io_dma_transfer_complete (io_t *io,io_dma_channel_t *channel) {
-	channel->implementation->transfer_complete (io,channel);
+io_dma_transfer_memory_to_memory (
+	io_dma_channel_t *channel,void *dest,void const *src,uint32_t size
+) {
+	channel->implementation->transfer_memory_to_memory(channel,dest,src,size);
 }
 
-#include <io_value.h>
-#include <io_sockets.h>
-
-#ifdef IMPLEMENT_IO_CORE
-//-----------------------------------------------------------------------------
 //
-// io core implementation (part 1)
+// a circular transfer restarts at the beginning of the buffer when it
+// completes, the position is the number of bytes transferred in the
+// current pass
 //
-//-----------------------------------------------------------------------------
+INLINE_FUNCTION void
+io_dma_transfer_from_peripheral_circular (
+	io_dma_channel_t *channel,void *dest,uint32_t size
+) {
+	channel->implementation->transfer_from_peripheral_circular(channel,dest,size);
+}
 
-static io_cpu_power_domain_t const*
-ro_pd_get_as_read_only (io_cpu_power_domain_pointer_t pd) {
-	return io_cpu_power_domain_pointer_ro (pd);
+INLINE_FUNCTION uint32_t
+io_dma_transfer_position (io_dma_channel_t const *channel) {
+	return channel->implementation->transfer_position(channel);
 }
 
-static io_cpu_power_domain_t*
-ro_pd_get_as_read_write (io_cpu_power_domain_pointer_t pd) {
+INLINE_FUNCTION void
+io_dma_transfer_complete (io_t *io,io_dma_channel_t *channel) {
+	channel->implementation->transfer_complete (io,channel);
+}
+
+//
+// software dma: a reference controller for builds without dma hardware,
+// each channel is one descriptor and next_channel chains descriptors
+// into a scatter-gather list.  Transfers run on the io event loop a
+// burst of bytes per event so other events are processed between bursts,
+// a host port with threads can instead run the bursts on a worker thread
+// (see io_linux.h).
+// A peripheral is a single byte register that is not incremented, or a
+// byte pipe that emulates a peripheral fifo: transfers then only move
+// bytes while the fifo has data (or room) and wait for a request.
+//
+#define IO_SOFTWARE_DMA_DEFAULT_BURST	256
+
+typedef struct io_software_dma_channel io_software_dma_channel_t;
+
+#define IO_SOFTWARE_DMA_CHANNEL_STRUCT_MEMBERS \
+	IO_DMA_CHANNEL_STRUCT_MEMBERS \
+	io_dma_controller_t *controller; \
+	io_software_dma_channel_t *queue_next; \
+	uint8_t volatile *peripheral; \
+	io_byte_pipe_t *peripheral_fifo; \
+	uint8_t const *source; \
+	uint8_t *destination; \
+	uint32_t size; \
+	uint32_t transferred; \
+	uint8_t mode; \
+	bool circular; \
+	bool queued; \
+	/**/
+
+struct PACK_STRUCTURE io_software_dma_channel {
+	IO_SOFTWARE_DMA_CHANNEL_STRUCT_MEMBERS
+};
+
+#define IO_SOFTWARE_DMA_CONTROLLER_STRUCT_MEMBERS \
+	IO_DMA_CONTROLLER_STRUCT_MEMBERS \
+	io_event_t worker; \
+	io_software_dma_channel_t *queue_head; \
+	io_software_dma_channel_t *queue_tail; \
+	uint32_t burst; \
+	bool running; \
+	uint32_t bytes_transferred; \
+	uint32_t descriptors_completed; \
+	uint32_t errors; \
+	/**/
+
+typedef struct io_software_dma_controller {
+	IO_SOFTWARE_DMA_CONTROLLER_STRUCT_MEMBERS
+} io_software_dma_controller_t;
+
+void initialise_io_software_dma_controller (io_software_dma_controller_t*,io_t*,uint32_t);
+void initialise_io_software_dma_channel (io_software_dma_channel_t*,io_dma_controller_t*,uint8_t volatile*);
+bool io_software_dma_channel_load (io_software_dma_channel_t*,uint8_t,void*,void const*,uint32_t);
+void io_software_dma_channel_set_peripheral_fifo (io_software_dma_channel_t*,io_byte_pipe_t*);
+void io_software_dma_channel_request (io_software_dma_channel_t*);
+bool io_software_dma_controller_run_burst (io_software_dma_controller_t*);
+
+extern EVENT_DATA io_dma_controller_implementation_t io_software_dma_controller_implementation;
+extern EVENT_DATA io_dma_channel_implementation_t io_software_dma_channel_implementation;
+
+INLINE_FUNCTION io_software_dma_channel_t*
+cast_to_io_software_dma_channel (io_dma_channel_t *channel) {
+	if (
+			channel != NULL
+		&&	channel->implementation == &io_software_dma_channel_implementation
+	) {
+		return (io_software_dma_channel_t*) channel;
+	} else {
+		return NULL;
+	}
+}
+
+#define io_software_dma_channel_is_busy(c)					(c)->queued
+#define io_software_dma_channel_transferred(c)				(c)->transferred
+#define io_software_dma_controller_bytes_transferred(d)	(d)->bytes_transferred
+#define io_software_dma_controller_descriptors_completed(d)	(d)->descriptors_completed
+#define io_software_dma_controller_errors(d)				(d)->errors
+
+//
+// dma receive ring: a circular transfer from a peripheral straight into
+// the ring of a byte pipe.  The pipe's write index follows the transfer
+// position on half and full transfer events and when the driver flushes
+// on an idle line, so received bytes need no per byte interrupt.  Laps
+// of the ring are counted from complete events so that a whole lap of
+// unread bytes is seen as an overrun, events coalesce so a reader more
+// than a lap behind is seen to overrun but the lost laps are not counted.
+//
+typedef struct io_byte_pipe_dma_receiver {
+	io_t *io;
+	io_dma_controller_t *controller;
+	io_dma_channel_t *channel;
+	io_byte_pipe_t *pipe;
+	io_event_t *data_available;
+	uint32_t laps;
+	uint32_t received;
+	uint32_t overrun;
+	uint32_t errors;
+} io_byte_pipe_dma_receiver_t;
+
+bool start_io_byte_pipe_dma_receiver (io_byte_pipe_dma_receiver_t*,io_t*,io_dma_controller_t*,io_dma_channel_t*,io_byte_pipe_t*,io_event_t*);
+void stop_io_byte_pipe_dma_receiver (io_byte_pipe_dma_receiver_t*);
+void io_byte_pipe_dma_receiver_flush (io_byte_pipe_dma_receiver_t*);
+
+#define io_byte_pipe_dma_receiver_overrun(r)	(r)->overrun
+#define io_byte_pipe_dma_receiver_errors(r)	(r)->errors
+
+//
+// power manager: counts the holders of each managed power domain and
+// turns a domain off once it has had no holders for its hysteresis time,
+// holders are the sockets, dma channels or clocks that need the domain
+//
+#define IO_POWER_DOMAIN_HOLDER_LIMIT	8
+
+typedef enum {
+	IO_POWER_DOMAIN_OFF = 0,
+	IO_POWER_DOMAIN_ON,
+	IO_POWER_DOMAIN_IDLE,			// on without holders
+	IO_POWER_DOMAIN_NUMBER_OF_STATES
+} io_power_domain_state_t;
+
+typedef struct io_power_manager io_power_manager_t;
+
+typedef struct io_power_domain_holder {
+	void const *holder;
+	uint32_t count;
+} io_power_domain_holder_t;
+
+typedef struct io_managed_power_domain {
+	io_power_manager_t *manager;
+	struct io_managed_power_domain *next;
+	io_cpu_power_domain_pointer_t domain;
+	io_power_domain_holder_t holder[IO_POWER_DOMAIN_HOLDER_LIMIT];
+	uint32_t holders;
+	io_power_domain_state_t state;
+	io_time_t hysteresis;
+	io_time_t idle_until;
+	io_time_t state_since;
+	io_time_t time_in_state[IO_POWER_DOMAIN_NUMBER_OF_STATES];
+	uint32_t turned_on;
+	uint32_t turned_off;
+	io_event_t idle_event;
+	io_alarm_t idle_alarm;
+} io_managed_power_domain_t;
+
+typedef io_time_t (*io_power_manager_clock_t) (void*);
+
+struct io_power_manager {
+	io_t *io;
+	io_managed_power_domain_t *domains;
+	io_power_manager_clock_t clock;
+	void *clock_user_value;
+};
+
+void initialise_io_power_manager (io_power_manager_t*,io_t*);
+void io_power_manager_set_clock (io_power_manager_t*,io_power_manager_clock_t,void*);
+void io_power_manager_add_domain (io_power_manager_t*,io_managed_power_domain_t*,io_cpu_power_domain_pointer_t,io_time_t,bool);
+void io_power_manager_remove_domain (io_power_manager_t*,io_managed_power_domain_t*);
+io_managed_power_domain_t* io_power_manager_find_domain (io_power_manager_t*,io_cpu_power_domain_pointer_t);
+void io_power_manager_poll (io_power_manager_t*);
+bool io_power_domain_hold (io_managed_power_domain_t*,void const*);
+bool io_power_domain_release (io_managed_power_domain_t*,void const*);
+bool io_power_domain_is_held_by (io_managed_power_domain_t const*,void const*);
+io_time_t io_power_domain_time_in_state (io_managed_power_domain_t*,io_power_domain_state_t);
+bool io_power_manager_hold_clock (io_power_manager_t*,io_cpu_clock_pointer_t);
+bool io_power_manager_release_clock (io_power_manager_t*,io_cpu_clock_pointer_t);
+
+#define io_power_domain_state(d)			(d)->state
+#define io_power_domain_holders(d)			(d)->holders
+#define io_power_domain_turned_on(d)		(d)->turned_on
+#define io_power_domain_turned_off(d)		(d)->turned_off
+
+#include <io_value.h>
+#include <io_sockets.h>
+
+#ifdef IMPLEMENT_IO_CORE
+//-----------------------------------------------------------------------------
+//
+// io core implementation (part 1)
+//
+//-----------------------------------------------------------------------------
+
+static io_cpu_power_domain_t const*
+ro_pd_get_as_read_only (io_cpu_power_domain_pointer_t pd) {
+	return io_cpu_power_domain_pointer_ro (pd);
+}
+
+static io_cpu_power_domain_t*
+ro_pd_get_as_read_write (io_cpu_power_domain_pointer_t pd) {
 	return NULL;
 }
 
@@ -2192,7 +3103,7 @@ duplicate_io_address (io_byte_memory_t *bm,io_address_t a) {
 			return a;
 			
 		default:
-			if (io_address_is_volatile(a)) {
+			if (io_address_is_volatile(a) || io_address_is_view(a)) {
 				return io_long_address (bm,io_address_size(a),io_address_ro_bytes(a));
 			} else {
 				return a;
@@ -2253,6 +3164,42 @@ read_le_io_address (io_byte_memory_t *bm,uint8_t const *ptr,uint32_t limit,io_ad
 	}
 }
 
+//
+// As read_le_io_address without allocating, a long address refers to the
+// bytes at ptr and is marked as a view so that duplicate_io_address copies
+// it and free_io_address leaves it alone.  The address is only valid while
+// the bytes are.
+//
+uint32_t
+read_le_io_address_view (uint8_t const *ptr,uint32_t limit,io_address_t *address) {
+	uint8_t const *cursor = ptr;
+	uint8_t const *end = cursor + limit;
+	uint32_t size = 0;
+	uint8_t byte = 0;
+
+	do {
+		byte = *cursor++;
+		size <<= 7;
+		size += (byte & 0x7f);
+	} while (byte & 0x80 && cursor < end);
+	
+	if (cursor < end && (byte & 0x80) == 0 && size <= (end - cursor)) {
+		if (size == IO_ADDRESS_INVALID_SIZE || size == 1 || size == 2 || size == 4) {
+			*address = mk_io_address (NULL,size,cursor);
+		} else {
+			*address = (io_address_t) {
+				.tag.size = size,
+				.tag.is_view = 1,
+				.tag.is_volatile = 0,
+				.value.ro_bytes = cursor,
+			};
+		}
+		return (cursor - ptr) + size;
+	} else {
+		return 0;
+	}
+}
+
 //
 // size > 0
 //
@@ -2271,10 +3218,22 @@ compare_as_big_int_values (uint8_t const *a_bytes,uint32_t a_size,uint8_t const
 		
 		if ( s1 > s2 ) {
 			cmp = 1;
-		} else if (s1 > s2) {
+		} else if (s1 < s2) {
 			cmp = -1;
 		} else {
 			uint8_t const *end = a_bytes - 1;
+
+			// a word at a time from the top while there is one
+			while ((a_head - end) >= sizeof(uint32_t)) {
+				uint32_t wa = read_le_uint32 (a_head - 3);
+				uint32_t wb = read_le_uint32 (b_head - 3);
+				if (wa != wb) {
+					return (wa > wb) ? 1 : -1;
+				}
+				a_head -= sizeof(uint32_t);
+				b_head -= sizeof(uint32_t);
+			}
+
 			while (a_head > end) {
 				if (*a_head > *b_head) {
 					cmp = 1;
@@ -2292,30 +3251,44 @@ compare_as_big_int_values (uint8_t const *a_bytes,uint32_t a_size,uint8_t const
 	return cmp;
 }
 
-static int32_t
-compare_io_address_values (io_address_t a,io_address_t b) {
-	return compare_as_big_int_values (
-		get_pointer_to_io_address_value(a),io_address_size(a),
-		get_pointer_to_io_address_value(b),io_address_size(b)
-	);
-}
-
 //
-// compare as little endian big numbers
+// compare_io_addresses when one of a or b is not inline
 //
 int32_t
-compare_io_addresses (io_address_t a,io_address_t b) {
-	int32_t cmp = 0;
-	
-	if (io_address_is_invalid(b)) {
-		return (io_address_is_invalid(a)) ? 0 : -1;
-	} else if (io_address_is_invalid(a)) {
-		return (io_address_is_invalid(b)) ? 0 : 1;
+compare_io_long_addresses (io_address_t a,io_address_t b) {
+	if (io_address_is_inline(a)) {
+		uint8_t bytes[4];
+		write_le_uint32 (bytes,io_inline_address_value (a));
+		return compare_as_big_int_values (
+			bytes,sizeof(bytes),io_address_ro_bytes(b),io_address_size(b)
+		);
+	} else if (io_address_is_inline(b)) {
+		uint8_t bytes[4];
+		write_le_uint32 (bytes,io_inline_address_value (b));
+		return compare_as_big_int_values (
+			io_address_ro_bytes(a),io_address_size(a),bytes,sizeof(bytes)
+		);
 	} else {
-		cmp = compare_io_address_values(a,b);
+		return compare_as_big_int_values (
+			io_address_ro_bytes(a),io_address_size(a),
+			io_address_ro_bytes(b),io_address_size(b)
+		);
 	}
-	
-	return cmp;
+}
+
+uint32_t
+io_long_address_hash (io_address_t a) {
+	uint8_t const *cursor = io_address_ro_bytes(a);
+	uint8_t const *end = cursor + io_address_size(a);
+	uint32_t h = IO_ADDRESS_HASH_BASIS;
+
+	while (end > cursor && end[-1] == 0) end--;
+
+	while (cursor < end) {
+		h = (h ^ *cursor++) * IO_ADDRESS_HASH_PRIME;
+	}
+
+	return h;
 }
 
 void
@@ -2444,6 +3417,14 @@ void
 io_no_enqueue_alarm (io_t *io,io_alarm_t *alarm) {
 }
 
+void
+io_no_set_wakeup_time (io_t *io,io_time_t t) {
+}
+
+void
+io_no_sleep (io_t *io) {
+}
+
 bool
 io_no_enter_critical_section (io_t *io) {
 	return false;
@@ -2662,6 +3643,107 @@ initialise_io (io_t *io,io_implementation_t const *I) {
 	io->events = &s_null_io_event;
 	io->alarms = &s_null_io_alarm;
 	io->log_level = IO_LOG_LEVEL_NO_LOGGING;
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+	io->instrumentation = NULL;
+#endif
+}
+
+//
+// tickless alarms
+//
+// The alarm list is kept in time order so the head is always the
+// next deadline.  Instead of a periodic tick the platform programs
+// a single wake up for the head; set_wakeup_time and sleep are the
+// only hooks a port needs to provide.
+//
+void
+enqueue_io_alarm (io_t *io,io_alarm_t *alarm) {
+	ENTER_CRITICAL_SECTION(io);
+	if (alarm->next_alarm == NULL) {
+		if (
+				io->alarms == &s_null_io_alarm
+			||	alarm->when.ns < io->alarms->when.ns
+		) {
+			alarm->next_alarm = io->alarms;
+			io->alarms = alarm;
+			io_set_wakeup_time (io,alarm->when);
+		} else {
+			io_alarm_t *prev = io->alarms;
+			while (
+					prev->next_alarm != &s_null_io_alarm
+				&&	prev->next_alarm->when.ns <= alarm->when.ns
+			) {
+				prev = prev->next_alarm;
+			}
+			alarm->next_alarm = prev->next_alarm;
+			prev->next_alarm = alarm;
+		}
+	}
+	EXIT_CRITICAL_SECTION(io);
+}
+
+void
+dequeue_io_alarm (io_t *io,io_alarm_t *alarm) {
+	ENTER_CRITICAL_SECTION(io);
+	if (alarm->next_alarm != NULL) {
+		if (io->alarms == alarm) {
+			io->alarms = alarm->next_alarm;
+			io_set_wakeup_time (io,io->alarms->when);
+		} else {
+			io_alarm_t *prev = io->alarms;
+			while (prev != &s_null_io_alarm) {
+				if (prev->next_alarm == alarm) {
+					prev->next_alarm = alarm->next_alarm;
+					break;
+				}
+				prev = prev->next_alarm;
+			}
+		}
+		alarm->next_alarm = NULL;
+	}
+	EXIT_CRITICAL_SECTION(io);
+}
+
+//
+// move every expired alarm onto the event queue, returns the number
+// of alarms that fired
+//
+uint32_t
+do_due_io_alarms (io_t *io) {
+	io_time_t now = io_get_time (io);
+	uint32_t count = 0;
+
+	ENTER_CRITICAL_SECTION(io);
+	while (io->alarms->when.ns <= now.ns) {
+		io_alarm_t *alarm = io->alarms;
+		io->alarms = alarm->next_alarm;
+		alarm->next_alarm = NULL;
+		io_enqueue_event (io,alarm->at);
+		count ++;
+	}
+	if (count) {
+		io_set_wakeup_time (io,io->alarms->when);
+	}
+	EXIT_CRITICAL_SECTION(io);
+
+	return count;
+}
+
+//
+// wait_for_event for ports without a periodic tick, the core sleeps
+// only when no event is pending and wakes at the next alarm deadline
+//
+void
+tickless_wait_for_io_event (io_t *io) {
+	if (do_due_io_alarms (io) == 0) {
+		ENTER_CRITICAL_SECTION(io);
+		if (io->events == &s_null_io_event) {
+			io_set_wakeup_time (io,io->alarms->when);
+			SLEEP_IN_CRITICAL_SECTION(io);
+		}
+		EXIT_CRITICAL_SECTION(io);
+		do_due_io_alarms (io);
+	}
 }
 
 int
@@ -2928,6 +4010,267 @@ io_cpu_clock_function_implementation = {
 	)
 };
 
+//
+// clock scaler
+//
+float64_t
+io_cpu_clock_scaler_get_expected_frequency (io_cpu_clock_pointer_t clock) {
+	io_cpu_clock_scaler_t const *this = (io_cpu_clock_scaler_t const*) (
+		io_cpu_clock_ro_pointer (clock)
+	);
+	io_cpu_clock_scaler_setting_t *setting = this->setting;
+
+	if (setting->frequency == 0 && setting->divider > 0) {
+		setting->frequency = (
+				io_cpu_clock_get_expected_frequency (this->input)
+			*	setting->multiplier
+			/	setting->divider
+		);
+	}
+
+	return setting->frequency;
+}
+
+static bool
+io_cpu_clock_invalidate_output (io_cpu_clock_pointer_t clock,void *user_value) {
+	io_cpu_clock_invalidate_frequency (clock);
+	return true;
+}
+
+//
+// clear the cached frequencies of a clock and the clocks it drives
+//
+void
+io_cpu_clock_invalidate_frequency (io_cpu_clock_pointer_t clock) {
+	io_cpu_clock_scaler_t const *scaler = cast_to_io_cpu_clock_scaler (clock);
+	if (scaler != NULL) {
+		scaler->setting->frequency = 0;
+	}
+	io_cpu_clock_iterate_outputs (clock,io_cpu_clock_invalidate_output,NULL);
+}
+
+bool
+io_cpu_clock_scaler_select (
+	io_cpu_clock_pointer_t clock,uint16_t multiplier,uint16_t divider
+) {
+	io_cpu_clock_scaler_t const *this = cast_to_io_cpu_clock_scaler (clock);
+	if (
+			this != NULL
+		&&	multiplier >= this->minimum_multiplier
+		&&	multiplier <= this->maximum_multiplier
+		&&	divider >= this->minimum_divider
+		&&	divider <= this->maximum_divider
+		&&	divider > 0
+	) {
+		this->setting->multiplier = multiplier;
+		this->setting->divider = divider;
+		io_cpu_clock_invalidate_frequency (clock);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+EVENT_DATA io_cpu_clock_implementation_t
+io_cpu_clock_scaler_implementation = {
+	SPECIALISE_IO_CPU_CLOCK_SCALER_IMPLEMENTATION (
+		&io_cpu_clock_function_implementation
+	)
+};
+
+//
+// clock planner
+//
+static float64_t
+io_cpu_clock_frequency_cost (io_cpu_clock_pointer_t clock,float64_t frequency) {
+	return frequency;
+}
+
+static uint32_t
+io_cpu_clock_scaler_depth (io_cpu_clock_pointer_t clock) {
+	uint32_t depth = 0;
+	while (!io_cpu_clock_is_null (clock = io_cpu_clock_get_input (clock))) {
+		depth ++;
+	}
+	return depth;
+}
+
+static int32_t
+io_cpu_clock_plan_index_of (io_cpu_clock_plan_t *this,io_cpu_clock_scaler_t const *scaler) {
+	for (int32_t i = 0; i < this->number_of_scalers; i++) {
+		if (this->scaler[i] == scaler) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+//
+// the scalers of all targets, sources first
+//
+static bool
+io_cpu_clock_plan_collect (io_cpu_clock_plan_t *this) {
+	this->number_of_scalers = 0;
+
+	for (uint32_t t = 0; t < this->number_of_targets; t++) {
+		io_cpu_clock_pointer_t clock = this->targets[t].clock;
+		while (!io_cpu_clock_is_null (clock)) {
+			io_cpu_clock_scaler_t const *scaler = cast_to_io_cpu_clock_scaler (clock);
+			if (scaler != NULL && io_cpu_clock_plan_index_of (this,scaler) < 0) {
+				if (this->number_of_scalers == IO_CPU_CLOCK_PLAN_MAXIMUM_SCALERS) {
+					return false;
+				}
+				this->scaler[this->number_of_scalers++] = scaler;
+			}
+			clock = io_cpu_clock_get_input (clock);
+		}
+	}
+
+	for (uint32_t i = 1; i < this->number_of_scalers; i++) {
+		io_cpu_clock_scaler_t const *s = this->scaler[i];
+		uint32_t depth = io_cpu_clock_scaler_depth (IO_CPU_CLOCK (s));
+		int32_t j = i - 1;
+		while (j >= 0 && io_cpu_clock_scaler_depth (IO_CPU_CLOCK (this->scaler[j])) > depth) {
+			this->scaler[j + 1] = this->scaler[j];
+			j--;
+		}
+		this->scaler[j + 1] = s;
+	}
+
+	return true;
+}
+
+//
+// check the targets whose scalers all have a setting
+//
+static bool
+io_cpu_clock_plan_targets_ok (io_cpu_clock_plan_t *this,int32_t decided) {
+	for (uint32_t t = 0; t < this->number_of_targets; t++) {
+		io_cpu_clock_target_t const *target = this->targets + t;
+		io_cpu_clock_pointer_t clock = target->clock;
+		bool ready = true;
+
+		while (ready && !io_cpu_clock_is_null (clock)) {
+			io_cpu_clock_scaler_t const *scaler = cast_to_io_cpu_clock_scaler (clock);
+			if (scaler != NULL) {
+				ready = io_cpu_clock_plan_index_of (this,scaler) <= decided;
+			}
+			clock = io_cpu_clock_get_input (clock);
+		}
+
+		if (ready) {
+			float64_t f = io_cpu_clock_get_expected_frequency (target->clock);
+			if (f < target->minimum || f > target->maximum) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void
+io_cpu_clock_plan_search (io_cpu_clock_plan_t *this,uint32_t index,float64_t cost) {
+	io_cpu_clock_scaler_t const *scaler;
+	float64_t input;
+
+	if (index == this->number_of_scalers) {
+		if (!this->found || cost < this->best_cost) {
+			this->found = true;
+			this->best_cost = cost;
+			for (uint32_t i = 0; i < this->number_of_scalers; i++) {
+				this->best[i] = *this->scaler[i]->setting;
+			}
+		}
+		return;
+	}
+
+	scaler = this->scaler[index];
+	input = io_cpu_clock_get_expected_frequency (scaler->input);
+
+	for (uint32_t m = scaler->minimum_multiplier; m <= scaler->maximum_multiplier; m++) {
+		for (uint32_t d = scaler->minimum_divider; d <= scaler->maximum_divider; d++) {
+			uint32_t g;
+			float64_t f,c;
+
+			if (d == 0) {
+				continue;
+			}
+
+			// an equal ratio with smaller numbers is also searched
+			g = gcd_uint32 (m,d);
+			if (
+					g > 1
+				&&	m / g >= scaler->minimum_multiplier
+				&&	d / g >= scaler->minimum_divider
+			) {
+				continue;
+			}
+
+			f = input * m / d;
+			if (scaler->maximum_frequency > 0 && f > scaler->maximum_frequency) {
+				continue;
+			}
+
+			c = cost + this->cost (IO_CPU_CLOCK (scaler),f);
+			if (this->found && c >= this->best_cost) {
+				continue;
+			}
+
+			this->evaluations ++;
+			*scaler->setting = (io_cpu_clock_scaler_setting_t) {
+				.multiplier = m,
+				.divider = d,
+				.frequency = f,
+			};
+			if (io_cpu_clock_plan_targets_ok (this,index)) {
+				io_cpu_clock_plan_search (this,index + 1,c);
+			}
+		}
+	}
+}
+
+//
+// choose scaler settings that meet the targets, the settings are
+// left unchanged if there are none
+//
+bool
+plan_io_cpu_clocks (
+	io_cpu_clock_plan_t *this,
+	io_cpu_clock_target_t const *targets,
+	uint32_t number_of_targets,
+	io_cpu_clock_cost_t cost
+) {
+	io_cpu_clock_scaler_setting_t original[IO_CPU_CLOCK_PLAN_MAXIMUM_SCALERS];
+
+	this->targets = targets;
+	this->number_of_targets = number_of_targets;
+	this->cost = (cost != NULL) ? cost : io_cpu_clock_frequency_cost;
+	this->best_cost = 0;
+	this->evaluations = 0;
+	this->found = false;
+
+	if (!io_cpu_clock_plan_collect (this)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < this->number_of_scalers; i++) {
+		original[i] = *this->scaler[i]->setting;
+	}
+
+	if (io_cpu_clock_plan_targets_ok (this,-1)) {
+		io_cpu_clock_plan_search (this,0,0);
+	}
+
+	// sources first, each invalidates the clocks it drives so those that
+	// are not targets see the new settings
+	for (uint32_t i = 0; i < this->number_of_scalers; i++) {
+		*this->scaler[i]->setting = (this->found) ? this->best[i] : original[i];
+		io_cpu_clock_invalidate_frequency (IO_CPU_CLOCK (this->scaler[i]));
+	}
+
+	return this->found;
+}
+
 
 //
 // pipes
@@ -3048,9 +4391,8 @@ io_byte_pipe_put_byte (io_byte_pipe_t *this,uint8_t byte) {
 uint32_t
 io_byte_pipe_put_bytes (io_byte_pipe_t *this,uint8_t const *byte,uint32_t length) {
 	uint8_t const *end = byte + length;
-	bool ok = true;
-	while (byte < end && ok) {
-		ok = io_byte_pipe_put_byte (this,*byte++);
+	while (byte < end && io_byte_pipe_put_byte (this,*byte)) {
+		byte++;
 	}
 	return length - (end - byte);
 }
@@ -3220,6 +4562,254 @@ io_value_pipe_put_value (io_value_pipe_t *this,vref_t r_value) {
 	}
 }
 
+//
+// channels between io
+//
+static io_channel_ring_t*
+mk_io_channel_ring (io_byte_memory_t *bm,uint16_t length) {
+	io_channel_ring_t *this = io_byte_memory_allocate (bm,sizeof(io_channel_ring_t));
+
+	if (this) {
+		this->write_index = this->read_index = 0;
+		this->size_of_ring = length;
+		this->ring = io_byte_memory_allocate (bm,sizeof(io_channel_message_t) * length);
+		if (this->ring == NULL) {
+			io_byte_memory_free (bm,this);
+			this = NULL;
+		}
+	}
+
+	return this;
+}
+
+static void
+free_io_channel_ring (io_channel_ring_t *this,io_byte_memory_t *bm) {
+	if (this) {
+		io_byte_memory_free (bm,this->ring);
+		io_byte_memory_free (bm,this);
+	}
+}
+
+INLINE_FUNCTION uint16_t
+io_channel_ring_next_index (io_channel_ring_t const *this,uint16_t i) {
+	return (i + 1 < this->size_of_ring) ? i + 1 : 0;
+}
+
+//
+// producer side, the caller guarantees a free slot; returns true when
+// the consumer may have found the ring empty and needs to be woken.
+// The fence orders the store of the write index before the load of the
+// read index, so a consumer that missed the message is always woken.
+//
+static bool
+io_channel_ring_put (io_channel_ring_t *this,io_channel_message_t const *message) {
+	uint16_t j = __atomic_load_n (&this->write_index,__ATOMIC_RELAXED);
+
+	this->ring[j] = *message;
+	__atomic_store_n (
+		&this->write_index,io_channel_ring_next_index (this,j),__ATOMIC_RELEASE
+	);
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+	return __atomic_load_n (&this->read_index,__ATOMIC_ACQUIRE) == j;
+}
+
+//
+// consumer side
+//
+static bool
+io_channel_ring_get (io_channel_ring_t *this,io_channel_message_t *message) {
+	uint16_t i = __atomic_load_n (&this->read_index,__ATOMIC_RELAXED);
+
+	if (i != __atomic_load_n (&this->write_index,__ATOMIC_ACQUIRE)) {
+		*message = this->ring[i];
+		__atomic_store_n (
+			&this->read_index,io_channel_ring_next_index (this,i),__ATOMIC_RELEASE
+		);
+		__atomic_thread_fence (__ATOMIC_SEQ_CST);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+static void
+io_channel_release_event (io_event_t *ev) {
+	io_channel_collect_released (ev->user_value);
+}
+
+io_channel_t*
+mk_io_channel (
+	io_t *sender,io_t *receiver,io_event_t *receive_event,uint16_t length
+) {
+	io_byte_memory_t *bm = io_get_byte_memory (sender);
+	io_channel_t *this = NULL;
+
+	if (length >= 2) {
+		this = io_byte_memory_allocate (bm,sizeof(io_channel_t));
+		if (this) {
+			this->sender = sender;
+			this->receiver = receiver;
+			this->receive_event = receive_event;
+			this->lent = 0;
+			this->signals = 0;
+			initialise_io_event (&this->release_event,io_channel_release_event,this);
+			this->forward = mk_io_channel_ring (bm,length);
+			this->returned = mk_io_channel_ring (bm,length);
+			if (this->forward == NULL || this->returned == NULL) {
+				free_io_channel_ring (this->forward,bm);
+				free_io_channel_ring (this->returned,bm);
+				io_byte_memory_free (bm,this);
+				this = NULL;
+			}
+		}
+	}
+
+	return this;
+}
+
+static void
+io_channel_drop_message (io_channel_t *this,io_channel_message_t const *message) {
+	if (vref_is_valid (message->value)) {
+		unreference_value (message->value);
+	}
+	if (message->encoding != NULL) {
+		unreference_io_encoding (message->encoding);
+	}
+	this->lent --;
+}
+
+//
+// on the sender's core once the receiver has stopped, messages the
+// receiver still holds are not recovered
+//
+void
+free_io_channel (io_channel_t *this) {
+	io_byte_memory_t *bm = io_get_byte_memory (this->sender);
+	io_channel_message_t message;
+
+	io_dequeue_event (this->sender,&this->release_event);
+	while (io_channel_ring_get (this->forward,&message)) {
+		io_channel_drop_message (this,&message);
+	}
+	io_channel_collect_released (this);
+
+	free_io_channel_ring (this->forward,bm);
+	free_io_channel_ring (this->returned,bm);
+	io_byte_memory_free (bm,this);
+}
+
+//
+// a lent message may be in the forward ring, with the receiver or in
+// the returned ring so limiting the loans keeps both rings from filling
+//
+static void
+io_channel_send (io_channel_t *this,io_channel_message_t const *message) {
+	this->lent ++;
+	if (io_channel_ring_put (this->forward,message)) {
+		this->signals ++;
+		io_enqueue_event (this->receiver,this->receive_event);
+	}
+}
+
+INLINE_FUNCTION bool
+io_channel_can_send (io_channel_t const *this) {
+	return this->lent + 1 < (uint32_t) this->forward->size_of_ring;
+}
+
+bool
+io_channel_send_value (io_channel_t *this,vref_t r_value) {
+	if (io_channel_can_send (this)) {
+		io_channel_message_t message = {
+			.value = reference_value (r_value),
+			.encoding = NULL,
+		};
+		io_channel_send (this,&message);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+bool
+io_channel_send_encoding (io_channel_t *this,io_encoding_t *encoding) {
+	if (io_channel_can_send (this)) {
+		io_channel_message_t message = {
+			.value = INVALID_VREF,
+			.encoding = reference_io_encoding (encoding),
+		};
+		io_channel_send (this,&message);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+//
+// on the receiver's core
+//
+bool
+io_channel_receive (io_channel_t *this,io_channel_message_t *message) {
+	return io_channel_ring_get (this->forward,message);
+}
+
+void
+io_channel_release (io_channel_t *this,io_channel_message_t const *message) {
+	if (io_channel_ring_put (this->returned,message)) {
+		io_enqueue_event (this->sender,&this->release_event);
+	}
+}
+
+//
+// on the sender's core
+//
+void
+io_channel_collect_released (io_channel_t *this) {
+	io_channel_message_t message;
+	while (io_channel_ring_get (this->returned,&message)) {
+		io_channel_drop_message (this,&message);
+	}
+}
+
+//
+// coroutines
+//
+static void
+io_coroutine_resume_event (io_event_t *ev) {
+	io_coroutine_t *co = ev->user_value;
+	if (!io_coroutine_is_finished (co)) {
+		co->body (co);
+	}
+}
+
+void
+initialise_io_coroutine (
+	io_coroutine_t *co,io_t *io,io_coroutine_body_t body,void *user_value
+) {
+	co->io = io;
+	co->body = body;
+	co->user_value = user_value;
+	co->resume_point = IO_COROUTINE_FINISHED;
+	co->timed_out = false;
+	initialise_io_event (&co->resume,io_coroutine_resume_event,co);
+	initialise_io_alarm (&co->alarm,&co->resume,&co->resume,time_zero());
+}
+
+void
+start_io_coroutine (io_coroutine_t *co) {
+	stop_io_coroutine (co);
+	co->resume_point = 0;
+	co->timed_out = false;
+	io_enqueue_event (co->io,&co->resume);
+}
+
+void
+stop_io_coroutine (io_coroutine_t *co) {
+	io_coroutine_cancel_alarm (co);
+	io_dequeue_event (co->io,&co->resume);
+	co->resume_point = IO_COROUTINE_FINISHED;
+}
+
 //
 // dma
 //
@@ -3250,6 +4840,17 @@ io_dma_channel_no_transfer_to_peripheral (
 ) {
 }
 
+void
+io_dma_channel_no_transfer_memory_to_memory (
+	io_dma_channel_t *channel,void *dest,void const *src,uint32_t len
+) {
+}
+
+uint32_t
+io_dma_channel_no_transfer_position (io_dma_channel_t const *channel) {
+	return 0;
+}
+
 void
 io_dma_channel_transfer_complete_nop (io_t *io,io_dma_channel_t *channel) {
 }
@@ -3261,1433 +4862,3076 @@ EVENT_DATA io_dma_channel_implementation_t dma_channel_implementation = {
 io_dma_channel_t null_dma_channel = {
 	.implementation = &dma_channel_implementation,
 	.complete = def_io_event(NULL,NULL),
+	.half_complete = def_io_event(NULL,NULL),
 	.error = def_io_event(NULL,NULL),
 	.next_channel = NULL,
 };
 
 //
-// hash
+// software dma
 //
 
-uint64_t integer_hash_u64 (uint64_t key) {
-	key = ~key + (key << 21);
-	key = key ^ (key >> 24);
-	key = key + (key << 3) + (key << 8);
-	key = key ^ (key >> 14);
-	key = key + (key << 2) + (key << 4);
-	key = key ^ (key >> 28);
-	key = key + (key << 31);
-	return key;
+static void io_software_dma_controller_worker (io_event_t*);
+
+void
+initialise_io_software_dma_controller (
+	io_software_dma_controller_t *this,io_t *io,uint32_t burst
+) {
+	this->implementation = &io_software_dma_controller_implementation;
+	this->io = io;
+	initialise_io_event (&this->worker,io_software_dma_controller_worker,this);
+	this->queue_head = NULL;
+	this->queue_tail = NULL;
+	this->burst = (burst > 0) ? burst : IO_SOFTWARE_DMA_DEFAULT_BURST;
+	this->running = false;
+	this->bytes_transferred = 0;
+	this->descriptors_completed = 0;
+	this->errors = 0;
 }
 
-#define tommy_rot(x, k) \
-	(((x) << (k)) | ((x) >> (32 - (k))))
+void
+initialise_io_software_dma_channel (
+	io_software_dma_channel_t *this,
+	io_dma_controller_t *controller,
+	uint8_t volatile *peripheral
+) {
+	this->implementation = &io_software_dma_channel_implementation;
+	initialise_io_event (&this->complete,NULL,NULL);
+	initialise_io_event (&this->half_complete,NULL,NULL);
+	initialise_io_event (&this->error,NULL,NULL);
+	this->next_channel = NULL;
+	this->controller = controller;
+	this->queue_next = NULL;
+	this->peripheral = peripheral;
+	this->peripheral_fifo = NULL;
+	this->source = NULL;
+	this->destination = NULL;
+	this->size = 0;
+	this->transferred = 0;
+	this->mode = IO_DMA_TRANSFER_MEMORY_TO_MEMORY;
+	this->circular = false;
+	this->queued = false;
+}
 
-#define tommy_mix(a, b, c) \
-	do { \
-		a -= c;  a ^= tommy_rot(c, 4);  c += b; \
-		b -= a;  b ^= tommy_rot(a, 6);  a += c; \
-		c -= b;  c ^= tommy_rot(b, 8);  b += a; \
-		a -= c;  a ^= tommy_rot(c, 16);  c += b; \
-		b -= a;  b ^= tommy_rot(a, 19);  a += c; \
-		c -= b;  c ^= tommy_rot(b, 4);  b += a; \
-	} while (0)
+void
+io_software_dma_channel_set_peripheral_fifo (
+	io_software_dma_channel_t *this,io_byte_pipe_t *fifo
+) {
+	this->peripheral_fifo = fifo;
+}
 
-#define tommy_final(a, b, c) \
-	do { \
-		c ^= b; c -= tommy_rot(b, 14); \
-		a ^= c; a -= tommy_rot(c, 11); \
-		b ^= a; b -= tommy_rot(a, 25); \
-		c ^= b; c -= tommy_rot(b, 16); \
-		a ^= c; a -= tommy_rot(c, 4);  \
-		b ^= a; b -= tommy_rot(a, 14); \
-		c ^= b; c -= tommy_rot(b, 24); \
-	} while (0)
+//
+// set the descriptor without starting it, for channels that are
+// later in a chain
+//
+bool
+io_software_dma_channel_load (
+	io_software_dma_channel_t *this,
+	uint8_t mode,
+	void *destination,
+	void const *source,
+	uint32_t size
+) {
+	if (this->queued) {
+		return false;
+	} else {
+		this->mode = mode;
+		this->destination = destination;
+		this->source = source;
+		this->size = size;
+		this->transferred = 0;
+		this->circular = false;
+		return true;
+	}
+}
 
-uint32_t
-tommy_hash_u32 (uint32_t init_val,uint8_t const *key,uint32_t key_len) {
-	uint32_t a, b, c;
+static bool
+io_software_dma_channel_is_valid (io_software_dma_channel_t *this) {
+	bool has_peripheral = (this->peripheral != NULL || this->peripheral_fifo != NULL);
 
-	a = b = c = 0xdeadbeef + ((uint32_t)key_len) + init_val;
+	switch (this->mode) {
+		case IO_DMA_TRANSFER_MEMORY_TO_MEMORY:
+		return this->size == 0 || (this->source != NULL && this->destination != NULL);
 
-	while (key_len > 12) {
-		a += read_le_uint32(key + 0);
-		b += read_le_uint32(key + 4);
-		c += read_le_uint32(key + 8);
+		case IO_DMA_TRANSFER_MEMORY_TO_PERIPHERAL:
+		return this->size == 0 || (this->source != NULL && has_peripheral);
 
-		tommy_mix(a, b, c);
+		case IO_DMA_TRANSFER_PERIPHERAL_TO_MEMORY:
+		if (this->circular) {
+			return this->size > 0 && has_peripheral && this->destination != NULL;
+		} else {
+			return this->size == 0 || (has_peripheral && this->destination != NULL);
+		}
 
-		key_len -= 12;
-		key += 12;
+		default:
+		return false;
 	}
+}
 
-	switch (key_len) {
-	case 0 :
-		return c; /* used only when called with a zero length */
-	case 12 :
-		c += read_le_uint32(key + 8);
-		b += read_le_uint32(key + 4);
-		a += read_le_uint32(key + 0);
-		break;
-	case 11 : c += ((uint32_t)key[10]) << 16; /* fallthrough */
-	case 10 : c += ((uint32_t)key[9]) << 8; /* fallthrough */
-	case 9 : c += key[8]; /* fallthrough */
-	case 8 :
-		b += read_le_uint32(key + 4);
-		a += read_le_uint32(key + 0);
-		break;
-	case 7 : b += ((uint32_t)key[6]) << 16; /* fallthrough */
-	case 6 : b += ((uint32_t)key[5]) << 8; /* fallthrough */
-	case 5 : b += key[4]; /* fallthrough */
-	case 4 :
-		a += read_le_uint32(key + 0);
-		break;
-	case 3 : a += ((uint32_t)key[2]) << 16; /* fallthrough */
-	case 2 : a += ((uint32_t)key[1]) << 8; /* fallthrough */
-	case 1 : a += key[0]; /* fallthrough */
+static void
+io_software_dma_controller_signal (io_software_dma_controller_t *this) {
+	if (this->running && this->queue_head != NULL) {
+		io_enqueue_event (this->io,&this->worker);
 	}
+}
 
-	tommy_final(a, b, c);
+static bool
+io_software_dma_controller_start (io_dma_controller_t *dmac) {
+	io_software_dma_controller_t *this = (io_software_dma_controller_t*) dmac;
+	this->running = true;
+	io_software_dma_controller_signal (this);
+	return true;
+}
 
-	return c;
+static bool
+io_software_dma_controller_stop (io_dma_controller_t *dmac) {
+	io_software_dma_controller_t *this = (io_software_dma_controller_t*) dmac;
+	this->running = false;
+	io_dequeue_event (this->io,&this->worker);
+	return true;
 }
-/*
- * Copyright (c) 2010, Andrea Mazzoleni. All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
- *
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- *
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in the
- *    documentation and/or other materials provided with the distribution.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
- * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
- * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
- * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
- * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
- * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
- * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
- * POSSIBILITY OF SUCH DAMAGE.
- */
 
-string_hash_table_entry_t*
-mk_string_hash_table_entry (
-	io_byte_memory_t *bm,char const *bytes,uint32_t size,string_hash_table_mapping_t map
+static bool
+io_software_dma_controller_start_transfer (
+	io_dma_controller_t *dmac,io_dma_channel_t *c
 ) {
-	string_hash_table_entry_t *entry = io_byte_memory_allocate (
-		bm,sizeof(string_hash_table_entry_t)
-	);
-	
-	if (entry) {
-		entry->size = size;
-		if (size) {
-			entry->bytes = io_byte_memory_allocate (bm,size);
-			if (entry->bytes != NULL) {
-				entry->next_entry = NULL;
-				entry->mapping = map;
-				memcpy (entry->bytes,bytes,size);
-			} else {
-				io_byte_memory_free (bm,entry);
-				entry = NULL;
-			}
-		} else {
-			entry->bytes = NULL;
-		}
-	}
-	
-	return entry;
-}
-
-void
-free_string_hash_table_entry (io_byte_memory_t *bm,string_hash_table_entry_t *entry) {
-	io_byte_memory_free (bm,entry->bytes);
-	io_byte_memory_free (bm,entry);
-}
+	io_software_dma_controller_t *this = (io_software_dma_controller_t*) dmac;
+	io_software_dma_channel_t *channel = cast_to_io_software_dma_channel (c);
 
-string_hash_table_t*
-mk_string_hash_table (io_byte_memory_t *bm,uint32_t initial_size) {
-	string_hash_table_t *this = io_byte_memory_allocate (
-		bm,sizeof(string_hash_table_t)
-	);
-	
-	if (this) {
-		this->bm = bm;
-		this->table_size = next_prime_u32_integer (initial_size);
-		this->table_grow = this->table_size/2;
-		this->table = io_byte_memory_allocate (
-			bm,sizeof(string_hash_table_entry_t*) * this->table_size
-		);
-		if (this->table != NULL) {
-			memset (
-				this->table,0,sizeof(string_hash_table_entry_t*) * this->table_size
-			);
-		} else {
-			io_byte_memory_free (bm,this);
-			this = NULL;
-		}
+	if (channel == NULL || channel->queued) {
+		return false;
 	}
-	
-	return this;
-}
 
-void
-free_string_hash_table (string_hash_table_t *this) {
-	uint32_t i;
-	
-	for (i = 0; i < this->table_size; i++) {
-		string_hash_table_entry_t *next,*cursor = this->table[i];
-		while (cursor != NULL) {
-			next = cursor->next_entry;
-			free_string_hash_table_entry (this->bm,cursor);
-			cursor = next;
-		}
+	channel->transferred = 0;
+	channel->queue_next = NULL;
+	channel->queued = true;
+	if (this->queue_tail != NULL) {
+		this->queue_tail->queue_next = channel;
+	} else {
+		this->queue_head = channel;
 	}
+	this->queue_tail = channel;
 
-	io_byte_memory_free (this->bm,this->table);
-	io_byte_memory_free (this->bm,this);
+	io_software_dma_controller_signal (this);
+	return true;
 }
 
-void
-iterate_string_hash_table (
-	string_hash_table_t *this,bool (*cb) (string_hash_table_entry_t*,void*),void *user_value
+//
+// remove a chain from the queue, no events are raised
+//
+static bool
+io_software_dma_controller_stop_transfer (
+	io_dma_controller_t *dmac,io_dma_channel_t *c
 ) {
-	for (int i = 0; i < this->table_size; i++) {
-		string_hash_table_entry_t *cursor = this->table[i];
-		while (cursor != NULL) {
-			cb (cursor,user_value);
-			cursor = cursor->next_entry;
+	io_software_dma_controller_t *this = (io_software_dma_controller_t*) dmac;
+	io_software_dma_channel_t *previous = NULL;
+	io_software_dma_channel_t *cursor = this->queue_head;
+
+	while (cursor != NULL && (io_dma_channel_t*) cursor != c) {
+		previous = cursor;
+		cursor = cursor->queue_next;
+	}
+
+	if (cursor != NULL) {
+		if (previous != NULL) {
+			previous->queue_next = cursor->queue_next;
+		} else {
+			this->queue_head = cursor->queue_next;
 		}
+		if (this->queue_tail == cursor) {
+			this->queue_tail = previous;
+		}
+		cursor->queue_next = NULL;
+		cursor->queued = false;
+		return true;
+	} else {
+		return false;
 	}
 }
 
-static string_hash_table_entry_t*
-string_hash_table_get_entry (
-	string_hash_table_t *this,const char *data,uint32_t size,int index,int *depth
+//
+// the head of the queue is replaced by the next descriptor in its chain
+//
+static void
+io_software_dma_controller_advance (
+	io_software_dma_controller_t *this,io_software_dma_channel_t *next
 ) {
-	string_hash_table_entry_t *cursor = this->table[index];
-	if (depth) *depth = 0;
-	
-	while (cursor != NULL ) {
-		if (depth)  (*depth) ++;
-		if (cursor->size == size && (size == 0 || memcmp(cursor->bytes,data,size) == 0)) {
-			break;
+	io_software_dma_channel_t *done = this->queue_head;
+
+	if (next != NULL) {
+		next->transferred = 0;
+		next->queued = true;
+		next->queue_next = done->queue_next;
+		this->queue_head = next;
+		if (this->queue_tail == done) {
+			this->queue_tail = next;
+		}
+	} else {
+		this->queue_head = done->queue_next;
+		if (this->queue_tail == done) {
+			this->queue_tail = NULL;
 		}
-		cursor = cursor->next_entry;
 	}
 
-	return cursor;
+	done->queue_next = NULL;
+	done->queued = false;
 }
 
-static void string_hash_table_grow (string_hash_table_t*);
-
-bool
-string_hash_table_insert (
-	string_hash_table_t *this,const char *data,uint32_t size,string_hash_table_mapping_t map
+//
+// the number of bytes the peripheral fifo allows now
+//
+static uint32_t
+io_software_dma_channel_peripheral_limit (
+	io_software_dma_channel_t *this,uint32_t n
 ) {
-	uint32_t index = tommy_hash_u32 (0,(uint8_t const*) data,size) % this->table_size;
-	int depth;
-	
-	string_hash_table_entry_t *cursor = string_hash_table_get_entry (
-		this,data,size,index,&depth
-	);
-
-	if (cursor != NULL ) {
-		cursor->mapping = map;
-		return false;
+	if (this->peripheral_fifo != NULL) {
+		io_pipe_t const *fifo = (io_pipe_t const*) this->peripheral_fifo;
+		uint32_t available = (
+			(this->mode == IO_DMA_TRANSFER_PERIPHERAL_TO_MEMORY)
+			?	io_pipe_count_occupied_slots (fifo)
+			:	io_pipe_count_free_slots (fifo)
+		);
+		return (n < available) ? n : available;
 	} else {
-		if (depth > 7) {
-			string_hash_table_grow (this);
-			string_hash_table_insert (this,data,size,map);
-		} else {
-			cursor = mk_string_hash_table_entry (this->bm,data,size,map);
-			cursor->next_entry = this->table[index];
-			this->table[index] = cursor;
-		}
-		return true;
+		return n;
 	}
 }
 
 static void
-string_hash_table_grow (string_hash_table_t *this) {
-	string_hash_table_entry_t **old_table = this->table;
-	uint32_t old_size = this->table_size;
-	
-	this->table_size = next_prime_u32_integer (this->table_size + this->table_grow);
-	this->table = io_byte_memory_allocate (
-		this->bm,sizeof(string_hash_table_entry_t*) * this->table_size
-	);
-	memset (this->table,0,sizeof(string_hash_table_entry_t*) * this->table_size);
-	for (uint32_t i = 0; i < old_size; i++) {
-		string_hash_table_entry_t *next,*cursor = old_table[i];
-		while (cursor != NULL) {
-			uint32_t index = tommy_hash_u32 (0,(uint8_t const*) cursor->bytes,cursor->size) % this->table_size;
-			next = cursor->next_entry;
-			cursor->next_entry = this->table[index];
-			this->table[index] = cursor;
-			cursor = next;
-		}
-	}
+io_software_dma_channel_move (io_software_dma_channel_t *channel,uint32_t n) {
+	switch (channel->mode) {
+		case IO_DMA_TRANSFER_MEMORY_TO_MEMORY:
+			memcpy (
+				channel->destination + channel->transferred,
+				channel->source + channel->transferred,
+				n
+			);
+		break;
 
-	io_byte_memory_free (this->bm,old_table);
-}
+		case IO_DMA_TRANSFER_MEMORY_TO_PERIPHERAL: {
+			uint8_t const *src = channel->source + channel->transferred;
+			for (uint32_t i = 0; i < n; i++) {
+				if (channel->peripheral_fifo != NULL) {
+					io_byte_pipe_put_byte (channel->peripheral_fifo,src[i]);
+				} else {
+					*channel->peripheral = src[i];
+				}
+			}
+		}
+		break;
 
-bool
-string_hash_table_remove (
-	string_hash_table_t *this,const char *data,uint32_t size
-) {
-	int index = tommy_hash_u32 (0,(uint8_t const*) data,size) % this->table_size;
-	string_hash_table_entry_t **cursor = this->table + index;
-	
-	if (*cursor != NULL) {
-		while (*cursor != NULL) {
-			if (((*cursor)->size) == size &&  memcmp ((*cursor)->bytes,data,size) == 0) {
-				string_hash_table_entry_t *remove = *cursor;
-				*cursor = (*cursor)->next_entry;
-				free_string_hash_table_entry (this->bm,remove);
-				return true;
+		case IO_DMA_TRANSFER_PERIPHERAL_TO_MEMORY: {
+			uint8_t *dest = channel->destination + channel->transferred;
+			for (uint32_t i = 0; i < n; i++) {
+				if (channel->peripheral_fifo != NULL) {
+					io_byte_pipe_get_byte (channel->peripheral_fifo,dest + i);
+				} else {
+					dest[i] = *channel->peripheral;
+				}
 			}
-			cursor = &((*cursor)->next_entry);
 		}
+		break;
 	}
-	
-	return false;
 }
 
-bool
-string_hash_table_map (string_hash_table_t *this,const char *data,uint32_t size,string_hash_table_mapping_t *map) {
-	uint32_t index = tommy_hash_u32 (0,(uint8_t const*) data,size) % this->table_size;
-	int depth;
-	
-	string_hash_table_entry_t *cursor = string_hash_table_get_entry (
-		this,data,size,index,&depth
-	);
-
-	if (cursor != NULL ) {
-		*map = cursor->mapping;
-		return true;
-	} else {
-		return false;
+static uint32_t
+io_software_dma_controller_queue_length (io_software_dma_controller_t *this) {
+	io_software_dma_channel_t *cursor = this->queue_head;
+	uint32_t length = 0;
+	while (cursor != NULL) {
+		length ++;
+		cursor = cursor->queue_next;
 	}
+	return length;
 }
 
 //
+// a channel waiting for its peripheral goes to the back of the queue
 //
+static void
+io_software_dma_controller_rotate (io_software_dma_controller_t *this) {
+	io_software_dma_channel_t *head = this->queue_head;
+	if (head != this->queue_tail) {
+		this->queue_head = head->queue_next;
+		this->queue_tail->queue_next = head;
+		this->queue_tail = head;
+		head->queue_next = NULL;
+	}
+}
+
 //
-typedef struct vref_bucket_hash_table_entry {
-	struct vref_bucket_hash_table_entry *next_entry;
-	vref_t r_value;
-} vref_bucket_hash_table_entry_t;
+// move up to one burst of bytes, returns false when there is nothing
+// to do until a transfer is started or a peripheral requests
+//
+bool
+io_software_dma_controller_run_burst (io_software_dma_controller_t *this) {
+	uint32_t budget = this->burst;
+	uint32_t waiting = 0;
+
+	while (budget > 0 && this->running && this->queue_head != NULL) {
+		io_software_dma_channel_t *channel = this->queue_head;
+		uint32_t half = channel->size / 2;
+		uint32_t n;
+
+		if (!io_software_dma_channel_is_valid (channel)) {
+			// the rest of the chain is abandoned
+			this->errors ++;
+			io_software_dma_controller_advance (this,NULL);
+			io_enqueue_event (this->io,&channel->error);
+			continue;
+		}
 
-typedef struct PACK_STRUCTURE {
-	VREF_HASH_TABLE_STRUCT_MEMBERS
-	vref_bucket_hash_table_entry_t **table;	
-	io_byte_memory_t *bm;
-	uint32_t table_size;
-	uint32_t table_grow;
-} vref_bucket_hash_table_t;
+		n = channel->size - channel->transferred;
+		if (n > budget) {
+			n = budget;
+		}
+		n = io_software_dma_channel_peripheral_limit (channel,n);
 
-vref_hash_table_t*
-mk_vref_bucket_hash_table (io_byte_memory_t *bm,uint32_t initial_size) {
-	extern EVENT_DATA vref_hash_table_implementation_t vref_bucket_hash_implementation;
-	vref_bucket_hash_table_t *this = io_byte_memory_allocate (
-		bm,sizeof(vref_bucket_hash_table_t)
-	);
-	
-	if (this) {
-		this->implementation = &vref_bucket_hash_implementation;
-		this->bm = bm;
-		this->table_size = next_prime_u32_integer (initial_size);
-		this->table_grow = this->table_size/2;
-		this->table = io_byte_memory_allocate (
-			bm,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size
-		);
-		if (this->table != NULL) {
-			memset (
-				this->table,0,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size
-			);
-		} else {
-			io_byte_memory_free (bm,this);
-			this = NULL;
+		if (n == 0 && channel->transferred < channel->size) {
+			if (++waiting >= io_software_dma_controller_queue_length (this)) {
+				// every queued channel waits for a request
+				return false;
+			}
+			io_software_dma_controller_rotate (this);
+			continue;
+		}
+		waiting = 0;
+
+		io_software_dma_channel_move (channel,n);
+
+		if (channel->transferred < half && channel->transferred + n >= half) {
+			io_enqueue_event (this->io,&channel->half_complete);
+		}
+		channel->transferred += n;
+		this->bytes_transferred += n;
+		budget -= n;
+
+		if (channel->transferred == channel->size) {
+			this->descriptors_completed ++;
+			io_enqueue_event (this->io,&channel->complete);
+
+			if (channel->circular) {
+				channel->transferred = 0;
+			} else {
+				io_dma_channel_t *link = channel->next_channel;
+				io_software_dma_channel_t *next = cast_to_io_software_dma_channel (link);
+
+				if (link != NULL && (next == NULL || next->queued)) {
+					// only idle software channels can be chained
+					this->errors ++;
+					io_software_dma_controller_advance (this,NULL);
+					io_enqueue_event (this->io,&channel->error);
+				} else {
+					io_software_dma_controller_advance (this,next);
+				}
+			}
 		}
 	}
-	
-	return (vref_hash_table_t*) this;
+
+	return this->running && this->queue_head != NULL;
 }
 
 static void
-free_vref_bucket_hash_table (vref_hash_table_t *ht) {
-	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
-	uint32_t i;
-	
-	for (i = 0; i < this->table_size; i++) {
-		vref_bucket_hash_table_entry_t *next,*cursor = this->table[i];
-		while (cursor != NULL) {
-			next = cursor->next_entry;
-			unreference_value (cursor->r_value);
-			io_byte_memory_free (this->bm,cursor);
-			cursor = next;
-		}
+io_software_dma_controller_worker (io_event_t *ev) {
+	io_software_dma_controller_t *this = ev->user_value;
+	if (io_software_dma_controller_run_burst (this)) {
+		io_software_dma_controller_signal (this);
 	}
-	
-	io_byte_memory_free (this->bm,this->table);
-	io_byte_memory_free (this->bm,this);
 }
 
-uint32_t
-vref_bucket_hash (vref_bucket_hash_table_t *ht,vref_t r_value) {
-	return (
-			integer_hash_u64 (vref_get_as_builtin_integer(r_value))
-		%	ht->table_size
-	);
+//
+// the peripheral has data, or room, for its channel
+//
+void
+io_software_dma_channel_request (io_software_dma_channel_t *this) {
+	if (this->queued) {
+		io_software_dma_controller_signal (
+			(io_software_dma_controller_t*) this->controller
+		);
+	}
 }
 
-static vref_bucket_hash_table_entry_t*
-vref_bucket_hash_get_entry (
-	vref_bucket_hash_table_t *this,vref_t r_value,int index,int *depth
+static void
+io_software_dma_channel_transfer_from_peripheral (
+	io_dma_channel_t *channel,void *dest,uint32_t size
 ) {
-	vref_bucket_hash_table_entry_t *cursor = this->table[index];
-	if (depth) *depth = 0;
-	
-	while (cursor != NULL ) {
-		if (depth)  (*depth) ++;
-		if (vref_is_equal_to ((cursor->r_value),r_value)) {
-			break;
-		}
-		cursor = cursor->next_entry;
+	io_software_dma_channel_t *this = (io_software_dma_channel_t*) channel;
+	if (
+		io_software_dma_channel_load (
+			this,IO_DMA_TRANSFER_PERIPHERAL_TO_MEMORY,dest,NULL,size
+		)
+	) {
+		io_dma_controller_start_transfer (this->controller,channel);
 	}
-
-	return cursor;
 }
 
-static void	vref_bucket_hash_grow (vref_bucket_hash_table_t*);
-
-static bool
-vref_bucket_hash_insert (vref_bucket_hash_table_t *this,vref_t r_value) {
-	int depth,index = vref_bucket_hash (this,r_value);
-	vref_bucket_hash_table_entry_t *cursor = vref_bucket_hash_get_entry (
-		this,r_value,index,&depth
-	);
-
-	if (cursor != NULL ) {
-		return false;
-	} else {
-		if (depth > 7) {
-			vref_bucket_hash_grow (this);
-			return vref_bucket_hash_insert (this,r_value);
-		} else {
-			cursor = io_byte_memory_allocate (
-				this->bm,sizeof(vref_bucket_hash_table_entry_t)
-			);
-			memset (cursor,0,sizeof(vref_bucket_hash_table_entry_t));
-			cursor->next_entry = this->table[index];
-			this->table[index] = cursor;
-			cursor->r_value = reference_value (r_value);
-			return true;
-		}
+static void
+io_software_dma_channel_transfer_to_peripheral (
+	io_dma_channel_t *channel,void const *src,uint32_t size
+) {
+	io_software_dma_channel_t *this = (io_software_dma_channel_t*) channel;
+	if (
+		io_software_dma_channel_load (
+			this,IO_DMA_TRANSFER_MEMORY_TO_PERIPHERAL,NULL,src,size
+		)
+	) {
+		io_dma_controller_start_transfer (this->controller,channel);
 	}
 }
 
 static void
-vref_bucket_hash_grow (vref_bucket_hash_table_t *this) {
-	vref_bucket_hash_table_entry_t **old_table = this->table;
-	uint32_t old_size = this->table_size;
-	
-	this->table_size = next_prime_u32_integer (this->table_size + this->table_grow);
-	this->table = io_byte_memory_allocate (
-		this->bm,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size
-	);
-	memset (this->table,0,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size);
-	for (uint32_t i = 0; i < old_size; i++) {
-		vref_bucket_hash_table_entry_t *next,*cursor = old_table[i];
-		while (cursor != NULL) {
-			next = cursor->next_entry;
-			vref_bucket_hash_insert (this,cursor->r_value);
-			unreference_value (cursor->r_value);
-			io_byte_memory_free (this->bm,cursor);
-			cursor = next;
-		}
+io_software_dma_channel_transfer_memory_to_memory (
+	io_dma_channel_t *channel,void *dest,void const *src,uint32_t size
+) {
+	io_software_dma_channel_t *this = (io_software_dma_channel_t*) channel;
+	if (
+		io_software_dma_channel_load (
+			this,IO_DMA_TRANSFER_MEMORY_TO_MEMORY,dest,src,size
+		)
+	) {
+		io_dma_controller_start_transfer (this->controller,channel);
 	}
-
-	io_byte_memory_free (this->bm,old_table);
 }
 
-static bool
-vref_bucket_hash_insert_value (vref_hash_table_t *ht,vref_t r_value) {
-	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
-	return vref_bucket_hash_insert (this,r_value);
+static void
+io_software_dma_channel_transfer_from_peripheral_circular (
+	io_dma_channel_t *channel,void *dest,uint32_t size
+) {
+	io_software_dma_channel_t *this = (io_software_dma_channel_t*) channel;
+	if (
+		io_software_dma_channel_load (
+			this,IO_DMA_TRANSFER_PERIPHERAL_TO_MEMORY,dest,NULL,size
+		)
+	) {
+		this->circular = true;
+		io_dma_controller_start_transfer (this->controller,channel);
+	}
 }
 
-static bool
-vref_bucket_hash_contains (vref_hash_table_t *ht,vref_t r_value) {
-	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
-	int index = vref_bucket_hash (this,r_value);
-	return NULL != vref_bucket_hash_get_entry (this,r_value,index,NULL);
+static uint32_t
+io_software_dma_channel_transfer_position (io_dma_channel_t const *channel) {
+	return ((io_software_dma_channel_t const*) channel)->transferred;
 }
 
-static bool
-vref_bucket_hash_remove (vref_hash_table_t *ht,vref_t r_value) {
-	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
-	int index = vref_bucket_hash (this,r_value);
-	vref_bucket_hash_table_entry_t **cursor = this->table + index;
-	
-	if (*cursor != NULL) {
-		while (*cursor != NULL) {
-			if (vref_is_equal_to (((*cursor)->r_value),r_value)) {
-				vref_bucket_hash_table_entry_t *remove = *cursor;
-				*cursor = (*cursor)->next_entry;
-				unreference_value (remove->r_value);
-				io_byte_memory_free (this->bm,remove);
-				return true;
-			}
-			cursor = &((*cursor)->next_entry);
-		}
-	}
-	
-	return false;
-}
+EVENT_DATA io_dma_controller_implementation_t io_software_dma_controller_implementation = {
+	SPECIALISE_IO_DMA_CONTROLLER_IMPLEMENTATION (NULL)
+	.start_controller = io_software_dma_controller_start,
+	.stop_controller = io_software_dma_controller_stop,
+	.start_transfer = io_software_dma_controller_start_transfer,
+	.stop_transfer = io_software_dma_controller_stop_transfer,
+};
 
-EVENT_DATA vref_hash_table_implementation_t vref_bucket_hash_implementation = {
-	.free = free_vref_bucket_hash_table,
-	.insert = vref_bucket_hash_insert_value,
-	.contains = vref_bucket_hash_contains,
-	.remove = vref_bucket_hash_remove,
+EVENT_DATA io_dma_channel_implementation_t io_software_dma_channel_implementation = {
+	SPECIALISE_IO_DMA_CHANNEL_IMPLEMENTATION (&dma_channel_implementation)
+	.transfer_from_peripheral = io_software_dma_channel_transfer_from_peripheral,
+	.transfer_to_peripheral = io_software_dma_channel_transfer_to_peripheral,
+	.transfer_memory_to_memory = io_software_dma_channel_transfer_memory_to_memory,
+	.transfer_from_peripheral_circular = io_software_dma_channel_transfer_from_peripheral_circular,
+	.transfer_position = io_software_dma_channel_transfer_position,
 };
 
 //
-// reference to umm value
+// dma receive ring
 //
-vref_t
-io_reference_to_umm_value_reference (vref_t r_value) {
-	io_value_t *value = vref_cast_to_rw_pointer (r_value);
-	if (value) {
-		io_value_reference_count(value) ++;
-	}
-	return r_value;
-}
-
 static void
-free_umm_value (umm_io_value_memory_t *this,io_value_t *value) {
-	io_value_free (value);
-	umm_free (this->bm,value);
+io_byte_pipe_dma_receiver_half_complete (io_event_t *ev) {
+	io_byte_pipe_dma_receiver_flush (ev->user_value);
 }
 
 static void
-io_reference_to_umm_value_unreference (vref_t r_value) {
-	io_value_t *value = vref_cast_to_rw_pointer (r_value);
-	if (value) {
-		if (io_value_reference_count(value)) {
-			io_value_reference_count(value) --;
-		} else {
-			// a panic really
-		}
-	}
+io_byte_pipe_dma_receiver_complete (io_event_t *ev) {
+	io_byte_pipe_dma_receiver_t *this = ev->user_value;
+	this->laps ++;
+	io_byte_pipe_dma_receiver_flush (this);
 }
 
-int64_t
-io_reference_to_umm_value_get_as_builtin_integer (vref_t r_value) {
-	return vref_expando(r_value).ptr;
+static void
+io_byte_pipe_dma_receiver_error (io_event_t *ev) {
+	io_byte_pipe_dma_receiver_t *this = ev->user_value;
+	this->errors ++;
 }
 
-void const*
-io_reference_to_umm_value_cast_to_ro_pointer (vref_t r_value) {
-	return (void const*) io_value_reference_p32_to_c_pointer(r_value);
-}
+bool
+start_io_byte_pipe_dma_receiver (
+	io_byte_pipe_dma_receiver_t *this,
+	io_t *io,
+	io_dma_controller_t *controller,
+	io_dma_channel_t *channel,
+	io_byte_pipe_t *pipe,
+	io_event_t *data_available
+) {
+	this->io = io;
+	this->controller = controller;
+	this->channel = channel;
+	this->pipe = pipe;
+	this->data_available = data_available;
+	this->laps = 0;
+	this->received = 0;
+	this->overrun = 0;
+	this->errors = 0;
+
+	initialise_io_event (&channel->complete,io_byte_pipe_dma_receiver_complete,this);
+	initialise_io_event (&channel->half_complete,io_byte_pipe_dma_receiver_half_complete,this);
+	initialise_io_event (&channel->error,io_byte_pipe_dma_receiver_error,this);
+
+	pipe->read_index = pipe->write_index = 0;
+	io_dma_transfer_from_peripheral_circular (
+		channel,pipe->byte_ring,pipe->size_of_ring
+	);
 
-void*
-io_reference_to_umm_value_cast_to_rw_pointer (vref_t r_value) {
-	return (void*) io_value_reference_p32_to_c_pointer(r_value);
+	return io_dma_controller_start_controller (controller);
 }
 
-io_value_memory_t*
-io_reference_to_umm_value_get_containing_memory (vref_t r_value) {
-	return io_get_value_memory_by_id (io_value_reference_p32_memory(r_value));
+void
+stop_io_byte_pipe_dma_receiver (io_byte_pipe_dma_receiver_t *this) {
+	io_dma_controller_stop_transfer (this->controller,this->channel);
+	io_byte_pipe_dma_receiver_flush (this);
+	io_dequeue_event (this->io,&this->channel->complete);
+	io_dequeue_event (this->io,&this->channel->half_complete);
+	io_dequeue_event (this->io,&this->channel->error);
 }
 
-EVENT_DATA io_value_reference_implementation_t reference_to_umm_value = {
-	.reference = io_reference_to_umm_value_reference,
-	.unreference = io_reference_to_umm_value_unreference,
-	.cast_to_ro_pointer = io_reference_to_umm_value_cast_to_ro_pointer,
-	.cast_to_rw_pointer = io_reference_to_umm_value_cast_to_rw_pointer,
-	.get_as_builtin_integer = io_reference_to_umm_value_get_as_builtin_integer,
-	.get_containing_memory = io_reference_to_umm_value_get_containing_memory,
-};
-
 //
-// umm-heap based io_value memory
+// move the write index to the transfer position, called on transfer
+// events and by the driver when the line goes idle.  The bytes written
+// by the dma are a running count of laps and position, so a full lap
+// is not mistaken for no data.  A flush between a wrap and its complete
+// event counts the lap itself, the event then finds nothing new.
 //
-#define GC_STACK_LENGTH	8
+void
+io_byte_pipe_dma_receiver_flush (io_byte_pipe_dma_receiver_t *this) {
+	io_byte_pipe_t *pipe = this->pipe;
+	uint32_t size = pipe->size_of_ring;
+	uint32_t position = io_dma_transfer_position (this->channel);
+	uint32_t laps,written,fresh;
+
+	if (position >= size) {
+		position = 0;
+	}
 
-static void initialise_io_byte_memory_cursor (io_byte_memory_t*,uint16_t*);
+	laps = this->laps;
+	if (io_event_is_active (&this->channel->complete)) {
+		// the transfer has wrapped and its complete event is queued
+		laps ++;
+	}
 
-io_value_memory_t*
-mk_umm_io_value_memory (io_t *io,uint32_t size,uint32_t id) {
-	umm_io_value_memory_t *this = io_byte_memory_allocate (
-		io_get_byte_memory(io),sizeof(umm_io_value_memory_t)
-	);
-	
-	if (this) {
-		this->implementation = &umm_value_memory_implementation;
-		this->io = io;
-		this->id_ = id;
-		this->bm = mk_io_byte_memory (io,size,UMM_BLOCK_SIZE_1N);
-		if (this->bm != NULL) {
-			initialise_io_byte_memory_cursor(this->bm,&this->gc_cursor);
-			this->gc_stack_size = GC_STACK_LENGTH;
-		} else {
-			io_byte_memory_free (io_get_byte_memory(io),this);
-			this = NULL;
+	written = laps * size + position;
+	if ((int32_t) (written - this->received) < 0) {
+		// the transfer has wrapped and its complete event is not yet raised
+		written += size;
+	}
+	fresh = written - this->received;
+
+	if (fresh > 0) {
+		if (fresh > (uint32_t) io_byte_pipe_count_free_slots (pipe)) {
+			// the dma has written over unread bytes
+			this->overrun ++;
+			pipe->overrun ++;
+			pipe->read_index = io_byte_pipe_increment_index (pipe,position,1);
+		}
+
+		pipe->write_index = position;
+		this->received = written;
+		if (this->data_available != NULL) {
+			io_enqueue_event (this->io,this->data_available);
 		}
 	}
-	
-	return (io_value_memory_t*) this;
 }
 
-void
-umm_value_memory_free_memory (io_value_memory_t *vm) {
-	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
-	free_io_byte_memory (this->bm);
-	umm_free (io_get_byte_memory(this->io),this);
-}
+//
+// power manager
+//
+static void io_managed_power_domain_idle_event (io_event_t*);
 
-vref_t
-umm_value_memory_allocate_value (
-	io_value_memory_t *vm,io_value_implementation_t const *I,size_t allocation_size
-) {
-	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
-	io_value_t *new_value = umm_malloc (this->bm,allocation_size);
+static io_time_t
+io_power_manager_io_clock (void *io) {
+	return io_get_time (io);
+}
 
-	*new_value = (io_value_t) {
-		decl_io_value (I,allocation_size)
-	};
+INLINE_FUNCTION io_time_t
+io_power_manager_now (io_power_manager_t *this) {
+	return this->clock (this->clock_user_value);
+}
 
-	return umm_vref (&reference_to_umm_value,io_value_memory_id(this),new_value);
+void
+initialise_io_power_manager (io_power_manager_t *this,io_t *io) {
+	this->io = io;
+	this->domains = NULL;
+	this->clock = io_power_manager_io_clock;
+	this->clock_user_value = io;
 }
 
-vref_t
-umm_value_memory_new_value (
-	io_value_memory_t *vm,
-	io_value_implementation_t const *I,
-	size_t size,
-	vref_t r_base
+void
+io_power_manager_set_clock (
+	io_power_manager_t *this,io_power_manager_clock_t clock,void *user_value
 ) {
-	vref_t r_new = umm_value_memory_allocate_value (vm,I,size);
-	if (vref_is_valid (r_new)) {
-		if (I->initialise (r_new,r_base) == NULL) {
-			r_new = INVALID_VREF;
-		}
-	}
+	this->clock = clock;
+	this->clock_user_value = user_value;
+}
 
-	return r_new;
+static void
+io_managed_power_domain_set_state (
+	io_managed_power_domain_t *this,io_power_domain_state_t state,io_time_t now
+) {
+	this->time_in_state[this->state].ns += now.ns - this->state_since.ns;
+	this->state_since = now;
+	this->state = state;
 }
 
-struct gc_stack {
-	io_value_t** cursor;
-	io_value_t** end;
-};
-
-bool
-umm_value_memory_gc_iterator (io_value_t *value,void *user_value) {
-	struct gc_stack *stack = user_value;
-	
-	if (io_value_reference_count(value) == 0) {
-		*stack->cursor++ = value;
+static void
+io_managed_power_domain_sync_reference_count (io_managed_power_domain_t *this) {
+	io_cpu_power_domain_t *rw = io_cpu_power_domain_rw_pointer (this->domain);
+	if (rw != NULL) {
+		rw->reference_count = this->holders;
 	}
-	
-	return stack->cursor < stack->end;
 }
 
 static void
-umm_value_memory_do_gc (io_value_memory_t *vm,int32_t count) {
-	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
-	io_value_t* values[this->gc_stack_size];
+io_managed_power_domain_stop_alarm (io_managed_power_domain_t *this) {
+	if (is_io_alarm_active (&this->idle_alarm)) {
+		io_dequeue_alarm (this->manager->io,&this->idle_alarm);
+	}
+}
 
-	if (count < 0) count = 1000000;
+void
+io_power_manager_add_domain (
+	io_power_manager_t *this,
+	io_managed_power_domain_t *domain,
+	io_cpu_power_domain_pointer_t pd,
+	io_time_t hysteresis,
+	bool is_on
+) {
+	memset (domain,0,sizeof(io_managed_power_domain_t));
+	domain->manager = this;
+	domain->domain = pd;
+	domain->hysteresis = hysteresis;
+	domain->state = is_on ? IO_POWER_DOMAIN_IDLE : IO_POWER_DOMAIN_OFF;
+	domain->state_since = io_power_manager_now (this);
+	domain->idle_until = (io_time_t) {domain->state_since.ns + hysteresis.ns};
+	initialise_io_event (&domain->idle_event,io_managed_power_domain_idle_event,this);
+	initialise_io_alarm (
+		&domain->idle_alarm,&domain->idle_event,&domain->idle_event,time_zero()
+	);
 
-	while (count > 0) {
-		struct gc_stack stack = {
-			.cursor = values,
-			.end = values + GC_STACK_LENGTH,
-		};
-		bool clean = true;
+	domain->next = this->domains;
+	this->domains = domain;
 
-		incremental_iterate_io_byte_memory_allocations (
-			this->bm,&this->gc_cursor,umm_value_memory_gc_iterator,&stack
-		);
+	if (is_on) {
+		set_alarm_delay_time (this->io,&domain->idle_alarm,hysteresis);
+		io_enqueue_alarm (this->io,&domain->idle_alarm);
+	}
+}
 
-		{
-			io_value_t** cursor = values;
-			while (cursor < stack.cursor) {
-				free_umm_value (this,*cursor);
-				cursor++;
-			}
-		}
+void
+io_power_manager_remove_domain (
+	io_power_manager_t *this,io_managed_power_domain_t *domain
+) {
+	io_managed_power_domain_t **cursor = &this->domains;
 
-		if (clean && stack.cursor == values) {
+	io_managed_power_domain_stop_alarm (domain);
+	io_dequeue_event (this->io,&domain->idle_event);
+
+	while (*cursor != NULL) {
+		if (*cursor == domain) {
+			*cursor = domain->next;
 			break;
 		}
-		count--;
-	};
+		cursor = &(*cursor)->next;
+	}
+	domain->next = NULL;
 }
 
-bool
-heap_value_memory_is_persistant (io_value_memory_t *vm) {
-	return false;
+io_managed_power_domain_t*
+io_power_manager_find_domain (
+	io_power_manager_t *this,io_cpu_power_domain_pointer_t pd
+) {
+	io_managed_power_domain_t *cursor = this->domains;
+	while (cursor != NULL) {
+		if (io_cpu_power_domain_pointer_ro (cursor->domain) == io_cpu_power_domain_pointer_ro (pd)) {
+			break;
+		}
+		cursor = cursor->next;
+	}
+	return cursor;
 }
 
-void const*
-umm_value_memory_get_value_ro_pointer (io_value_memory_t *vm,vref_t r_value) {
-	return vref_cast_to_ro_pointer (r_value);
+//
+// turn off the domains whose hysteresis has passed
+//
+void
+io_power_manager_poll (io_power_manager_t *this) {
+	io_time_t now = io_power_manager_now (this);
+	io_managed_power_domain_t *cursor = this->domains;
+
+	while (cursor != NULL) {
+		if (cursor->state == IO_POWER_DOMAIN_IDLE) {
+			if (now.ns >= cursor->idle_until.ns) {
+				io_managed_power_domain_stop_alarm (cursor);
+				turn_off_io_power_domain (this->io,cursor->domain);
+				cursor->turned_off ++;
+				io_managed_power_domain_set_state (cursor,IO_POWER_DOMAIN_OFF,now);
+			} else if (!is_io_alarm_active (&cursor->idle_alarm)) {
+				set_alarm_delay_time (
+					this->io,&cursor->idle_alarm,
+					(io_time_t) {cursor->idle_until.ns - now.ns}
+				);
+				io_enqueue_alarm (this->io,&cursor->idle_alarm);
+			}
+		}
+		cursor = cursor->next;
+	}
 }
 
-void*
-umm_value_memory_get_value_rw_pointer (io_value_memory_t *vm,vref_t r_value) {
-	return vref_cast_to_rw_pointer (r_value);
+static void
+io_managed_power_domain_idle_event (io_event_t *ev) {
+	io_power_manager_poll (ev->user_value);
 }
 
-void
-umm_value_memory_get_info (io_value_memory_t *vm,memory_info_t *info) {
-	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
-	io_byte_memory_get_info (this->bm,info);
-}
+bool
+io_power_domain_hold (io_managed_power_domain_t *this,void const *holder) {
+	io_power_domain_holder_t *free_slot = NULL;
+	io_power_domain_holder_t *slot = NULL;
 
-static io_t*
-umm_value_memory_get_io (io_value_memory_t *vm) {
-	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
-	return this->io;
-}
+	for (int i = 0; i < IO_POWER_DOMAIN_HOLDER_LIMIT; i++) {
+		if (this->holder[i].count > 0 && this->holder[i].holder == holder) {
+			slot = this->holder + i;
+			break;
+		}
+		if (this->holder[i].count == 0 && free_slot == NULL) {
+			free_slot = this->holder + i;
+		}
+	}
 
-EVENT_DATA io_value_memory_implementation_t umm_value_memory_implementation = {
-	.free = umm_value_memory_free_memory,
-	.allocate_value = umm_value_memory_allocate_value,
-	.new_value = umm_value_memory_new_value,
-	.do_gc = umm_value_memory_do_gc,
-	.get_info = umm_value_memory_get_info,
-	.get_io = umm_value_memory_get_io,
-	.is_persistant = heap_value_memory_is_persistant,
-	.get_value_ro_pointer = umm_value_memory_get_value_ro_pointer,
-	.get_value_rw_pointer = umm_value_memory_get_value_rw_pointer,
-};
+	if (slot == NULL) {
+		if (free_slot == NULL) {
+			return false;
+		}
+		slot = free_slot;
+		slot->holder = holder;
+	}
 
-//
-// reference to values in the C data section
-//
-static vref_t
-io_reference_to_data_section_value_reference (vref_t r_value) {
-	return r_value;
-}
+	slot->count ++;
+	if (this->holders++ == 0) {
+		io_time_t now = io_power_manager_now (this->manager);
+		if (this->state == IO_POWER_DOMAIN_OFF) {
+			turn_on_io_power_domain (this->manager->io,this->domain);
+			this->turned_on ++;
+		} else {
+			io_managed_power_domain_stop_alarm (this);
+		}
+		io_managed_power_domain_set_state (this,IO_POWER_DOMAIN_ON,now);
+	}
+	io_managed_power_domain_sync_reference_count (this);
 
-static void
-io_reference_to_data_section_value_unreference (vref_t r_value) {
+	return true;
 }
 
-static int64_t
-io_reference_to_data_section_value_get_as_builtin_integer (vref_t r_value) {
-	return vref_expando(r_value).ptr;
+bool
+io_power_domain_release (io_managed_power_domain_t *this,void const *holder) {
+	for (int i = 0; i < IO_POWER_DOMAIN_HOLDER_LIMIT; i++) {
+		if (this->holder[i].count > 0 && this->holder[i].holder == holder) {
+			this->holder[i].count --;
+			if (--this->holders == 0) {
+				io_time_t now = io_power_manager_now (this->manager);
+				io_managed_power_domain_set_state (this,IO_POWER_DOMAIN_IDLE,now);
+				this->idle_until = (io_time_t) {now.ns + this->hysteresis.ns};
+				if (this->hysteresis.ns > 0) {
+					set_alarm_delay_time (this->manager->io,&this->idle_alarm,this->hysteresis);
+					io_enqueue_alarm (this->manager->io,&this->idle_alarm);
+				} else {
+					io_power_manager_poll (this->manager);
+				}
+			}
+			io_managed_power_domain_sync_reference_count (this);
+			return true;
+		}
+	}
+	return false;
 }
 
-static void const*
-io_reference_to_data_section_value_cast_to_ro_pointer (vref_t r_value) {
-	return (void const*) vref_expando(r_value).ptr;
+bool
+io_power_domain_is_held_by (io_managed_power_domain_t const *this,void const *holder) {
+	for (int i = 0; i < IO_POWER_DOMAIN_HOLDER_LIMIT; i++) {
+		if (this->holder[i].count > 0 && this->holder[i].holder == holder) {
+			return true;
+		}
+	}
+	return false;
 }
 
-static void*
-io_reference_to_data_section_value_cast_to_rw_pointer (vref_t r_value) {
-	return (void*) vref_expando(r_value).ptr;
+//
+// includes the time so far in the current state
+//
+io_time_t
+io_power_domain_time_in_state (
+	io_managed_power_domain_t *this,io_power_domain_state_t state
+) {
+	io_time_t t = this->time_in_state[state];
+	if (state == this->state) {
+		t.ns += io_power_manager_now (this->manager).ns - this->state_since.ns;
+	}
+	return t;
 }
 
-static io_value_memory_t*
-io_reference_to_value_get_null_containing_memory (vref_t r_value) {
-	return NULL;
+bool
+io_power_manager_hold_clock (io_power_manager_t *this,io_cpu_clock_pointer_t clock) {
+	io_managed_power_domain_t *domain = io_power_manager_find_domain (
+		this,io_cpu_clock_power_domain (clock)
+	);
+	return (
+			domain != NULL
+		&&	io_power_domain_hold (domain,io_cpu_clock_ro_pointer (clock))
+	);
 }
 
-EVENT_DATA io_value_reference_implementation_t 
-reference_to_data_section_value = {
-	.reference = io_reference_to_data_section_value_reference,
-	.unreference = io_reference_to_data_section_value_unreference,
-	.cast_to_ro_pointer = io_reference_to_data_section_value_cast_to_ro_pointer,
-	.cast_to_rw_pointer = io_reference_to_data_section_value_cast_to_rw_pointer,
-	.get_as_builtin_integer = io_reference_to_data_section_value_get_as_builtin_integer,
-	.get_containing_memory = io_reference_to_value_get_null_containing_memory,
-};
+bool
+io_power_manager_release_clock (io_power_manager_t *this,io_cpu_clock_pointer_t clock) {
+	io_managed_power_domain_t *domain = io_power_manager_find_domain (
+		this,io_cpu_clock_power_domain (clock)
+	);
+	return (
+			domain != NULL
+		&&	io_power_domain_release (domain,io_cpu_clock_ro_pointer (clock))
+	);
+}
 
 //
-// reference to constant values
+// hash
 //
-static vref_t
-io_reference_to_constant_value_reference (vref_t r_value) {
-	return r_value;
-}
 
-static void
-io_reference_to_constant_value_unreference (vref_t r_value) {
+uint64_t integer_hash_u64 (uint64_t key) {
+	key = ~key + (key << 21);
+	key = key ^ (key >> 24);
+	key = key + (key << 3) + (key << 8);
+	key = key ^ (key >> 14);
+	key = key + (key << 2) + (key << 4);
+	key = key ^ (key >> 28);
+	key = key + (key << 31);
+	return key;
 }
 
-static int64_t
-io_reference_to_constant_value_get_as_builtin_integer (vref_t r_value) {
-	return vref_expando(r_value).ptr;
-}
+#define tommy_rot(x, k) \
+	(((x) << (k)) | ((x) >> (32 - (k))))
 
-static void const*
-io_reference_to_constant_value_cast_to_ro_pointer (vref_t r_value) {
-	return (void const*) vref_expando(r_value).ptr;
-}
+#define tommy_mix(a, b, c) \
+	do { \
+		a -= c;  a ^= tommy_rot(c, 4);  c += b; \
+		b -= a;  b ^= tommy_rot(a, 6);  a += c; \
+		c -= b;  c ^= tommy_rot(b, 8);  b += a; \
+		a -= c;  a ^= tommy_rot(c, 16);  c += b; \
+		b -= a;  b ^= tommy_rot(a, 19);  a += c; \
+		c -= b;  c ^= tommy_rot(b, 4);  b += a; \
+	} while (0)
 
-static void*
-io_reference_to_constant_value_cast_to_rw_pointer (vref_t r_value) {
-	return NULL;
-}
+#define tommy_final(a, b, c) \
+	do { \
+		c ^= b; c -= tommy_rot(b, 14); \
+		a ^= c; a -= tommy_rot(c, 11); \
+		b ^= a; b -= tommy_rot(a, 25); \
+		c ^= b; c -= tommy_rot(b, 16); \
+		a ^= c; a -= tommy_rot(c, 4);  \
+		b ^= a; b -= tommy_rot(a, 14); \
+		c ^= b; c -= tommy_rot(b, 24); \
+	} while (0)
 
-EVENT_DATA io_value_reference_implementation_t reference_to_constant_value = {
-	.reference = io_reference_to_constant_value_reference,
-	.unreference = io_reference_to_constant_value_unreference,
-	.cast_to_ro_pointer = io_reference_to_constant_value_cast_to_ro_pointer,
-	.cast_to_rw_pointer = io_reference_to_constant_value_cast_to_rw_pointer,
-	.get_as_builtin_integer = io_reference_to_constant_value_get_as_builtin_integer,
-	.get_containing_memory = io_reference_to_value_get_null_containing_memory,
-};
+uint32_t
+tommy_hash_u32 (uint32_t init_val,uint8_t const *key,uint32_t key_len) {
+	uint32_t a, b, c;
 
-//
-// reference to constant values
-//
-static vref_t
-io_reference_to_c_stack_value_reference (vref_t r_value) {
-	return r_value;
+	a = b = c = 0xdeadbeef + ((uint32_t)key_len) + init_val;
+
+	while (key_len > 12) {
+		a += read_le_uint32(key + 0);
+		b += read_le_uint32(key + 4);
+		c += read_le_uint32(key + 8);
+
+		tommy_mix(a, b, c);
+
+		key_len -= 12;
+		key += 12;
+	}
+
+	switch (key_len) {
+	case 0 :
+		return c; /* used only when called with a zero length */
+	case 12 :
+		c += read_le_uint32(key + 8);
+		b += read_le_uint32(key + 4);
+		a += read_le_uint32(key + 0);
+		break;
+	case 11 : c += ((uint32_t)key[10]) << 16; /* fallthrough */
+	case 10 : c += ((uint32_t)key[9]) << 8; /* fallthrough */
+	case 9 : c += key[8]; /* fallthrough */
+	case 8 :
+		b += read_le_uint32(key + 4);
+		a += read_le_uint32(key + 0);
+		break;
+	case 7 : b += ((uint32_t)key[6]) << 16; /* fallthrough */
+	case 6 : b += ((uint32_t)key[5]) << 8; /* fallthrough */
+	case 5 : b += key[4]; /* fallthrough */
+	case 4 :
+		a += read_le_uint32(key + 0);
+		break;
+	case 3 : a += ((uint32_t)key[2]) << 16; /* fallthrough */
+	case 2 : a += ((uint32_t)key[1]) << 8; /* fallthrough */
+	case 1 : a += key[0]; /* fallthrough */
+	}
+
+	tommy_final(a, b, c);
+
+	return c;
+}
+/*
+ * Copyright (c) 2010, Andrea Mazzoleni. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+string_hash_table_entry_t*
+mk_string_hash_table_entry (
+	io_byte_memory_t *bm,char const *bytes,uint32_t size,string_hash_table_mapping_t map
+) {
+	string_hash_table_entry_t *entry = io_byte_memory_allocate (
+		bm,sizeof(string_hash_table_entry_t)
+	);
+	
+	if (entry) {
+		entry->size = size;
+		if (size) {
+			entry->bytes = io_byte_memory_allocate (bm,size);
+			if (entry->bytes != NULL) {
+				entry->next_entry = NULL;
+				entry->mapping = map;
+				memcpy (entry->bytes,bytes,size);
+			} else {
+				io_byte_memory_free (bm,entry);
+				entry = NULL;
+			}
+		} else {
+			entry->bytes = NULL;
+		}
+	}
+	
+	return entry;
+}
+
+void
+free_string_hash_table_entry (io_byte_memory_t *bm,string_hash_table_entry_t *entry) {
+	io_byte_memory_free (bm,entry->bytes);
+	io_byte_memory_free (bm,entry);
+}
+
+string_hash_table_t*
+mk_string_hash_table (io_byte_memory_t *bm,uint32_t initial_size) {
+	string_hash_table_t *this = io_byte_memory_allocate (
+		bm,sizeof(string_hash_table_t)
+	);
+	
+	if (this) {
+		this->bm = bm;
+		this->table_size = next_prime_u32_integer (initial_size);
+		this->table_grow = this->table_size/2;
+		this->table = io_byte_memory_allocate (
+			bm,sizeof(string_hash_table_entry_t*) * this->table_size
+		);
+		if (this->table != NULL) {
+			memset (
+				this->table,0,sizeof(string_hash_table_entry_t*) * this->table_size
+			);
+		} else {
+			io_byte_memory_free (bm,this);
+			this = NULL;
+		}
+	}
+	
+	return this;
+}
+
+void
+free_string_hash_table (string_hash_table_t *this) {
+	uint32_t i;
+	
+	for (i = 0; i < this->table_size; i++) {
+		string_hash_table_entry_t *next,*cursor = this->table[i];
+		while (cursor != NULL) {
+			next = cursor->next_entry;
+			free_string_hash_table_entry (this->bm,cursor);
+			cursor = next;
+		}
+	}
+
+	io_byte_memory_free (this->bm,this->table);
+	io_byte_memory_free (this->bm,this);
+}
+
+void
+iterate_string_hash_table (
+	string_hash_table_t *this,bool (*cb) (string_hash_table_entry_t*,void*),void *user_value
+) {
+	for (int i = 0; i < this->table_size; i++) {
+		string_hash_table_entry_t *cursor = this->table[i];
+		while (cursor != NULL) {
+			cb (cursor,user_value);
+			cursor = cursor->next_entry;
+		}
+	}
+}
+
+static string_hash_table_entry_t*
+string_hash_table_get_entry (
+	string_hash_table_t *this,const char *data,uint32_t size,int index,int *depth
+) {
+	string_hash_table_entry_t *cursor = this->table[index];
+	if (depth) *depth = 0;
+	
+	while (cursor != NULL ) {
+		if (depth)  (*depth) ++;
+		if (cursor->size == size && (size == 0 || memcmp(cursor->bytes,data,size) == 0)) {
+			break;
+		}
+		cursor = cursor->next_entry;
+	}
+
+	return cursor;
+}
+
+static void string_hash_table_grow (string_hash_table_t*);
+
+bool
+string_hash_table_insert (
+	string_hash_table_t *this,const char *data,uint32_t size,string_hash_table_mapping_t map
+) {
+	uint32_t index = tommy_hash_u32 (0,(uint8_t const*) data,size) % this->table_size;
+	int depth;
+	
+	string_hash_table_entry_t *cursor = string_hash_table_get_entry (
+		this,data,size,index,&depth
+	);
+
+	if (cursor != NULL ) {
+		cursor->mapping = map;
+		return false;
+	} else {
+		if (depth > 7) {
+			string_hash_table_grow (this);
+			string_hash_table_insert (this,data,size,map);
+		} else {
+			cursor = mk_string_hash_table_entry (this->bm,data,size,map);
+			cursor->next_entry = this->table[index];
+			this->table[index] = cursor;
+		}
+		return true;
+	}
+}
+
+static void
+string_hash_table_grow (string_hash_table_t *this) {
+	string_hash_table_entry_t **old_table = this->table;
+	uint32_t old_size = this->table_size;
+	
+	this->table_size = next_prime_u32_integer (this->table_size + this->table_grow);
+	this->table = io_byte_memory_allocate (
+		this->bm,sizeof(string_hash_table_entry_t*) * this->table_size
+	);
+	memset (this->table,0,sizeof(string_hash_table_entry_t*) * this->table_size);
+	for (uint32_t i = 0; i < old_size; i++) {
+		string_hash_table_entry_t *next,*cursor = old_table[i];
+		while (cursor != NULL) {
+			uint32_t index = tommy_hash_u32 (0,(uint8_t const*) cursor->bytes,cursor->size) % this->table_size;
+			next = cursor->next_entry;
+			cursor->next_entry = this->table[index];
+			this->table[index] = cursor;
+			cursor = next;
+		}
+	}
+
+	io_byte_memory_free (this->bm,old_table);
+}
+
+bool
+string_hash_table_remove (
+	string_hash_table_t *this,const char *data,uint32_t size
+) {
+	int index = tommy_hash_u32 (0,(uint8_t const*) data,size) % this->table_size;
+	string_hash_table_entry_t **cursor = this->table + index;
+	
+	if (*cursor != NULL) {
+		while (*cursor != NULL) {
+			if (((*cursor)->size) == size &&  memcmp ((*cursor)->bytes,data,size) == 0) {
+				string_hash_table_entry_t *remove = *cursor;
+				*cursor = (*cursor)->next_entry;
+				free_string_hash_table_entry (this->bm,remove);
+				return true;
+			}
+			cursor = &((*cursor)->next_entry);
+		}
+	}
+	
+	return false;
+}
+
+bool
+string_hash_table_map (string_hash_table_t *this,const char *data,uint32_t size,string_hash_table_mapping_t *map) {
+	uint32_t index = tommy_hash_u32 (0,(uint8_t const*) data,size) % this->table_size;
+	int depth;
+	
+	string_hash_table_entry_t *cursor = string_hash_table_get_entry (
+		this,data,size,index,&depth
+	);
+
+	if (cursor != NULL ) {
+		*map = cursor->mapping;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+//
+//
+//
+typedef struct vref_bucket_hash_table_entry {
+	struct vref_bucket_hash_table_entry *next_entry;
+	vref_t r_value;
+} vref_bucket_hash_table_entry_t;
+
+typedef struct PACK_STRUCTURE {
+	VREF_HASH_TABLE_STRUCT_MEMBERS
+	vref_bucket_hash_table_entry_t **table;	
+	io_byte_memory_t *bm;
+	uint32_t table_size;
+	uint32_t table_grow;
+} vref_bucket_hash_table_t;
+
+vref_hash_table_t*
+mk_vref_bucket_hash_table (io_byte_memory_t *bm,uint32_t initial_size) {
+	extern EVENT_DATA vref_hash_table_implementation_t vref_bucket_hash_implementation;
+	vref_bucket_hash_table_t *this = io_byte_memory_allocate (
+		bm,sizeof(vref_bucket_hash_table_t)
+	);
+	
+	if (this) {
+		this->implementation = &vref_bucket_hash_implementation;
+		this->bm = bm;
+		this->table_size = next_prime_u32_integer (initial_size);
+		this->table_grow = this->table_size/2;
+		this->table = io_byte_memory_allocate (
+			bm,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size
+		);
+		if (this->table != NULL) {
+			memset (
+				this->table,0,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size
+			);
+		} else {
+			io_byte_memory_free (bm,this);
+			this = NULL;
+		}
+	}
+	
+	return (vref_hash_table_t*) this;
+}
+
+static void
+free_vref_bucket_hash_table (vref_hash_table_t *ht) {
+	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
+	uint32_t i;
+	
+	for (i = 0; i < this->table_size; i++) {
+		vref_bucket_hash_table_entry_t *next,*cursor = this->table[i];
+		while (cursor != NULL) {
+			next = cursor->next_entry;
+			unreference_value (cursor->r_value);
+			io_byte_memory_free (this->bm,cursor);
+			cursor = next;
+		}
+	}
+	
+	io_byte_memory_free (this->bm,this->table);
+	io_byte_memory_free (this->bm,this);
+}
+
+uint32_t
+vref_bucket_hash (vref_bucket_hash_table_t *ht,vref_t r_value) {
+	return (
+			integer_hash_u64 (vref_get_as_builtin_integer(r_value))
+		%	ht->table_size
+	);
+}
+
+static vref_bucket_hash_table_entry_t*
+vref_bucket_hash_get_entry (
+	vref_bucket_hash_table_t *this,vref_t r_value,int index,int *depth
+) {
+	vref_bucket_hash_table_entry_t *cursor = this->table[index];
+	if (depth) *depth = 0;
+	
+	while (cursor != NULL ) {
+		if (depth)  (*depth) ++;
+		if (vref_is_equal_to ((cursor->r_value),r_value)) {
+			break;
+		}
+		cursor = cursor->next_entry;
+	}
+
+	return cursor;
+}
+
+static void	vref_bucket_hash_grow (vref_bucket_hash_table_t*);
+
+static bool
+vref_bucket_hash_insert (vref_bucket_hash_table_t *this,vref_t r_value) {
+	int depth,index = vref_bucket_hash (this,r_value);
+	vref_bucket_hash_table_entry_t *cursor = vref_bucket_hash_get_entry (
+		this,r_value,index,&depth
+	);
+
+	if (cursor != NULL ) {
+		return false;
+	} else {
+		if (depth > 7) {
+			vref_bucket_hash_grow (this);
+			return vref_bucket_hash_insert (this,r_value);
+		} else {
+			cursor = io_byte_memory_allocate (
+				this->bm,sizeof(vref_bucket_hash_table_entry_t)
+			);
+			memset (cursor,0,sizeof(vref_bucket_hash_table_entry_t));
+			cursor->next_entry = this->table[index];
+			this->table[index] = cursor;
+			cursor->r_value = reference_value (r_value);
+			return true;
+		}
+	}
+}
+
+static void
+vref_bucket_hash_grow (vref_bucket_hash_table_t *this) {
+	vref_bucket_hash_table_entry_t **old_table = this->table;
+	uint32_t old_size = this->table_size;
+	
+	this->table_size = next_prime_u32_integer (this->table_size + this->table_grow);
+	this->table = io_byte_memory_allocate (
+		this->bm,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size
+	);
+	memset (this->table,0,sizeof(vref_bucket_hash_table_entry_t*) * this->table_size);
+	for (uint32_t i = 0; i < old_size; i++) {
+		vref_bucket_hash_table_entry_t *next,*cursor = old_table[i];
+		while (cursor != NULL) {
+			next = cursor->next_entry;
+			vref_bucket_hash_insert (this,cursor->r_value);
+			unreference_value (cursor->r_value);
+			io_byte_memory_free (this->bm,cursor);
+			cursor = next;
+		}
+	}
+
+	io_byte_memory_free (this->bm,old_table);
+}
+
+static bool
+vref_bucket_hash_insert_value (vref_hash_table_t *ht,vref_t r_value) {
+	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
+	return vref_bucket_hash_insert (this,r_value);
+}
+
+static bool
+vref_bucket_hash_contains (vref_hash_table_t *ht,vref_t r_value) {
+	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
+	int index = vref_bucket_hash (this,r_value);
+	return NULL != vref_bucket_hash_get_entry (this,r_value,index,NULL);
+}
+
+static bool
+vref_bucket_hash_remove (vref_hash_table_t *ht,vref_t r_value) {
+	vref_bucket_hash_table_t *this = (vref_bucket_hash_table_t*) ht;
+	int index = vref_bucket_hash (this,r_value);
+	vref_bucket_hash_table_entry_t **cursor = this->table + index;
+	
+	if (*cursor != NULL) {
+		while (*cursor != NULL) {
+			if (vref_is_equal_to (((*cursor)->r_value),r_value)) {
+				vref_bucket_hash_table_entry_t *remove = *cursor;
+				*cursor = (*cursor)->next_entry;
+				unreference_value (remove->r_value);
+				io_byte_memory_free (this->bm,remove);
+				return true;
+			}
+			cursor = &((*cursor)->next_entry);
+		}
+	}
+	
+	return false;
+}
+
+EVENT_DATA vref_hash_table_implementation_t vref_bucket_hash_implementation = {
+	.free = free_vref_bucket_hash_table,
+	.insert = vref_bucket_hash_insert_value,
+	.contains = vref_bucket_hash_contains,
+	.remove = vref_bucket_hash_remove,
+};
+
+//
+// reference to umm value
+//
+vref_t
+io_reference_to_umm_value_reference (vref_t r_value) {
+	io_value_t *value = vref_cast_to_rw_pointer (r_value);
+	if (value) {
+		io_value_reference_count(value) ++;
+	}
+	return r_value;
+}
+
+static void
+free_umm_value (umm_io_value_memory_t *this,io_value_t *value) {
+	io_value_free (value);
+	umm_free (this->bm,value);
+}
+
+static void
+io_reference_to_umm_value_unreference (vref_t r_value) {
+	io_value_t *value = vref_cast_to_rw_pointer (r_value);
+	if (value) {
+		if (io_value_reference_count(value)) {
+			io_value_reference_count(value) --;
+		} else {
+			// a panic really
+		}
+	}
+}
+
+int64_t
+io_reference_to_umm_value_get_as_builtin_integer (vref_t r_value) {
+	return vref_expando(r_value).ptr;
+}
+
+void const*
+io_reference_to_umm_value_cast_to_ro_pointer (vref_t r_value) {
+	return (void const*) io_value_reference_p32_to_c_pointer(r_value);
+}
+
+void*
+io_reference_to_umm_value_cast_to_rw_pointer (vref_t r_value) {
+	return (void*) io_value_reference_p32_to_c_pointer(r_value);
+}
+
+io_value_memory_t*
+io_reference_to_umm_value_get_containing_memory (vref_t r_value) {
+	return io_get_value_memory_by_id (io_value_reference_p32_memory(r_value));
+}
+
+EVENT_DATA io_value_reference_implementation_t reference_to_umm_value = {
+	.reference = io_reference_to_umm_value_reference,
+	.unreference = io_reference_to_umm_value_unreference,
+	.cast_to_ro_pointer = io_reference_to_umm_value_cast_to_ro_pointer,
+	.cast_to_rw_pointer = io_reference_to_umm_value_cast_to_rw_pointer,
+	.get_as_builtin_integer = io_reference_to_umm_value_get_as_builtin_integer,
+	.get_containing_memory = io_reference_to_umm_value_get_containing_memory,
+};
+
+//
+// umm-heap based io_value memory
+//
+#define GC_STACK_LENGTH	8
+
+static void initialise_io_byte_memory_cursor (io_byte_memory_t*,uint16_t*);
+
+io_value_memory_t*
+mk_umm_io_value_memory (io_t *io,uint32_t size,uint32_t id) {
+	umm_io_value_memory_t *this = io_byte_memory_allocate (
+		io_get_byte_memory(io),sizeof(umm_io_value_memory_t)
+	);
+	
+	if (this) {
+		this->implementation = &umm_value_memory_implementation;
+		this->io = io;
+		this->id_ = id;
+		this->bm = mk_io_byte_memory (io,size,UMM_BLOCK_SIZE_1N);
+		if (this->bm != NULL) {
+			initialise_io_byte_memory_cursor(this->bm,&this->gc_cursor);
+			this->gc_stack_size = GC_STACK_LENGTH;
+		} else {
+			io_byte_memory_free (io_get_byte_memory(io),this);
+			this = NULL;
+		}
+	}
+	
+	return (io_value_memory_t*) this;
+}
+
+void
+umm_value_memory_free_memory (io_value_memory_t *vm) {
+	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
+	free_io_byte_memory (this->bm);
+	umm_free (io_get_byte_memory(this->io),this);
+}
+
+vref_t
+umm_value_memory_allocate_value (
+	io_value_memory_t *vm,io_value_implementation_t const *I,size_t allocation_size
+) {
+	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
+	io_value_t *new_value = umm_malloc (this->bm,allocation_size);
+
+	*new_value = (io_value_t) {
+		decl_io_value (I,allocation_size)
+	};
+
+	return umm_vref (&reference_to_umm_value,io_value_memory_id(this),new_value);
+}
+
+vref_t
+umm_value_memory_new_value (
+	io_value_memory_t *vm,
+	io_value_implementation_t const *I,
+	size_t size,
+	vref_t r_base
+) {
+	vref_t r_new = umm_value_memory_allocate_value (vm,I,size);
+	if (vref_is_valid (r_new)) {
+		if (I->initialise (r_new,r_base) == NULL) {
+			r_new = INVALID_VREF;
+		}
+	}
+
+	return r_new;
+}
+
+struct gc_stack {
+	io_value_t** cursor;
+	io_value_t** end;
+};
+
+bool
+umm_value_memory_gc_iterator (io_value_t *value,void *user_value) {
+	struct gc_stack *stack = user_value;
+	
+	if (io_value_reference_count(value) == 0) {
+		*stack->cursor++ = value;
+	}
+	
+	return stack->cursor < stack->end;
+}
+
+static void
+umm_value_memory_do_gc (io_value_memory_t *vm,int32_t count) {
+	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
+	io_value_t* values[this->gc_stack_size];
+
+	if (count < 0) count = 1000000;
+
+	while (count > 0) {
+		struct gc_stack stack = {
+			.cursor = values,
+			.end = values + GC_STACK_LENGTH,
+		};
+		bool clean = true;
+
+		incremental_iterate_io_byte_memory_allocations (
+			this->bm,&this->gc_cursor,umm_value_memory_gc_iterator,&stack
+		);
+
+		{
+			io_value_t** cursor = values;
+			while (cursor < stack.cursor) {
+				free_umm_value (this,*cursor);
+				cursor++;
+			}
+		}
+
+		if (clean && stack.cursor == values) {
+			break;
+		}
+		count--;
+	};
+}
+
+bool
+heap_value_memory_is_persistant (io_value_memory_t *vm) {
+	return false;
+}
+
+void const*
+umm_value_memory_get_value_ro_pointer (io_value_memory_t *vm,vref_t r_value) {
+	return vref_cast_to_ro_pointer (r_value);
+}
+
+void*
+umm_value_memory_get_value_rw_pointer (io_value_memory_t *vm,vref_t r_value) {
+	return vref_cast_to_rw_pointer (r_value);
+}
+
+void
+umm_value_memory_get_info (io_value_memory_t *vm,memory_info_t *info) {
+	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
+	io_byte_memory_get_info (this->bm,info);
+}
+
+static io_t*
+umm_value_memory_get_io (io_value_memory_t *vm) {
+	umm_io_value_memory_t *this = (umm_io_value_memory_t*) vm;
+	return this->io;
+}
+
+EVENT_DATA io_value_memory_implementation_t umm_value_memory_implementation = {
+	.free = umm_value_memory_free_memory,
+	.allocate_value = umm_value_memory_allocate_value,
+	.new_value = umm_value_memory_new_value,
+	.do_gc = umm_value_memory_do_gc,
+	.get_info = umm_value_memory_get_info,
+	.get_io = umm_value_memory_get_io,
+	.is_persistant = heap_value_memory_is_persistant,
+	.get_value_ro_pointer = umm_value_memory_get_value_ro_pointer,
+	.get_value_rw_pointer = umm_value_memory_get_value_rw_pointer,
+};
+
+//
+// reference to values in the C data section
+//
+static vref_t
+io_reference_to_data_section_value_reference (vref_t r_value) {
+	return r_value;
+}
+
+static void
+io_reference_to_data_section_value_unreference (vref_t r_value) {
+}
+
+static int64_t
+io_reference_to_data_section_value_get_as_builtin_integer (vref_t r_value) {
+	return vref_expando(r_value).ptr;
+}
+
+static void const*
+io_reference_to_data_section_value_cast_to_ro_pointer (vref_t r_value) {
+	return (void const*) vref_expando(r_value).ptr;
+}
+
+static void*
+io_reference_to_data_section_value_cast_to_rw_pointer (vref_t r_value) {
+	return (void*) vref_expando(r_value).ptr;
+}
+
+static io_value_memory_t*
+io_reference_to_value_get_null_containing_memory (vref_t r_value) {
+	return NULL;
+}
+
+EVENT_DATA io_value_reference_implementation_t 
+reference_to_data_section_value = {
+	.reference = io_reference_to_data_section_value_reference,
+	.unreference = io_reference_to_data_section_value_unreference,
+	.cast_to_ro_pointer = io_reference_to_data_section_value_cast_to_ro_pointer,
+	.cast_to_rw_pointer = io_reference_to_data_section_value_cast_to_rw_pointer,
+	.get_as_builtin_integer = io_reference_to_data_section_value_get_as_builtin_integer,
+	.get_containing_memory = io_reference_to_value_get_null_containing_memory,
+};
+
+//
+// reference to constant values
+//
+static vref_t
+io_reference_to_constant_value_reference (vref_t r_value) {
+	return r_value;
+}
+
+static void
+io_reference_to_constant_value_unreference (vref_t r_value) {
+}
+
+static int64_t
+io_reference_to_constant_value_get_as_builtin_integer (vref_t r_value) {
+	return vref_expando(r_value).ptr;
+}
+
+static void const*
+io_reference_to_constant_value_cast_to_ro_pointer (vref_t r_value) {
+	return (void const*) vref_expando(r_value).ptr;
+}
+
+static void*
+io_reference_to_constant_value_cast_to_rw_pointer (vref_t r_value) {
+	return NULL;
+}
+
+EVENT_DATA io_value_reference_implementation_t reference_to_constant_value = {
+	.reference = io_reference_to_constant_value_reference,
+	.unreference = io_reference_to_constant_value_unreference,
+	.cast_to_ro_pointer = io_reference_to_constant_value_cast_to_ro_pointer,
+	.cast_to_rw_pointer = io_reference_to_constant_value_cast_to_rw_pointer,
+	.get_as_builtin_integer = io_reference_to_constant_value_get_as_builtin_integer,
+	.get_containing_memory = io_reference_to_value_get_null_containing_memory,
+};
+
+//
+// reference to constant values
+//
+static vref_t
+io_reference_to_c_stack_value_reference (vref_t r_value) {
+	return r_value;
+}
+
+static void
+io_reference_to_c_stack_value_unreference (vref_t r_value) {
+}
+
+static int64_t
+io_reference_to_c_stack_value_get_as_builtin_integer (vref_t r_value) {
+	return vref_expando(r_value).ptr;
+}
+
+static void const*
+io_reference_to_c_stack_value_cast_to_ro_pointer (vref_t r_value) {
+	return (void const*) vref_expando(r_value).ptr;
+}
+
+static void*
+io_reference_to_c_stack_value_cast_to_rw_pointer (vref_t r_value) {
+	return (void*) vref_expando(r_value).ptr;
+}
+
+EVENT_DATA io_value_reference_implementation_t reference_to_c_stack_value = {
+	.reference = io_reference_to_c_stack_value_reference,
+	.unreference = io_reference_to_c_stack_value_unreference,
+	.cast_to_ro_pointer = io_reference_to_c_stack_value_cast_to_ro_pointer,
+	.cast_to_rw_pointer = io_reference_to_c_stack_value_cast_to_rw_pointer,
+	.get_as_builtin_integer = io_reference_to_c_stack_value_get_as_builtin_integer,
+	.get_containing_memory = io_reference_to_value_get_null_containing_memory,
+};
+
+//
+// Encoding
+//
+
+io_encoding_t*
+reference_io_encoding (io_encoding_t *encoding) {
+	if (encoding != NULL) { 
+		uint32_t new_count = (uint32_t) io_encoding_reference_count (encoding) + 1;
+		if (new_count <= IO_ENCODING_REFERENCE_COUNT_LIMIT) {
+			io_encoding_reference_count (encoding) = new_count;
+		} else {
+			io_panic (io_encoding_get_io (encoding),IO_PANIC_UNRECOVERABLE_ERROR);
+		}
+	}
+	return encoding;
+}
+
+void
+unreference_io_encoding (io_encoding_t *encoding) {
+	if (io_encoding_reference_count(encoding)) {
+		if (--io_encoding_reference_count(encoding) == 0) {
+			io_encoding_free(encoding);
+		}
+	} else {
+		io_panic (io_encoding_get_io (encoding),IO_PANIC_UNRECOVERABLE_ERROR);
+	}
+}
+
+vref_t
+io_value_encoding_decode_to_io_value (
+	io_encoding_t *encoding,io_value_decoder_t decoder,io_value_memory_t *vm
+) {
+	return decoder (encoding,vm);
+}
+
+io_encoding_t*
+mk_null_encoding (io_byte_memory_t *bm) {
+	return NULL;
+}
+
+void
+free_null_encoding (io_encoding_t *encoding) {
+}
+
+size_t
+null_encoding_length (io_encoding_t const *encoding) {
+	return 0;
+}
+
+int32_t
+null_encoding_limit (void) {
+	return 0;
+}
+
+uint32_t
+null_encoding_grow_increment (io_encoding_t *encoding) {
+	return 0;
+}
+
+io_t*
+null_encoding_get_io (io_encoding_t *encoding) {
+	return NULL;
+}
+
+void*
+io_encoding_no_layer (io_encoding_t *encoding,io_layer_implementation_t const *L) {
+	return NULL;
+}
+
+void*
+io_encoding_no_byte_stream (io_encoding_t *encoding) {
+	return NULL;
+}
+
+void
+io_encoding_no_content (io_encoding_t *encoding,uint8_t const** b,uint8_t const** e) {
+	*b = *e = NULL;
+}
+
+size_t
+io_encoding_no_fill (io_encoding_t *encoding,uint8_t b,size_t s) {
+	return 0;
+}
+
+bool
+io_encoding_no_grow (io_encoding_t *encoding,uint32_t g) {
+	return false;
+}
+
+void
+io_encoding_no_reset (io_encoding_t *encoding) {
+}
+
+size_t
+io_encoding_no_print (io_encoding_t *encoding,char const *fmt,va_list va) {
+	return 0;
+}
+
+bool
+io_encoding_no_append_byte (io_encoding_t *encoding,uint8_t byte) {
+	return false;
+}
+
+bool
+io_encoding_no_append_bytes (io_encoding_t *encoding,uint8_t const *b,size_t s) {
+	return false;
+}
+
+bool
+io_encoding_no_pop_last_byte (io_encoding_t *encoding,uint8_t *b) {
+	return false;
+}
+
+uint32_t
+io_encoding_no_decode_increment (io_encoding_t *encoding,uint32_t incr) {
+	return 0;
+}
+
+EVENT_DATA io_encoding_layer_api_t no_packet_layer_api = {
+	.get_inner_layer = NULL,
+	.get_outer_layer = NULL,
+	.get_layer = io_encoding_no_layer,
+	.push_layer = NULL,
+};
+
+EVENT_DATA io_encoding_implementation_t io_encoding_implementation_base = {
+	SPECIALISE_IO_ENCODING_IMPLEMENTATION(NULL)
+};
+
+bool
+io_encoding_has_implementation (
+	io_encoding_t const *encoding,io_encoding_implementation_t const *T
+) {
+	io_encoding_implementation_t const *E = io_encoding_implementation(encoding);
+	bool is = false;
+	do {
+		is = (E == T);
+	} while (!is && (E = E->specialisation_of) != NULL);
+
+	return is && (E != NULL);
+}
+
+EVENT_DATA io_encoding_implementation_t 
+io_value_int64_encoding_implementation = {
+	SPECIALISE_IO_ENCODING_IMPLEMENTATION (&io_encoding_implementation_base)
+};
+
+bool encoding_is_io_value_int64 (io_encoding_t *encoding) {
+	return io_encoding_has_implementation (
+		encoding,&io_value_int64_encoding_implementation
+	);
+}
+
+EVENT_DATA io_encoding_implementation_t 
+io_value_float64_encoding_implementation = {
+	SPECIALISE_IO_ENCODING_IMPLEMENTATION (
+		&io_encoding_implementation_base
+	)
+};
+
+bool
+encoding_is_io_value_float64 (io_encoding_t *encoding) {
+	return io_encoding_has_implementation (
+		encoding,&io_value_float64_encoding_implementation
+	);
+}
+
+vref_t
+io_binary_encoding_decode_to_io_value (
+	io_encoding_t *encoding,io_value_decoder_t decoder,io_value_memory_t *vm
+) {
+	return decoder (encoding,vm);
+}
+
+void*
+io_binary_encoding_initialise (io_binary_encoding_t *this) {
+	this->byte_stream = io_byte_memory_allocate (
+		this->bm,TEXT_ENCODING_INITIAL_SIZE * sizeof(uint8_t)
+	);
+	if (this->byte_stream != NULL) {
+		this->cursor = this->byte_stream;
+		this->end = this->byte_stream + TEXT_ENCODING_INITIAL_SIZE;
+		this->tag.all = 0;
+	} else {
+		io_byte_memory_free (this->bm,this);
+		this = NULL;
+	}
+	return this;
+};
+
+void
+io_binary_encoding_free (io_encoding_t *encoding) {
+	if (encoding != NULL) {
+		io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+		io_byte_memory_free (this->bm,this->byte_stream);
+		io_byte_memory_free (this->bm,this);
+	}
+}
+
+bool
+io_binary_encoding_grow (io_encoding_t *encoding,uint32_t increase) {
+	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+	uint32_t old_size = io_binary_encoding_allocation_size (this);
+	uint32_t new_size = (old_size +	(increase * sizeof(uint8_t)));
+	uint32_t cursor_offset = io_binary_encoding_data_size (this);
+	uint8_t *bigger;
+
+	if (io_encoding_is_read_only (encoding)) {
+		return false;
+	}
+
+	bigger = io_byte_memory_reallocate (
+		this->bm,this->byte_stream,new_size
+	);
+
+	if (bigger) {
+		this->byte_stream = bigger;
+		this->cursor = this->byte_stream + cursor_offset;
+		this->end = this->byte_stream + new_size;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+bool
+io_binary_encoding_append_byte (io_encoding_t *encoding,uint8_t byte) {
+	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+	if (io_encoding_is_read_only (encoding)) {
+		return false;
+	}
+	if (this->cursor == this->end) {
+		if (
+				io_encoding_limit (encoding) < 0
+			||	io_binary_encoding_data_size (this) < io_encoding_limit (encoding)
+		) {
+			io_encoding_grow (
+				encoding,io_encoding_get_grow_increment(encoding)
+			);
+		}
+	}
+
+	if (this->cursor < this->end) {
+		*this->cursor++ = byte;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+void
+io_binary_encoding_get_content (
+	io_encoding_t *encoding,uint8_t const **begin,uint8_t const **end
+) {
+	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+	*begin = this->byte_stream,
+	*end = this->cursor;
+};
+
+void*
+wordwise_32_unaligned_memset (void* s,int c,size_t sz) {
+	uint32_t* p;
+	uint32_t x = c & 0xff;
+	uint8_t xx = c & 0xff;
+	uint8_t* pp = (uint8_t*)s;
+	size_t tail;
+
+	// set up to the first alignment boundary.
+	while (((unsigned int)pp & 3) && sz) {
+		*pp++ = xx;
+		sz--;
+	}
+	p = (uint32_t*)pp;
+
+	// the number of bytes that will be trailing when the last word
+	tail = sz & 3;
+
+	x |= x << 8;
+	x |= x << 16;
+
+	sz >>= 2;
+
+	while (sz--) {
+	  *p++ = x;
+	}
+
+	// set after the last alignment boundary.
+	pp = (uint8_t*)p;
+	while (tail--) {
+		*pp++ = xx;
+	}
+
+	return s;
+}
+
+size_t
+io_binary_encoding_fill_bytes (
+	io_encoding_t *encoding,uint8_t byte,size_t size
+) {
+	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+	if (io_encoding_is_read_only (encoding)) {
+		return 0;
+	}
+	if ((this->cursor + size) >= this->end) {
+		if (
+				io_encoding_limit (encoding) < 0
+			||	io_binary_encoding_data_size (this) < io_encoding_limit (encoding)
+		) {
+			io_encoding_grow (
+				encoding,
+				(
+						(size - (this->end - this->cursor))
+					+	io_encoding_get_grow_increment(encoding)
+				)
+			);
+		} else {
+			return 0;
+		}
+	}
+
+/*
+	uint8_t *end = this->cursor + size;
+	while (this->cursor < end) {
+		*this->cursor++ = byte;
+	}
+*/
+	wordwise_32_unaligned_memset (this->cursor,byte,size);
+	this->cursor += size;
+	
+	return size;
+}
+
+bool
+io_binary_encoding_append_bytes (
+	io_encoding_t *this,uint8_t const *byte,size_t size
+) {
+	uint8_t const *end = byte + size;
+	while (byte < end) {
+		if (!io_binary_encoding_append_byte (this,*byte++)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool
+io_binary_encoding_pop_last_byte (io_encoding_t *encoding,uint8_t *byte) {
+	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+	if (this->cursor > this->byte_stream && !io_encoding_is_read_only (encoding)) {
+		this->cursor --;
+		*byte = *this->cursor;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+struct PACK_STRUCTURE io_binary_encoding_print_data {
+	io_binary_encoding_t *this;
+	char buf[STB_SPRINTF_MIN];
+};
+
+char*
+io_binary_encoding_print_cb (char *buf,void *user,int len) {
+	struct io_binary_encoding_print_data *info = user;
+	io_binary_encoding_append_bytes ((io_encoding_t*) info->this,(uint8_t const*)info->buf,len);
+	return info->buf;
+}
+
+size_t
+io_binary_encoding_print (io_encoding_t *encoding,char const *fmt,va_list va) {
+	struct io_binary_encoding_print_data user = {
+		.this = (io_binary_encoding_t*) encoding
+	};
+	return STB_SPRINTF_DECORATE(vsprintfcb) (
+		io_binary_encoding_print_cb,&user,user.buf,fmt,va
+	);
+}
+
+bool
+is_io_text_encoding (io_encoding_t const *encoding) {
+	extern EVENT_DATA io_encoding_implementation_t io_text_encoding_implementation;
+	return io_encoding_has_implementation (
+		encoding,&io_text_encoding_implementation
+	);
+}
+
+bool
+io_text_encoding_iterate_characters (
+	io_encoding_t *encoding,io_character_iterator_t cb,void *user_value
+) {
+	bool ok = true;
+
+	if (is_io_text_encoding(encoding)) {
+		const uint8_t *b,*e;
+
+		io_encoding_get_content (encoding,&b,&e);
+
+		while (b < e) {
+			if ((*b & 0x80) == 0) {
+				if ((ok &= cb(*b,user_value)) == false) break;
+			} else {
+				// up to U+07FF		110xxxxx 	10xxxxxx
+				// up to U+FFFF 	1110xxxx 	10xxxxxx 	10xxxxxx
+				// up to U+10FFFF 	11110xxx 	10xxxxxx 	10xxxxxx 	10xxxxxx
+			}
+			b++;
+		}
+	}
+
+	return ok;
+};
+
+size_t
+io_encoding_printf (io_encoding_t *encoding,const char *format, ... ) {
+	size_t r = 0;
+
+	if (is_io_binary_encoding (encoding)) {
+		va_list va;
+		va_start(va, format);
+		r = io_encoding_print (encoding,format,va);
+		va_end(va);
+	}
+
+	return r;
+}
+
+void
+io_binary_encoding_reset (io_encoding_t *encoding) {
+	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+	if (!io_encoding_is_read_only (encoding)) {
+		this->cursor = this->byte_stream;
+	}
+}
+
+//
+// number of bytes
+//
+size_t
+io_binary_encoding_length (io_encoding_t const *encoding) {
+	io_binary_encoding_t const *this = (io_binary_encoding_t const*) encoding;
+	return io_binary_encoding_data_size (this);
+}
+
+int32_t
+io_binary_encoding_nolimit (void) {
+	return -1;
+}
+
+uint32_t
+default_io_encoding_grow_increment (io_encoding_t *encoding) {
+	return TEXT_ENCODING_GROWTH_INCREMENT;
+}
+
+io_t*
+io_binary_encoding_get_io (io_encoding_t *encoding) {
+	io_binary_encoding_t *this = (io_binary_encoding_t *) encoding;
+	return this->bm->io;
+}
+
+void*
+io_binary_encoding_get_byte_stream (io_encoding_t *encoding) {
+	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
+	return this->byte_stream;
+}
+
+	
+EVENT_DATA io_encoding_implementation_t 
+io_binary_encoding_implementation = {
+	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
+		&io_encoding_implementation_base
+	)
+};
+
+bool
+is_io_binary_encoding (io_encoding_t const *encoding) {
+	return io_encoding_has_implementation (
+		encoding,&io_binary_encoding_implementation
+	);
+}
+
+static io_encoding_t* 
+io_text_encoding_new (io_byte_memory_t *bm) {
+	io_text_encoding_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_text_encoding_t)
+	);
+
+	if (this != NULL) {
+		extern EVENT_DATA io_encoding_implementation_t io_text_encoding_implementation;
+		this->implementation = &io_text_encoding_implementation;
+		this->bm = bm;
+		this = io_binary_encoding_initialise ((io_binary_encoding_t*) this);
+		this->visited = NULL;
+	}
+
+	return (io_encoding_t*) this;
+};
+
+static void
+io_text_encoding_free (io_encoding_t *encoding) {
+	if (encoding != NULL) {
+		io_text_encoding_t *this = (io_text_encoding_t*) encoding;
+		io_byte_memory_free (this->bm,this->byte_stream);
+		if (this->visited) {
+			free_vref_bucket_hash_table (this->visited);
+		}
+		io_byte_memory_free (this->bm,this);
+	}
 }
 
-static void
-io_reference_to_c_stack_value_unreference (vref_t r_value) {
+vref_hash_table_t*
+io_text_encoding_get_visited (io_text_encoding_t *this) {
+	if (this->visited == NULL) {
+		this->visited = mk_vref_bucket_hash_table (this->bm,17);
+	}
+	return this->visited;
 }
 
-static int64_t
-io_reference_to_c_stack_value_get_as_builtin_integer (vref_t r_value) {
-	return vref_expando(r_value).ptr;
-}
+EVENT_DATA io_encoding_implementation_t 
+io_text_encoding_implementation = {
+	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
+		&io_binary_encoding_implementation
+	)
+	.make_encoding = io_text_encoding_new,
+	.free = io_text_encoding_free,
+	.decode_to_io_value = io_binary_encoding_decode_to_io_value,
+};
 
-static void const*
-io_reference_to_c_stack_value_cast_to_ro_pointer (vref_t r_value) {
-	return (void const*) vref_expando(r_value).ptr;
-}
+static io_encoding_t*
+io_x70_encoding_new (io_byte_memory_t *bm) {
+	io_binary_encoding_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_binary_encoding_t)
+	);
 
-static void*
-io_reference_to_c_stack_value_cast_to_rw_pointer (vref_t r_value) {
-	return (void*) vref_expando(r_value).ptr;
-}
+	if (this != NULL) {
+		extern EVENT_DATA io_encoding_implementation_t io_x70_encoding_implementation;
+		this->implementation = &io_x70_encoding_implementation;
+		this->bm = bm;
+		this = io_binary_encoding_initialise(this);
+	}
 
-EVENT_DATA io_value_reference_implementation_t reference_to_c_stack_value = {
-	.reference = io_reference_to_c_stack_value_reference,
-	.unreference = io_reference_to_c_stack_value_unreference,
-	.cast_to_ro_pointer = io_reference_to_c_stack_value_cast_to_ro_pointer,
-	.cast_to_rw_pointer = io_reference_to_c_stack_value_cast_to_rw_pointer,
-	.get_as_builtin_integer = io_reference_to_c_stack_value_get_as_builtin_integer,
-	.get_containing_memory = io_reference_to_value_get_null_containing_memory,
+	return (io_encoding_t*) this;
 };
 
+void
+io_x70_encoding_append_uint_value (io_encoding_t *encoding,uint32_t value) {
+	uint8_t flag;
+	io_encoding_append_byte (encoding,X70_UINT_VALUE_BYTE);
+	do {
+		flag = (value > 0x7f);
+		io_encoding_append_byte (encoding,(value & 0x7f) | (flag << 7));
+		value >>= 7;
+	} while (flag);
+}
+
 //
-// Encoding
+// returns the number of bytes taken or zero if the uint is truncated
+// or does not fit in 32 bits
 //
+int32_t
+io_x70_encoding_take_uint_value (const uint8_t *b,const uint8_t *e,uint32_t *value) {
+	int32_t c = 0;
 
-io_encoding_t*
-reference_io_encoding (io_encoding_t *encoding) {
-	if (encoding != NULL) { 
-		uint32_t new_count = (uint32_t) io_encoding_reference_count (encoding) + 1;
-		if (new_count <= IO_ENCODING_REFERENCE_COUNT_LIMIT) {
-			io_encoding_reference_count (encoding) = new_count;
-		} else {
-			io_panic (io_encoding_get_io (encoding),IO_PANIC_UNRECOVERABLE_ERROR);
+	*value = 0;
+	while (b < e && c < X70_UINT_MAXIMUM_LENGTH) {
+		uint8_t byte = *b++;
+		if (c == X70_UINT_MAXIMUM_LENGTH - 1 && (byte & 0xf0) != 0) {
+			break;
 		}
-	}
-	return encoding;
-}
-
-void
-unreference_io_encoding (io_encoding_t *encoding) {
-	if (io_encoding_reference_count(encoding)) {
-		if (--io_encoding_reference_count(encoding) == 0) {
-			io_encoding_free(encoding);
+		*value |= (uint32_t) (byte & 0x7f) << (7 * c);
+		c++;
+		if ((byte & 0x80) == 0) {
+			return c;
 		}
-	} else {
-		io_panic (io_encoding_get_io (encoding),IO_PANIC_UNRECOVERABLE_ERROR);
 	}
-}
-
-vref_t
-io_value_encoding_decode_to_io_value (
-	io_encoding_t *encoding,io_value_decoder_t decoder,io_value_memory_t *vm
-) {
-	return decoder (encoding,vm);
-}
 
-io_encoding_t*
-mk_null_encoding (io_byte_memory_t *bm) {
-	return NULL;
+	return 0;
 }
 
+//
+// 7-bit groups without a leading uint byte, used for x70 version 2 payloads
+//
 void
-free_null_encoding (io_encoding_t *encoding) {
-}
-
-size_t
-null_encoding_length (io_encoding_t const *encoding) {
-	return 0;
+io_x70_encoding_append_varint64 (io_encoding_t *encoding,uint64_t value) {
+	uint8_t flag;
+	do {
+		flag = (value > 0x7f);
+		io_encoding_append_byte (encoding,(value & 0x7f) | (flag << 7));
+		value >>= 7;
+	} while (flag);
 }
 
+//
+// returns the number of bytes taken or zero if the varint is truncated
+//
 int32_t
-null_encoding_limit (void) {
-	return 0;
-}
+io_x70_encoding_take_varint64 (const uint8_t *b,const uint8_t *e,uint64_t *value) {
+	int32_t c = 0;
+	uint8_t shift = 0;
+
+	*value = 0;
+	while (b < e && c < X70_VARINT64_MAXIMUM_LENGTH) {
+		uint8_t byte = *b++;
+		c++;
+		*value |= (uint64_t) (byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return c;
+		}
+		shift += 7;
+	}
 
-uint32_t
-null_encoding_grow_increment (io_encoding_t *encoding) {
 	return 0;
 }
 
-io_t*
-null_encoding_get_io (io_encoding_t *encoding) {
-	return NULL;
+//
+// decode one complete value at *b
+//
+vref_t
+io_x70_decode_value (
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const **b,const uint8_t *e
+) {
+	vref_t r_value = INVALID_VREF;
+	uint32_t u;
+
+	if (*b < e && **b == X70_UINT_VALUE_BYTE) {
+		int32_t c = io_x70_encoding_take_uint_value (*b + 1,e,&u);
+		*b += 1 + c;
+		if (c > 0 && *b <= (e - u)) {
+			io_value_implementation_t const *I = io_get_value_implementation (
+				io_value_memory_get_io (vm),(const char*) *b,u
+			);
+			*b += u;
+			if (I) {
+				r_value = I->decode[IO_VALUE_ENCODING_FORMAT_X70] (vm,context,b,e);
+			}
+		}
+	}
+
+	return r_value;
 }
 
-void*
-io_encoding_no_layer (io_encoding_t *encoding,io_layer_implementation_t const *L) {
-	return NULL;
+//
+// x70 dictionary decoding, the table is in the decode context of the
+// message and text values are added as they are made
+//
+void
+io_x70_decode_dictionary_add (io_x70_decode_context_t *context,vref_t r_value) {
+	io_x70_dictionary_t *this = context->dictionary;
+	if (this != NULL && this->count < IO_X70_DICTIONARY_LIMIT) {
+		this->entries[this->count++] = reference_value (r_value);
+	}
 }
 
-void*
-io_encoding_no_byte_stream (io_encoding_t *encoding) {
-	return NULL;
+vref_t
+io_x70_decode_dictionary_entry (io_x70_decode_context_t *context,uint32_t index) {
+	io_x70_dictionary_t *this = context->dictionary;
+	if (this != NULL && index < this->count) {
+		return this->entries[index];
+	} else {
+		return INVALID_VREF;
+	}
 }
 
 void
-io_encoding_no_content (io_encoding_t *encoding,uint8_t const** b,uint8_t const** e) {
-	*b = *e = NULL;
+io_x70_dictionary_clear (io_x70_dictionary_t *this) {
+	while (this->count > 0) {
+		unreference_value (this->entries[--this->count]);
+	}
 }
 
-size_t
-io_encoding_no_fill (io_encoding_t *encoding,uint8_t b,size_t s) {
-	return 0;
+//
+// the zero-copy source if it holds all of the bytes
+//
+io_encoding_t*
+io_x70_decode_source_containing (
+	io_x70_decode_context_t *context,uint8_t const *bytes,uint32_t size
+) {
+	if (context->source != NULL) {
+		const uint8_t *b,*e;
+		io_encoding_get_content (context->source,&b,&e);
+		if (bytes >= b && bytes + size <= e) {
+			return context->source;
+		}
+	}
+	return NULL;
 }
 
-bool
-io_encoding_no_grow (io_encoding_t *encoding,uint32_t g) {
-	return false;
-}
+//
+// returns the last complete value in the encoding, binary and text
+// values point into source when it is not NULL
+//
+static vref_t
+io_x70_decode_encoding (
+	io_encoding_t *encoding,io_value_memory_t *vm,io_encoding_t *source
+) {
+	io_x70_dictionary_t dictionary = {.count = 0};
+	io_x70_decode_context_t context = {
+		.dictionary = &dictionary,
+		.source = source,
+		.depth = 0,
+	};
+	const uint8_t *b,*e;
+	vref_t r_value = INVALID_VREF;
+	
+	io_encoding_get_content (encoding,&b,&e);
+	
+	while (b < e) {
+		vref_t r_part = io_x70_decode_value (vm,&context,&b,e);
+		if (vref_is_valid (r_part)) {
+			r_value = r_part;
+		} else {
+			break;
+		}
+	}
 
-void
-io_encoding_no_reset (io_encoding_t *encoding) {
+	io_x70_dictionary_clear (&dictionary);
+	
+	return r_value;
 }
 
-size_t
-io_encoding_no_print (io_encoding_t *encoding,char const *fmt,va_list va) {
-	return 0;
+vref_t
+io_x70_zero_copy_decoder (io_encoding_t *encoding,io_value_memory_t *vm) {
+	return io_x70_decode_encoding (encoding,vm,encoding);
 }
 
-bool
-io_encoding_no_append_byte (io_encoding_t *encoding,uint8_t byte) {
-	return false;
+vref_t
+io_x70_decoder (io_encoding_t *encoding,io_value_memory_t *vm) {
+	return io_x70_decode_encoding (encoding,vm,NULL);
 }
 
-bool
-io_encoding_no_append_bytes (io_encoding_t *encoding,uint8_t const *b,size_t s) {
-	return false;
-}
+EVENT_DATA io_encoding_implementation_t io_x70_encoding_implementation = {
+	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
+		&io_binary_encoding_implementation
+	)
+	.make_encoding = io_x70_encoding_new,
+	.free = io_binary_encoding_free,
+};
 
-bool
-io_encoding_no_pop_last_byte (io_encoding_t *encoding,uint8_t *b) {
-	return false;
-}
+static io_encoding_t*
+io_x70_compact_encoding_new (io_byte_memory_t *bm) {
+	io_binary_encoding_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_binary_encoding_t)
+	);
 
-uint32_t
-io_encoding_no_decode_increment (io_encoding_t *encoding,uint32_t incr) {
-	return 0;
-}
+	if (this != NULL) {
+		extern EVENT_DATA io_encoding_implementation_t io_x70_compact_encoding_implementation;
+		this->implementation = &io_x70_compact_encoding_implementation;
+		this->bm = bm;
+		this = io_binary_encoding_initialise(this);
+	}
 
-EVENT_DATA io_encoding_layer_api_t no_packet_layer_api = {
-	.get_inner_layer = NULL,
-	.get_outer_layer = NULL,
-	.get_layer = io_encoding_no_layer,
-	.push_layer = NULL,
+	return (io_encoding_t*) this;
 };
 
-EVENT_DATA io_encoding_implementation_t io_encoding_implementation_base = {
-	SPECIALISE_IO_ENCODING_IMPLEMENTATION(NULL)
+EVENT_DATA io_encoding_implementation_t io_x70_compact_encoding_implementation = {
+	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
+		&io_x70_encoding_implementation
+	)
+	.make_encoding = io_x70_compact_encoding_new,
+	.free = io_binary_encoding_free,
 };
 
-bool
-io_encoding_has_implementation (
-	io_encoding_t const *encoding,io_encoding_implementation_t const *T
-) {
-	io_encoding_implementation_t const *E = io_encoding_implementation(encoding);
-	bool is = false;
-	do {
-		is = (E == T);
-	} while (!is && (E = E->specialisation_of) != NULL);
+static io_encoding_t*
+io_x70_dictionary_encoding_new (io_byte_memory_t *bm) {
+	io_x70_dictionary_encoding_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_x70_dictionary_encoding_t)
+	);
+
+	if (this != NULL) {
+		extern EVENT_DATA io_encoding_implementation_t io_x70_dictionary_encoding_implementation;
+		this->implementation = &io_x70_dictionary_encoding_implementation;
+		this->bm = bm;
+		this->number_of_entries = 0;
+		this = io_binary_encoding_initialise((io_binary_encoding_t*) this);
+	}
+
+	return (io_encoding_t*) this;
+};
 
-	return is && (E != NULL);
+static void
+io_x70_dictionary_encoding_reset (io_encoding_t *encoding) {
+	io_x70_dictionary_encoding_t *this = (io_x70_dictionary_encoding_t*) encoding;
+	io_binary_encoding_reset (encoding);
+	this->number_of_entries = 0;
 }
 
-EVENT_DATA io_encoding_implementation_t 
-io_value_int64_encoding_implementation = {
-	SPECIALISE_IO_ENCODING_IMPLEMENTATION (&io_encoding_implementation_base)
-};
+//
+// returns the index of text already in the message or -1
+//
+int32_t
+io_x70_dictionary_encoding_find (
+	io_encoding_t *encoding,uint8_t const *bytes,uint32_t size
+) {
+	io_x70_dictionary_encoding_t *this = (io_x70_dictionary_encoding_t*) encoding;
+	for (int32_t i = 0; i < this->number_of_entries; i++) {
+		io_x70_dictionary_entry_t const *entry = this->entries + i;
+		if (
+				entry->length == size
+			&&	memcmp (this->byte_stream + entry->offset,bytes,size) == 0
+		) {
+			return i;
+		}
+	}
+	return -1;
+}
 
-bool encoding_is_io_value_int64 (io_encoding_t *encoding) {
-	return io_encoding_has_implementation (
-		encoding,&io_value_int64_encoding_implementation
-	);
+//
+// remember text written at offset, entries beyond the limit are
+// not added on either side
+//
+void
+io_x70_dictionary_encoding_add (
+	io_encoding_t *encoding,uint32_t offset,uint32_t length
+) {
+	io_x70_dictionary_encoding_t *this = (io_x70_dictionary_encoding_t*) encoding;
+	if (this->number_of_entries < IO_X70_DICTIONARY_LIMIT) {
+		io_x70_dictionary_entry_t *entry = this->entries + this->number_of_entries++;
+		entry->offset = offset;
+		entry->length = length;
+	}
 }
 
-EVENT_DATA io_encoding_implementation_t 
-io_value_float64_encoding_implementation = {
-	SPECIALISE_IO_ENCODING_IMPLEMENTATION (
-		&io_encoding_implementation_base
+EVENT_DATA io_encoding_implementation_t io_x70_dictionary_encoding_implementation = {
+	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
+		&io_x70_compact_encoding_implementation
 	)
+	.make_encoding = io_x70_dictionary_encoding_new,
+	.free = io_binary_encoding_free,
+	.reset = io_x70_dictionary_encoding_reset,
 };
 
-bool
-encoding_is_io_value_float64 (io_encoding_t *encoding) {
-	return io_encoding_has_implementation (
-		encoding,&io_value_float64_encoding_implementation
+//
+// streaming x70 decoder
+//
+io_x70_stream_decoder_t*
+mk_io_x70_stream_decoder (
+	io_byte_memory_t *bm,
+	io_value_memory_t *vm,
+	io_x70_stream_decoder_emit_t emit,
+	void *user_value
+) {
+	io_x70_stream_decoder_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_x70_stream_decoder_t)
 	);
-}
 
-vref_t
-io_binary_encoding_decode_to_io_value (
-	io_encoding_t *encoding,io_value_decoder_t decoder,io_value_memory_t *vm
-) {
-	return decoder (encoding,vm);
+	if (this != NULL) {
+		this->bm = bm;
+		this->vm = vm;
+		this->emit = emit;
+		this->user_value = user_value;
+		this->scratch = NULL;
+		this->scratch_size = 0;
+		this->top = NULL;
+		this->dictionary.count = 0;
+		io_x70_stream_decoder_reset (this);
+	}
+
+	return this;
 }
 
-void*
-io_binary_encoding_initialise (io_binary_encoding_t *this) {
-	this->byte_stream = io_byte_memory_allocate (
-		this->bm,TEXT_ENCODING_INITIAL_SIZE * sizeof(uint8_t)
-	);
-	if (this->byte_stream != NULL) {
-		this->cursor = this->byte_stream;
-		this->end = this->byte_stream + TEXT_ENCODING_INITIAL_SIZE;
-		this->tag.all = 0;
-	} else {
-		io_byte_memory_free (this->bm,this);
-		this = NULL;
+static void
+io_x70_stream_decoder_pop_frame (io_x70_stream_decoder_t *this) {
+	io_x70_stream_frame_t *frame = this->top;
+	vref_t *cursor = frame->values;
+	vref_t *end = cursor + frame->count;
+
+	while (cursor < end) {
+		unreference_value (*cursor++);
 	}
-	return this;
-};
+	io_byte_memory_free (this->bm,frame->values);
+
+	this->top = (frame == this->stack) ? NULL : frame - 1;
+}
 
 void
-io_binary_encoding_free (io_encoding_t *encoding) {
-	if (encoding != NULL) {
-		io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-		io_byte_memory_free (this->bm,this->byte_stream);
-		io_byte_memory_free (this->bm,this);
+io_x70_stream_decoder_reset (io_x70_stream_decoder_t *this) {
+	while (this->top != NULL) {
+		io_x70_stream_decoder_pop_frame (this);
 	}
+	io_x70_dictionary_clear (&this->dictionary);
+	this->implementation = NULL;
+	this->state = X70_STREAM_EXPECT_VALUE;
+	this->shift = 0;
+	this->uint_value = 0;
+	this->remaining = 0;
+	this->scratch_length = 0;
+	this->name_length = 0;
+	this->name_cursor = 0;
 }
 
-bool
-io_binary_encoding_grow (io_encoding_t *encoding,uint32_t increase) {
-	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-	uint32_t old_size = io_binary_encoding_allocation_size (this);
-	uint32_t new_size = (old_size +	(increase * sizeof(uint8_t)));
-	uint32_t cursor_offset = io_binary_encoding_data_size (this);
-	uint8_t *bigger = io_byte_memory_reallocate (
-		this->bm,this->byte_stream,new_size
-	);
+void
+free_io_x70_stream_decoder (io_x70_stream_decoder_t *this) {
+	io_x70_stream_decoder_reset (this);
+	io_byte_memory_free (this->bm,this->scratch);
+	io_byte_memory_free (this->bm,this);
+}
 
-	if (bigger) {
-		this->byte_stream = bigger;
-		this->cursor = this->byte_stream + cursor_offset;
-		this->end = this->byte_stream + new_size;
-		return true;
-	} else {
-		return false;
-	}
+static bool
+io_x70_stream_decoder_fail (io_x70_stream_decoder_t *this) {
+	io_x70_stream_decoder_reset (this);
+	this->state = X70_STREAM_ERROR;
+	return false;
 }
 
-bool
-io_binary_encoding_append_byte (io_encoding_t *encoding,uint8_t byte) {
-	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-	if (this->cursor == this->end) {
-		if (
-				io_encoding_limit (encoding) < 0
-			||	io_binary_encoding_data_size (this) < io_encoding_limit (encoding)
-		) {
-			io_encoding_grow (
-				encoding,io_encoding_get_grow_increment(encoding)
-			);
+static bool
+io_x70_stream_decoder_reserve (io_x70_stream_decoder_t *this,uint32_t size) {
+	if (size > this->scratch_size) {
+		uint8_t *bigger = io_byte_memory_reallocate (this->bm,this->scratch,size);
+		if (bigger != NULL) {
+			this->scratch = bigger;
+			this->scratch_size = size;
+		} else {
+			return false;
 		}
 	}
+	return true;
+}
 
-	if (this->cursor < this->end) {
-		*this->cursor++ = byte;
+static bool
+io_x70_stream_decoder_append_scratch (io_x70_stream_decoder_t *this,uint8_t byte) {
+	if (io_x70_stream_decoder_reserve (this,this->scratch_length + 1)) {
+		this->scratch[this->scratch_length++] = byte;
 		return true;
 	} else {
 		return false;
 	}
 }
 
-void
-io_binary_encoding_get_content (
-	io_encoding_t *encoding,uint8_t const **begin,uint8_t const **end
-) {
-	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-	*begin = this->byte_stream,
-	*end = this->cursor;
-};
+//
+// accumulate a uint value, returns true when the last byte is taken
+//
+static bool
+io_x70_stream_decoder_take_uint_byte (io_x70_stream_decoder_t *this,uint8_t byte) {
+	this->uint_value |= (uint32_t) (byte & 0x7f) << this->shift;
+	this->shift += 7;
+	return (byte & 0x80) == 0 || this->shift > 28;
+}
 
-void*
-wordwise_32_unaligned_memset (void* s,int c,size_t sz) {
-	uint32_t* p;
-	uint32_t x = c & 0xff;
-	uint8_t xx = c & 0xff;
-	uint8_t* pp = (uint8_t*)s;
-	size_t tail;
+INLINE_FUNCTION void
+io_x70_stream_decoder_begin_uint (io_x70_stream_decoder_t *this,uint8_t state) {
+	this->uint_value = 0;
+	this->shift = 0;
+	this->state = state;
+}
 
-	// set up to the first alignment boundary.
-	while (((unsigned int)pp & 3) && sz) {
-		*pp++ = xx;
-		sz--;
+//
+// a value is complete, add it to the enclosing vector or emit it
+//
+static bool
+io_x70_stream_decoder_complete_value (io_x70_stream_decoder_t *this,vref_t r_value) {
+	this->state = X70_STREAM_EXPECT_VALUE;
+	this->implementation = NULL;
+
+	while (vref_is_valid (r_value)) {
+		io_x70_stream_frame_t *frame = this->top;
+		if (frame == NULL) {
+			io_x70_dictionary_clear (&this->dictionary);
+			this->emit (r_value,this->user_value);
+			return true;
+		}
+		
+		frame->values[frame->count++] = reference_value (r_value);
+		if (frame->count < frame->arity) {
+			return true;
+		}
+
+		r_value = mk_io_vector_value (this->vm,frame->arity,frame->values);
+		io_x70_stream_decoder_pop_frame (this);
 	}
-	p = (uint32_t*)pp;
 
-	// the number of bytes that will be trailing when the last word
-	tail = sz & 3;
+	return io_x70_stream_decoder_fail (this);
+}
 
-	x |= x << 8;
-	x |= x << 16;
+static bool
+io_x70_stream_decoder_complete_leaf (io_x70_stream_decoder_t *this) {
+	io_x70_decode_context_t context = {
+		.dictionary = &this->dictionary,
+		.source = NULL,
+		.depth = 0,
+	};
+	uint8_t const *b = this->scratch;
+	uint8_t const *e = b + this->scratch_length;
+	vref_t r_value = this->implementation->decode[IO_VALUE_ENCODING_FORMAT_X70] (
+		this->vm,&context,&b,e
+	);
+	this->scratch_length = 0;
+	return io_x70_stream_decoder_complete_value (this,r_value);
+}
 
-	sz >>= 2;
+static bool
+io_x70_stream_decoder_begin_payload (io_x70_stream_decoder_t *this) {
+	io_x70_framing_t framing = this->implementation->x70_framing;
+
+	this->scratch_length = 0;
+	switch (framing.type) {
+		case IO_X70_FRAMING_FIXED:
+			if (!io_x70_stream_decoder_reserve (this,framing.size)) {
+				return io_x70_stream_decoder_fail (this);
+			}
+			this->remaining = framing.size;
+			this->state = X70_STREAM_PAYLOAD;
+			return (this->remaining > 0) || io_x70_stream_decoder_complete_leaf (this);
 
-	while (sz--) {
-	  *p++ = x;
-	}
+		case IO_X70_FRAMING_SIZED:
+			this->state = X70_STREAM_SIZE_BYTE;
+			return true;
 
-	// set after the last alignment boundary.
-	pp = (uint8_t*)p;
-	while (tail--) {
-		*pp++ = xx;
-	}
+		case IO_X70_FRAMING_VALUES:
+			this->state = X70_STREAM_ARITY_BYTE;
+			return true;
 
-	return s;
+		case IO_X70_FRAMING_VARINT:
+			this->state = X70_STREAM_VARINT;
+			return true;
+
+		default:
+			return io_x70_stream_decoder_complete_leaf (this);
+	}
 }
 
-size_t
-io_binary_encoding_fill_bytes (
-	io_encoding_t *encoding,uint8_t byte,size_t size
-) {
-	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-	if ((this->cursor + size) >= this->end) {
+static bool
+io_x70_stream_decoder_begin_vector (io_x70_stream_decoder_t *this,uint32_t arity) {
+	if (arity == 0) {
+		return io_x70_stream_decoder_complete_value (
+			this,mk_io_vector_value (this->vm,0,NULL)
+		);
+	} else {
+		io_x70_stream_frame_t *frame = (this->top == NULL) ? this->stack : this->top + 1;
 		if (
-				io_encoding_limit (encoding) < 0
-			||	io_binary_encoding_data_size (this) < io_encoding_limit (encoding)
+				arity <= IO_X70_STREAM_DECODER_ARITY_LIMIT
+			&&	frame < this->stack + IO_X70_STREAM_DECODER_STACK_DEPTH
 		) {
-			io_encoding_grow (
-				encoding,
-				(
-						(size - (this->end - this->cursor))
-					+	io_encoding_get_grow_increment(encoding)
-				)
-			);
-		} else {
-			return 0;
+			frame->values = io_byte_memory_allocate (this->bm,sizeof(vref_t) * arity);
+			if (frame->values != NULL) {
+				frame->arity = arity;
+				frame->count = 0;
+				this->top = frame;
+				this->state = X70_STREAM_EXPECT_VALUE;
+				return true;
+			}
 		}
+		return io_x70_stream_decoder_fail (this);
 	}
-
-/*
-	uint8_t *end = this->cursor + size;
-	while (this->cursor < end) {
-		*this->cursor++ = byte;
-	}
-*/
-	wordwise_32_unaligned_memset (this->cursor,byte,size);
-	this->cursor += size;
-	
-	return size;
 }
 
 bool
-io_binary_encoding_append_bytes (
-	io_encoding_t *this,uint8_t const *byte,size_t size
+io_x70_stream_decoder_push (
+	io_x70_stream_decoder_t *this,uint8_t const *b,uint32_t size
 ) {
-	uint8_t const *end = byte + size;
-	while (byte < end) {
-		if (!io_binary_encoding_append_byte (this,*byte++)) {
-			return false;
-		}
-	}
-	return true;
-}
+	uint8_t const *e = b + size;
+	bool ok = this->state != X70_STREAM_ERROR;
+
+	while (ok && b < e) {
+		switch (this->state) {
+			case X70_STREAM_EXPECT_VALUE:
+				if (*b++ == X70_UINT_VALUE_BYTE) {
+					io_x70_stream_decoder_begin_uint (this,X70_STREAM_NAME_LENGTH);
+				} else {
+					ok = io_x70_stream_decoder_fail (this);
+				}
+			break;
 
-bool
-io_binary_encoding_pop_last_byte (io_encoding_t *encoding,uint8_t *byte) {
-	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-	if (this->cursor > this->byte_stream) {
-		this->cursor --;
-		*byte = *this->cursor;
-		return true;
-	} else {
-		return false;
-	}
-}
+			case X70_STREAM_NAME_LENGTH:
+				if (io_x70_stream_decoder_take_uint_byte (this,*b++)) {
+					if (
+							this->uint_value > 0
+						&&	this->uint_value <= IO_X70_STREAM_DECODER_NAME_LIMIT
+					) {
+						this->name_length = this->uint_value;
+						this->name_cursor = 0;
+						this->state = X70_STREAM_NAME;
+					} else {
+						ok = io_x70_stream_decoder_fail (this);
+					}
+				}
+			break;
+
+			case X70_STREAM_NAME:
+				this->name[this->name_cursor++] = *b++;
+				if (this->name_cursor == this->name_length) {
+					this->implementation = io_get_value_implementation (
+						io_value_memory_get_io (this->vm),this->name,this->name_length
+					);
+					if (this->implementation != NULL) {
+						ok = io_x70_stream_decoder_begin_payload (this);
+					} else {
+						ok = io_x70_stream_decoder_fail (this);
+					}
+				}
+			break;
+
+			case X70_STREAM_SIZE_BYTE:
+				if (*b == X70_UINT_VALUE_BYTE) {
+					ok = io_x70_stream_decoder_append_scratch (this,*b++);
+					io_x70_stream_decoder_begin_uint (this,X70_STREAM_SIZE);
+				} else {
+					ok = io_x70_stream_decoder_fail (this);
+				}
+			break;
+
+			case X70_STREAM_SIZE:
+				ok = io_x70_stream_decoder_append_scratch (this,*b);
+				if (ok && io_x70_stream_decoder_take_uint_byte (this,*b++)) {
+					this->remaining = this->uint_value;
+					if (
+							this->remaining <= UINT32_MAX - this->scratch_length
+						&&	io_x70_stream_decoder_reserve (
+								this,this->scratch_length + this->remaining
+							)
+					) {
+						this->state = X70_STREAM_PAYLOAD;
+						if (this->remaining == 0) {
+							ok = io_x70_stream_decoder_complete_leaf (this);
+						}
+					} else {
+						ok = false;
+					}
+				}
+				if (!ok) {
+					io_x70_stream_decoder_fail (this);
+				}
+			break;
+
+			case X70_STREAM_PAYLOAD: {
+				uint32_t count = e - b;
+				if (count > this->remaining) {
+					count = this->remaining;
+				}
+				memcpy (this->scratch + this->scratch_length,b,count);
+				this->scratch_length += count;
+				this->remaining -= count;
+				b += count;
+				if (this->remaining == 0) {
+					ok = io_x70_stream_decoder_complete_leaf (this);
+				}
+			}
+			break;
+
+			case X70_STREAM_ARITY_BYTE:
+				if (*b++ == X70_UINT_VALUE_BYTE) {
+					io_x70_stream_decoder_begin_uint (this,X70_STREAM_ARITY);
+				} else {
+					ok = io_x70_stream_decoder_fail (this);
+				}
+			break;
 
-struct PACK_STRUCTURE io_binary_encoding_print_data {
-	io_binary_encoding_t *this;
-	char buf[STB_SPRINTF_MIN];
-};
+			case X70_STREAM_ARITY:
+				if (io_x70_stream_decoder_take_uint_byte (this,*b++)) {
+					ok = io_x70_stream_decoder_begin_vector (this,this->uint_value);
+				}
+			break;
 
-char*
-io_binary_encoding_print_cb (char *buf,void *user,int len) {
-	struct io_binary_encoding_print_data *info = user;
-	io_binary_encoding_append_bytes ((io_encoding_t*) info->this,(uint8_t const*)info->buf,len);
-	return info->buf;
-}
+			case X70_STREAM_VARINT:
+				if (this->scratch_length < X70_VARINT64_MAXIMUM_LENGTH) {
+					uint8_t byte = *b++;
+					ok = io_x70_stream_decoder_append_scratch (this,byte);
+					if (ok && (byte & 0x80) == 0) {
+						ok = io_x70_stream_decoder_complete_leaf (this);
+					}
+				} else {
+					ok = io_x70_stream_decoder_fail (this);
+				}
+			break;
 
-size_t
-io_binary_encoding_print (io_encoding_t *encoding,char const *fmt,va_list va) {
-	struct io_binary_encoding_print_data user = {
-		.this = (io_binary_encoding_t*) encoding
-	};
-	return STB_SPRINTF_DECORATE(vsprintfcb) (
-		io_binary_encoding_print_cb,&user,user.buf,fmt,va
-	);
-}
+			default:
+				ok = io_x70_stream_decoder_fail (this);
+			break;
+		}
+	}
 
-bool
-is_io_text_encoding (io_encoding_t const *encoding) {
-	extern EVENT_DATA io_encoding_implementation_t io_text_encoding_implementation;
-	return io_encoding_has_implementation (
-		encoding,&io_text_encoding_implementation
-	);
+	return ok;
 }
 
+//
+// consume everything readable in a byte pipe
+//
 bool
-io_text_encoding_iterate_characters (
-	io_encoding_t *encoding,io_character_iterator_t cb,void *user_value
-) {
+io_x70_stream_decoder_push_pipe (io_x70_stream_decoder_t *this,io_byte_pipe_t *pipe) {
 	bool ok = true;
 
-	if (is_io_text_encoding(encoding)) {
-		const uint8_t *b,*e;
+	while (ok && io_byte_pipe_is_readable (pipe)) {
+		int16_t read_index = pipe->read_index;
+		int16_t write_index = pipe->write_index;
+		int16_t end = (write_index > read_index) ? write_index : pipe->size_of_ring;
 
-		io_encoding_get_content (encoding,&b,&e);
+		ok = io_x70_stream_decoder_push (
+			this,pipe->byte_ring + read_index,end - read_index
+		);
 
-		while (b < e) {
-			if ((*b & 0x80) == 0) {
-				if ((ok &= cb(*b,user_value)) == false) break;
-			} else {
-				// up to U+07FF		110xxxxx 	10xxxxxx
-				// up to U+FFFF 	1110xxxx 	10xxxxxx 	10xxxxxx
-				// up to U+10FFFF 	11110xxx 	10xxxxxx 	10xxxxxx 	10xxxxxx
-			}
-			b++;
-		}
+		pipe->read_index = (end == pipe->size_of_ring) ? 0 : end;
 	}
 
 	return ok;
-};
+}
 
-size_t
-io_encoding_printf (io_encoding_t *encoding,const char *format, ... ) {
-	size_t r = 0;
+//
+// streaming x70 encoder
+//
+io_x70_stream_encoder_t*
+mk_io_x70_stream_encoder (io_byte_memory_t *bm) {
+	io_x70_stream_encoder_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_x70_stream_encoder_t)
+	);
 
-	if (is_io_binary_encoding (encoding)) {
-		va_list va;
-		va_start(va, format);
-		r = io_encoding_print (encoding,format,va);
-		va_end(va);
+	if (this != NULL) {
+		this->bm = bm;
+		this->r_value = INVALID_VREF;
+		this->chunk = NULL;
+		this->chunk_size = 0;
+		this->header = reference_io_encoding (mk_io_x70_encoding (bm));
+		if (this->header == NULL) {
+			io_byte_memory_free (bm,this);
+			return NULL;
+		}
+		io_x70_stream_encoder_reset (this);
 	}
 
-	return r;
+	return this;
 }
 
 void
-io_binary_encoding_reset (io_encoding_t *encoding) {
-	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-	this->cursor = this->byte_stream;
+io_x70_stream_encoder_reset (io_x70_stream_encoder_t *this) {
+	if (vref_is_valid (this->r_value)) {
+		unreference_value (this->r_value);
+		this->r_value = INVALID_VREF;
+	}
+	io_encoding_reset (this->header);
+	this->header_cursor = 0;
+	this->body = NULL;
+	this->body_remaining = 0;
+	this->chunk_length = 0;
+	this->error = false;
+	this->top = NULL;
 }
 
-//
-// number of bytes
-//
-size_t
-io_binary_encoding_length (io_encoding_t const *encoding) {
-	io_binary_encoding_t const *this = (io_binary_encoding_t const*) encoding;
-	return io_binary_encoding_data_size (this);
+void
+free_io_x70_stream_encoder (io_x70_stream_encoder_t *this) {
+	io_x70_stream_encoder_reset (this);
+	unreference_io_encoding (this->header);
+	io_byte_memory_free (this->bm,this->chunk);
+	io_byte_memory_free (this->bm,this);
 }
 
-int32_t
-io_binary_encoding_nolimit (void) {
-	return -1;
-}
+//
+// load the header (and body) of the next value
+//
+static bool
+io_x70_stream_encoder_load_value (io_x70_stream_encoder_t *this,vref_t r_value) {
+	io_value_t const *value = vref_cast_to_ro_pointer (r_value);
+	io_x70_framing_t framing = value->implementation->x70_framing;
+
+	io_encoding_reset (this->header);
+	this->header_cursor = 0;
+
+	switch (framing.type) {
+		case IO_X70_FRAMING_SIZED: {
+			io_binary_value_t const *binary = (io_binary_value_t const*) value;
+			io_encode_value_implementation_to_x70 (value,this->header);
+			io_x70_encoding_append_uint_value (this->header,io_binary_value_size (binary));
+			this->body = io_binary_value_ro_bytes (binary);
+			this->body_remaining = io_binary_value_size (binary);
+			return true;
+		}
 
-uint32_t
-default_io_encoding_grow_increment (io_encoding_t *encoding) {
-	return TEXT_ENCODING_GROWTH_INCREMENT;
-}
+		case IO_X70_FRAMING_VALUES: {
+			io_vector_value_t const *vector = (io_vector_value_t const*) value;
+			io_x70_stream_encoder_frame_t *frame = (
+				(this->top == NULL) ? this->stack : this->top + 1
+			);
+			if (frame < this->stack + IO_X70_STREAM_ENCODER_STACK_DEPTH) {
+				io_encode_value_implementation_to_x70 (value,this->header);
+				io_x70_encoding_append_uint_value (this->header,vector->arity);
+				frame->cursor = vector->values;
+				frame->end = vector->values + vector->arity;
+				this->top = frame;
+				return true;
+			} else {
+				return false;
+			}
+		}
 
-io_t*
-io_binary_encoding_get_io (io_encoding_t *encoding) {
-	io_binary_encoding_t *this = (io_binary_encoding_t *) encoding;
-	return this->bm->io;
+		default:
+			return io_value_encode (r_value,this->header);
+	}
 }
 
-void*
-io_binary_encoding_get_byte_stream (io_encoding_t *encoding) {
-	io_binary_encoding_t *this = (io_binary_encoding_t*) encoding;
-	return this->byte_stream;
+//
+// find the next value in the tree, returns false when there is none
+//
+static bool
+io_x70_stream_encoder_next_value (io_x70_stream_encoder_t *this) {
+	while (this->top != NULL) {
+		io_x70_stream_encoder_frame_t *frame = this->top;
+		if (frame->cursor < frame->end) {
+			if (io_x70_stream_encoder_load_value (this,*frame->cursor++)) {
+				return true;
+			} else {
+				this->error = true;
+				return false;
+			}
+		}
+		this->top = (frame == this->stack) ? NULL : frame - 1;
+	}
+	return false;
 }
 
-	
-EVENT_DATA io_encoding_implementation_t 
-io_binary_encoding_implementation = {
-	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
-		&io_encoding_implementation_base
-	)
-};
-
 bool
-is_io_binary_encoding (io_encoding_t const *encoding) {
-	return io_encoding_has_implementation (
-		encoding,&io_binary_encoding_implementation
-	);
-}
-
-static io_encoding_t* 
-io_text_encoding_new (io_byte_memory_t *bm) {
-	io_text_encoding_t *this = io_byte_memory_allocate (
-		bm,sizeof(io_text_encoding_t)
-	);
-
-	if (this != NULL) {
-		extern EVENT_DATA io_encoding_implementation_t io_text_encoding_implementation;
-		this->implementation = &io_text_encoding_implementation;
-		this->bm = bm;
-		this = io_binary_encoding_initialise ((io_binary_encoding_t*) this);
-		this->visited = NULL;
+io_x70_stream_encoder_begin (io_x70_stream_encoder_t *this,vref_t r_value) {
+	if (io_x70_stream_encoder_is_complete (this)) {
+		io_x70_stream_encoder_reset (this);
+		this->r_value = reference_value (r_value);
+		if (io_x70_stream_encoder_load_value (this,r_value)) {
+			return true;
+		} else {
+			io_x70_stream_encoder_reset (this);
+			this->error = true;
+		}
 	}
+	return false;
+}
 
-	return (io_encoding_t*) this;
-};
+uint32_t
+io_x70_stream_encoder_read (io_x70_stream_encoder_t *this,uint8_t *buffer,uint32_t size) {
+	uint8_t *cursor = buffer;
+	uint8_t *end = buffer + size;
 
-static void
-io_text_encoding_free (io_encoding_t *encoding) {
-	if (encoding != NULL) {
-		io_text_encoding_t *this = (io_text_encoding_t*) encoding;
-		io_byte_memory_free (this->bm,this->byte_stream);
-		if (this->visited) {
-			free_vref_bucket_hash_table (this->visited);
+	while (cursor < end && vref_is_valid (this->r_value)) {
+		uint32_t header_length = io_encoding_length (this->header);
+		uint32_t count;
+		
+		if (this->header_cursor < header_length) {
+			uint8_t const *header = io_encoding_get_byte_stream (this->header);
+			count = header_length - this->header_cursor;
+			if (count > (end - cursor)) count = (end - cursor);
+			memcpy (cursor,header + this->header_cursor,count);
+			this->header_cursor += count;
+			cursor += count;
+		} else if (this->body_remaining > 0) {
+			count = this->body_remaining;
+			if (count > (end - cursor)) count = (end - cursor);
+			memcpy (cursor,this->body,count);
+			this->body += count;
+			this->body_remaining -= count;
+			cursor += count;
+		} else if (!io_x70_stream_encoder_next_value (this)) {
+			bool error = this->error;
+			io_x70_stream_encoder_reset (this);
+			this->error = error;
 		}
-		io_byte_memory_free (this->bm,this);
 	}
-}
 
-vref_hash_table_t*
-io_text_encoding_get_visited (io_text_encoding_t *this) {
-	if (this->visited == NULL) {
-		this->visited = mk_vref_bucket_hash_table (this->bm,17);
-	}
-	return this->visited;
+	return cursor - buffer;
 }
 
-EVENT_DATA io_encoding_implementation_t 
-io_text_encoding_implementation = {
-	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
-		&io_binary_encoding_implementation
-	)
-	.make_encoding = io_text_encoding_new,
-	.free = io_text_encoding_free,
-	.decode_to_io_value = io_binary_encoding_decode_to_io_value,
-};
+//
+// Send the value as a sequence of messages of at most the socket's mtu.
+// A chunk that the socket refuses is kept and retried on the next call,
+// returns true when the value has been sent in full and false while it
+// is still pending or if the stream failed (io_x70_stream_encoder_has_error).
+//
+bool
+io_x70_stream_encoder_send (io_x70_stream_encoder_t *this,io_socket_t *socket) {
+	uint32_t mtu = io_socket_mtu (socket);
 
-static io_encoding_t*
-io_x70_encoding_new (io_byte_memory_t *bm) {
-	io_binary_encoding_t *this = io_byte_memory_allocate (
-		bm,sizeof(io_binary_encoding_t)
-	);
+	if (mtu < IO_SOCKET_MINIMUM_MTU) {
+		mtu = IO_SOCKET_MINIMUM_MTU;
+	}
 
-	if (this != NULL) {
-		extern EVENT_DATA io_encoding_implementation_t io_x70_encoding_implementation;
-		this->implementation = &io_x70_encoding_implementation;
-		this->bm = bm;
-		this = io_binary_encoding_initialise(this);
+	if (mtu > this->chunk_size) {
+		uint8_t *bigger = io_byte_memory_reallocate (this->bm,this->chunk,mtu);
+		if (bigger == NULL) {
+			return false;
+		}
+		this->chunk = bigger;
+		this->chunk_size = mtu;
 	}
 
-	return (io_encoding_t*) this;
-};
+	while (!io_x70_stream_encoder_is_complete (this)) {
+		io_encoding_t *message = io_socket_new_message (socket);
+		uint32_t header_length;
 
-void
-io_x70_encoding_append_uint_value (io_encoding_t *encoding,uint32_t value) {
-	uint8_t flag;
-	io_encoding_append_byte (encoding,X70_UINT_VALUE_BYTE);
-	do {
-		flag = (value > 0x7f);
-		io_encoding_append_byte (encoding,(value & 0x7f) | (flag << 7));
-		value >>= 7;
-	} while (flag);
-}
+		if (message == NULL) {
+			return false;
+		}
 
-int32_t
-io_x70_encoding_take_uint_value (const uint8_t *b,const uint8_t *e,uint32_t *value) {
-	uint8_t byte;
-	int32_t c = 0;
-	
-	*value = 0;
-	do {
-		byte = *b++;
-		c++;
-		*value <<= 7;
-		*value += (byte & 0x7f);
-	} while (byte & 0x80 && b < e);
-	
-	return c;
-}
+		header_length = io_encoding_length (message);
+		if (header_length >= mtu) {
+			unreference_io_encoding (message);
+			this->error = true;
+			return false;
+		}
 
-vref_t
-io_x70_decoder (io_encoding_t *encoding,io_value_memory_t *vm) {
-	io_t *io = io_encoding_get_io (encoding);
-	const uint8_t *b,*e;
-	vref_t r_value = INVALID_VREF;
-	
-	io_encoding_get_content (encoding,&b,&e);
-	
-	while (b < e) {
-		uint32_t u;
-		
-		switch (*b++) {
-			case X70_UINT_VALUE_BYTE:
-				b += io_x70_encoding_take_uint_value (b,e,&u);
-				if (b < e) {
-					io_value_implementation_t const *I;
-					I = io_get_value_implementation (io,(const char*) b,u);
-					b += u;
-					if (I) {
-						vref_t r_part = I->decode[IO_VALUE_ENCODING_FORMAT_X70] (vm,&b,e);
-						if (vref_is_valid(r_part)) {
-							r_value = r_part;
-						}
-					}
-				}
-			break;
+		if (this->chunk_length == 0) {
+			this->chunk_length = io_x70_stream_encoder_read (
+				this,this->chunk,mtu - header_length
+			);
+			if (this->chunk_length == 0) {
+				unreference_io_encoding (message);
+				continue;
+			}
+		}
+
+		io_encoding_append_bytes (message,this->chunk,this->chunk_length);
+		if (io_socket_send_message (socket,message)) {
+			this->chunk_length = 0;
+		} else {
+			return false;
 		}
-		
-		b++;
 	}
-	
-	return r_value;
-}
 
-EVENT_DATA io_encoding_implementation_t io_x70_encoding_implementation = {
-	SPECIALISE_IO_BINARY_ENCODING_IMPLEMENTATION (
-		&io_binary_encoding_implementation
-	)
-	.make_encoding = io_x70_encoding_new,
-	.free = io_binary_encoding_free,
-};
+	return !this->error;
+}
 
 void
 io_binary_encoding_free_memory (io_binary_encoding_t *this) {
@@ -27,11 +27,20 @@ void null_io_event_handler (io_event_t*);
 
 extern EVENT_DATA io_event_implementation_t io_event_implementation;
 
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+# define IO_EVENT_TIMESTAMP_STRUCT_MEMBERS \
+	io_time_t enqueued;\
+	/**/
+#else
+# define IO_EVENT_TIMESTAMP_STRUCT_MEMBERS
+#endif
+
 #define IO_EVENT_STRUCT_MEMBERS \
 	io_event_implementation_t const * implementation; \
 	void (*event_handler) (io_event_t*);\
 	void *user_value;\
 	io_event_t *next_event;\
+	IO_EVENT_TIMESTAMP_STRUCT_MEMBERS \
 	/**/
 
 struct PACK_STRUCTURE io_event {
@@ -144,6 +153,113 @@ io_event_list_first_match_exception (io_event_list_t *this) {
 	);
 }
 
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+//
+// event loop instrumentation
+//
+// Times are recorded in nanosecond histograms of fixed size, each power
+// of two is split into four buckets so a recorded time is within 25%
+// of its true value (HDR style with two significant bits).
+//
+#ifndef IO_EVENT_HISTOGRAM_BUCKETS
+# define IO_EVENT_HISTOGRAM_BUCKETS				128
+#endif
+#ifndef IO_EVENT_INSTRUMENTATION_HANDLERS
+# define IO_EVENT_INSTRUMENTATION_HANDLERS		8
+#endif
+
+typedef struct io_event_histogram {
+	uint32_t count;
+	int64_t total;
+	int64_t maximum;
+	uint32_t bucket[IO_EVENT_HISTOGRAM_BUCKETS];
+} io_event_histogram_t;
+
+typedef struct io_event_handler_statistics {
+	io_event_handler_t handler;
+	io_event_histogram_t run_time;
+} io_event_handler_statistics_t;
+
+struct io_event_instrumentation {
+	io_event_histogram_t wait_time;
+	io_event_histogram_t critical_section_time;
+	io_event_handler_statistics_t handlers[IO_EVENT_INSTRUMENTATION_HANDLERS];
+	uint32_t untracked_dispatches;
+	uint32_t queue_depth;
+	uint32_t maximum_queue_depth;
+};
+
+void	initialise_io_event_instrumentation (io_event_instrumentation_t*);
+void	io_attach_event_instrumentation (io_t*,io_event_instrumentation_t*);
+void	io_event_histogram_record (io_event_histogram_t*,int64_t);
+int64_t	io_event_histogram_percentile (io_event_histogram_t const*,uint32_t);
+io_event_handler_statistics_t const*	io_event_instrumentation_handler (io_event_instrumentation_t const*,io_event_handler_t);
+void	io_print_event_instrumentation (io_t*);
+
+#define io_event_histogram_count(h)		(h)->count
+#define io_event_histogram_maximum(h)		(h)->maximum
+#define io_event_histogram_mean(h)			((h)->count ? (h)->total / (h)->count : 0)
+
+INLINE_FUNCTION io_time_t
+io_instrument_critical_section_enter (io_t *io,bool h) {
+	if (!h && io->instrumentation != NULL) {
+		return io_get_time (io);
+	} else {
+		return time_zero();
+	}
+}
+
+//
+// sleeping inside a critical section is idle time, not hold time, so
+// the begin time moves forward by the time spent asleep
+//
+INLINE_FUNCTION io_time_t
+io_instrument_critical_section_sleep (io_t *io,bool h,io_time_t begin) {
+	if (!h && io->instrumentation != NULL) {
+		int64_t held = io_get_time (io).ns - begin.ns;
+		io_sleep (io);
+		return (io_time_t) {io_get_time (io).ns - held};
+	} else {
+		io_sleep (io);
+		return begin;
+	}
+}
+
+INLINE_FUNCTION void
+io_instrument_critical_section_exit (io_t *io,bool h,io_time_t begin) {
+	if (!h && io->instrumentation != NULL) {
+		io_event_histogram_record (
+			&io->instrumentation->critical_section_time,
+			io_get_time (io).ns - begin.ns
+		);
+	}
+}
+
+INLINE_FUNCTION void
+io_instrument_event_enqueued (io_t *io,io_event_t *ev) {
+	io_event_instrumentation_t *this = io->instrumentation;
+	if (this != NULL) {
+		ev->enqueued = io_get_time (io);
+		if (++this->queue_depth > this->maximum_queue_depth) {
+			this->maximum_queue_depth = this->queue_depth;
+		}
+	}
+}
+
+INLINE_FUNCTION void
+io_instrument_event_removed (io_t *io) {
+	if (io->instrumentation != NULL && io->instrumentation->queue_depth > 0) {
+		io->instrumentation->queue_depth --;
+	}
+}
+
+# define IO_EVENT_INSTRUMENT_ENQUEUED(io,ev)		io_instrument_event_enqueued (io,ev);
+# define IO_EVENT_INSTRUMENT_REMOVED(io)			io_instrument_event_removed (io);
+#else
+# define IO_EVENT_INSTRUMENT_ENQUEUED(io,ev)
+# define IO_EVENT_INSTRUMENT_REMOVED(io)
+#endif /* WITH_IO_EVENT_INSTRUMENTATION */
+
 #ifdef IMPLEMENT_IO_CORE
 //-----------------------------------------------------------------------------
 //
@@ -350,12 +466,177 @@ io_event_list_remove (io_event_list_t *this,io_event_t *ev) {
 }
 
 
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+//
+// event loop instrumentation
+//
+void
+initialise_io_event_instrumentation (io_event_instrumentation_t *this) {
+	memset (this,0,sizeof(io_event_instrumentation_t));
+}
+
+//
+// attach while the event queue is empty, the pointer is set outside a
+// critical section so the attach is not itself sampled
+//
+void
+io_attach_event_instrumentation (io_t *io,io_event_instrumentation_t *this) {
+	io->instrumentation = this;
+}
+
+//
+// values below four have their own bucket, after that the bucket is the
+// most significant bit and the two bits below it
+//
+static uint32_t
+io_event_histogram_bucket (int64_t value) {
+	uint32_t b;
+	if (value < 4) {
+		b = (value < 0) ? 0 : (uint32_t) value;
+	} else {
+		uint32_t msb = 63 - __builtin_clzll ((uint64_t) value);
+		b = ((msb - 1) << 2) + ((value >> (msb - 2)) & 3);
+	}
+	return (b < IO_EVENT_HISTOGRAM_BUCKETS) ? b : IO_EVENT_HISTOGRAM_BUCKETS - 1;
+}
+
+static int64_t
+io_event_histogram_bucket_value (uint32_t b) {
+	if (b < 4) {
+		return b;
+	} else {
+		uint32_t msb = (b >> 2) + 1;
+		return (int64_t) (4 + (b & 3)) << (msb - 2);
+	}
+}
+
+void
+io_event_histogram_record (io_event_histogram_t *this,int64_t value) {
+	this->bucket[io_event_histogram_bucket (value)] ++;
+	this->count ++;
+	this->total += value;
+	if (value > this->maximum) {
+		this->maximum = value;
+	}
+}
+
+//
+// the lower bound of the bucket holding the given percentile, the
+// maximum is exact
+//
+int64_t
+io_event_histogram_percentile (io_event_histogram_t const *this,uint32_t percent) {
+	if (this->count > 0) {
+		uint64_t rank = ((uint64_t) this->count * percent + 99) / 100;
+		uint64_t seen = 0;
+		if (percent >= 100) {
+			return this->maximum;
+		}
+		for (uint32_t b = 0; b < IO_EVENT_HISTOGRAM_BUCKETS; b++) {
+			seen += this->bucket[b];
+			if (seen >= rank && seen > 0) {
+				return io_event_histogram_bucket_value (b);
+			}
+		}
+		return this->maximum;
+	} else {
+		return 0;
+	}
+}
+
+io_event_handler_statistics_t const*
+io_event_instrumentation_handler (
+	io_event_instrumentation_t const *this,io_event_handler_t handler
+) {
+	for (uint32_t i = 0; i < IO_EVENT_INSTRUMENTATION_HANDLERS; i++) {
+		if (this->handlers[i].handler == handler) {
+			return this->handlers + i;
+		}
+	}
+	return NULL;
+}
+
+static io_event_handler_statistics_t*
+io_event_instrumentation_claim_handler (
+	io_event_instrumentation_t *this,io_event_handler_t handler
+) {
+	for (uint32_t i = 0; i < IO_EVENT_INSTRUMENTATION_HANDLERS; i++) {
+		if (this->handlers[i].handler == handler) {
+			return this->handlers + i;
+		}
+		if (this->handlers[i].handler == NULL) {
+			this->handlers[i].handler = handler;
+			return this->handlers + i;
+		}
+	}
+	return NULL;
+}
+
+static void
+io_dispatch_instrumented_io_event (io_t *io,io_event_t *ev) {
+	io_event_instrumentation_t *this = io->instrumentation;
+	io_event_handler_t handler = ev->event_handler;
+	io_event_handler_statistics_t *stats;
+	io_time_t begin = io_get_time (io);
+
+	io_event_histogram_record (&this->wait_time,begin.ns - ev->enqueued.ns);
+
+	handler (ev);
+
+	stats = io_event_instrumentation_claim_handler (this,handler);
+	if (stats != NULL) {
+		io_event_histogram_record (&stats->run_time,io_get_time (io).ns - begin.ns);
+	} else {
+		this->untracked_dispatches ++;
+	}
+}
+
+static void
+io_print_event_histogram (io_t *io,char const *name,io_event_histogram_t const *h) {
+	io_printf (
+		io,"%-*s%-*s%u, mean %lld, p50 %lld, p99 %lld, max %lld ns\n",
+		DBP_FIELD1,"",
+		DBP_FIELD2,name,
+		io_event_histogram_count (h),
+		io_event_histogram_mean (h),
+		io_event_histogram_percentile (h,50),
+		io_event_histogram_percentile (h,99),
+		io_event_histogram_maximum (h)
+	);
+}
+
+void
+io_print_event_instrumentation (io_t *io) {
+	io_event_instrumentation_t const *this = io->instrumentation;
+	if (this != NULL) {
+		io_printf (
+			io,"%-*s%-*sdepth %u, max depth %u, untracked %u\n",
+			DBP_FIELD1,"events",
+			DBP_FIELD2,"queue",
+			this->queue_depth,
+			this->maximum_queue_depth,
+			this->untracked_dispatches
+		);
+		io_print_event_histogram (io,"wait",&this->wait_time);
+		io_print_event_histogram (io,"critical",&this->critical_section_time);
+		for (uint32_t i = 0; i < IO_EVENT_INSTRUMENTATION_HANDLERS; i++) {
+			io_event_handler_statistics_t const *stats = this->handlers + i;
+			if (stats->handler != NULL) {
+				io_printf (io,"%-*s%p\n",DBP_FIELD1,"handler",(void*) stats->handler);
+				io_print_event_histogram (io,"run",&stats->run_time);
+			}
+		}
+	}
+}
+#endif /* WITH_IO_EVENT_INSTRUMENTATION */
+
 void
 enqueue_io_event (io_t *io,io_event_t *ev) {
 	ENTER_CRITICAL_SECTION(io);
 	if (ev->next_event == NULL) {
 		ev->next_event = io->events;
 		io->events = ev;
+		IO_EVENT_INSTRUMENT_ENQUEUED(io,ev)
 	}
 	EXIT_CRITICAL_SECTION(io);
 	signal_io_event_pending (io);
@@ -373,11 +654,13 @@ dequeue_io_event (io_t *io,io_event_t *old) {
 	) {
 		if (*list == old) {
 			*list = old->next_event;
+			IO_EVENT_INSTRUMENT_REMOVED(io)
 		} else {
 			io_event_t *ev = *list;
 			while (ev->next_event != &s_null_io_event) {
 				if (ev->next_event == old) {
 					ev->next_event = old->next_event;
+					IO_EVENT_INSTRUMENT_REMOVED(io)
 					break;
 				}
 				ev = ev->next_event;
@@ -398,6 +681,7 @@ do_next_io_event (io_t *io) {
 
 	ev = *list;
 	if (ev != &s_null_io_event) {
+		IO_EVENT_INSTRUMENT_REMOVED(io)
 		if (ev->next_event != &s_null_io_event) {
 			io_event_t *last;
 			while(ev->next_event->next_event != &s_null_io_event) {
@@ -415,6 +699,13 @@ do_next_io_event (io_t *io) {
 
 	EXIT_CRITICAL_SECTION(io);
 
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+	if (io->instrumentation != NULL && ev != &s_null_io_event) {
+		io_dispatch_instrumented_io_event (io,ev);
+		return r;
+	}
+#endif
+
 	ev->event_handler(ev);
 
 	return r;
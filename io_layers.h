@@ -22,6 +22,9 @@
 #define IO_X70_LAYER_ID			def_io_layer_registered_address('X','7','0')
 #define IO_MTU_LAYER_ID			def_io_layer_registered_address('M','T','U')
 #define IO_BEACON_LAYER_ID		def_io_layer_registered_address('N','I','M')
+#define IO_FRAGMENT_LAYER_ID	def_io_layer_registered_address('F','R','G')
+#define IO_AGGREGATE_LAYER_ID	def_io_layer_registered_address('A','G','G')
+#define IO_RELIABLE_LAYER_ID	def_io_layer_registered_address('R','E','L')
 
 #define NRF_RADIO_LAYER_ID		def_io_layer_registered_address('P','0','1')
 
@@ -178,6 +181,7 @@ io_inner_binding_t* virtual_io_layer_select_inner_binding (io_layer_t*,io_encodi
 	io_layer_t **layers; \
 	io_layer_t **end_of_layers; \
 	uint32_t decode_cursor; \
+	uint32_t views; \
 	/**/
 	
 struct PACK_STRUCTURE io_packet_encoding {
@@ -219,6 +223,33 @@ cast_to_io_packet_encoding (io_encoding_t *encoding) {
 	}
 }
 
+//
+// packet view encoding: a read-only packet encoding over the bytes of
+// another packet encoding so that one message can be received by many
+// sockets without copying, the source is referenced until the view is
+// freed and is read only while it has views so that its bytes cannot
+// move or change under them
+//
+#define IO_PACKET_VIEW_ENCODING_STRUCT_MEMBERS \
+	IO_PACKET_ENCODING_STRUCT_MEMBERS \
+	io_encoding_t *source; \
+	/**/
+
+typedef struct PACK_STRUCTURE io_packet_view_encoding {
+	IO_PACKET_VIEW_ENCODING_STRUCT_MEMBERS
+} io_packet_view_encoding_t;
+
+io_encoding_t* mk_io_packet_view_encoding (io_encoding_t*);
+
+extern EVENT_DATA io_encoding_implementation_t io_packet_view_encoding_implementation;
+
+INLINE_FUNCTION bool
+is_io_packet_view_encoding (io_encoding_t const *encoding) {
+	return io_encoding_has_implementation (
+		encoding,&io_packet_view_encoding_implementation
+	);
+}
+
 //
 // layers
 //
@@ -231,6 +262,62 @@ io_layer_t* push_io_link_transmit_layer (io_encoding_t*);
 io_layer_t* push_io_link_receive_layer (io_encoding_t*);
 io_layer_t* get_io_link_layer (io_encoding_t*);
 
+//
+// A link header template holds the encoded addresses of a link frame.
+// Frames between the same addresses, such as the frames of one inner
+// binding, are loaded with a copy of the template which is re-encoded
+// only when the addresses change.
+//
+#define IO_A4_LINK_FRAME_BUFFER_LIMIT	16
+
+typedef struct PACK_STRUCTURE io_link_header_template {
+	io_address_t source_address;
+	io_address_t destination_address;
+	io_address_t inner_address;
+	uint8_t address_buffer[IO_A4_LINK_FRAME_BUFFER_LIMIT];
+} io_link_header_template_t;
+
+void initialise_io_link_header_template (io_link_header_template_t*);
+void free_io_link_header_template (io_byte_memory_t*,io_link_header_template_t*);
+bool io_link_layer_load_header_from_template (io_layer_t*,io_encoding_t*,io_link_header_template_t*);
+
+io_layer_t* push_io_fragment_transmit_layer (io_encoding_t*);
+io_layer_t* push_io_fragment_receive_layer (io_encoding_t*);
+io_layer_t* get_io_fragment_layer (io_encoding_t*);
+
+//
+// the content of an aggregate frame is a sequence of records, each
+// record is a two byte length followed by that many bytes
+//
+#define IO_AGGREGATE_RECORD_HEADER_SIZE	2
+#define IO_AGGREGATE_RECORD_LIMIT			0xffff
+
+io_layer_t* push_io_aggregate_transmit_layer (io_encoding_t*);
+io_layer_t* push_io_aggregate_receive_layer (io_encoding_t*);
+io_layer_t* get_io_aggregate_layer (io_encoding_t*);
+bool io_aggregate_layer_append_record (io_layer_t*,io_encoding_t*,uint8_t const*,uint32_t);
+uint32_t io_aggregate_layer_record_count (io_layer_t*,io_encoding_t*);
+uint8_t const* io_aggregate_next_record (uint8_t const*,uint8_t const*,uint8_t const**,uint32_t*);
+
+//
+// the reliable layer carries a sequence number, the cumulative
+// acknowledgement, the receive window and up to IO_RELIABLE_SACK_LIMIT
+// selective acknowledgement blocks of sequence numbers [begin,end)
+//
+#define IO_RELIABLE_SACK_LIMIT		3
+#define IO_RELIABLE_DATA				0x01
+#define IO_RELIABLE_ACK					0x02
+
+typedef struct PACK_STRUCTURE io_reliable_sack_block {
+	uint32_t begin;
+	uint32_t end;
+} io_reliable_sack_block_t;
+
+io_layer_t* push_io_reliable_transmit_layer (io_encoding_t*);
+io_layer_t* push_io_reliable_receive_layer (io_encoding_t*);
+io_layer_t* get_io_reliable_layer (io_encoding_t*);
+
+
 
 #ifdef IMPLEMENT_IO_CORE
 //-----------------------------------------------------------------------------
@@ -338,6 +425,7 @@ initialise_io_packet_encoding (io_packet_encoding_t *this) {
 		this->layers = NULL;
 		this->end_of_layers = NULL;
 		this->decode_cursor = 0;
+		this->views = 0;
 	}
 	return this;
 }
@@ -474,6 +562,99 @@ EVENT_DATA io_encoding_layer_api_t io_packet_layer_api = {
 	.push_layer = io_packet_encoding_push_layer,
 };
 
+//
+// packet view encoding
+//
+io_encoding_t*
+mk_io_packet_view_encoding (io_encoding_t *source) {
+	io_packet_encoding_t *src = cast_to_io_packet_encoding (source);
+	io_packet_view_encoding_t *this = NULL;
+
+	if (src != NULL) {
+		this = io_byte_memory_allocate (src->bm,sizeof(io_packet_view_encoding_t));
+		if (this != NULL) {
+			this->implementation = &io_packet_view_encoding_implementation;
+			this->tag.all = 0;
+			this->bm = src->bm;
+			this->byte_stream = src->byte_stream;
+			this->cursor = src->cursor;
+			this->end = src->cursor;
+			this->layers = NULL;
+			this->end_of_layers = NULL;
+			this->decode_cursor = 0;
+			this->views = 0;
+			this->source = reference_io_encoding (source);
+			src->views ++;
+			io_encoding_set_read_only (source);
+			io_encoding_set_read_only ((io_encoding_t*) this);
+		}
+	}
+
+	return (io_encoding_t*) this;
+}
+
+//
+// a view is always read only, any other source becomes writable again
+// when its last view is freed
+//
+static void
+release_io_packet_view_source (io_encoding_t *source) {
+	io_packet_encoding_t *src = (io_packet_encoding_t*) source;
+	if (
+			--src->views == 0
+		&&	!is_io_packet_view_encoding (source)
+	) {
+		io_encoding_clear_read_only (source);
+	}
+	unreference_io_encoding (source);
+}
+
+static void
+io_packet_view_encoding_free (io_encoding_t *encoding) {
+	io_packet_view_encoding_t *this = (io_packet_view_encoding_t*) encoding;
+	io_layer_t **cursor = this->layers;
+	while (cursor < this->end_of_layers) {
+		free_io_layer (*cursor++,this->bm);
+	}
+	io_byte_memory_free (this->bm,this->layers);
+	release_io_packet_view_source (this->source);
+	io_byte_memory_free (this->bm,this);
+}
+
+static bool
+io_packet_view_encoding_grow (io_encoding_t *encoding,uint32_t increase) {
+	return false;
+}
+
+static size_t
+io_packet_view_encoding_fill (io_encoding_t *encoding,uint8_t byte,size_t size) {
+	return 0;
+}
+
+static bool
+io_packet_view_encoding_pop_last_byte (io_encoding_t *encoding,uint8_t *byte) {
+	return false;
+}
+
+static void
+io_packet_view_encoding_reset (io_encoding_t *encoding) {
+}
+
+//
+// a copy of a view is an ordinary packet encoding
+//
+EVENT_DATA io_encoding_implementation_t io_packet_view_encoding_implementation = {
+	SPECIALISE_IO_PACKET_ENCODING_IMPLEMENTATION (
+		&io_packet_encoding_implementation
+	)
+	.limit = io_packet_encoding_default_limit,
+	.free = io_packet_view_encoding_free,
+	.grow = io_packet_view_encoding_grow,
+	.fill = io_packet_view_encoding_fill,
+	.pop_last_byte = io_packet_view_encoding_pop_last_byte,
+	.reset = io_packet_view_encoding_reset,
+};
+
 //
 // io binary layer
 //
@@ -666,6 +847,10 @@ get_io_binary_layer (io_encoding_t *encoding) {
 //
 // link layer
 //
+// the addresses of a received frame are read in place as address views
+// of the frame bytes
+//
+
 typedef struct PACK_STRUCTURE io_link_layer {
 	IO_LAYER_STRUCT_PROPERTIES
 	io_address_t source_address;
@@ -673,8 +858,6 @@ typedef struct PACK_STRUCTURE io_link_layer {
 	io_address_t inner_address;
 } io_link_layer_t;
 
-#define IO_A4_LINK_FRAME_BUFFER_LIMIT	16
-
 typedef struct PACK_STRUCTURE io_a4_link_frame {
 	uint8_t length[4];
 	//
@@ -723,21 +906,18 @@ mk_io_link_receive_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
 			packet,sizeof(io_a4_link_frame_t)
 		);
 		io_a4_link_frame_t *frame = io_layer_get_byte_stream ((io_layer_t*) this,packet);
-		io_address_t address;
-		uint8_t *read_cursor = frame->address_buffer;
-		uint8_t *end_of_buffer = read_cursor + IO_A4_LINK_FRAME_BUFFER_LIMIT;
-	
-		address = io_invalid_address();
-		read_cursor += read_le_io_address (bm,read_cursor,end_of_buffer - read_cursor,&address);
-		io_layer_set_source_address ((io_layer_t*) this,packet,address);
-
-		address = io_invalid_address();
-		read_cursor += read_le_io_address (bm,read_cursor,end_of_buffer - read_cursor,&address);
-		io_layer_set_destination_address ((io_layer_t*) this,packet,address);
+		uint8_t const *read_cursor = frame->address_buffer;
+		uint8_t const *end_of_buffer = read_cursor + IO_A4_LINK_FRAME_BUFFER_LIMIT;
 
-		address = io_invalid_address();
-		read_cursor += read_le_io_address (bm,read_cursor,end_of_buffer - read_cursor,&address);
-		io_layer_set_inner_address ((io_layer_t*) this,packet,address);
+		read_cursor += read_le_io_address_view (
+			read_cursor,end_of_buffer - read_cursor,&this->source_address
+		);
+		read_cursor += read_le_io_address_view (
+			read_cursor,end_of_buffer - read_cursor,&this->destination_address
+		);
+		read_cursor += read_le_io_address_view (
+			read_cursor,end_of_buffer - read_cursor,&this->inner_address
+		);
 	}
 	
 	return (io_layer_t*) this;
@@ -763,7 +943,7 @@ io_link_layer_get_content (
 ) {
 	io_a4_link_frame_t *frame = io_layer_get_byte_stream (layer,encoding);
 	*begin = frame->content;
-	*end = frame->content + io_layer_get_length (layer,encoding);
+	*end = frame->content + io_layer_get_length (layer,encoding) - sizeof(io_a4_link_frame_t);
 }
 
 static bool
@@ -869,6 +1049,79 @@ io_link_layer_load_header (io_layer_t *layer,io_encoding_t *encoding) {
 	return true;
 }
 
+void
+initialise_io_link_header_template (io_link_header_template_t *this) {
+	this->source_address = io_invalid_address();
+	this->destination_address = io_invalid_address();
+	this->inner_address = io_invalid_address();
+	memset (this->address_buffer,0,IO_A4_LINK_FRAME_BUFFER_LIMIT);
+}
+
+void
+free_io_link_header_template (io_byte_memory_t *bm,io_link_header_template_t *this) {
+	free_io_address (bm,this->source_address);
+	free_io_address (bm,this->destination_address);
+	free_io_address (bm,this->inner_address);
+	initialise_io_link_header_template (this);
+}
+
+//
+// equal addresses of different sizes have different encodings
+//
+static bool
+io_link_header_template_has_address (io_address_t a,io_address_t b) {
+	return (
+			io_address_size (a) == io_address_size (b)
+		&&	compare_io_addresses (a,b) == 0
+	);
+}
+
+//
+// load the header of a link layer, the template is encoded again
+// if its addresses are not the layer's addresses
+//
+bool
+io_link_layer_load_header_from_template (
+	io_layer_t *layer,io_encoding_t *encoding,io_link_header_template_t *template
+) {
+	io_link_layer_t *this = (io_link_layer_t *) layer;
+	io_a4_link_frame_t *packet = io_layer_get_byte_stream (layer,encoding);
+
+	if (
+			!io_link_header_template_has_address (this->source_address,template->source_address)
+		||	!io_link_header_template_has_address (this->destination_address,template->destination_address)
+		||	!io_link_header_template_has_address (this->inner_address,template->inner_address)
+	) {
+		io_packet_encoding_t *p = cast_to_io_packet_encoding (encoding);
+		uint8_t *write_cursor = template->address_buffer;
+		uint8_t *end_of_buffer = write_cursor + IO_A4_LINK_FRAME_BUFFER_LIMIT;
+
+		if (p == NULL) {
+			return false;
+		}
+
+		assign_io_address (p->bm,&template->source_address,this->source_address);
+		assign_io_address (p->bm,&template->destination_address,this->destination_address);
+		assign_io_address (p->bm,&template->inner_address,this->inner_address);
+
+		memset (template->address_buffer,0,IO_A4_LINK_FRAME_BUFFER_LIMIT);
+		write_cursor += write_le_io_address (
+			write_cursor,end_of_buffer - write_cursor,this->source_address
+		);
+		write_cursor += write_le_io_address (
+			write_cursor,end_of_buffer - write_cursor,this->destination_address
+		);
+		write_cursor += write_le_io_address (
+			write_cursor,end_of_buffer - write_cursor,this->inner_address
+		);
+	}
+
+	write_le_uint32 (packet->length,io_layer_get_length (layer,encoding));
+	memcpy (packet->address_buffer,template->address_buffer,IO_A4_LINK_FRAME_BUFFER_LIMIT);
+
+	return true;
+}
+
 EVENT_DATA io_layer_implementation_t io_link_layer_implementation = {
 	SPECIALISE_IO_LAYER_IMPLEMENTATION (&io_layer_implementation)\
 	.free = free_io_link_layer,
@@ -901,6 +1154,440 @@ get_io_link_layer (io_encoding_t *encoding) {
 	return io_encoding_get_layer (encoding,&io_link_layer_implementation);
 }
 
+//
+// fragment layer
+//
+typedef struct PACK_STRUCTURE io_fragment_layer {
+	IO_LAYER_STRUCT_PROPERTIES
+	uint16_t id;
+	uint16_t index;
+	uint16_t count;
+	uint32_t offset;
+	uint32_t length;
+} io_fragment_layer_t;
+
+typedef struct PACK_STRUCTURE io_fragment_frame {
+	uint8_t id[2];
+	uint8_t index[2];
+	uint8_t count[2];
+	uint8_t offset[4];
+	uint8_t length[4];
+	uint8_t content[];
+} io_fragment_frame_t;
+
+static io_fragment_layer_t*
+mk_io_fragment_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	extern EVENT_DATA io_layer_implementation_t io_fragment_layer_implementation;
+	io_fragment_layer_t *this = io_byte_memory_allocate (bm,sizeof(io_fragment_layer_t));
+
+	if (this) {
+		this->implementation = &io_fragment_layer_implementation;
+		this->id = 0;
+		this->index = 0;
+		this->count = 0;
+		this->offset = 0;
+		this->length = 0;
+	}
+	
+	return this;
+}
+
+static io_layer_t*
+mk_io_fragment_transmit_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	io_fragment_layer_t *this = mk_io_fragment_layer (bm,packet);
+
+	if (this) {
+		this->layer_offset_in_byte_stream = io_encoding_length (packet);
+		io_encoding_fill (packet,0,sizeof(io_fragment_frame_t));
+	}
+	
+	return (io_layer_t*) this;
+}
+
+//
+// a frame that is too short to hold a header is read as zero fragments
+//
+static io_layer_t*
+mk_io_fragment_receive_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	io_fragment_layer_t *this = mk_io_fragment_layer (bm,packet);
+
+	if (this) {
+		this->layer_offset_in_byte_stream = io_encoding_increment_decode_offest (
+			packet,sizeof(io_fragment_frame_t)
+		);
+		if (
+				io_encoding_length (packet)
+			>=	this->layer_offset_in_byte_stream + sizeof(io_fragment_frame_t)
+		) {
+			io_fragment_frame_t *frame = io_layer_get_byte_stream ((io_layer_t*) this,packet);
+			this->id = read_le_uint16 (frame->id);
+			this->index = read_le_uint16 (frame->index);
+			this->count = read_le_uint16 (frame->count);
+			this->offset = read_le_uint32 (frame->offset);
+			this->length = read_le_uint32 (frame->length);
+		}
+	}
+	
+	return (io_layer_t*) this;
+}
+
+static void
+free_io_fragment_layer (io_layer_t *layer,io_byte_memory_t *bm) {
+	io_byte_memory_free (bm,layer);
+}
+
+static void
+io_fragment_layer_get_content (
+	io_layer_t *layer,io_encoding_t *encoding,uint8_t const **begin,uint8_t const **end
+) {
+	if (
+			io_encoding_length (encoding)
+		>=	layer->layer_offset_in_byte_stream + sizeof(io_fragment_frame_t)
+	) {
+		io_fragment_frame_t *frame = io_layer_get_byte_stream (layer,encoding);
+		*begin = frame->content;
+		*end = frame->content + io_layer_get_length (layer,encoding) - sizeof(io_fragment_frame_t);
+	} else {
+		*begin = *end = NULL;
+	}
+}
+
+static bool
+io_fragment_layer_load_header (io_layer_t *layer,io_encoding_t *encoding) {
+	io_fragment_layer_t *this = (io_fragment_layer_t *) layer;
+	io_fragment_frame_t *frame = io_layer_get_byte_stream (layer,encoding);
+	write_le_uint16 (frame->id,this->id);
+	write_le_uint16 (frame->index,this->index);
+	write_le_uint16 (frame->count,this->count);
+	write_le_uint32 (frame->offset,this->offset);
+	write_le_uint32 (frame->length,this->length);
+	return true;
+}
+
+EVENT_DATA io_layer_implementation_t io_fragment_layer_implementation = {
+	SPECIALISE_IO_LAYER_IMPLEMENTATION (&io_layer_implementation)
+	.free = free_io_fragment_layer,
+	.get_content = io_fragment_layer_get_content,
+	.load_header = io_fragment_layer_load_header,
+};
+
+io_layer_t*
+push_io_fragment_transmit_layer (io_encoding_t *encoding) {
+	return io_encoding_push_layer (encoding,mk_io_fragment_transmit_layer);
+}
+
+io_layer_t*
+push_io_fragment_receive_layer (io_encoding_t *encoding) {
+	return io_encoding_push_layer (encoding,mk_io_fragment_receive_layer);
+}
+
+io_layer_t*
+get_io_fragment_layer (io_encoding_t *encoding) {
+	return io_encoding_get_layer (encoding,&io_fragment_layer_implementation);
+}
+
+//
+// aggregate layer
+//
+typedef struct PACK_STRUCTURE io_aggregate_layer {
+	IO_LAYER_STRUCT_PROPERTIES
+	uint16_t count;
+} io_aggregate_layer_t;
+
+typedef struct PACK_STRUCTURE io_aggregate_frame {
+	uint8_t count[2];
+	uint8_t content[];
+} io_aggregate_frame_t;
+
+static io_aggregate_layer_t*
+mk_io_aggregate_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	extern EVENT_DATA io_layer_implementation_t io_aggregate_layer_implementation;
+	io_aggregate_layer_t *this = io_byte_memory_allocate (bm,sizeof(io_aggregate_layer_t));
+
+	if (this) {
+		this->implementation = &io_aggregate_layer_implementation;
+		this->count = 0;
+	}
+	
+	return this;
+}
+
+static io_layer_t*
+mk_io_aggregate_transmit_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	io_aggregate_layer_t *this = mk_io_aggregate_layer (bm,packet);
+
+	if (this) {
+		this->layer_offset_in_byte_stream = io_encoding_length (packet);
+		io_encoding_fill (packet,0,sizeof(io_aggregate_frame_t));
+	}
+	
+	return (io_layer_t*) this;
+}
+
+static io_layer_t*
+mk_io_aggregate_receive_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	io_aggregate_layer_t *this = mk_io_aggregate_layer (bm,packet);
+
+	if (this) {
+		this->layer_offset_in_byte_stream = io_encoding_increment_decode_offest (
+			packet,sizeof(io_aggregate_frame_t)
+		);
+		if (
+				io_encoding_length (packet)
+			>=	this->layer_offset_in_byte_stream + sizeof(io_aggregate_frame_t)
+		) {
+			io_aggregate_frame_t *frame = io_layer_get_byte_stream ((io_layer_t*) this,packet);
+			this->count = read_le_uint16 (frame->count);
+		}
+	}
+	
+	return (io_layer_t*) this;
+}
+
+static void
+free_io_aggregate_layer (io_layer_t *layer,io_byte_memory_t *bm) {
+	io_byte_memory_free (bm,layer);
+}
+
+static void
+io_aggregate_layer_get_content (
+	io_layer_t *layer,io_encoding_t *encoding,uint8_t const **begin,uint8_t const **end
+) {
+	if (
+			io_encoding_length (encoding)
+		>=	layer->layer_offset_in_byte_stream + sizeof(io_aggregate_frame_t)
+	) {
+		io_aggregate_frame_t *frame = io_layer_get_byte_stream (layer,encoding);
+		*begin = frame->content;
+		*end = frame->content + io_layer_get_length (layer,encoding) - sizeof(io_aggregate_frame_t);
+	} else {
+		*begin = *end = NULL;
+	}
+}
+
+static bool
+io_aggregate_layer_load_header (io_layer_t *layer,io_encoding_t *encoding) {
+	io_aggregate_layer_t *this = (io_aggregate_layer_t *) layer;
+	io_aggregate_frame_t *frame = io_layer_get_byte_stream (layer,encoding);
+	write_le_uint16 (frame->count,this->count);
+	return true;
+}
+
+EVENT_DATA io_layer_implementation_t io_aggregate_layer_implementation = {
+	SPECIALISE_IO_LAYER_IMPLEMENTATION (&io_layer_implementation)
+	.free = free_io_aggregate_layer,
+	.get_content = io_aggregate_layer_get_content,
+	.load_header = io_aggregate_layer_load_header,
+};
+
+io_layer_t*
+push_io_aggregate_transmit_layer (io_encoding_t *encoding) {
+	return io_encoding_push_layer (encoding,mk_io_aggregate_transmit_layer);
+}
+
+io_layer_t*
+push_io_aggregate_receive_layer (io_encoding_t *encoding) {
+	return io_encoding_push_layer (encoding,mk_io_aggregate_receive_layer);
+}
+
+io_layer_t*
+get_io_aggregate_layer (io_encoding_t *encoding) {
+	return io_encoding_get_layer (encoding,&io_aggregate_layer_implementation);
+}
+
+//
+// append a record to the end of the encoding, the aggregate layer
+// must be the innermost layer of the encoding
+//
+bool
+io_aggregate_layer_append_record (
+	io_layer_t *layer,io_encoding_t *encoding,uint8_t const *bytes,uint32_t size
+) {
+	io_aggregate_layer_t *this = (io_aggregate_layer_t *) layer;
+	uint8_t header[IO_AGGREGATE_RECORD_HEADER_SIZE];
+
+	if (size > IO_AGGREGATE_RECORD_LIMIT || this->count == 0xffff) {
+		return false;
+	}
+
+	write_le_uint16 (header,size);
+	io_encoding_append_bytes (encoding,header,sizeof(header));
+	io_encoding_append_bytes (encoding,bytes,size);
+	this->count ++;
+
+	return true;
+}
+
+uint32_t
+io_aggregate_layer_record_count (io_layer_t *layer,io_encoding_t *encoding) {
+	return ((io_aggregate_layer_t *) layer)->count;
+}
+
+//
+// Step over the record at cursor.  Returns the cursor of the following
+// record or NULL when there are no more complete records.
+//
+uint8_t const*
+io_aggregate_next_record (
+	uint8_t const *cursor,uint8_t const *end,uint8_t const **record,uint32_t *size
+) {
+	if (cursor != NULL && (end - cursor) >= IO_AGGREGATE_RECORD_HEADER_SIZE) {
+		uint32_t length = read_le_uint16 (cursor);
+		cursor += IO_AGGREGATE_RECORD_HEADER_SIZE;
+		if ((end - cursor) >= length) {
+			*record = cursor;
+			*size = length;
+			return cursor + length;
+		}
+	}
+	return NULL;
+}
+
+//
+// reliable layer
+//
+typedef struct PACK_STRUCTURE io_reliable_layer {
+	IO_LAYER_STRUCT_PROPERTIES
+	uint8_t flags;
+	uint8_t sack_count;
+	uint16_t window;
+	uint32_t sequence;
+	uint32_t acknowledge;
+	io_reliable_sack_block_t sack[IO_RELIABLE_SACK_LIMIT];
+} io_reliable_layer_t;
+
+typedef struct PACK_STRUCTURE io_reliable_frame {
+	uint8_t flags[1];
+	uint8_t sack_count[1];
+	uint8_t window[2];
+	uint8_t sequence[4];
+	uint8_t acknowledge[4];
+	uint8_t sack[IO_RELIABLE_SACK_LIMIT][8];
+	uint8_t content[];
+} io_reliable_frame_t;
+
+static io_reliable_layer_t*
+mk_io_reliable_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	extern EVENT_DATA io_layer_implementation_t io_reliable_layer_implementation;
+	io_reliable_layer_t *this = io_byte_memory_allocate (bm,sizeof(io_reliable_layer_t));
+
+	if (this) {
+		this->implementation = &io_reliable_layer_implementation;
+		this->flags = 0;
+		this->sack_count = 0;
+		this->window = 0;
+		this->sequence = 0;
+		this->acknowledge = 0;
+	}
+	
+	return this;
+}
+
+static io_layer_t*
+mk_io_reliable_transmit_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	io_reliable_layer_t *this = mk_io_reliable_layer (bm,packet);
+
+	if (this) {
+		this->layer_offset_in_byte_stream = io_encoding_length (packet);
+		io_encoding_fill (packet,0,sizeof(io_reliable_frame_t));
+	}
+	
+	return (io_layer_t*) this;
+}
+
+//
+// a frame that is too short to hold a header is read with no flags
+//
+static io_layer_t*
+mk_io_reliable_receive_layer (io_byte_memory_t *bm,io_encoding_t *packet) {
+	io_reliable_layer_t *this = mk_io_reliable_layer (bm,packet);
+
+	if (this) {
+		this->layer_offset_in_byte_stream = io_encoding_increment_decode_offest (
+			packet,sizeof(io_reliable_frame_t)
+		);
+		if (
+				io_encoding_length (packet)
+			>=	this->layer_offset_in_byte_stream + sizeof(io_reliable_frame_t)
+		) {
+			io_reliable_frame_t *frame = io_layer_get_byte_stream ((io_layer_t*) this,packet);
+			this->flags = frame->flags[0];
+			this->sack_count = frame->sack_count[0];
+			if (this->sack_count > IO_RELIABLE_SACK_LIMIT) {
+				this->sack_count = IO_RELIABLE_SACK_LIMIT;
+			}
+			this->window = read_le_uint16 (frame->window);
+			this->sequence = read_le_uint32 (frame->sequence);
+			this->acknowledge = read_le_uint32 (frame->acknowledge);
+			for (int i = 0; i < this->sack_count; i++) {
+				this->sack[i].begin = read_le_uint32 (frame->sack[i]);
+				this->sack[i].end = read_le_uint32 (frame->sack[i] + 4);
+			}
+		}
+	}
+	
+	return (io_layer_t*) this;
+}
+
+static void
+free_io_reliable_layer (io_layer_t *layer,io_byte_memory_t *bm) {
+	io_byte_memory_free (bm,layer);
+}
+
+static void
+io_reliable_layer_get_content (
+	io_layer_t *layer,io_encoding_t *encoding,uint8_t const **begin,uint8_t const **end
+) {
+	if (
+			io_encoding_length (encoding)
+		>=	layer->layer_offset_in_byte_stream + sizeof(io_reliable_frame_t)
+	) {
+		io_reliable_frame_t *frame = io_layer_get_byte_stream (layer,encoding);
+		*begin = frame->content;
+		*end = frame->content + io_layer_get_length (layer,encoding) - sizeof(io_reliable_frame_t);
+	} else {
+		*begin = *end = NULL;
+	}
+}
+
+static bool
+io_reliable_layer_load_header (io_layer_t *layer,io_encoding_t *encoding) {
+	io_reliable_layer_t *this = (io_reliable_layer_t *) layer;
+	io_reliable_frame_t *frame = io_layer_get_byte_stream (layer,encoding);
+	frame->flags[0] = this->flags;
+	frame->sack_count[0] = this->sack_count;
+	write_le_uint16 (frame->window,this->window);
+	write_le_uint32 (frame->sequence,this->sequence);
+	write_le_uint32 (frame->acknowledge,this->acknowledge);
+	for (int i = 0; i < this->sack_count; i++) {
+		write_le_uint32 (frame->sack[i],this->sack[i].begin);
+		write_le_uint32 (frame->sack[i] + 4,this->sack[i].end);
+	}
+	return true;
+}
+
+EVENT_DATA io_layer_implementation_t io_reliable_layer_implementation = {
+	SPECIALISE_IO_LAYER_IMPLEMENTATION (&io_layer_implementation)
+	.free = free_io_reliable_layer,
+	.get_content = io_reliable_layer_get_content,
+	.load_header = io_reliable_layer_load_header,
+};
+
+io_layer_t*
+push_io_reliable_transmit_layer (io_encoding_t *encoding) {
+	return io_encoding_push_layer (encoding,mk_io_reliable_transmit_layer);
+}
+
+io_layer_t*
+push_io_reliable_receive_layer (io_encoding_t *encoding) {
+	return io_encoding_push_layer (encoding,mk_io_reliable_receive_layer);
+}
+
+io_layer_t*
+get_io_reliable_layer (io_encoding_t *encoding) {
+	return io_encoding_get_layer (encoding,&io_reliable_layer_implementation);
+}
+
 #endif /* IMPLEMENT_IO_CORE */
 #endif
 /*
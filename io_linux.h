@@ -0,0 +1,1404 @@
+/*
+ *
+ * a linux host io cpu
+ *
+ * LICENSE
+ * =======
+ * See end of file for license terms.
+ *
+ * USAGE
+ * =====
+ * In one C source define IMPLEMENT_IO_LINUX prior to the include
+ * directive.  The host io runs its event loop on the thread that
+ * initialised it, other threads may enqueue events and alarms.
+ *
+ *		io_linux_t host;
+ *		io_t *io = initialise_io_linux (
+ *			&host,&io_linux_implementation,heap_size,value_memory_size
+ *		);
+ *		while (1) {
+ *			while (next_io_event (io));
+ *			io_wait_for_event (io);
+ *		}
+ *
+ */
+#ifndef io_linux_H_
+#define io_linux_H_
+#include <io_core.h>
+#include <pthread.h>
+
+//
+// the core byte memory is a umm heap so it is limited to 0x7fff blocks
+//
+#define IO_LINUX_BYTE_MEMORY_LIMIT		(0x7fffUL << UMM_BLOCK_SIZE_1N)
+#define IO_LINUX_VALUE_MEMORY_LIMIT		4
+#define STVM									0
+
+//
+// io_t is packed so the byte memory and lock live in their own allocations
+//
+typedef struct io_linux_critical_section {
+	pthread_mutex_t mutex;
+	pthread_t owner;
+} io_linux_critical_section_t;
+
+//
+// task executor
+//
+// Tasks are values, a worker runs one by sending it no arguments.  Task
+// references are only changed on the owning io: enqueue takes one and
+// the reference is dropped when the completed task is collected, so a
+// task's receive must treat values in the owner's memory as read only.
+//
+// Each worker sends to the task with its own io, which has a private
+// byte memory but no value memory and no event loop.  A task's receive
+// may allocate scratch bytes from the io it is given but must not make
+// values or enqueue events on it.
+//
+#define IO_LINUX_TASK_DEQUE_LENGTH		256
+#define IO_LINUX_TASK_WORKER_HEAP_SIZE	0x4000
+
+typedef struct io_linux_task io_linux_task_t;
+typedef struct io_linux_executor io_linux_executor_t;
+
+struct io_linux_task {
+	io_linux_task_t *next;
+	vref_t r_task;
+};
+
+//
+// the worker pushes and pops at the bottom, thieves take from the top
+//
+typedef struct io_linux_task_deque {
+	pthread_mutex_t lock;
+	io_linux_task_t *ring[IO_LINUX_TASK_DEQUE_LENGTH];
+	uint32_t top;
+	uint32_t bottom;
+} io_linux_task_deque_t;
+
+typedef struct io_linux_task_worker {
+	io_linux_executor_t *executor;
+	io_t *io;
+	io_linux_task_deque_t deque;
+	pthread_t thread;
+	uint32_t executed;
+	uint32_t stolen;
+} io_linux_task_worker_t;
+
+struct io_linux_executor {
+	io_t *io;
+	io_event_t *completed;
+	io_event_t collect;
+	io_linux_task_t *done;
+	io_linux_task_deque_t owner;
+	pthread_mutex_t idle_lock;
+	pthread_cond_t idle;
+	uint32_t pending;
+	uint32_t in_flight;
+	uint32_t completed_count;
+	uint32_t next_worker;
+	bool running;
+	uint32_t number_of_workers;
+	io_linux_task_worker_t workers[];
+};
+
+//
+// dma
+//
+// A software dma controller whose bursts run on a worker thread so that
+// copies overlap with the event loop.  Complete, half complete and error
+// events are enqueued on the io from the worker.  The controller lock is
+// held for each burst and by the controller api, a peripheral fifo must
+// only be used by the io thread through io_software_dma_channel_request.
+//
+typedef struct io_linux_dma_controller {
+	IO_SOFTWARE_DMA_CONTROLLER_STRUCT_MEMBERS
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_t thread;
+	bool ready;
+	bool alive;
+} io_linux_dma_controller_t;
+
+bool	initialise_io_linux_dma_controller (io_linux_dma_controller_t*,io_t*,uint32_t);
+void	close_io_linux_dma_controller (io_linux_dma_controller_t*);
+
+extern EVENT_DATA io_dma_controller_implementation_t io_linux_dma_controller_implementation;
+
+#define IO_LINUX_STRUCT_MEMBERS \
+	IO_STRUCT_MEMBERS \
+	io_byte_memory_t *bm; \
+	io_value_memory_t *stvm; \
+	io_linux_critical_section_t *critical; \
+	io_linux_executor_t *executor; \
+	pthread_t event_thread; \
+	int epoll_fd; \
+	int event_fd; \
+	int timer_fd; \
+	/**/
+
+typedef struct PACK_STRUCTURE io_linux {
+	IO_LINUX_STRUCT_MEMBERS
+} io_linux_t;
+
+io_t*	initialise_io_linux (io_linux_t*,io_implementation_t const*,uint32_t,uint32_t);
+void	close_io_linux (io_linux_t*);
+bool	io_linux_start_executor (io_linux_t*,uint32_t,io_event_t*);
+void	io_linux_stop_executor (io_linux_t*);
+
+#define io_linux_executor_completed(l)	((l)->executor->completed_count)
+#define io_linux_executor_in_flight(l)	((l)->executor->in_flight)
+
+io_byte_memory_t*	io_linux_get_byte_memory (io_t*);
+io_value_memory_t*	io_linux_get_value_memory (io_t*);
+bool	io_linux_in_event_thread (io_t*);
+void	io_linux_signal_event_pending (io_t*);
+void	io_linux_wait_for_all_events (io_t*);
+bool	io_linux_enqueue_task (io_t*,vref_t);
+void	io_linux_signal_task_pending (io_t*);
+bool	io_linux_do_next_task (io_t*);
+io_time_t	io_linux_get_time (io_t*);
+void	io_linux_set_wakeup_time (io_t*,io_time_t);
+void	io_linux_sleep (io_t*);
+bool	io_linux_enter_critical_section (io_t*);
+void	io_linux_exit_critical_section (io_t*,bool);
+void	io_linux_log (io_t*,char const*,va_list);
+void	io_linux_flush_log (io_t*);
+void	io_linux_panic (io_t*,int);
+
+//
+// alarms use the tickless core so a single timerfd holds the next
+// deadline, event signals are an eventfd and the wait is an epoll
+// over both
+//
+#define SPECIALISE_IO_LINUX_IMPLEMENTATION(S) \
+	SPECIALISE_IO_IMPLEMENTATION(S) \
+	.get_byte_memory = io_linux_get_byte_memory, \
+	.get_short_term_value_memory = io_linux_get_value_memory, \
+	.get_long_term_value_memory = io_linux_get_value_memory, \
+	.enqueue_task = io_linux_enqueue_task, \
+	.signal_task_pending = io_linux_signal_task_pending, \
+	.do_next_task = io_linux_do_next_task, \
+	.in_event_thread = io_linux_in_event_thread, \
+	.signal_event_pending = io_linux_signal_event_pending, \
+	.wait_for_event = tickless_wait_for_io_event, \
+	.wait_for_all_events = io_linux_wait_for_all_events, \
+	.get_time = io_linux_get_time, \
+	.enqueue_alarm = enqueue_io_alarm, \
+	.dequeue_alarm = dequeue_io_alarm, \
+	.set_wakeup_time = io_linux_set_wakeup_time, \
+	.sleep = io_linux_sleep, \
+	.enter_critical_section = io_linux_enter_critical_section, \
+	.exit_critical_section = io_linux_exit_critical_section, \
+	.log = io_linux_log, \
+	.flush_log = io_linux_flush_log, \
+	.panic = io_linux_panic, \
+	/**/
+
+extern EVENT_DATA io_implementation_t io_linux_implementation;
+
+#ifdef IMPLEMENT_IO_LINUX
+//-----------------------------------------------------------------------------
+//
+// implementation of io_linux
+//
+//-----------------------------------------------------------------------------
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static io_value_memory_t *io_linux_value_memories[IO_LINUX_VALUE_MEMORY_LIMIT] = {NULL};
+
+bool
+register_io_value_memory (io_value_memory_t *vm) {
+	uint32_t id = io_value_memory_id (vm);
+	if (id < IO_LINUX_VALUE_MEMORY_LIMIT && io_linux_value_memories[id] == NULL) {
+		io_linux_value_memories[id] = vm;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+io_value_memory_t*
+io_get_value_memory_by_id (uint32_t id) {
+	if (id < IO_LINUX_VALUE_MEMORY_LIMIT) {
+		return io_linux_value_memories[id];
+	} else {
+		return NULL;
+	}
+}
+
+static bool
+io_linux_watch (io_linux_t *this,int fd) {
+	struct epoll_event watch = {
+		.events = EPOLLIN,
+		.data.fd = fd,
+	};
+	return epoll_ctl (this->epoll_fd,EPOLL_CTL_ADD,fd,&watch) == 0;
+}
+
+io_t*
+initialise_io_linux (
+	io_linux_t *this,io_implementation_t const *I,uint32_t heap_size,uint32_t vm_size
+) {
+	io_t *io = (io_t*) this;
+
+	initialise_io (io,I);
+	this->stvm = NULL;
+	this->executor = NULL;
+	this->event_thread = pthread_self ();
+	this->critical = malloc (sizeof(io_linux_critical_section_t));
+	if (this->critical != NULL) {
+		pthread_mutex_init (&this->critical->mutex,NULL);
+		this->critical->owner = 0;
+	}
+
+	this->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+	this->event_fd = eventfd (0,EFD_NONBLOCK | EFD_CLOEXEC);
+	this->timer_fd = timerfd_create (CLOCK_MONOTONIC,TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (heap_size > IO_LINUX_BYTE_MEMORY_LIMIT) {
+		heap_size = IO_LINUX_BYTE_MEMORY_LIMIT;
+	}
+	this->bm = malloc (sizeof(io_byte_memory_t));
+	if (this->bm != NULL) {
+		this->bm->number_of_blocks = heap_size >> UMM_BLOCK_SIZE_1N;
+		this->bm->heap = malloc (this->bm->number_of_blocks << UMM_BLOCK_SIZE_1N);
+	}
+
+	if (
+			this->epoll_fd < 0
+		||	this->event_fd < 0
+		||	this->timer_fd < 0
+		||	this->bm == NULL
+		||	this->bm->heap == NULL
+		||	this->critical == NULL
+		||	!io_linux_watch (this,this->event_fd)
+		||	!io_linux_watch (this,this->timer_fd)
+	) {
+		close_io_linux (this);
+		return NULL;
+	}
+
+	initialise_io_byte_memory (io,this->bm,UMM_BLOCK_SIZE_1N);
+
+	if (vm_size > 0) {
+		this->stvm = mk_umm_io_value_memory (io,vm_size,STVM);
+		if (this->stvm == NULL || !register_io_value_memory (this->stvm)) {
+			close_io_linux (this);
+			return NULL;
+		}
+	}
+
+	return io;
+}
+
+void
+close_io_linux (io_linux_t *this) {
+	io_linux_stop_executor (this);
+	if (this->stvm != NULL) {
+		uint32_t id = io_value_memory_id (this->stvm);
+		if (io_get_value_memory_by_id (id) == this->stvm) {
+			io_linux_value_memories[id] = NULL;
+		}
+		free_io_value_memory (this->stvm);
+		this->stvm = NULL;
+	}
+	if (this->epoll_fd >= 0) close (this->epoll_fd);
+	if (this->event_fd >= 0) close (this->event_fd);
+	if (this->timer_fd >= 0) close (this->timer_fd);
+	this->epoll_fd = this->event_fd = this->timer_fd = -1;
+	if (this->bm != NULL) {
+		free (this->bm->heap);
+		free (this->bm);
+		this->bm = NULL;
+	}
+	if (this->critical != NULL) {
+		pthread_mutex_destroy (&this->critical->mutex);
+		free (this->critical);
+		this->critical = NULL;
+	}
+}
+
+io_byte_memory_t*
+io_linux_get_byte_memory (io_t *io) {
+	return ((io_linux_t*) io)->bm;
+}
+
+io_value_memory_t*
+io_linux_get_value_memory (io_t *io) {
+	return ((io_linux_t*) io)->stvm;
+}
+
+bool
+io_linux_in_event_thread (io_t *io) {
+	return pthread_equal (((io_linux_t*) io)->event_thread,pthread_self ());
+}
+
+void
+io_linux_signal_event_pending (io_t *io) {
+	uint64_t one = 1;
+	if (write (((io_linux_t*) io)->event_fd,&one,sizeof(one)) < 0) {
+		// the counter is already pending so the wake up is not lost
+	}
+}
+
+void
+io_linux_wait_for_all_events (io_t *io) {
+	do {
+		while (io->events != &s_null_io_event) {
+			do_next_io_event (io);
+		}
+	} while (do_due_io_alarms (io) > 0);
+}
+
+io_time_t
+io_linux_get_time (io_t *io) {
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC,&now);
+	return (io_time_t) {(int64_t) now.tv_sec * 1000000000LL + now.tv_nsec};
+}
+
+void
+io_linux_set_wakeup_time (io_t *io,io_time_t t) {
+	struct itimerspec when = {.it_interval = {0,0},.it_value = {0,0}};
+	if (t.ns != LLONG_MAX) {
+		when.it_value.tv_sec = t.ns / 1000000000LL;
+		when.it_value.tv_nsec = t.ns % 1000000000LL;
+		if (when.it_value.tv_sec == 0 && when.it_value.tv_nsec == 0) {
+			// a zero time would disarm the timer
+			when.it_value.tv_nsec = 1;
+		}
+	}
+	timerfd_settime (((io_linux_t*) io)->timer_fd,TFD_TIMER_ABSTIME,&when,NULL);
+}
+
+//
+// called in the critical section, like a wfi the lock is released while
+// the thread waits so other threads can enqueue events and alarms
+//
+void
+io_linux_sleep (io_t *io) {
+	io_linux_t *this = (io_linux_t*) io;
+	io_linux_critical_section_t *critical = this->critical;
+	struct epoll_event ready[2];
+	int count;
+
+	__atomic_store_n (&critical->owner,0,__ATOMIC_RELAXED);
+	pthread_mutex_unlock (&critical->mutex);
+
+	count = epoll_wait (this->epoll_fd,ready,SIZEOF(ready),-1);
+
+	pthread_mutex_lock (&critical->mutex);
+	__atomic_store_n (&critical->owner,pthread_self (),__ATOMIC_RELAXED);
+
+	for (int i = 0; i < count; i++) {
+		uint64_t value;
+		if (read (ready[i].data.fd,&value,sizeof(value)) < 0) {
+			// already drained
+		}
+	}
+}
+
+//
+// the handle is true when this thread already holds the section
+//
+bool
+io_linux_enter_critical_section (io_t *io) {
+	io_linux_critical_section_t *critical = ((io_linux_t*) io)->critical;
+	pthread_t self = pthread_self ();
+	if (pthread_equal (__atomic_load_n (&critical->owner,__ATOMIC_RELAXED),self)) {
+		return true;
+	} else {
+		pthread_mutex_lock (&critical->mutex);
+		__atomic_store_n (&critical->owner,self,__ATOMIC_RELAXED);
+		return false;
+	}
+}
+
+void
+io_linux_exit_critical_section (io_t *io,bool h) {
+	io_linux_critical_section_t *critical = ((io_linux_t*) io)->critical;
+	if (!h) {
+		__atomic_store_n (&critical->owner,0,__ATOMIC_RELAXED);
+		pthread_mutex_unlock (&critical->mutex);
+	}
+}
+
+void
+io_linux_log (io_t *io,char const *fmt,va_list va) {
+	vfprintf (stderr,fmt,va);
+}
+
+void
+io_linux_flush_log (io_t *io) {
+	fflush (stderr);
+}
+
+void
+io_linux_panic (io_t *io,int code) {
+	fprintf (stderr,"panic %d\n",code);
+	abort ();
+}
+
+//
+// task executor
+//
+static bool
+io_linux_task_deque_push (io_linux_task_deque_t *this,io_linux_task_t *task) {
+	bool ok;
+	pthread_mutex_lock (&this->lock);
+	ok = (this->bottom - this->top) < IO_LINUX_TASK_DEQUE_LENGTH;
+	if (ok) {
+		this->ring[this->bottom++ % IO_LINUX_TASK_DEQUE_LENGTH] = task;
+	}
+	pthread_mutex_unlock (&this->lock);
+	return ok;
+}
+
+static io_linux_task_t*
+io_linux_task_deque_pop (io_linux_task_deque_t *this) {
+	io_linux_task_t *task = NULL;
+	pthread_mutex_lock (&this->lock);
+	if (this->bottom != this->top) {
+		task = this->ring[--this->bottom % IO_LINUX_TASK_DEQUE_LENGTH];
+	}
+	pthread_mutex_unlock (&this->lock);
+	return task;
+}
+
+static io_linux_task_t*
+io_linux_task_deque_steal (io_linux_task_deque_t *this) {
+	io_linux_task_t *task = NULL;
+	pthread_mutex_lock (&this->lock);
+	if (this->bottom != this->top) {
+		task = this->ring[this->top++ % IO_LINUX_TASK_DEQUE_LENGTH];
+	}
+	pthread_mutex_unlock (&this->lock);
+	return task;
+}
+
+//
+// a worker takes from its own deque first then steals from the other
+// workers and the owner's deque, the owning io (worker NULL) only steals
+//
+static io_linux_task_t*
+io_linux_executor_take (io_linux_executor_t *this,io_linux_task_worker_t *worker) {
+	io_linux_task_t *task = NULL;
+	uint32_t start = 0;
+
+	if (worker != NULL) {
+		task = io_linux_task_deque_pop (&worker->deque);
+		start = (worker - this->workers) + 1;
+	}
+
+	for (uint32_t i = 0; task == NULL && i < this->number_of_workers; i++) {
+		io_linux_task_worker_t *victim = this->workers + (start + i) % this->number_of_workers;
+		if (victim != worker) {
+			task = io_linux_task_deque_steal (&victim->deque);
+			if (task != NULL && worker != NULL) {
+				worker->stolen ++;
+			}
+		}
+	}
+
+	if (task == NULL) {
+		task = io_linux_task_deque_steal (&this->owner);
+	}
+
+	if (task != NULL) {
+		__atomic_sub_fetch (&this->pending,1,__ATOMIC_RELAXED);
+	}
+
+	return task;
+}
+
+//
+// completed tasks go on a lock free stack, the first completion into
+// an empty stack wakes the owning io
+//
+static void
+io_linux_executor_run (io_linux_executor_t *this,io_t *io,io_linux_task_t *task) {
+	io_linux_task_t *head;
+
+	io_value_sendm (io,task->r_task,0,NULL);
+
+	head = __atomic_load_n (&this->done,__ATOMIC_RELAXED);
+	do {
+		task->next = head;
+	} while (
+		!__atomic_compare_exchange_n (
+			&this->done,&head,task,true,__ATOMIC_RELEASE,__ATOMIC_RELAXED
+		)
+	);
+
+	if (head == NULL) {
+		io_enqueue_event (this->io,&this->collect);
+	}
+}
+
+static void
+io_linux_executor_collect (io_event_t *ev) {
+	io_linux_executor_t *this = ev->user_value;
+	io_byte_memory_t *bm = io_get_byte_memory (this->io);
+	io_linux_task_t *task = __atomic_exchange_n (&this->done,NULL,__ATOMIC_ACQUIRE);
+	uint32_t count = 0;
+
+	while (task != NULL) {
+		io_linux_task_t *next = task->next;
+		unreference_value (task->r_task);
+		io_byte_memory_free (bm,task);
+		task = next;
+		count ++;
+	}
+
+	if (count) {
+		this->in_flight -= count;
+		this->completed_count += count;
+		if (this->completed != NULL) {
+			io_enqueue_event (this->io,this->completed);
+		}
+	}
+}
+
+static void*
+io_linux_task_worker_thread (void *user_value) {
+	io_linux_task_worker_t *worker = user_value;
+	io_linux_executor_t *this = worker->executor;
+
+	((io_linux_t*) worker->io)->event_thread = pthread_self ();
+
+	while (__atomic_load_n (&this->running,__ATOMIC_ACQUIRE)) {
+		io_linux_task_t *task = io_linux_executor_take (this,worker);
+		if (task != NULL) {
+			io_linux_executor_run (this,worker->io,task);
+			worker->executed ++;
+		} else {
+			pthread_mutex_lock (&this->idle_lock);
+			while (
+					__atomic_load_n (&this->running,__ATOMIC_ACQUIRE)
+				&&	__atomic_load_n (&this->pending,__ATOMIC_ACQUIRE) == 0
+			) {
+				pthread_cond_wait (&this->idle,&this->idle_lock);
+			}
+			pthread_mutex_unlock (&this->idle_lock);
+		}
+	}
+
+	return NULL;
+}
+
+//
+// with no workers tasks only run when the owning io calls do_next_task
+//
+bool
+io_linux_start_executor (io_linux_t *host,uint32_t workers,io_event_t *completed) {
+	io_linux_executor_t *this;
+
+	if (host->executor != NULL) {
+		return false;
+	}
+
+	this = malloc (sizeof(io_linux_executor_t) + workers * sizeof(io_linux_task_worker_t));
+	if (this == NULL) {
+		return false;
+	}
+
+	this->io = (io_t*) host;
+	this->completed = completed;
+	initialise_io_event (&this->collect,io_linux_executor_collect,this);
+	this->done = NULL;
+	this->owner.top = this->owner.bottom = 0;
+	pthread_mutex_init (&this->owner.lock,NULL);
+	pthread_mutex_init (&this->idle_lock,NULL);
+	pthread_cond_init (&this->idle,NULL);
+	this->pending = 0;
+	this->in_flight = 0;
+	this->completed_count = 0;
+	this->next_worker = 0;
+	this->running = true;
+	this->number_of_workers = 0;
+	host->executor = this;
+
+	for (uint32_t i = 0; i < workers; i++) {
+		io_linux_task_worker_t *worker = this->workers + i;
+		io_linux_t *worker_io = malloc (sizeof(io_linux_t));
+		worker->executor = this;
+		worker->io = (
+			(worker_io != NULL)
+		?	initialise_io_linux (
+				worker_io,host->implementation,
+				IO_LINUX_TASK_WORKER_HEAP_SIZE,0
+			)
+		:	NULL
+		);
+		if (worker->io == NULL) {
+			free (worker_io);
+			io_linux_stop_executor (host);
+			return false;
+		}
+		worker->deque.top = worker->deque.bottom = 0;
+		worker->executed = 0;
+		worker->stolen = 0;
+		pthread_mutex_init (&worker->deque.lock,NULL);
+		if (pthread_create (&worker->thread,NULL,io_linux_task_worker_thread,worker) != 0) {
+			pthread_mutex_destroy (&worker->deque.lock);
+			close_io_linux (worker_io);
+			free (worker_io);
+			io_linux_stop_executor (host);
+			return false;
+		}
+		this->number_of_workers ++;
+	}
+
+	return true;
+}
+
+//
+// on the owning io, queued tasks that have not run are dropped
+//
+void
+io_linux_stop_executor (io_linux_t *host) {
+	io_linux_executor_t *this = host->executor;
+
+	if (this != NULL) {
+		io_byte_memory_t *bm = io_get_byte_memory (this->io);
+		io_linux_task_t *task;
+
+		pthread_mutex_lock (&this->idle_lock);
+		__atomic_store_n (&this->running,false,__ATOMIC_RELEASE);
+		pthread_cond_broadcast (&this->idle);
+		pthread_mutex_unlock (&this->idle_lock);
+
+		for (uint32_t i = 0; i < this->number_of_workers; i++) {
+			pthread_join (this->workers[i].thread,NULL);
+		}
+
+		while ((task = io_linux_executor_take (this,NULL)) != NULL) {
+			unreference_value (task->r_task);
+			io_byte_memory_free (bm,task);
+		}
+		io_dequeue_event (this->io,&this->collect);
+		io_linux_executor_collect (&this->collect);
+		if (this->completed != NULL) {
+			io_dequeue_event (this->io,this->completed);
+		}
+
+		for (uint32_t i = 0; i < this->number_of_workers; i++) {
+			pthread_mutex_destroy (&this->workers[i].deque.lock);
+			close_io_linux ((io_linux_t*) this->workers[i].io);
+			free (this->workers[i].io);
+		}
+		pthread_mutex_destroy (&this->owner.lock);
+		pthread_cond_destroy (&this->idle);
+		pthread_mutex_destroy (&this->idle_lock);
+		free (this);
+		host->executor = NULL;
+	}
+}
+
+//
+// on the owning io, tasks are dealt to the workers in turn
+//
+bool
+io_linux_enqueue_task (io_t *io,vref_t r_task) {
+	io_linux_executor_t *this = ((io_linux_t*) io)->executor;
+	io_linux_task_t *task;
+	bool ok = false;
+
+	if (this == NULL) {
+		return false;
+	}
+
+	task = io_byte_memory_allocate (io_get_byte_memory (io),sizeof(io_linux_task_t));
+	if (task == NULL) {
+		return false;
+	}
+	task->r_task = reference_value (r_task);
+	task->next = NULL;
+
+	// counted before it is published so a thief never takes pending below zero
+	__atomic_add_fetch (&this->pending,1,__ATOMIC_RELEASE);
+
+	for (uint32_t i = 0; !ok && i < this->number_of_workers; i++) {
+		io_linux_task_worker_t *worker = this->workers + this->next_worker;
+		this->next_worker = (this->next_worker + 1) % this->number_of_workers;
+		ok = io_linux_task_deque_push (&worker->deque,task);
+	}
+	if (!ok) {
+		ok = io_linux_task_deque_push (&this->owner,task);
+	}
+
+	if (ok) {
+		this->in_flight ++;
+		signal_io_task_pending (io);
+	} else {
+		__atomic_sub_fetch (&this->pending,1,__ATOMIC_RELAXED);
+		unreference_value (task->r_task);
+		io_byte_memory_free (io_get_byte_memory (io),task);
+	}
+
+	return ok;
+}
+
+void
+io_linux_signal_task_pending (io_t *io) {
+	io_linux_executor_t *this = ((io_linux_t*) io)->executor;
+	if (this != NULL) {
+		pthread_mutex_lock (&this->idle_lock);
+		pthread_cond_signal (&this->idle);
+		pthread_mutex_unlock (&this->idle_lock);
+	}
+}
+
+//
+// the owning io helps by running a queued task itself
+//
+bool
+io_linux_do_next_task (io_t *io) {
+	io_linux_executor_t *this = ((io_linux_t*) io)->executor;
+	if (this != NULL) {
+		io_linux_task_t *task = io_linux_executor_take (this,NULL);
+		if (task != NULL) {
+			io_linux_executor_run (this,io,task);
+			return true;
+		}
+	}
+	return false;
+}
+
+//
+// dma
+//
+static void
+io_linux_dma_controller_wake (io_linux_dma_controller_t *this) {
+	pthread_mutex_lock (&this->lock);
+	this->ready = true;
+	pthread_cond_signal (&this->wake);
+	pthread_mutex_unlock (&this->lock);
+}
+
+//
+// the software controller signals by enqueueing its worker event
+//
+static void
+io_linux_dma_controller_worker_event (io_event_t *ev) {
+	io_linux_dma_controller_wake (ev->user_value);
+}
+
+static void*
+io_linux_dma_controller_thread (void *user_value) {
+	io_linux_dma_controller_t *this = user_value;
+
+	pthread_mutex_lock (&this->lock);
+	while (this->alive) {
+		if (this->ready) {
+			this->ready = io_software_dma_controller_run_burst (
+				(io_software_dma_controller_t*) this
+			);
+			// let the io in between bursts
+			pthread_mutex_unlock (&this->lock);
+			sched_yield ();
+			pthread_mutex_lock (&this->lock);
+		} else {
+			pthread_cond_wait (&this->wake,&this->lock);
+		}
+	}
+	pthread_mutex_unlock (&this->lock);
+
+	return NULL;
+}
+
+bool
+initialise_io_linux_dma_controller (
+	io_linux_dma_controller_t *this,io_t *io,uint32_t burst
+) {
+	initialise_io_software_dma_controller (
+		(io_software_dma_controller_t*) this,io,burst
+	);
+	this->implementation = &io_linux_dma_controller_implementation;
+	initialise_io_event (&this->worker,io_linux_dma_controller_worker_event,this);
+	this->ready = false;
+	this->alive = true;
+	pthread_mutex_init (&this->lock,NULL);
+	pthread_cond_init (&this->wake,NULL);
+
+	if (pthread_create (&this->thread,NULL,io_linux_dma_controller_thread,this) == 0) {
+		return true;
+	} else {
+		pthread_cond_destroy (&this->wake);
+		pthread_mutex_destroy (&this->lock);
+		return false;
+	}
+}
+
+//
+// on the owning io, queued transfers are abandoned without events
+//
+void
+close_io_linux_dma_controller (io_linux_dma_controller_t *this) {
+	pthread_mutex_lock (&this->lock);
+	this->alive = false;
+	this->running = false;
+	pthread_cond_signal (&this->wake);
+	pthread_mutex_unlock (&this->lock);
+
+	pthread_join (this->thread,NULL);
+	io_dequeue_event (this->io,&this->worker);
+	pthread_cond_destroy (&this->wake);
+	pthread_mutex_destroy (&this->lock);
+}
+
+static bool
+io_linux_dma_controller_start (io_dma_controller_t *dmac) {
+	io_linux_dma_controller_t *this = (io_linux_dma_controller_t*) dmac;
+	bool ok;
+	pthread_mutex_lock (&this->lock);
+	ok = io_software_dma_controller_implementation.start_controller (dmac);
+	pthread_mutex_unlock (&this->lock);
+	return ok;
+}
+
+static bool
+io_linux_dma_controller_stop (io_dma_controller_t *dmac) {
+	io_linux_dma_controller_t *this = (io_linux_dma_controller_t*) dmac;
+	bool ok;
+	pthread_mutex_lock (&this->lock);
+	ok = io_software_dma_controller_implementation.stop_controller (dmac);
+	pthread_mutex_unlock (&this->lock);
+	return ok;
+}
+
+static bool
+io_linux_dma_controller_start_transfer (io_dma_controller_t *dmac,io_dma_channel_t *c) {
+	io_linux_dma_controller_t *this = (io_linux_dma_controller_t*) dmac;
+	bool ok;
+	pthread_mutex_lock (&this->lock);
+	ok = io_software_dma_controller_implementation.start_transfer (dmac,c);
+	pthread_mutex_unlock (&this->lock);
+	return ok;
+}
+
+static bool
+io_linux_dma_controller_stop_transfer (io_dma_controller_t *dmac,io_dma_channel_t *c) {
+	io_linux_dma_controller_t *this = (io_linux_dma_controller_t*) dmac;
+	bool ok;
+	pthread_mutex_lock (&this->lock);
+	ok = io_software_dma_controller_implementation.stop_transfer (dmac,c);
+	pthread_mutex_unlock (&this->lock);
+	return ok;
+}
+
+EVENT_DATA io_dma_controller_implementation_t io_linux_dma_controller_implementation = {
+	SPECIALISE_IO_DMA_CONTROLLER_IMPLEMENTATION (&io_software_dma_controller_implementation)
+	.start_controller = io_linux_dma_controller_start,
+	.stop_controller = io_linux_dma_controller_stop,
+	.start_transfer = io_linux_dma_controller_start_transfer,
+	.stop_transfer = io_linux_dma_controller_stop_transfer,
+};
+
+EVENT_DATA io_implementation_t io_linux_implementation = {
+	SPECIALISE_IO_LINUX_IMPLEMENTATION(NULL)
+};
+
+#endif /* IMPLEMENT_IO_LINUX */
+#ifdef IMPLEMENT_VERIFY_IO_LINUX
+#include <io_verify.h>
+#include <sched.h>
+
+#define TEST_IO_LINUX_EVENTS	1000
+#define TEST_IO_LINUX_ALARMS	100
+
+typedef struct {
+	io_t *io;
+	io_event_t event;
+	io_time_t sent;
+	uint32_t handled;
+	io_event_t alarm_event;
+	io_alarm_t alarm;
+	uint32_t alarms;
+	int64_t event_total,event_max;
+	int64_t alarm_total,alarm_max;
+} test_io_linux_latency_t;
+
+static void
+test_io_linux_latency_event (io_event_t *ev) {
+	test_io_linux_latency_t *this = ev->user_value;
+	int64_t latency = io_get_time (this->io).ns - this->sent.ns;
+	this->event_total += latency;
+	if (latency > this->event_max) this->event_max = latency;
+	__atomic_add_fetch (&this->handled,1,__ATOMIC_RELEASE);
+}
+
+static void
+test_io_linux_alarm_event (io_event_t *ev) {
+	test_io_linux_latency_t *this = ev->user_value;
+	int64_t late = io_get_time (this->io).ns - this->alarm.when.ns;
+	this->alarm_total += late;
+	if (late > this->alarm_max) this->alarm_max = late;
+	if (++this->alarms < TEST_IO_LINUX_ALARMS) {
+		set_alarm_delay_time (this->io,&this->alarm,millisecond_time (1));
+		io_enqueue_alarm (this->io,&this->alarm);
+	}
+}
+
+//
+// another thread raises each event once the previous one is handled
+//
+static void*
+test_io_linux_producer (void *user_value) {
+	test_io_linux_latency_t *this = user_value;
+	for (uint32_t i = 0; i < TEST_IO_LINUX_EVENTS; i++) {
+		while (__atomic_load_n (&this->handled,__ATOMIC_ACQUIRE) < i) {
+			sched_yield ();
+		}
+		this->sent = io_get_time (this->io);
+		io_enqueue_event (this->io,&this->event);
+	}
+	return NULL;
+}
+
+TEST_BEGIN(test_io_linux_latency_1) {
+	test_io_linux_latency_t t = {0};
+	io_linux_t host;
+	pthread_t producer;
+	io_t *io;
+
+	io = initialise_io_linux (&host,&io_linux_implementation,0x4000,0);
+	VERIFY (io != NULL,NULL);
+
+	if (io) {
+		t.io = io;
+		initialise_io_event (&t.event,test_io_linux_latency_event,&t);
+		initialise_io_event (&t.alarm_event,test_io_linux_alarm_event,&t);
+		initialise_io_alarm (&t.alarm,&t.alarm_event,&t.alarm_event,time_zero());
+
+		// event latency from another thread
+		VERIFY (pthread_create (&producer,NULL,test_io_linux_producer,&t) == 0,NULL);
+		while (__atomic_load_n (&t.handled,__ATOMIC_ACQUIRE) < TEST_IO_LINUX_EVENTS) {
+			while (io->events != &s_null_io_event) {
+				do_next_io_event (io);
+			}
+			io_wait_for_event (io);
+		}
+		pthread_join (producer,NULL);
+
+		// alarm lateness
+		set_alarm_delay_time (io,&t.alarm,millisecond_time (1));
+		io_enqueue_alarm (io,&t.alarm);
+		while (t.alarms < TEST_IO_LINUX_ALARMS) {
+			while (io->events != &s_null_io_event) {
+				do_next_io_event (io);
+			}
+			io_wait_for_event (io);
+		}
+
+		io_log (
+			TEST_IO,IO_INFO_LOG_LEVEL,
+			"%-*s%-*sevent %lld/%lld ns, alarm %lld/%lld ns (mean/max)\n",
+			DBP_FIELD1,"",
+			DBP_FIELD2,"latency",
+			t.event_total / TEST_IO_LINUX_EVENTS,t.event_max,
+			t.alarm_total / TEST_IO_LINUX_ALARMS,t.alarm_max
+		);
+
+		VERIFY (t.handled == TEST_IO_LINUX_EVENTS,NULL);
+		VERIFY (t.alarm_total >= 0 && t.alarm_max < millisecond_time (100).ns,NULL);
+		VERIFY (t.event_max < millisecond_time (100).ns,NULL);
+		VERIFY (io->alarms == &s_null_io_alarm,NULL);
+
+		close_io_linux (&host);
+	}
+}
+TEST_END
+
+#define TEST_IO_LINUX_MESSAGES	100000
+
+typedef struct {
+	io_t *io;
+	io_channel_t *channel;
+	uint32_t received;
+} test_io_linux_channel_t;
+
+static void
+test_io_linux_channel_receive (io_event_t *ev) {
+	test_io_linux_channel_t *this = ev->user_value;
+	io_channel_message_t message;
+	while (io_channel_receive (this->channel,&message)) {
+		io_channel_release (this->channel,&message);
+		this->received ++;
+	}
+}
+
+//
+// the sending io runs on its own thread and only waits when every
+// message is lent
+//
+static void*
+test_io_linux_channel_sender (void *user_value) {
+	test_io_linux_channel_t *this = user_value;
+	io_t *io = this->io;
+	uint32_t sent = 0;
+
+	while (sent < TEST_IO_LINUX_MESSAGES || io_channel_messages_lent (this->channel)) {
+		while (sent < TEST_IO_LINUX_MESSAGES && io_channel_send_value (this->channel,cr_NIL)) {
+			sent ++;
+		}
+		while (io->events != &s_null_io_event) {
+			do_next_io_event (io);
+		}
+		if (io_channel_messages_lent (this->channel)) {
+			io_wait_for_event (io);
+		}
+	}
+	return NULL;
+}
+
+TEST_BEGIN(test_io_linux_channel_1) {
+	test_io_linux_channel_t t = {0};
+	io_linux_t a,b;
+	io_t *sender = initialise_io_linux (&a,&io_linux_implementation,0x4000,0);
+	io_t *receiver = initialise_io_linux (&b,&io_linux_implementation,0x4000,0);
+	io_event_t receive;
+	pthread_t thread;
+
+	if (VERIFY (sender != NULL && receiver != NULL,NULL)) {
+		io_time_t begin,end;
+
+		initialise_io_event (&receive,test_io_linux_channel_receive,&t);
+		t.io = sender;
+		t.channel = mk_io_channel (sender,receiver,&receive,256);
+		VERIFY (t.channel != NULL,NULL);
+
+		begin = io_get_time (receiver);
+		VERIFY (pthread_create (&thread,NULL,test_io_linux_channel_sender,&t) == 0,NULL);
+		while (t.received < TEST_IO_LINUX_MESSAGES) {
+			while (receiver->events != &s_null_io_event) {
+				do_next_io_event (receiver);
+			}
+			if (t.received < TEST_IO_LINUX_MESSAGES) {
+				io_wait_for_event (receiver);
+			}
+		}
+		end = io_get_time (receiver);
+		pthread_join (thread,NULL);
+
+		io_log (
+			TEST_IO,IO_INFO_LOG_LEVEL,
+			"%-*s%-*s%lld messages per second, %u wake ups\n",
+			DBP_FIELD1,"",
+			DBP_FIELD2,"channel",
+			(TEST_IO_LINUX_MESSAGES * 1000000000LL) / (end.ns - begin.ns + 1),
+			io_channel_signals (t.channel)
+		);
+
+		VERIFY (t.received == TEST_IO_LINUX_MESSAGES,NULL);
+		VERIFY (io_channel_messages_lent (t.channel) == 0,NULL);
+		free_io_channel (t.channel);
+	}
+
+	if (sender) close_io_linux (&a);
+	if (receiver) close_io_linux (&b);
+}
+TEST_END
+
+#define TEST_IO_LINUX_TASKS	20000
+
+typedef struct PACK_STRUCTURE test_io_linux_task {
+	IO_VALUE_STRUCT_MEMBERS
+	uint32_t work;
+	uint32_t *runs;
+	io_t *owner;
+	uint32_t *away;
+} test_io_linux_task_t;
+
+static vref_t
+test_io_linux_task_receive (io_t *io,vref_t r_task,uint32_t argc,vref_t const *args) {
+	test_io_linux_task_t const *this = vref_cast_to_ro_pointer (r_task);
+	volatile uint32_t sum = 0;
+	for (uint32_t i = 0; i < this->work; i++) {
+		sum += i;
+	}
+	if (io != this->owner) {
+		// a worker's io has its own byte memory
+		io_byte_memory_t *bm = io_get_byte_memory (io);
+		void *scratch = io_byte_memory_allocate (bm,64);
+		if (scratch != NULL) {
+			io_byte_memory_free (bm,scratch);
+			__atomic_add_fetch (this->away,1,__ATOMIC_RELAXED);
+		}
+	}
+	__atomic_add_fetch (this->runs,1,__ATOMIC_RELAXED);
+	return cr_RESULT_CONTINUE;
+}
+
+static EVENT_DATA io_value_implementation_t test_io_linux_task_implementation = {
+	SPECIALISE_IO_VALUE_IMPLEMENTATION (&io_value_implementation)
+	.name = "task",
+	.receive = test_io_linux_task_receive,
+};
+
+TEST_BEGIN(test_io_linux_tasks_1) {
+	uint32_t runs = 0,away = 0;
+	test_io_linux_task_t task = {
+		decl_io_value (&test_io_linux_task_implementation,sizeof(test_io_linux_task_t))
+		.work = 100,
+		.runs = &runs,
+		.away = &away,
+	};
+	vref_t r_task = def_vref (&reference_to_constant_value,&task);
+	io_linux_t host;
+	io_t *io = initialise_io_linux (&host,&io_linux_implementation,0x10000,0);
+
+	if (VERIFY (io != NULL,NULL)) {
+		task.owner = io;
+		VERIFY (!io_enqueue_task (io,r_task),NULL);
+
+		// without workers the owning io runs its own tasks
+		VERIFY (io_linux_start_executor (&host,0,NULL),NULL);
+		VERIFY (io_enqueue_task (io,r_task) && io_enqueue_task (io,r_task),NULL);
+		VERIFY (io_do_next_task (io) && io_do_next_task (io),NULL);
+		VERIFY (!io_do_next_task (io),NULL);
+		io_wait_for_all_events (io);
+		VERIFY (runs == 2 && io_linux_executor_completed (&host) == 2,NULL);
+		VERIFY (away == 0,NULL);
+		io_linux_stop_executor (&host);
+
+		// throughput from one to four workers
+		task.work = 2000;
+		for (uint32_t workers = 1; workers <= 4; workers *= 2) {
+			uint32_t queued = 0,stolen = 0;
+			io_time_t begin,end;
+
+			runs = 0;
+			VERIFY (io_linux_start_executor (&host,workers,NULL),NULL);
+			begin = io_get_time (io);
+			while (io_linux_executor_completed (&host) < TEST_IO_LINUX_TASKS) {
+				while (queued < TEST_IO_LINUX_TASKS && io_enqueue_task (io,r_task)) {
+					queued ++;
+				}
+				while (io->events != &s_null_io_event) {
+					do_next_io_event (io);
+				}
+				if (io_linux_executor_in_flight (&host) > 0) {
+					io_wait_for_event (io);
+				}
+			}
+			end = io_get_time (io);
+
+			for (uint32_t i = 0; i < workers; i++) {
+				stolen += host.executor->workers[i].stolen;
+			}
+			io_log (
+				TEST_IO,IO_INFO_LOG_LEVEL,
+				"%-*s%-*s%u worker%s %lld tasks per second, %u stolen\n",
+				DBP_FIELD1,"",
+				DBP_FIELD2,"executor",
+				workers,plural(workers),
+				(TEST_IO_LINUX_TASKS * 1000000000LL) / (end.ns - begin.ns + 1),
+				stolen
+			);
+
+			VERIFY (runs == TEST_IO_LINUX_TASKS,NULL);
+			VERIFY (away > 0,NULL);
+			VERIFY (io_linux_executor_in_flight (&host) == 0,NULL);
+			io_linux_stop_executor (&host);
+		}
+
+		close_io_linux (&host);
+	}
+}
+TEST_END
+
+#define TEST_IO_LINUX_DMA_SIZE	0x10000
+
+typedef struct {
+	uint32_t complete;
+	uint32_t errors;
+} test_io_linux_dma_t;
+
+static void
+test_io_linux_dma_complete (io_event_t *ev) {
+	test_io_linux_dma_t *this = ev->user_value;
+	this->complete ++;
+}
+
+static void
+test_io_linux_dma_error (io_event_t *ev) {
+	test_io_linux_dma_t *this = ev->user_value;
+	this->errors ++;
+}
+
+static void
+test_io_linux_dma_wait (io_t *io,test_io_linux_dma_t *t,uint32_t complete,uint32_t errors) {
+	while (t->complete < complete || t->errors < errors) {
+		while (io->events != &s_null_io_event) {
+			do_next_io_event (io);
+		}
+		if (t->complete < complete || t->errors < errors) {
+			io_wait_for_event (io);
+		}
+	}
+}
+
+//
+// a chain of memory to memory descriptors copied by the worker thread
+//
+TEST_BEGIN(test_io_linux_dma_1) {
+	static uint8_t source[3][TEST_IO_LINUX_DMA_SIZE];
+	static uint8_t destination[3][TEST_IO_LINUX_DMA_SIZE];
+	test_io_linux_dma_t t = {0};
+	io_linux_dma_controller_t dmac;
+	io_software_dma_channel_t channel[3];
+	io_linux_t host;
+	io_t *io = initialise_io_linux (&host,&io_linux_implementation,0x4000,0);
+
+	if (VERIFY (io != NULL,NULL)) {
+		if (VERIFY (initialise_io_linux_dma_controller (&dmac,io,4096),NULL)) {
+			io_time_t begin,end;
+
+			for (int i = 0; i < SIZEOF(channel); i++) {
+				memset (source[i],i + 1,TEST_IO_LINUX_DMA_SIZE);
+				memset (destination[i],0,TEST_IO_LINUX_DMA_SIZE);
+				initialise_io_software_dma_channel (channel + i,(io_dma_controller_t*) &dmac,NULL);
+				initialise_io_event (&channel[i].complete,test_io_linux_dma_complete,&t);
+				initialise_io_event (&channel[i].error,test_io_linux_dma_error,&t);
+				io_software_dma_channel_load (
+					channel + i,IO_DMA_TRANSFER_MEMORY_TO_MEMORY,
+					destination[i],source[i],TEST_IO_LINUX_DMA_SIZE
+				);
+				if (i > 0) {
+					channel[i - 1].next_channel = (io_dma_channel_t*) (channel + i);
+				}
+			}
+
+			VERIFY (io_dma_controller_start_controller ((io_dma_controller_t*) &dmac),NULL);
+
+			begin = io_get_time (io);
+			VERIFY (
+				io_dma_controller_start_transfer (
+					(io_dma_controller_t*) &dmac,(io_dma_channel_t*) channel
+				),
+				NULL
+			);
+			test_io_linux_dma_wait (io,&t,SIZEOF(channel),0);
+			end = io_get_time (io);
+
+			io_log (
+				TEST_IO,IO_INFO_LOG_LEVEL,
+				"%-*s%-*s%u bytes in %lld ns\n",
+				DBP_FIELD1,"",
+				DBP_FIELD2,"dma",
+				io_software_dma_controller_bytes_transferred (&dmac),
+				end.ns - begin.ns
+			);
+
+			for (int i = 0; i < SIZEOF(channel); i++) {
+				VERIFY (memcmp (source[i],destination[i],TEST_IO_LINUX_DMA_SIZE) == 0,NULL);
+			}
+			VERIFY (io_software_dma_controller_descriptors_completed (&dmac) == SIZEOF(channel),NULL);
+			VERIFY (io_software_dma_controller_bytes_transferred (&dmac) == SIZEOF(channel) * TEST_IO_LINUX_DMA_SIZE,NULL);
+
+			// an invalid descriptor raises its error and abandons the chain
+			io_software_dma_channel_load (
+				channel,IO_DMA_TRANSFER_MEMORY_TO_MEMORY,destination[0],NULL,16
+			);
+			VERIFY (
+				io_dma_controller_start_transfer (
+					(io_dma_controller_t*) &dmac,(io_dma_channel_t*) channel
+				),
+				NULL
+			);
+			test_io_linux_dma_wait (io,&t,SIZEOF(channel),1);
+			VERIFY (io_software_dma_controller_errors (&dmac) == 1,NULL);
+			VERIFY (!io_software_dma_channel_is_busy (channel + 1),NULL);
+
+			close_io_linux_dma_controller (&dmac);
+		}
+		close_io_linux (&host);
+	}
+}
+TEST_END
+
+UNIT_SETUP(setup_io_linux_unit_test) {
+	return VERIFY_UNIT_CONTINUE;
+}
+
+UNIT_TEARDOWN(teardown_io_linux_unit_test) {
+}
+
+static void
+io_linux_unit_test (V_unit_test_t *unit) {
+	static V_test_t const tests[] = {
+		test_io_linux_latency_1,
+		test_io_linux_channel_1,
+		test_io_linux_tasks_1,
+		test_io_linux_dma_1,
+		0
+	};
+	unit->name = "io linux";
+	unit->description = "io linux host unit test";
+	unit->tests = tests;
+	unit->setup = setup_io_linux_unit_test;
+	unit->teardown = teardown_io_linux_unit_test;
+}
+
+void
+run_ut_io_linux (V_runner_t *runner) {
+	static const unit_test_t test_set[] = {
+		io_linux_unit_test,
+		0
+	};
+	V_run_unit_tests(runner,test_set);
+}
+
+#endif /* IMPLEMENT_VERIFY_IO_LINUX */
+#endif /* io_linux_H_ */
+/*
+------------------------------------------------------------------------------
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2020 Gregor Bruce
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+*/
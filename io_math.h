@@ -48,8 +48,10 @@ int64_t		read_le_int48 (uint8_t const*);
 uint64_t		read_le_uint48 (uint8_t const*);
 int64_t		read_le_int64 (uint8_t const*);
 float64_t	read_le_float64 (uint8_t const*);
+float32_t	read_le_float32 (uint8_t const*);
 float64_t	read_be_float64 (uint8_t const*);
 
+void			write_le_uint16 (uint8_t*,uint16_t);
 void			write_le_uint32 (uint8_t*,uint32_t);
 
 typedef int32_t	q32f31_t;
@@ -127,6 +129,16 @@ read_le_float64 (uint8_t const *ptr8) {
 	return conv.f;
 }
 
+float32_t
+read_le_float32 (uint8_t const *ptr8) {
+	union {
+		uint8_t b[4];
+		float32_t f;
+	} conv = {0};
+	memcpy (conv.b,ptr8,4);
+	return conv.f;
+}
+
 float64_t
 read_be_float64 (uint8_t const *ptr8) {
 	union {
@@ -144,6 +156,13 @@ read_be_float64 (uint8_t const *ptr8) {
 	return conv.f;
 }
 
+void
+write_le_uint16 (uint8_t *ptr,uint16_t value) {
+	*ptr++ = value;
+	value >>= 8;
+	*ptr++ = value;
+}
+
 void
 write_le_uint32 (uint8_t *ptr,uint32_t value) {
 	*ptr++ = value;
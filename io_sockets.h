@@ -141,10 +141,12 @@ typedef struct PACK_STRUCTURE io_settings {
 	io_socket_constructor_t make;
 	io_notify_event_t *notify;
 	uint32_t speed;
+	uint16_t mtu;
 } io_settings_t;
 
 #define io_settings_receive_pipe_length(c)	(c)->receive_pipe_length
 #define io_settings_transmit_pipe_length(c)	(c)->transmit_pipe_length
+#define io_settings_mtu(c)						(c)->mtu
 
 #define IO_SOCKET_IMPLEMENTATION_STRUCT_MEMBERS \
 	io_socket_implementation_t const *specialisation_of;\
@@ -562,6 +564,14 @@ typedef struct io_inner_constructor {
 	io_notify_event_t *notify;
 } io_inner_constructor_t;
 
+//
+// inner bindings share the outer socket's bandwidth in proportion
+// to their weights, a binding's transmit_finish is the virtual time
+// at which the message at the head of its transmit pipe finishes
+//
+#define IO_INNER_PORT_DEFAULT_WEIGHT		1
+#define IO_INNER_PORT_WEIGHT_SCALE			1024
+
 typedef struct io_inner_port io_inner_port_t;
 struct io_inner_port {
 	io_encoding_pipe_t *transmit_pipe;
@@ -569,6 +579,13 @@ struct io_inner_port {
 	io_event_t *tx_available;
 	io_event_t *rx_available;
 	io_event_list_t event_subscriptions;
+	uint32_t transmit_finish;
+	uint32_t transmit_bytes;
+	uint32_t transmit_packets;
+	uint32_t mtu;
+	uint16_t weight;
+	bool transmit_finish_is_valid;
+	io_link_header_template_t *link_header;
 };
 
 void free_io_inner_port (io_byte_memory_t*,io_inner_port_t*);
@@ -584,6 +601,10 @@ struct PACK_STRUCTURE io_inner_binding {
 #define io_inner_binding_receive_pipe(b)		io_inner_binding_port(b)->receive_pipe
 #define io_inner_binding_receive_event(b)		io_inner_binding_port(b)->rx_available
 #define io_inner_binding_transmit_event(b)	io_inner_binding_port(b)->tx_available
+#define io_inner_binding_weight(b)				io_inner_binding_port(b)->weight
+#define io_inner_binding_mtu(b)					io_inner_binding_port(b)->mtu
+#define io_inner_binding_transmit_bytes(b)	io_inner_binding_port(b)->transmit_bytes
+#define io_inner_binding_transmit_packets(b)	io_inner_binding_port(b)->transmit_packets
 
 //
 // multiplex socket
@@ -598,8 +619,11 @@ struct PACK_STRUCTURE io_inner_binding {
 	IO_COUNTED_SOCKET_STRUCT_MEMBERS \
 	io_inner_binding_t *slots; \
 	uint32_t number_of_slots; \
+	uint32_t *slot_index; \
+	uint32_t number_of_bound_slots; \
 	io_inner_constructor_bindings_t *inner_constructors;\
 	io_inner_binding_t *transmit_cursor; \
+	uint32_t transmit_virtual_time; \
 	uint16_t transmit_pipe_length; \
 	uint16_t receive_pipe_length; \
 	/**/
@@ -610,17 +634,25 @@ struct PACK_STRUCTURE io_multiplex_socket {
 
 #define io_multiplex_socket_has_inner_bindings(s) 	((s)->slots != NULL)
 
+//
+// slot_index holds the positions of the bound slots sorted by address
+// so a binding is found with a binary search
+//
+
 io_socket_t* allocate_io_multiplex_socket (io_t*,io_address_t);
 io_socket_t* initialise_io_multiplex_socket (io_socket_t*,io_t*,io_settings_t const*);
 void io_multiplex_socket_free (io_socket_t*);
 bool io_multiplex_socket_bind_inner (io_socket_t*,io_address_t,io_event_t*,io_event_t*);
+bool io_multiplex_socket_bind_inner_with_weight (io_socket_t*,io_address_t,io_event_t*,io_event_t*,uint16_t);
 bool io_multiplex_socket_set_inner_binding (io_socket_t*,io_address_t,io_event_t**,uint32_t);
 bool io_multiplex_socket_bind_inner_constructor (io_socket_t*,io_address_t,io_socket_constructor_t,io_notify_event_t*);
 void io_multiplex_socket_unbind_inner (io_socket_t*,io_address_t);
+bool io_multiplex_socket_set_inner_mtu (io_socket_t*,io_address_t,uint32_t);
 void io_multiplex_socket_round_robin_signal_transmit_available (io_multiplex_socket_t*);
 io_pipe_t* io_multiplex_socket_get_receive_pipe (io_socket_t*,io_address_t);
 io_inner_constructor_binding_t* io_multiplex_socket_find_inner_constructor_binding (io_multiplex_socket_t*,io_address_t);
 io_inner_binding_t* io_multiplex_socket_get_next_transmit_binding (io_multiplex_socket_t*);
+void io_multiplex_socket_transmit_complete (io_multiplex_socket_t*,io_inner_binding_t*);
 
 extern EVENT_DATA io_socket_implementation_t io_multiplex_socket_implementation;
 
@@ -672,6 +704,16 @@ void				close_io_multiplexer_socket (io_multiplexer_socket_t*);
 bool				io_multiplexer_socket_bind_to_outer (io_socket_t*,io_socket_t*);
 bool				io_multiplexer_socket_send_message (io_socket_t*,io_encoding_t*);
 size_t			io_multiplexer_socket_mtu (io_socket_t const*);
+uint32_t			io_multiplexer_socket_transmit_credit (io_socket_t*,io_address_t);
+void				io_multiplexer_socket_outer_transmit_event (io_event_t*);
+void				io_multiplexer_socket_outer_receive_event (io_event_t*);
+
+//
+// messages from an inner binding that the outer socket cannot take are
+// queued in the binding's transmit pipe and sent in weighted fair order
+// when the outer socket signals transmit available, the free slots in
+// the pipe are the binding's transmit credit
+//
 
 #define  SPECIALISE_IO_MULTIPLEXER_SOCKET_IMPLEMENTATION(S) \
 	SPECIALISE_IO_MULTIPLEX_SOCKET_IMPLEMENTATION (S)\
@@ -743,6 +785,8 @@ typedef struct PACK_STRUCTURE io_socket_emulator {
 	// events for single outter binding
 	io_event_t tx;
 	io_event_t rx;
+
+	uint32_t mtu;
 	
 } io_socket_emulator_t;
 
@@ -771,7 +815,9 @@ extern EVENT_DATA io_socket_implementation_t io_socket_emulator_implementation;
 	/**/
 
 //
-// emmulate a shared communication media
+// emmulate a shared communication media, messages are delivered to
+// every other attached socket as views of the sent bytes and the mtu
+// is the smallest mtu of the attached sockets
 //
 typedef struct PACK_STRUCTURE io_shared_media {
 	IO_MULTIPLEX_SOCKET_STRUCT_MEMBERS
@@ -779,6 +825,321 @@ typedef struct PACK_STRUCTURE io_shared_media {
 
 io_socket_t* allocate_io_shared_media (io_t*,io_address_t);
 
+extern EVENT_DATA io_socket_implementation_t io_shared_media_implementation;
+
+//
+// simulated media: a shared media where each delivery is scheduled on a
+// virtual clock after the message has been serialised at the link rate
+// plus a fixed latency and a random jitter (which reorders messages),
+// deliveries may be lost, the pseudo random sequence is seeded so every
+// run is the same
+//
+typedef struct PACK_STRUCTURE io_simulated_link {
+	io_time_t latency;
+	io_time_t jitter;
+	uint32_t bytes_per_second;		// zero for no limit
+	uint32_t loss_per_million;
+	uint32_t seed;
+} io_simulated_link_t;
+
+#define IO_SIMULATED_MEDIA_LATENCY_BUCKETS	16
+
+typedef struct PACK_STRUCTURE io_simulated_media_statistics {
+	uint32_t messages_sent;
+	uint32_t delivered;
+	uint32_t lost;
+	uint32_t overrun;
+	uint32_t bytes_delivered;
+	int64_t latency_min;
+	int64_t latency_max;
+	int64_t latency_total;
+	// bucket i counts latencies below 2^i microseconds, the last bucket
+	// counts all the longer ones
+	uint32_t latency[IO_SIMULATED_MEDIA_LATENCY_BUCKETS];
+} io_simulated_media_statistics_t;
+
+typedef struct PACK_STRUCTURE io_simulated_delivery {
+	io_time_t when;
+	io_time_t sent;
+	io_encoding_t *message;
+	uint32_t slot;
+	uint32_t sequence;
+} io_simulated_delivery_t;
+
+typedef struct PACK_STRUCTURE io_simulated_media {
+	IO_MULTIPLEX_SOCKET_STRUCT_MEMBERS
+	io_simulated_link_t link;
+	io_simulated_media_statistics_t statistics;
+	io_simulated_delivery_t *pending;
+	uint32_t number_of_pending;
+	uint32_t pending_size;
+	uint32_t sequence;
+	uint32_t random;
+	io_time_t now;
+	io_time_t busy_until;
+} io_simulated_media_t;
+
+io_socket_t* allocate_io_simulated_media (io_t*,io_address_t);
+void io_simulated_media_set_link (io_socket_t*,io_simulated_link_t const*);
+uint32_t io_simulated_media_run_until (io_socket_t*,io_time_t);
+uint32_t io_simulated_media_run (io_socket_t*);
+void io_simulated_media_reset_statistics (io_socket_t*);
+
+extern EVENT_DATA io_socket_implementation_t io_simulated_media_implementation;
+
+INLINE_FUNCTION io_simulated_media_t*
+cast_to_io_simulated_media (io_socket_t *socket) {
+	if (is_io_socket_of_type (socket,&io_simulated_media_implementation)) {
+		return (io_simulated_media_t*) socket;
+	} else {
+		return NULL;
+	}
+}
+
+#define io_simulated_media_time(s)				(s)->now
+#define io_simulated_media_statistics(s)		(&(s)->statistics)
+#define io_simulated_media_pending_count(s)	(s)->number_of_pending
+
+//
+// fragmentation
+//
+// A message that is longer than a socket's mtu is sent as a sequence of
+// fragments.  Each fragment carries the message id, its index, the number
+// of fragments and the offset of its content in the message.
+//
+//   encoder = mk_io_fragment_encoder (bm);
+//   io_fragment_encoder_begin (encoder,message);
+//   io_fragment_encoder_send (encoder,socket);
+//
+// and then on each of the socket's transmit available events:
+//
+//   if (io_fragment_encoder_send (encoder,socket)) {
+//      ... the message has been sent
+//   } else if (io_fragment_encoder_has_error (encoder)) {
+//      ... the message cannot be sent
+//   }
+//
+// A reassembler collects the fragments of up to IO_FRAGMENT_REASSEMBLY_SLOTS
+// messages into packet encodings.  A message is dropped if it is not complete
+// within the timeout or if its slot is needed to stay within the memory limit,
+// the oldest message is dropped first.
+//
+//   message = io_fragment_reassembler_receive (reassembler,fragment,now);
+//   if (message) {
+//      ...
+//      unreference_io_encoding (message);
+//   }
+//
+#define IO_FRAGMENT_MAXIMUM_COUNT			256
+#define IO_FRAGMENT_REASSEMBLY_SLOTS		4
+
+typedef struct PACK_STRUCTURE io_fragment_encoder {
+	io_byte_memory_t *bm;
+	io_encoding_t *message;
+	uint8_t const *content;
+	uint32_t length;
+	uint32_t offset;
+	uint32_t chunk;
+	uint16_t id;
+	uint16_t index;
+	uint16_t count;
+	bool error;
+} io_fragment_encoder_t;
+
+io_fragment_encoder_t* mk_io_fragment_encoder (io_byte_memory_t*);
+void free_io_fragment_encoder (io_fragment_encoder_t*);
+bool io_fragment_encoder_begin (io_fragment_encoder_t*,io_encoding_t*);
+void io_fragment_encoder_reset (io_fragment_encoder_t*);
+bool io_fragment_encoder_send (io_fragment_encoder_t*,io_socket_t*);
+
+#define io_fragment_encoder_has_error(e)		((e)->error)
+#define io_fragment_encoder_count(e)			((e)->count)
+#define io_fragment_encoder_chunk_size(e)		((e)->chunk)
+
+//
+// true when every fragment of the message has been sent
+//
+INLINE_FUNCTION bool
+io_fragment_encoder_is_complete (io_fragment_encoder_t const *this) {
+	return this->message == NULL;
+}
+
+typedef struct PACK_STRUCTURE io_fragment_reassembly {
+	io_encoding_t *message;
+	io_address_t source;
+	io_time_t started;
+	uint16_t id;
+	uint16_t count;
+	uint16_t received;
+	uint8_t have[IO_FRAGMENT_MAXIMUM_COUNT / 8];
+} io_fragment_reassembly_t;
+
+typedef struct PACK_STRUCTURE io_fragment_reassembler {
+	io_byte_memory_t *bm;
+	io_time_t timeout;
+	uint32_t memory_limit;
+	uint32_t memory_used;
+	uint32_t dropped;
+	io_fragment_reassembly_t slot[IO_FRAGMENT_REASSEMBLY_SLOTS];
+} io_fragment_reassembler_t;
+
+io_fragment_reassembler_t* mk_io_fragment_reassembler (io_byte_memory_t*,uint32_t,io_time_t);
+void free_io_fragment_reassembler (io_fragment_reassembler_t*);
+io_encoding_t* io_fragment_reassembler_receive (io_fragment_reassembler_t*,io_encoding_t*,io_time_t);
+uint32_t io_fragment_reassembler_expire (io_fragment_reassembler_t*,io_time_t);
+
+#define io_fragment_reassembler_memory_used(r)	((r)->memory_used)
+#define io_fragment_reassembler_dropped(r)		((r)->dropped)
+
+//
+// aggregation
+//
+// Coalesces small messages for one socket into aggregate frames.  A frame
+// is sent when the next record would not fit in the socket's mtu, when
+// io_aggregator_flush is called or when the delay after its first record
+// has passed.  Records larger than a frame are refused and should be sent
+// directly.
+//
+//   aggregator = mk_io_aggregator (socket,millisecond_time (2));
+//   io_aggregator_append (aggregator,bytes,size);
+//
+// The receive side steps over the records of a frame in place:
+//
+//   layer = push_io_aggregate_receive_layer (message);
+//   io_layer_get_content (layer,message,&cursor,&end);
+//   while ((cursor = io_aggregate_next_record (cursor,end,&record,&size))) {
+//      ...
+//   }
+//
+typedef struct PACK_STRUCTURE io_aggregator {
+	io_socket_t *socket;
+	io_encoding_t *message;
+	io_layer_t *layer;
+	io_time_t delay;
+	io_event_t flush_event;
+	io_alarm_t flush_alarm;
+	uint32_t frames_sent;
+	uint32_t records_sent;
+	uint32_t records_dropped;
+} io_aggregator_t;
+
+io_aggregator_t* mk_io_aggregator (io_socket_t*,io_time_t);
+void free_io_aggregator (io_aggregator_t*);
+bool io_aggregator_append (io_aggregator_t*,uint8_t const*,uint32_t);
+bool io_aggregator_flush (io_aggregator_t*);
+
+#define io_aggregator_frames_sent(a)		((a)->frames_sent)
+#define io_aggregator_records_sent(a)		((a)->records_sent)
+#define io_aggregator_records_dropped(a)	((a)->records_dropped)
+
+INLINE_FUNCTION bool
+io_aggregator_append_encoding (io_aggregator_t *this,io_encoding_t *encoding) {
+	uint8_t const *begin,*end;
+	io_encoding_get_content (encoding,&begin,&end);
+	return io_aggregator_append (this,begin,end - begin);
+}
+
+//
+// reliable socket: ordered delivery over an unreliable outer socket
+//
+//		v
+//    |
+//    r
+//    |
+//    o
+//
+// Messages are numbered and kept until they are acknowledged.  The
+// receiver acknowledges every data message with its next expected number
+// and selective acknowledgements of what it holds beyond it.  Lost messages
+// are sent again after a retransmit timeout derived from the round trip time
+// or when selective acknowledgements show a hole.  The number of messages
+// in flight is limited by a congestion window and by the peer's receive
+// window.
+//
+// The socket's address is the address of its peer on the outer socket.
+//
+#define IO_RELIABLE_WINDOW					32
+#define IO_RELIABLE_INITIAL_RTO			millisecond_time (100)
+#define IO_RELIABLE_MINIMUM_RTO			millisecond_time (5)
+#define IO_RELIABLE_MAXIMUM_RTO			second_time (4)
+#define IO_RELIABLE_DUPLICATE_THRESHOLD	3
+
+typedef io_time_t (*io_reliable_clock_t) (void*);
+
+typedef struct PACK_STRUCTURE io_reliable_segment {
+	io_encoding_t *message;
+	io_time_t sent;
+	uint8_t transmissions;
+	bool sacked;
+} io_reliable_segment_t;
+
+typedef struct PACK_STRUCTURE io_reliable_statistics {
+	uint32_t segments_sent;
+	uint32_t retransmissions;
+	uint32_t fast_retransmissions;
+	uint32_t timeouts;
+	uint32_t acknowledgements_sent;
+	uint32_t duplicates_received;
+	uint32_t delivered;
+} io_reliable_statistics_t;
+
+#define IO_RELIABLE_SOCKET_STRUCT_MEMBERS \
+	IO_COUNTED_SOCKET_STRUCT_MEMBERS \
+	io_event_t *transmit_available; \
+	io_event_t *receive_data_available; \
+	io_socket_t *outer_socket; \
+	io_event_t outer_transmit_event; \
+	io_event_t outer_receive_event; \
+	io_event_t timer_event; \
+	io_alarm_t timer; \
+	io_time_t timer_due; \
+	bool timer_is_running; \
+	io_reliable_clock_t clock; \
+	void *clock_user_value; \
+	io_encoding_pipe_t *receive_pipe; \
+	uint32_t send_base; \
+	uint32_t send_next; \
+	uint32_t transmit_next; \
+	uint32_t recover; \
+	bool in_recovery; \
+	uint32_t duplicates; \
+	uint32_t congestion_window; \
+	uint32_t congestion_count; \
+	uint32_t slow_start_threshold; \
+	uint32_t peer_window; \
+	int64_t smoothed_rtt; \
+	int64_t rtt_variance; \
+	int64_t rto; \
+	io_reliable_segment_t segment[IO_RELIABLE_WINDOW]; \
+	uint32_t receive_next; \
+	bool acknowledgement_pending; \
+	io_encoding_t *reorder[IO_RELIABLE_WINDOW]; \
+	io_reliable_statistics_t statistics; \
+	/**/
+
+typedef struct PACK_STRUCTURE io_reliable_socket {
+	IO_RELIABLE_SOCKET_STRUCT_MEMBERS
+} io_reliable_socket_t;
+
+io_socket_t* allocate_io_reliable_socket (io_t*,io_address_t);
+void io_reliable_socket_set_clock (io_socket_t*,io_reliable_clock_t,void*);
+void io_reliable_socket_poll (io_socket_t*);
+
+extern EVENT_DATA io_socket_implementation_t io_reliable_socket_implementation;
+
+INLINE_FUNCTION io_reliable_socket_t*
+cast_to_io_reliable_socket (io_socket_t *socket) {
+	if (is_io_socket_of_type (socket,&io_reliable_socket_implementation)) {
+		return (io_reliable_socket_t*) socket;
+	} else {
+		return NULL;
+	}
+}
+
+#define io_reliable_socket_statistics(s)		(&(s)->statistics)
+#define io_reliable_socket_unacknowledged(s)	((s)->send_next - (s)->send_base)
+#define io_reliable_socket_rto(s)				((s)->rto)
+
 INLINE_FUNCTION void
 free_io_sockets (io_socket_t **cursor,io_socket_t **end) {
 	while (cursor < end) {
@@ -1748,6 +2109,13 @@ mk_io_inner_port (io_byte_memory_t *bm,uint16_t tx_length,uint16_t rx_length) {
 		initialise_io_event_list (&this->event_subscriptions,bm);
 		this->tx_available = NULL;
 		this->rx_available = NULL;
+		this->transmit_finish = 0;
+		this->transmit_bytes = 0;
+		this->transmit_packets = 0;
+		this->mtu = 0;
+		this->weight = IO_INNER_PORT_DEFAULT_WEIGHT;
+		this->transmit_finish_is_valid = false;
+		this->link_header = NULL;
 		this->transmit_pipe = mk_io_encoding_pipe (bm,tx_length);
 		if (this->transmit_pipe == NULL) {
 			goto nope;
@@ -1770,6 +2138,10 @@ free_io_inner_port (io_byte_memory_t *bm,io_inner_port_t *this) {
 	free_io_encoding_pipe (this->transmit_pipe,bm);
 	free_io_encoding_pipe (this->receive_pipe,bm);
 	io_event_list_reset (&this->event_subscriptions);
+	if (this->link_header != NULL) {
+		free_io_link_header_template (bm,this->link_header);
+		io_byte_memory_free (bm,this->link_header);
+	}
 	io_byte_memory_free (bm,this);
 }
 
@@ -1790,7 +2162,10 @@ initialise_io_multiplex_socket (io_socket_t *socket,io_t *io,io_settings_t const
 
 	this->slots = NULL;
 	this->number_of_slots = 0;
+	this->slot_index = NULL;
+	this->number_of_bound_slots = 0;
 	this->transmit_cursor = this->slots;
+	this->transmit_virtual_time = 0;
 	this->transmit_pipe_length = io_settings_transmit_pipe_length(C);
 	this->receive_pipe_length = io_settings_receive_pipe_length(C);
 	this->inner_constructors = mk_io_inner_constructor_bindings(io);
@@ -1814,8 +2189,11 @@ io_multiplex_socket_free (io_socket_t *socket) {
 			cursor++;
 		}
 		io_byte_memory_free (bm,this->slots);
+		io_byte_memory_free (bm,this->slot_index);
 		this->slots = NULL,
 		this->number_of_slots = 0;
+		this->slot_index = NULL;
+		this->number_of_bound_slots = 0;
 		this->transmit_cursor = this->slots;
 	}
 	
@@ -1824,23 +2202,79 @@ io_multiplex_socket_free (io_socket_t *socket) {
 	io_counted_socket_free (socket);
 }
 
+//
+// binary search of the slot index, returns true if found and sets
+// *at to the position of the address in the index or where it
+// should be inserted
+//
+static bool
+io_multiplex_socket_search_slot_index (
+	io_multiplex_socket_t *this,io_address_t address,uint32_t *at
+) {
+	uint32_t low = 0,high = this->number_of_bound_slots;
+
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		int32_t cmp = compare_io_addresses (
+			this->slots[this->slot_index[mid]].address,address
+		);
+		if (cmp == 0) {
+			*at = mid;
+			return true;
+		} else if (cmp < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	*at = low;
+	return false;
+}
+
+static void
+io_multiplex_socket_index_slot (io_multiplex_socket_t *this,io_inner_binding_t *inner) {
+	uint32_t at;
+	if (
+			io_address_is_valid (inner->address)
+		&&	!io_multiplex_socket_search_slot_index (this,inner->address,&at)
+	) {
+		memmove (
+			this->slot_index + at + 1,
+			this->slot_index + at,
+			sizeof(uint32_t) * (this->number_of_bound_slots - at)
+		);
+		this->slot_index[at] = inner - this->slots;
+		this->number_of_bound_slots++;
+	}
+}
+
+static void
+io_multiplex_socket_unindex_slot (io_multiplex_socket_t *this,io_address_t address) {
+	uint32_t at;
+	if (io_multiplex_socket_search_slot_index (this,address,&at)) {
+		this->number_of_bound_slots--;
+		memmove (
+			this->slot_index + at,
+			this->slot_index + at + 1,
+			sizeof(uint32_t) * (this->number_of_bound_slots - at)
+		);
+	}
+}
+
 io_inner_binding_t*
 io_multiplex_socket_find_inner_binding (
 	io_multiplex_socket_t *this,io_address_t sa
 ) {
-	io_inner_binding_t *remote = NULL;
-	io_inner_binding_t *cursor = this->slots;
-	io_inner_binding_t *end = cursor + this->number_of_slots;
-	
-	while (cursor < end) {
-		if (compare_io_addresses (cursor->address,sa) == 0) {
-			remote = cursor;
-			break;
-		}
-		cursor++;
+	uint32_t at;
+	if (
+			io_address_is_valid (sa)
+		&&	io_multiplex_socket_search_slot_index (this,sa,&at)
+	) {
+		return this->slots + this->slot_index[at];
+	} else {
+		return NULL;
 	}
-	
-	return remote;
 }
 
 io_pipe_t*
@@ -1859,6 +2293,11 @@ io_multiplex_socket_get_free_binding (io_multiplex_socket_t *this) {
 	io_inner_binding_t *cursor = this->slots;
 	io_inner_binding_t *end = cursor + this->number_of_slots;
 	
+	if (this->number_of_bound_slots == this->number_of_slots) {
+		// every slot is bound
+		return NULL;
+	}
+
 	while (cursor < end) {
 		if (io_address_is_invalid (cursor->address)) {
 			return cursor;
@@ -1894,9 +2333,17 @@ io_multiplex_socket_get_inner_binding (
 			this->receive_pipe_length
 		);
 		if (p != NULL) {
-			io_inner_binding_t *more = io_byte_memory_reallocate (
-				bm,this->slots,sizeof(io_inner_binding_t) * (this->number_of_slots + 1)
+			p->transmit_finish = this->transmit_virtual_time;
+			uint32_t *index = io_byte_memory_reallocate (
+				bm,this->slot_index,sizeof(uint32_t) * (this->number_of_slots + 1)
 			);
+			io_inner_binding_t *more = NULL;
+			if (index != NULL) {
+				this->slot_index = index;
+				more = io_byte_memory_reallocate (
+					bm,this->slots,sizeof(io_inner_binding_t) * (this->number_of_slots + 1)
+				);
+			}
 			if (more != NULL) {
 				this->transmit_cursor = (more + (this->transmit_cursor - this->slots));
 				this->slots = more;
@@ -1905,9 +2352,16 @@ io_multiplex_socket_get_inner_binding (
 				};
 				inner = this->slots + this->number_of_slots;
 				this->number_of_slots++;
+				io_multiplex_socket_index_slot (this,inner);
+			} else {
+				free_io_inner_port (bm,p);
 			}
 		}
 	} else {
+		assign_io_address (
+			io_get_byte_memory (io_socket_io (this)),&inner->address,address
+		);
+		io_multiplex_socket_index_slot (this,inner);
 		goto reset;
 	}
 
@@ -1917,6 +2371,12 @@ reset:
 	io_event_list_reset (&inner->port->event_subscriptions);
 	reset_io_encoding_pipe (inner->port->transmit_pipe);
 	reset_io_encoding_pipe (inner->port->receive_pipe);
+	inner->port->transmit_bytes = 0;
+	inner->port->transmit_packets = 0;
+	inner->port->weight = IO_INNER_PORT_DEFAULT_WEIGHT;
+	inner->port->mtu = 0;
+	inner->port->transmit_finish = this->transmit_virtual_time;
+	inner->port->transmit_finish_is_valid = false;
 	return inner;
 }
 
@@ -1924,13 +2384,29 @@ bool
 io_multiplex_socket_bind_inner (
 	io_socket_t *socket,io_address_t address,io_event_t *tx,io_event_t *rx
 ) {
-	io_multiplex_socket_t *this = (io_multiplex_socket_t*) socket;
-	io_inner_binding_t *inner = io_multiplex_socket_get_inner_binding (
-		this,address
+	return io_multiplex_socket_bind_inner_with_weight (
+		socket,address,tx,rx,IO_INNER_PORT_DEFAULT_WEIGHT
 	);
+}
+
+//
+// a binding with weight w gets w times the bandwidth of a binding
+// with weight 1 when both have messages waiting
+//
+bool
+io_multiplex_socket_bind_inner_with_weight (
+	io_socket_t *socket,io_address_t address,io_event_t *tx,io_event_t *rx,uint16_t weight
+) {
+	io_multiplex_socket_t *this = (io_multiplex_socket_t*) socket;
+	io_inner_binding_t *inner = NULL;
+
+	if (weight > 0) {
+		inner = io_multiplex_socket_get_inner_binding (this,address);
+	}
 
 	if (inner != NULL) {
 		io_inner_port_t *port = inner->port;
+		port->weight = weight;
 		if(port->tx_available != NULL) {
 			io_dequeue_event (io_socket_io (socket),port->tx_available);
 		}
@@ -2015,12 +2491,32 @@ io_multiplex_socket_unbind_inner (io_socket_t *socket,io_address_t address) {
 			port->rx_available = NULL;
 		}
 		io_event_list_reset (&port->event_subscriptions);
+		reset_io_encoding_pipe (port->transmit_pipe);
+		io_multiplex_socket_unindex_slot (this,address);
 		assign_io_address (
 			io_socket_byte_memory (socket),&inner->address,io_invalid_address()
 		);
 	}
 }
 
+//
+// record the largest message an inner socket can take
+//
+bool
+io_multiplex_socket_set_inner_mtu (
+	io_socket_t *socket,io_address_t address,uint32_t mtu
+) {
+	io_inner_binding_t *inner = io_multiplex_socket_find_inner_binding (
+		(io_multiplex_socket_t*) socket,address
+	);
+	if (inner != NULL) {
+		inner->port->mtu = mtu;
+		return true;
+	} else {
+		return false;
+	}
+}
+
 INLINE_FUNCTION void
 io_multiplex_socket_increment_transmit_cursor (io_multiplex_socket_t *this) {
 	this->transmit_cursor ++;
@@ -2029,24 +2525,103 @@ io_multiplex_socket_increment_transmit_cursor (io_multiplex_socket_t *this) {
 	}
 }
 
+static bool
+io_multiplex_socket_has_transmit_backlog (io_multiplex_socket_t *this) {
+	io_inner_binding_t *cursor = this->slots;
+	io_inner_binding_t *end = cursor + this->number_of_slots;
+	while (cursor < end) {
+		if (io_encoding_pipe_is_readable (cursor->port->transmit_pipe)) {
+			return true;
+		}
+		cursor++;
+	}
+	return false;
+}
+
+//
+// virtual times wrap so they are compared by difference
+//
+INLINE_FUNCTION bool
+io_inner_port_virtual_time_is_before (uint32_t a,uint32_t b) {
+	return (int32_t) (a - b) < 0;
+}
+
+static void
+io_multiplex_socket_tag_transmit_head (
+	io_multiplex_socket_t *this,io_inner_port_t *port
+) {
+	io_encoding_t *next;
+	if (io_encoding_pipe_peek (port->transmit_pipe,&next)) {
+		if (!port->transmit_finish_is_valid) {
+			uint32_t start = port->transmit_finish;
+			if (io_inner_port_virtual_time_is_before (start,this->transmit_virtual_time)) {
+				start = this->transmit_virtual_time;
+			}
+			port->transmit_finish = start + (
+				(io_encoding_length (next) * IO_INNER_PORT_WEIGHT_SCALE) / port->weight
+			);
+			port->transmit_finish_is_valid = true;
+		}
+	} else {
+		// an idle binding keeps no claim on the bandwidth
+		port->transmit_finish = this->transmit_virtual_time;
+		port->transmit_finish_is_valid = false;
+	}
+}
+
+//
+// self-clocked fair queueing: the next message is the waiting message with
+// the earliest finish time, ties are broken round robin from the cursor
+//
 io_inner_binding_t*
 io_multiplex_socket_get_next_transmit_binding (io_multiplex_socket_t *this) {	
+	io_inner_binding_t *next = NULL;
+
 	if (io_multiplex_socket_has_inner_bindings (this)) {
 		io_inner_binding_t *at = this->transmit_cursor;
 		do {
 			io_multiplex_socket_increment_transmit_cursor (this);
+			io_inner_port_t *port = this->transmit_cursor->port;
+
+			io_multiplex_socket_tag_transmit_head (this,port);
 			if (
-				io_encoding_pipe_is_readable (
-					this->transmit_cursor->port->transmit_pipe
-				)
+					port->transmit_finish_is_valid
+				&&	(
+							next == NULL
+						||	io_inner_port_virtual_time_is_before (
+								port->transmit_finish,next->port->transmit_finish
+							)
+					)
 			) {
-				return this->transmit_cursor;
+				next = this->transmit_cursor;
 			}
 
 		} while (this->transmit_cursor != at);
+
+		if (next != NULL) {
+			this->transmit_cursor = next;
+		}
 	}
 	
-	return NULL;
+	return next;
+}
+
+//
+// the message at the head of the binding's transmit pipe has been sent
+//
+void
+io_multiplex_socket_transmit_complete (
+	io_multiplex_socket_t *this,io_inner_binding_t *inner
+) {
+	io_inner_port_t *port = inner->port;
+	io_encoding_t *sent;
+	if (io_encoding_pipe_peek (port->transmit_pipe,&sent)) {
+		port->transmit_bytes += io_encoding_length (sent);
+		port->transmit_packets ++;
+		this->transmit_virtual_time = port->transmit_finish;
+		port->transmit_finish_is_valid = false;
+		io_encoding_pipe_pop_encoding (port->transmit_pipe);
+	}
 }
 
 //
@@ -2092,12 +2667,19 @@ io_socket_t*
 initialise_io_multiplexer_socket (io_socket_t *socket,io_t *io,io_settings_t const *C) {
 	io_multiplexer_socket_t *this = (io_multiplexer_socket_t*) socket;
 	initialise_io_multiplex_socket (socket,io,C);
+	initialise_io_event (
+		&this->transmit_event,io_multiplexer_socket_outer_transmit_event,this
+	);
+	initialise_io_event (
+		&this->receive_event,io_multiplexer_socket_outer_receive_event,this
+	);
 	this->outer_socket = NULL;
 	return socket;
 }
 
 void
 io_multiplexer_socket_free (io_socket_t *socket) {
+	close_io_multiplexer_socket ((io_multiplexer_socket_t*) socket);
 	io_multiplex_socket_free (socket);
 }
 
@@ -2123,18 +2705,56 @@ io_multiplexer_socket_bind_to_outer (io_socket_t *socket,io_socket_t *outer) {
 	return true;
 }
 
+//
+// the inner binding that sent a message is found from the destination
+// or inner address of the message's outermost layer
+//
+static io_inner_binding_t*
+io_multiplexer_socket_select_transmit_binding (
+	io_multiplexer_socket_t *this,io_encoding_t *encoding
+) {
+	io_layer_t *base = io_encoding_get_outermost_layer (encoding);
+	io_inner_binding_t *inner = NULL;
+	if (base) {
+		inner = io_multiplex_socket_find_inner_binding (
+			(io_multiplex_socket_t*) this,
+			io_layer_get_destination_address (base,encoding)
+		);
+		if (inner == NULL) {
+			inner = io_multiplex_socket_find_inner_binding (
+				(io_multiplex_socket_t*) this,
+				io_layer_get_inner_address (base,encoding)
+			);
+		}
+	}
+	return inner;
+}
+
+//
+// returns false only if the message is dropped, which for a message
+// from an inner binding means the binding had no transmit credit
+//
 bool
 io_multiplexer_socket_send_message (io_socket_t *socket,io_encoding_t *encoding) {
 	io_multiplexer_socket_t *this = (io_multiplexer_socket_t*) socket;
 	bool ok = false;
 
 	if (this->outer_socket != NULL) {
-		ok = io_socket_send_message (this->outer_socket,encoding);
-		
-		if (!ok) {
-			// try to queue, but this socket needs a reference to its layer implementation
-			// (or a bool (*) (io_encoding_t*) pointer) so we can get binding address from
-			// encoding
+		io_inner_binding_t *inner = io_multiplexer_socket_select_transmit_binding (
+			this,encoding
+		);
+		if (inner == NULL) {
+			ok = io_socket_send_message (this->outer_socket,encoding);
+		} else if (
+				!io_multiplex_socket_has_transmit_backlog ((io_multiplex_socket_t*) this)
+			&&	io_socket_send_message (this->outer_socket,encoding)
+		) {
+			inner->port->transmit_bytes += io_encoding_length (encoding);
+			inner->port->transmit_packets ++;
+			ok = true;
+		} else {
+			// queue behind the messages already waiting
+			ok = io_encoding_pipe_put_encoding (inner->port->transmit_pipe,encoding);
 		}
 	}
 	
@@ -2142,6 +2762,42 @@ io_multiplexer_socket_send_message (io_socket_t *socket,io_encoding_t *encoding)
 	return ok;
 }
 
+uint32_t
+io_multiplexer_socket_transmit_credit (io_socket_t *socket,io_address_t address) {
+	io_inner_binding_t *inner = io_multiplex_socket_find_inner_binding (
+		(io_multiplex_socket_t*) socket,address
+	);
+	if (inner != NULL) {
+		return io_encoding_pipe_count_free_slots (inner->port->transmit_pipe);
+	} else {
+		return 0;
+	}
+}
+
+//
+// drain the inner transmit pipes in weighted fair order until the outer
+// socket refuses, then let the inner sockets send more
+//
+void
+io_multiplexer_socket_outer_transmit_event (io_event_t *ev) {
+	io_multiplexer_socket_t *this = ev->user_value;
+	io_multiplex_socket_t *mux = (io_multiplex_socket_t*) this;
+	
+	if (this->outer_socket && io_multiplex_socket_has_inner_bindings (mux)) {
+		io_inner_binding_t *inner;
+		while ((inner = io_multiplex_socket_get_next_transmit_binding (mux)) != NULL) {
+			io_encoding_t *next;
+			io_encoding_pipe_peek (inner->port->transmit_pipe,&next);
+			if (io_socket_send_message (this->outer_socket,next)) {
+				io_multiplex_socket_transmit_complete (mux,inner);
+			} else {
+				break;
+			}
+		}
+		io_multiplex_socket_round_robin_signal_transmit_available (mux);
+	}
+}
+
 size_t
 io_multiplexer_socket_mtu (io_socket_t const *socket) {
 	io_multiplexer_socket_t const *this = (io_multiplexer_socket_t const*) socket;
@@ -2164,7 +2820,9 @@ io_multiplexer_socket_outer_receive_event (io_event_t *ev) {
 		);
 		if (rx) {
 			io_encoding_t *next;
-			if (io_encoding_pipe_peek (rx,&next)) {
+			// the outer socket signals once for any number of
+			// messages so take every message now
+			while (io_encoding_pipe_peek (rx,&next)) {
 				io_layer_t *base = io_encoding_get_outermost_layer (next);
 				if (base) {
 					io_inner_binding_t *inner = io_layer_select_inner_binding (
@@ -2191,10 +2849,6 @@ EVENT_DATA io_socket_implementation_t io_multiplexer_socket_implementation = {
 //
 // socket emulator
 //
-static void	
-io_socket_emulator_tx_event (io_event_t *ev) {
-}
-
 io_socket_t*
 io_socket_emulator_initialise (io_socket_t *socket,io_t *io,io_settings_t const *C) {
 	io_socket_emulator_t *this = (io_socket_emulator_t*) socket;
@@ -2202,18 +2856,27 @@ io_socket_emulator_initialise (io_socket_t *socket,io_t *io,io_settings_t const
 	initialise_io_multiplexer_socket (socket,io,C);
 
 	initialise_io_event (
-		&this->tx,io_socket_emulator_tx_event,this
+		&this->tx,io_multiplexer_socket_outer_transmit_event,this
 	);
 	
 	initialise_io_event (
 		&this->rx,io_multiplexer_socket_outer_receive_event,this
 	);
 
+	if (C != NULL && io_settings_mtu (C) > 0) {
+		this->mtu = io_settings_mtu (C);
+	} else {
+		this->mtu = IO_SOCKET_MINIMUM_MTU;
+	}
+
 	return socket;
 }
 
 void
 io_socket_emulator_free (io_socket_t *socket) {
+	io_socket_emulator_t *this = (io_socket_emulator_t*) socket;
+	io_dequeue_event (io_socket_io (socket),&this->tx);
+	io_dequeue_event (io_socket_io (socket),&this->rx);
 	io_multiplexer_socket_free (socket);
 }
 
@@ -2236,14 +2899,26 @@ bool
 io_socket_emulator_bind_to_outer_socket (io_socket_t *socket,io_socket_t *outer) {
 	io_socket_emulator_t *this = (io_socket_emulator_t*) socket;
 	this->outer_socket = outer;
-	return io_socket_bind_inner (
-		this->outer_socket,io_socket_address(socket),&this->tx,&this->rx
-	);
+	if (
+		io_socket_bind_inner (
+			this->outer_socket,io_socket_address(socket),&this->tx,&this->rx
+		)
+	) {
+		if (cast_to_io_multiplex_socket (outer) != NULL) {
+			io_multiplex_socket_set_inner_mtu (
+				outer,io_socket_address(socket),this->mtu
+			);
+		}
+		return true;
+	} else {
+		return false;
+	}
 }
 
 size_t
 io_socket_emulator_mtu (io_socket_t const *socket) {
-	return 0;
+	io_socket_emulator_t const *this = (io_socket_emulator_t const*) socket;
+	return this->mtu;
 }
 
 EVENT_DATA io_socket_implementation_t io_socket_emulator_implementation = {
@@ -2325,11 +3000,43 @@ io_socket_emulator_new_link_message (io_socket_t *socket) {
 	return message;
 }
 
+//
+// the header of a message from an inner binding is loaded from the
+// binding's header template
+//
+static bool
+io_socket_emulator_load_link_header (
+	io_socket_t *socket,io_layer_t *layer,io_encoding_t *encoding
+) {
+	io_inner_binding_t *inner = io_multiplexer_socket_select_transmit_binding (
+		(io_multiplexer_socket_t*) socket,encoding
+	);
+
+	if (inner != NULL) {
+		io_inner_port_t *port = inner->port;
+		if (port->link_header == NULL) {
+			port->link_header = io_byte_memory_allocate (
+				io_socket_byte_memory (socket),sizeof(io_link_header_template_t)
+			);
+			if (port->link_header != NULL) {
+				initialise_io_link_header_template (port->link_header);
+			}
+		}
+		if (port->link_header != NULL) {
+			return io_link_layer_load_header_from_template (
+				layer,encoding,port->link_header
+			);
+		}
+	}
+
+	return io_layer_load_header (layer,encoding);
+}
+
 static bool
 io_socket_emulator_send_link_message (io_socket_t *socket,io_encoding_t *encoding) {
 	io_layer_t *layer = get_io_link_layer (encoding);
 	if (layer) {
-		io_layer_load_header (layer,encoding);
+		io_socket_emulator_load_link_header (socket,layer,encoding);
 		return io_multiplexer_socket_send_message (socket,encoding);
 	} else {
 		unreference_io_encoding (encoding);
@@ -2407,13 +3114,18 @@ io_packet_encoding_copy (io_encoding_t *source_encoding) {
 	return copy;
 }
 
+//
+// all receivers share one view of the sent bytes
+//
 static io_encoding_t*
-io_shared_media_make_receive_copy (io_packet_encoding_t *source_encoding) {
-	io_layer_t *base = io_encoding_get_outermost_layer ((io_encoding_t*) source_encoding);
+io_shared_media_make_receive_view (io_encoding_t *source_encoding) {
+	io_layer_t *base = io_encoding_get_outermost_layer (source_encoding);
 	if (base) {
-		io_encoding_t *copy = io_packet_encoding_copy ((io_encoding_t*) source_encoding);
-		io_layer_push_receive_layer (base,copy);
-		return copy;
+		io_encoding_t *view = mk_io_packet_view_encoding (source_encoding);
+		if (view) {
+			io_layer_push_receive_layer (base,view);
+		}
+		return view;
 	} else {
 		return NULL;
 	}
@@ -2433,8 +3145,10 @@ io_shared_media_send_message (io_socket_t *socket,io_encoding_t *encoding) {
 		io_encoding_t *receive_message = NULL;
 		
 		if (cursor != end) {
-			//
-			receive_message = io_shared_media_make_receive_copy ((io_packet_encoding_t*) encoding);
+			receive_message = io_shared_media_make_receive_view (encoding);
+			if (receive_message == NULL) {
+				return false;
+			}
 			reference_io_encoding (receive_message);
 		}
 
@@ -2460,12 +3174,28 @@ io_shared_media_send_message (io_socket_t *socket,io_encoding_t *encoding) {
 	return true;
 }
 
+//
+// minimum mtu of all attached sockets, zero if none are known
+//
 static size_t
 io_shared_media_mtu (io_socket_t const *socket) {
-	//
-	// minimum mtu of all attached sockets
-	//
-	return 0;
+	io_multiplex_socket_t const *this = (io_multiplex_socket_t const*) socket;
+	io_inner_binding_t const *cursor = this->slots;
+	io_inner_binding_t const *end = cursor + this->number_of_slots;
+	uint32_t mtu = 0;
+
+	while (cursor < end) {
+		if (
+				!io_address_is_invalid (cursor->address)
+			&&	cursor->port->mtu > 0
+			&&	(mtu == 0 || cursor->port->mtu < mtu)
+		) {
+			mtu = cursor->port->mtu;
+		}
+		cursor++;
+	}
+
+	return mtu;
 }
 
 //
@@ -2494,6 +3224,1537 @@ allocate_io_shared_media (io_t *io,io_address_t address) {
 	return socket;
 }
 
+//
+// simulated media
+//
+static void
+io_simulated_media_reset_link (io_simulated_media_t *this) {
+	this->random = (this->link.seed != 0) ? this->link.seed : 1;
+	this->now = time_zero();
+	this->busy_until = time_zero();
+}
+
+static io_socket_t*
+io_simulated_media_initialise (io_socket_t *socket,io_t *io,io_settings_t const *C) {
+	io_simulated_media_t *this = (io_simulated_media_t*) socket;
+	initialise_io_multiplex_socket (socket,io,C);
+	this->link = (io_simulated_link_t) {
+		.latency = time_zero(),
+		.jitter = time_zero(),
+		.bytes_per_second = 0,
+		.loss_per_million = 0,
+		.seed = 1,
+	};
+	this->pending = NULL;
+	this->number_of_pending = 0;
+	this->pending_size = 0;
+	this->sequence = 0;
+	io_simulated_media_reset_link (this);
+	io_simulated_media_reset_statistics (socket);
+	return socket;
+}
+
+static void
+io_simulated_media_free (io_socket_t *socket) {
+	io_simulated_media_t *this = (io_simulated_media_t*) socket;
+	io_simulated_delivery_t *cursor = this->pending;
+	io_simulated_delivery_t *end = cursor + this->number_of_pending;
+	while (cursor < end) {
+		unreference_io_encoding (cursor->message);
+		cursor++;
+	}
+	io_byte_memory_free (io_socket_byte_memory (socket),this->pending);
+	io_multiplex_socket_free (socket);
+}
+
+void
+io_simulated_media_set_link (io_socket_t *socket,io_simulated_link_t const *link) {
+	io_simulated_media_t *this = (io_simulated_media_t*) socket;
+	this->link = *link;
+	io_simulated_media_reset_link (this);
+}
+
+void
+io_simulated_media_reset_statistics (io_socket_t *socket) {
+	io_simulated_media_t *this = (io_simulated_media_t*) socket;
+	memset (&this->statistics,0,sizeof(io_simulated_media_statistics_t));
+}
+
+//
+// xorshift32
+//
+static uint32_t
+io_simulated_media_next_random (io_simulated_media_t *this) {
+	uint32_t x = this->random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	this->random = x;
+	return x;
+}
+
+//
+// pending deliveries are a binary heap ordered by time then by the
+// order they were scheduled
+//
+INLINE_FUNCTION bool
+io_simulated_delivery_is_before (
+	io_simulated_delivery_t const *a,io_simulated_delivery_t const *b
+) {
+	return (
+			a->when.ns < b->when.ns
+		||	(a->when.ns == b->when.ns && (int32_t) (a->sequence - b->sequence) < 0)
+	);
+}
+
+static bool
+io_simulated_media_schedule (
+	io_simulated_media_t *this,io_encoding_t *message,uint32_t slot,io_time_t when
+) {
+	io_simulated_delivery_t *heap = this->pending;
+	uint32_t i = this->number_of_pending;
+
+	if (this->number_of_pending == this->pending_size) {
+		uint32_t size = (this->pending_size > 0) ? (this->pending_size * 2) : 16;
+		heap = io_byte_memory_reallocate (
+			io_socket_byte_memory (this),this->pending,sizeof(io_simulated_delivery_t) * size
+		);
+		if (heap == NULL) {
+			return false;
+		}
+		this->pending = heap;
+		this->pending_size = size;
+	}
+
+	io_simulated_delivery_t next = {
+		.when = when,
+		.sent = this->now,
+		.message = reference_io_encoding (message),
+		.slot = slot,
+		.sequence = this->sequence++,
+	};
+
+	while (i > 0) {
+		uint32_t parent = (i - 1) / 2;
+		if (io_simulated_delivery_is_before (&next,heap + parent)) {
+			heap[i] = heap[parent];
+			i = parent;
+		} else {
+			break;
+		}
+	}
+	heap[i] = next;
+	this->number_of_pending++;
+
+	return true;
+}
+
+static io_simulated_delivery_t
+io_simulated_media_pop_delivery (io_simulated_media_t *this) {
+	io_simulated_delivery_t *heap = this->pending;
+	io_simulated_delivery_t first = heap[0];
+	io_simulated_delivery_t last = heap[--this->number_of_pending];
+	uint32_t n = this->number_of_pending;
+	uint32_t i = 0;
+
+	while (2 * i + 1 < n) {
+		uint32_t child = 2 * i + 1;
+		if (child + 1 < n && io_simulated_delivery_is_before (heap + child + 1,heap + child)) {
+			child++;
+		}
+		if (io_simulated_delivery_is_before (heap + child,&last)) {
+			heap[i] = heap[child];
+			i = child;
+		} else {
+			break;
+		}
+	}
+	if (n > 0) {
+		heap[i] = last;
+	}
+
+	return first;
+}
+
+static void
+io_simulated_media_record_latency (io_simulated_media_t *this,int64_t latency) {
+	io_simulated_media_statistics_t *stats = &this->statistics;
+	int64_t us = latency / 1000LL;
+	uint32_t bucket = 0;
+
+	if (stats->delivered == 0 || latency < stats->latency_min) {
+		stats->latency_min = latency;
+	}
+	if (stats->delivered == 0 || latency > stats->latency_max) {
+		stats->latency_max = latency;
+	}
+	stats->latency_total += latency;
+
+	while (bucket < (IO_SIMULATED_MEDIA_LATENCY_BUCKETS - 1) && us >= (1LL << bucket)) {
+		bucket++;
+	}
+	stats->latency[bucket]++;
+}
+
+//
+// the message occupies the media for its serialisation time, then each
+// receiver gets it after the latency and its own jitter unless it is lost
+//
+static bool
+io_simulated_media_send_message (io_socket_t *socket,io_encoding_t *encoding) {
+	io_simulated_media_t *this = (io_simulated_media_t*) socket;
+	io_layer_t *layer = io_encoding_get_outermost_layer (encoding);
+
+	if (layer != NULL) {
+		io_address_t src = io_layer_get_source_address (layer,encoding);
+		io_encoding_t *view = io_shared_media_make_receive_view (encoding);
+		io_time_t start;
+
+		if (view == NULL) {
+			return false;
+		}
+		reference_io_encoding (view);
+
+		this->statistics.messages_sent++;
+
+		start = (this->busy_until.ns > this->now.ns) ? this->busy_until : this->now;
+		this->busy_until = start;
+		if (this->link.bytes_per_second > 0) {
+			this->busy_until.ns += (
+				((int64_t) io_encoding_length (encoding) * 1000000000LL)
+			/	this->link.bytes_per_second
+			);
+		}
+
+		for (uint32_t i = 0; i < this->number_of_slots; i++) {
+			io_inner_binding_t *inner = this->slots + i;
+			if (
+					!io_address_is_invalid (inner->address)
+				&&	compare_io_addresses (inner->address,src) != 0
+				&&	io_layer_match_address (layer,inner->address)
+				&&	inner->port->rx_available
+			) {
+				if (
+					(io_simulated_media_next_random (this) % 1000000) 
+					< this->link.loss_per_million
+				) {
+					this->statistics.lost++;
+				} else {
+					io_time_t when = this->busy_until;
+					when.ns += this->link.latency.ns;
+					if (this->link.jitter.ns > 0) {
+						when.ns += (
+							io_simulated_media_next_random (this) 
+						%	(uint32_t) (this->link.jitter.ns + 1)
+						);
+					}
+					if (!io_simulated_media_schedule (this,view,i,when)) {
+						this->statistics.lost++;
+					}
+				}
+			}
+		}
+
+		unreference_io_encoding (view);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+//
+// deliver everything due by the given virtual time, the inner sockets
+// handle each delivery before the next so their replies are scheduled
+// from the time they received
+//
+uint32_t
+io_simulated_media_run_until (io_socket_t *socket,io_time_t until) {
+	io_simulated_media_t *this = (io_simulated_media_t*) socket;
+	uint32_t count = 0;
+
+	while (this->number_of_pending > 0 && this->pending[0].when.ns <= until.ns) {
+		io_simulated_delivery_t next = io_simulated_media_pop_delivery (this);
+		// slots are never removed so the slot is still there
+		io_inner_binding_t *inner = this->slots + next.slot;
+
+		this->now = next.when;
+
+		if (
+				!io_address_is_invalid (inner->address)
+			&&	inner->port->rx_available != NULL
+		) {
+			if (io_encoding_pipe_put_encoding (inner->port->receive_pipe,next.message)) {
+				io_simulated_media_record_latency (this,next.when.ns - next.sent.ns);
+				this->statistics.delivered++;
+				this->statistics.bytes_delivered += io_encoding_length (next.message);
+				io_enqueue_event (io_socket_io (this),inner->port->rx_available);
+			} else {
+				this->statistics.overrun++;
+			}
+		} else {
+			this->statistics.lost++;
+		}
+
+		unreference_io_encoding (next.message);
+		io_wait_for_all_events (io_socket_io (this));
+		count++;
+	}
+
+	if (until.ns > this->now.ns) {
+		this->now = until;
+	}
+
+	return count;
+}
+
+uint32_t
+io_simulated_media_run (io_socket_t *socket) {
+	io_simulated_media_t *this = (io_simulated_media_t*) socket;
+	uint32_t count = 0;
+	while (this->number_of_pending > 0) {
+		count += io_simulated_media_run_until (socket,this->pending[0].when);
+	}
+	return count;
+}
+
+EVENT_DATA io_socket_implementation_t io_simulated_media_implementation = {
+	SPECIALISE_IO_MULTIPLEX_SOCKET_IMPLEMENTATION(&io_shared_media_implementation)
+	.initialise = io_simulated_media_initialise,
+	.free = io_simulated_media_free,
+	.open = io_shared_media_open,
+	.close = io_shared_media_close,
+	.is_closed = io_shared_media_is_closed,
+	.bind_to_outer_socket = io_shared_media_bind_to_outer_socket,
+	.new_message = io_shared_media_new_message,
+	.send_message = io_simulated_media_send_message,
+	.mtu = io_shared_media_mtu,
+};
+
+io_socket_t*
+allocate_io_simulated_media (io_t *io,io_address_t address) {
+	io_socket_t *socket = io_byte_memory_allocate (
+		io_get_byte_memory (io),sizeof(io_simulated_media_t)
+	);
+	socket->implementation = &io_simulated_media_implementation;
+	socket->address = duplicate_io_address (io_get_byte_memory (io),address);
+	return socket;
+}
+
+//
+// fragment encoder
+//
+io_fragment_encoder_t*
+mk_io_fragment_encoder (io_byte_memory_t *bm) {
+	io_fragment_encoder_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_fragment_encoder_t)
+	);
+
+	if (this != NULL) {
+		this->bm = bm;
+		this->message = NULL;
+		this->id = 0;
+		io_fragment_encoder_reset (this);
+	}
+
+	return this;
+}
+
+void
+free_io_fragment_encoder (io_fragment_encoder_t *this) {
+	io_fragment_encoder_reset (this);
+	io_byte_memory_free (this->bm,this);
+}
+
+void
+io_fragment_encoder_reset (io_fragment_encoder_t *this) {
+	if (this->message != NULL) {
+		unreference_io_encoding (this->message);
+		this->message = NULL;
+	}
+	this->content = NULL;
+	this->length = 0;
+	this->offset = 0;
+	this->chunk = 0;
+	this->index = 0;
+	this->count = 0;
+	this->error = false;
+}
+
+//
+// the content of the message is sent, the encoder keeps a reference
+// to the message until its last fragment has been sent
+//
+bool
+io_fragment_encoder_begin (io_fragment_encoder_t *this,io_encoding_t *message) {
+	uint8_t const *begin,*end;
+
+	io_fragment_encoder_reset (this);
+	if (message == NULL) {
+		this->error = true;
+		return false;
+	}
+
+	io_encoding_get_content (message,&begin,&end);
+	this->message = reference_io_encoding (message);
+	this->content = begin;
+	this->length = end - begin;
+	this->id ++;
+
+	return true;
+}
+
+//
+// Send the remaining fragments of the message.  A fragment that the
+// socket refuses is rebuilt and retried on the next call, returns true
+// when the last fragment has been sent.
+//
+bool
+io_fragment_encoder_send (io_fragment_encoder_t *this,io_socket_t *socket) {
+	uint32_t mtu = io_socket_mtu (socket);
+
+	if (mtu < IO_SOCKET_MINIMUM_MTU) {
+		mtu = IO_SOCKET_MINIMUM_MTU;
+	}
+
+	while (!io_fragment_encoder_is_complete (this)) {
+		io_encoding_t *message = io_socket_new_message (socket);
+		io_fragment_layer_t *fragment;
+		uint32_t header_length,size;
+
+		if (message == NULL) {
+			return false;
+		}
+
+		fragment = (io_fragment_layer_t*) push_io_fragment_transmit_layer (message);
+		header_length = io_encoding_length (message);
+		if (fragment == NULL || header_length >= mtu) {
+			unreference_io_encoding (message);
+			io_fragment_encoder_reset (this);
+			this->error = true;
+			return false;
+		}
+
+		if (this->count == 0) {
+			this->chunk = mtu - header_length;
+			this->count = (this->length + this->chunk - 1) / this->chunk;
+			if (this->count == 0) {
+				this->count = 1;
+			}
+		}
+
+		if (
+				this->count > IO_FRAGMENT_MAXIMUM_COUNT
+			||	header_length + this->chunk > mtu
+		) {
+			unreference_io_encoding (message);
+			io_fragment_encoder_reset (this);
+			this->error = true;
+			return false;
+		}
+
+		size = this->length - this->offset;
+		if (size > this->chunk) {
+			size = this->chunk;
+		}
+
+		fragment->id = this->id;
+		fragment->index = this->index;
+		fragment->count = this->count;
+		fragment->offset = this->offset;
+		fragment->length = this->length;
+		io_encoding_append_bytes (message,this->content + this->offset,size);
+		io_layer_load_header ((io_layer_t*) fragment,message);
+
+		if (io_socket_send_message (socket,message)) {
+			this->offset += size;
+			if (++this->index == this->count) {
+				unreference_io_encoding (this->message);
+				this->message = NULL;
+			}
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//
+// fragment reassembler
+//
+io_fragment_reassembler_t*
+mk_io_fragment_reassembler (
+	io_byte_memory_t *bm,uint32_t memory_limit,io_time_t timeout
+) {
+	io_fragment_reassembler_t *this = io_byte_memory_allocate (
+		bm,sizeof(io_fragment_reassembler_t)
+	);
+
+	if (this != NULL) {
+		this->bm = bm;
+		this->timeout = timeout;
+		this->memory_limit = memory_limit;
+		this->memory_used = 0;
+		this->dropped = 0;
+		memset (this->slot,0,sizeof(this->slot));
+		for (int i = 0; i < IO_FRAGMENT_REASSEMBLY_SLOTS; i++) {
+			this->slot[i].source = io_invalid_address();
+		}
+	}
+
+	return this;
+}
+
+//
+// empty a slot, the slot's reference to its message is returned
+//
+static io_encoding_t*
+io_fragment_reassembler_take (
+	io_fragment_reassembler_t *this,io_fragment_reassembly_t *slot
+) {
+	io_encoding_t *message = slot->message;
+	this->memory_used -= io_encoding_length (message);
+	free_io_address (this->bm,slot->source);
+	slot->source = io_invalid_address();
+	slot->message = NULL;
+	return message;
+}
+
+static void
+io_fragment_reassembler_drop (
+	io_fragment_reassembler_t *this,io_fragment_reassembly_t *slot
+) {
+	unreference_io_encoding (io_fragment_reassembler_take (this,slot));
+	this->dropped ++;
+}
+
+void
+free_io_fragment_reassembler (io_fragment_reassembler_t *this) {
+	for (int i = 0; i < IO_FRAGMENT_REASSEMBLY_SLOTS; i++) {
+		if (this->slot[i].message != NULL) {
+			unreference_io_encoding (io_fragment_reassembler_take (this,this->slot + i));
+		}
+	}
+	io_byte_memory_free (this->bm,this);
+}
+
+//
+// drop incomplete messages that are older than the timeout, a zero
+// timeout keeps messages until their slot is needed
+//
+uint32_t
+io_fragment_reassembler_expire (io_fragment_reassembler_t *this,io_time_t now) {
+	uint32_t count = 0;
+	if (this->timeout.ns > 0) {
+		for (int i = 0; i < IO_FRAGMENT_REASSEMBLY_SLOTS; i++) {
+			io_fragment_reassembly_t *slot = this->slot + i;
+			if (
+					slot->message != NULL
+				&&	(now.ns - slot->started.ns) >= this->timeout.ns
+			) {
+				io_fragment_reassembler_drop (this,slot);
+				count ++;
+			}
+		}
+	}
+	return count;
+}
+
+static io_fragment_reassembly_t*
+io_fragment_reassembler_find (
+	io_fragment_reassembler_t *this,io_address_t source,uint16_t id
+) {
+	for (int i = 0; i < IO_FRAGMENT_REASSEMBLY_SLOTS; i++) {
+		io_fragment_reassembly_t *slot = this->slot + i;
+		if (
+				slot->message != NULL
+			&&	slot->id == id
+			&&	compare_io_addresses (slot->source,source) == 0
+		) {
+			return slot;
+		}
+	}
+	return NULL;
+}
+
+static io_fragment_reassembly_t*
+io_fragment_reassembler_oldest (io_fragment_reassembler_t *this) {
+	io_fragment_reassembly_t *oldest = NULL;
+	for (int i = 0; i < IO_FRAGMENT_REASSEMBLY_SLOTS; i++) {
+		io_fragment_reassembly_t *slot = this->slot + i;
+		if (
+				slot->message != NULL
+			&&	(oldest == NULL || slot->started.ns < oldest->started.ns)
+		) {
+			oldest = slot;
+		}
+	}
+	return oldest;
+}
+
+static io_fragment_reassembly_t*
+io_fragment_reassembler_start (
+	io_fragment_reassembler_t *this,
+	io_address_t source,
+	io_fragment_layer_t const *fragment,
+	io_time_t now
+) {
+	io_fragment_reassembly_t *slot = NULL;
+	io_encoding_t *message;
+
+	if (fragment->length > this->memory_limit) {
+		return NULL;
+	}
+
+	while (this->memory_used + fragment->length > this->memory_limit) {
+		io_fragment_reassembler_drop (this,io_fragment_reassembler_oldest (this));
+	}
+
+	for (int i = 0; i < IO_FRAGMENT_REASSEMBLY_SLOTS && slot == NULL; i++) {
+		if (this->slot[i].message == NULL) {
+			slot = this->slot + i;
+		}
+	}
+	if (slot == NULL) {
+		slot = io_fragment_reassembler_oldest (this);
+		io_fragment_reassembler_drop (this,slot);
+	}
+
+	message = reference_io_encoding (mk_io_packet_encoding (this->bm));
+	if (message == NULL) {
+		return NULL;
+	}
+
+	if (
+			fragment->length > 0
+		&&	(
+					!io_encoding_grow (message,fragment->length)
+				||	io_encoding_fill (message,0,fragment->length) != fragment->length
+			)
+	) {
+		unreference_io_encoding (message);
+		return NULL;
+	}
+
+	slot->message = message;
+	slot->source = duplicate_io_address (this->bm,source);
+	slot->started = now;
+	slot->id = fragment->id;
+	slot->count = fragment->count;
+	slot->received = 0;
+	memset (slot->have,0,sizeof(slot->have));
+	this->memory_used += fragment->length;
+
+	return slot;
+}
+
+//
+// Add a received fragment to its message.  Returns the message, with
+// a reference for the caller, when this was its last missing fragment.
+//
+io_encoding_t*
+io_fragment_reassembler_receive (
+	io_fragment_reassembler_t *this,io_encoding_t *encoding,io_time_t now
+) {
+	io_layer_t *layer = get_io_fragment_layer (encoding);
+	io_address_t source = io_invalid_address();
+	io_fragment_layer_t *fragment;
+	io_fragment_reassembly_t *slot;
+	uint8_t const *begin,*end;
+	uint32_t size;
+
+	if (layer == NULL) {
+		layer = push_io_fragment_receive_layer (encoding);
+		if (layer == NULL) {
+			return NULL;
+		}
+	}
+
+	fragment = (io_fragment_layer_t*) layer;
+	io_layer_get_content (layer,encoding,&begin,&end);
+	size = end - begin;
+
+	if (
+			fragment->count == 0
+		||	fragment->count > IO_FRAGMENT_MAXIMUM_COUNT
+		||	fragment->index >= fragment->count
+		||	fragment->offset > fragment->length
+		||	size > fragment->length - fragment->offset
+	) {
+		return NULL;
+	}
+
+	{
+		io_layer_t *outer = io_encoding_get_outer_layer (encoding,layer);
+		if (outer != NULL) {
+			source = io_layer_get_source_address (outer,encoding);
+		}
+	}
+
+	io_fragment_reassembler_expire (this,now);
+
+	slot = io_fragment_reassembler_find (this,source,fragment->id);
+	if (slot == NULL) {
+		slot = io_fragment_reassembler_start (this,source,fragment,now);
+		if (slot == NULL) {
+			return NULL;
+		}
+	} else if (
+			slot->count != fragment->count
+		||	io_encoding_length (slot->message) != fragment->length
+	) {
+		return NULL;
+	}
+
+	if ((slot->have[fragment->index >> 3] & (1 << (fragment->index & 7))) == 0) {
+		uint8_t *bytes = io_encoding_get_byte_stream (slot->message);
+		memcpy (bytes + fragment->offset,begin,size);
+		slot->have[fragment->index >> 3] |= (1 << (fragment->index & 7));
+		slot->received ++;
+	}
+
+	if (slot->received == slot->count) {
+		return io_fragment_reassembler_take (this,slot);
+	} else {
+		return NULL;
+	}
+}
+
+//
+// aggregator
+//
+static void
+io_aggregator_flush_event (io_event_t *ev) {
+	io_aggregator_flush (ev->user_value);
+}
+
+io_aggregator_t*
+mk_io_aggregator (io_socket_t *socket,io_time_t delay) {
+	io_aggregator_t *this = io_byte_memory_allocate (
+		io_socket_byte_memory (socket),sizeof(io_aggregator_t)
+	);
+
+	if (this != NULL) {
+		this->socket = reference_io_socket (socket);
+		this->message = NULL;
+		this->layer = NULL;
+		this->delay = delay;
+		this->frames_sent = 0;
+		this->records_sent = 0;
+		this->records_dropped = 0;
+		initialise_io_event (&this->flush_event,io_aggregator_flush_event,this);
+		initialise_io_alarm (
+			&this->flush_alarm,&this->flush_event,&this->flush_event,time_zero()
+		);
+	}
+
+	return this;
+}
+
+//
+// records that have not been sent are flushed before the aggregator is freed
+//
+void
+free_io_aggregator (io_aggregator_t *this) {
+	io_socket_t *socket = this->socket;
+	io_aggregator_flush (this);
+	io_byte_memory_free (io_socket_byte_memory (socket),this);
+	unreference_io_socket (socket);
+}
+
+bool
+io_aggregator_flush (io_aggregator_t *this) {
+	if (is_io_alarm_active (&this->flush_alarm)) {
+		io_dequeue_alarm (io_socket_io (this->socket),&this->flush_alarm);
+	}
+
+	if (this->message != NULL) {
+		io_encoding_t *message = this->message;
+		uint32_t count = io_aggregate_layer_record_count (this->layer,message);
+
+		this->message = NULL;
+		io_layer_load_header (this->layer,message);
+		this->layer = NULL;
+		if (io_socket_send_message (this->socket,message)) {
+			this->frames_sent ++;
+			this->records_sent += count;
+		} else {
+			this->records_dropped += count;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool
+io_aggregator_append (io_aggregator_t *this,uint8_t const *bytes,uint32_t size) {
+	uint32_t mtu = io_socket_mtu (this->socket);
+	uint32_t record = IO_AGGREGATE_RECORD_HEADER_SIZE + size;
+
+	if (mtu < IO_SOCKET_MINIMUM_MTU) {
+		mtu = IO_SOCKET_MINIMUM_MTU;
+	}
+
+	if (
+			this->message != NULL
+		&&	io_encoding_length (this->message) + record > mtu
+		&&	!io_aggregator_flush (this)
+	) {
+		return false;
+	}
+
+	if (this->message == NULL) {
+		io_encoding_t *message = io_socket_new_message (this->socket);
+		if (message == NULL) {
+			return false;
+		}
+
+		this->layer = push_io_aggregate_transmit_layer (message);
+		if (this->layer == NULL || io_encoding_length (message) + record > mtu) {
+			unreference_io_encoding (message);
+			this->layer = NULL;
+			return false;
+		}
+
+		this->message = message;
+		set_alarm_delay_time (
+			io_socket_io (this->socket),&this->flush_alarm,this->delay
+		);
+		io_enqueue_alarm (io_socket_io (this->socket),&this->flush_alarm);
+	}
+
+	if (!io_aggregate_layer_append_record (this->layer,this->message,bytes,size)) {
+		return false;
+	}
+
+	if (io_encoding_length (this->message) + IO_AGGREGATE_RECORD_HEADER_SIZE >= mtu) {
+		io_aggregator_flush (this);
+	}
+
+	return true;
+}
+
+//
+// reliable socket
+//
+#define io_reliable_sequence_before(a,b)	((int32_t) ((a) - (b)) < 0)
+
+static void io_reliable_socket_outer_transmit_event (io_event_t*);
+static void io_reliable_socket_outer_receive_event (io_event_t*);
+static void io_reliable_socket_timer_event (io_event_t*);
+
+static io_time_t
+io_reliable_socket_io_clock (void *io) {
+	return io_get_time (io);
+}
+
+INLINE_FUNCTION io_time_t
+io_reliable_socket_now (io_reliable_socket_t *this) {
+	return this->clock (this->clock_user_value);
+}
+
+static io_socket_t*
+io_reliable_socket_initialise (io_socket_t *socket,io_t *io,io_settings_t const *C) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+
+	initialise_io_counted_socket ((io_counted_socket_t*) socket,io);
+
+	this->transmit_available = NULL;
+	this->receive_data_available = NULL;
+	this->outer_socket = NULL;
+	initialise_io_event (
+		&this->outer_transmit_event,io_reliable_socket_outer_transmit_event,this
+	);
+	initialise_io_event (
+		&this->outer_receive_event,io_reliable_socket_outer_receive_event,this
+	);
+	initialise_io_event (&this->timer_event,io_reliable_socket_timer_event,this);
+	initialise_io_alarm (&this->timer,&this->timer_event,&this->timer_event,time_zero());
+	this->timer_due = time_zero();
+	this->timer_is_running = false;
+	this->clock = io_reliable_socket_io_clock;
+	this->clock_user_value = io;
+	this->receive_pipe = mk_io_encoding_pipe (
+		io_get_byte_memory (io),io_settings_receive_pipe_length (C)
+	);
+
+	this->send_base = 0;
+	this->send_next = 0;
+	this->transmit_next = 0;
+	this->recover = 0;
+	this->in_recovery = false;
+	this->duplicates = 0;
+	this->congestion_window = 2;
+	this->congestion_count = 0;
+	this->slow_start_threshold = IO_RELIABLE_WINDOW;
+	this->peer_window = IO_RELIABLE_WINDOW;
+	this->smoothed_rtt = 0;
+	this->rtt_variance = 0;
+	this->rto = IO_RELIABLE_INITIAL_RTO.ns;
+	memset (this->segment,0,sizeof(this->segment));
+
+	this->receive_next = 0;
+	this->acknowledgement_pending = false;
+	memset (this->reorder,0,sizeof(this->reorder));
+	memset (&this->statistics,0,sizeof(io_reliable_statistics_t));
+
+	return socket;
+}
+
+static void
+io_reliable_socket_stop_timer (io_reliable_socket_t *this) {
+	if (is_io_alarm_active (&this->timer)) {
+		io_dequeue_alarm (io_socket_io (this),&this->timer);
+	}
+	this->timer_is_running = false;
+}
+
+static void
+io_reliable_socket_start_timer (io_reliable_socket_t *this,io_time_t now) {
+	io_reliable_socket_stop_timer (this);
+	this->timer_due = (io_time_t) {now.ns + this->rto};
+	this->timer_is_running = true;
+	set_alarm_delay_time (
+		io_socket_io (this),&this->timer,(io_time_t) {this->rto}
+	);
+	io_enqueue_alarm (io_socket_io (this),&this->timer);
+}
+
+static void
+io_reliable_socket_free (io_socket_t *socket) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+	io_byte_memory_t *bm = io_socket_byte_memory (socket);
+
+	io_reliable_socket_stop_timer (this);
+
+	if (this->outer_socket != NULL) {
+		io_socket_unbind_inner (this->outer_socket,io_socket_address (socket));
+		unreference_io_socket (this->outer_socket);
+		this->outer_socket = NULL;
+	}
+
+	io_dequeue_event (io_socket_io (socket),&this->outer_transmit_event);
+	io_dequeue_event (io_socket_io (socket),&this->outer_receive_event);
+	io_dequeue_event (io_socket_io (socket),&this->timer_event);
+
+	for (int i = 0; i < IO_RELIABLE_WINDOW; i++) {
+		if (this->segment[i].message != NULL) {
+			unreference_io_encoding (this->segment[i].message);
+		}
+		if (this->reorder[i] != NULL) {
+			unreference_io_encoding (this->reorder[i]);
+		}
+	}
+
+	if (this->receive_pipe != NULL) {
+		free_io_encoding_pipe (this->receive_pipe,bm);
+	}
+
+	io_counted_socket_free (socket);
+}
+
+static bool
+io_reliable_socket_open (io_socket_t *socket,io_socket_open_flag_t flag) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+	return this->outer_socket != NULL;
+}
+
+static bool
+io_reliable_socket_is_closed (io_socket_t const *socket) {
+	io_reliable_socket_t const *this = (io_reliable_socket_t const*) socket;
+	return this->outer_socket == NULL;
+}
+
+static bool
+io_reliable_socket_bind_inner (
+	io_socket_t *socket,io_address_t address,io_event_t *tx,io_event_t *rx
+) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+	this->transmit_available = tx;
+	this->receive_data_available = rx;
+	return true;
+}
+
+static void
+io_reliable_socket_unbind_inner (io_socket_t *socket,io_address_t address) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+	if (this->transmit_available != NULL) {
+		io_dequeue_event (io_socket_io (socket),this->transmit_available);
+	}
+	if (this->receive_data_available != NULL) {
+		io_dequeue_event (io_socket_io (socket),this->receive_data_available);
+	}
+	this->transmit_available = NULL;
+	this->receive_data_available = NULL;
+}
+
+static bool
+io_reliable_socket_bind_to_outer (io_socket_t *socket,io_socket_t *outer) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+
+	if (this->outer_socket != NULL) {
+		io_socket_unbind_inner (this->outer_socket,io_socket_address (socket));
+		unreference_io_socket (this->outer_socket);
+	}
+
+	this->outer_socket = reference_io_socket (outer);
+
+	if (outer != NULL) {
+		return io_socket_bind_inner (
+			outer,
+			io_socket_address (socket),
+			&this->outer_transmit_event,
+			&this->outer_receive_event
+		);
+	} else {
+		return true;
+	}
+}
+
+static io_pipe_t*
+io_reliable_socket_get_receive_pipe (io_socket_t *socket,io_address_t address) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+	return (io_pipe_t*) this->receive_pipe;
+}
+
+//
+// the content of a message is what is delivered to the peer
+//
+static io_encoding_t*
+io_reliable_socket_new_message (io_socket_t *socket) {
+	return reference_io_encoding (
+		mk_io_packet_encoding (io_socket_byte_memory (socket))
+	);
+}
+
+static size_t
+io_reliable_socket_mtu (io_socket_t const *socket) {
+	io_reliable_socket_t const *this = (io_reliable_socket_t const*) socket;
+	if (this->outer_socket != NULL) {
+		size_t mtu = io_socket_mtu (this->outer_socket);
+		size_t header = sizeof(io_reliable_frame_t);
+		return (mtu > header) ? mtu - header : 0;
+	} else {
+		return 0;
+	}
+}
+
+static uint32_t
+io_reliable_socket_in_flight (io_reliable_socket_t *this) {
+	uint32_t count = 0;
+	for (uint32_t s = this->send_base; s != this->transmit_next; s++) {
+		if (!this->segment[s % IO_RELIABLE_WINDOW].sacked) {
+			count ++;
+		}
+	}
+	return count;
+}
+
+//
+// the window the receiver can accept beyond its next expected number
+//
+static uint16_t
+io_reliable_socket_receive_window (io_reliable_socket_t *this) {
+	uint32_t held = 0;
+	while (
+			held < IO_RELIABLE_WINDOW
+		&&	this->reorder[(this->receive_next + held) % IO_RELIABLE_WINDOW] != NULL
+	) {
+		held ++;
+	}
+	return IO_RELIABLE_WINDOW - held;
+}
+
+static void
+io_reliable_socket_load_acknowledgement (
+	io_reliable_socket_t *this,io_reliable_layer_t *layer
+) {
+	uint32_t s = this->receive_next + 1;
+	uint32_t end = this->receive_next + IO_RELIABLE_WINDOW;
+
+	layer->flags |= IO_RELIABLE_ACK;
+	layer->acknowledge = this->receive_next;
+	layer->window = io_reliable_socket_receive_window (this);
+	layer->sack_count = 0;
+
+	while (s != end && layer->sack_count < IO_RELIABLE_SACK_LIMIT) {
+		if (this->reorder[s % IO_RELIABLE_WINDOW] != NULL) {
+			io_reliable_sack_block_t *block = layer->sack + layer->sack_count++;
+			block->begin = s;
+			while (s != end && this->reorder[s % IO_RELIABLE_WINDOW] != NULL) {
+				s++;
+			}
+			block->end = s;
+		} else {
+			s++;
+		}
+	}
+
+	this->acknowledgement_pending = false;
+}
+
+//
+// a message for the outer socket with a reliable layer
+//
+static io_encoding_t*
+io_reliable_socket_new_outer_message (
+	io_reliable_socket_t *this,io_reliable_layer_t **layer
+) {
+	io_encoding_t *message = io_socket_new_message (this->outer_socket);
+	if (message != NULL) {
+		io_layer_t *outer = io_encoding_get_innermost_layer (message);
+		if (outer != NULL) {
+			io_layer_set_destination_address (outer,message,io_socket_address (this));
+		}
+		*layer = (io_reliable_layer_t*) push_io_reliable_transmit_layer (message);
+		if (*layer == NULL) {
+			unreference_io_encoding (message);
+			message = NULL;
+		}
+	}
+	return message;
+}
+
+static bool
+io_reliable_socket_send_segment (io_reliable_socket_t *this,uint32_t sequence) {
+	io_reliable_segment_t *segment = this->segment + (sequence % IO_RELIABLE_WINDOW);
+	io_reliable_layer_t *layer;
+	io_encoding_t *message = io_reliable_socket_new_outer_message (this,&layer);
+
+	if (message != NULL) {
+		uint8_t const *begin,*end;
+
+		layer->flags = IO_RELIABLE_DATA;
+		layer->sequence = sequence;
+		io_reliable_socket_load_acknowledgement (this,layer);
+		io_encoding_get_content (segment->message,&begin,&end);
+		io_encoding_append_bytes (message,begin,end - begin);
+		io_layer_load_header ((io_layer_t*) layer,message);
+
+		if (io_socket_send_message (this->outer_socket,message)) {
+			segment->sent = io_reliable_socket_now (this);
+			if (segment->transmissions++ == 0) {
+				this->statistics.segments_sent ++;
+			} else {
+				this->statistics.retransmissions ++;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void
+io_reliable_socket_send_acknowledgement (io_reliable_socket_t *this) {
+	io_reliable_layer_t *layer;
+	io_encoding_t *message = io_reliable_socket_new_outer_message (this,&layer);
+
+	if (message != NULL) {
+		layer->flags = 0;
+		layer->sequence = this->send_next;
+		io_reliable_socket_load_acknowledgement (this,layer);
+		io_layer_load_header ((io_layer_t*) layer,message);
+		if (io_socket_send_message (this->outer_socket,message)) {
+			this->statistics.acknowledgements_sent ++;
+		} else {
+			this->acknowledgement_pending = true;
+		}
+	}
+}
+
+//
+// send new or lost messages while the windows allow
+//
+static void
+io_reliable_socket_transmit (io_reliable_socket_t *this) {
+	uint32_t window = this->congestion_window;
+	uint32_t flight;
+
+	if (this->outer_socket == NULL) {
+		return;
+	}
+
+	if (window > this->peer_window) {
+		window = this->peer_window;
+	}
+	if (window == 0) {
+		// probe a closed window with one message
+		window = 1;
+	}
+
+	flight = io_reliable_socket_in_flight (this);
+	while (this->transmit_next != this->send_next && flight < window) {
+		io_reliable_segment_t *segment = this->segment + (
+			this->transmit_next % IO_RELIABLE_WINDOW
+		);
+		if (!segment->sacked) {
+			if (!io_reliable_socket_send_segment (this,this->transmit_next)) {
+				break;
+			}
+			flight ++;
+		}
+		this->transmit_next ++;
+	}
+
+	if (this->acknowledgement_pending) {
+		io_reliable_socket_send_acknowledgement (this);
+	}
+
+	if (flight > 0 && !this->timer_is_running) {
+		io_reliable_socket_start_timer (this,io_reliable_socket_now (this));
+	}
+}
+
+static bool
+io_reliable_socket_send_message (io_socket_t *socket,io_encoding_t *encoding) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+
+	if (
+			this->outer_socket == NULL
+		||	(this->send_next - this->send_base) >= IO_RELIABLE_WINDOW
+	) {
+		unreference_io_encoding (encoding);
+		return false;
+	}
+
+	// the segment keeps the reference until the message is acknowledged
+	this->segment[this->send_next % IO_RELIABLE_WINDOW] = (io_reliable_segment_t) {
+		.message = encoding,
+		.sent = time_zero(),
+		.transmissions = 0,
+		.sacked = false,
+	};
+	this->send_next ++;
+
+	io_reliable_socket_transmit (this);
+	return true;
+}
+
+//
+// RFC 6298 round trip estimate
+//
+static void
+io_reliable_socket_sample_rtt (io_reliable_socket_t *this,int64_t rtt) {
+	if (this->smoothed_rtt == 0) {
+		this->smoothed_rtt = rtt;
+		this->rtt_variance = rtt / 2;
+	} else {
+		int64_t error = this->smoothed_rtt - rtt;
+		if (error < 0) {
+			error = -error;
+		}
+		this->rtt_variance = (3 * this->rtt_variance + error) / 4;
+		this->smoothed_rtt = (7 * this->smoothed_rtt + rtt) / 8;
+	}
+
+	this->rto = this->smoothed_rtt + 4 * this->rtt_variance;
+	if (this->rto < IO_RELIABLE_MINIMUM_RTO.ns) {
+		this->rto = IO_RELIABLE_MINIMUM_RTO.ns;
+	}
+	if (this->rto > IO_RELIABLE_MAXIMUM_RTO.ns) {
+		this->rto = IO_RELIABLE_MAXIMUM_RTO.ns;
+	}
+}
+
+static void
+io_reliable_socket_lost (io_reliable_socket_t *this) {
+	uint32_t half = io_reliable_socket_in_flight (this) / 2;
+	this->slow_start_threshold = (half > 2) ? half : 2;
+}
+
+static void
+io_reliable_socket_process_acknowledgement (
+	io_reliable_socket_t *this,io_reliable_layer_t *layer,io_time_t now
+) {
+	uint32_t ack = layer->acknowledge;
+	bool window_changed = (layer->window != this->peer_window);
+
+	this->peer_window = layer->window;
+
+	for (int i = 0; i < layer->sack_count; i++) {
+		uint32_t begin = layer->sack[i].begin;
+		uint32_t end = layer->sack[i].end;
+
+		// blocks come from the peer, only those inside what is in flight
+		// are believed
+		if (
+				end - begin <= IO_RELIABLE_WINDOW
+			&&	!io_reliable_sequence_before (begin,this->send_base)
+			&&	!io_reliable_sequence_before (this->transmit_next,end)
+		) {
+			for (uint32_t s = begin; s != end; s++) {
+				this->segment[s % IO_RELIABLE_WINDOW].sacked = true;
+			}
+		}
+	}
+
+	if (
+			io_reliable_sequence_before (this->send_base,ack)
+		&&	!io_reliable_sequence_before (this->send_next,ack)
+	) {
+		uint32_t acknowledged = ack - this->send_base;
+		io_reliable_segment_t *last = this->segment + ((ack - 1) % IO_RELIABLE_WINDOW);
+
+		// Karn: only messages sent once, and not held behind a hole, give
+		// a round trip sample
+		if (last->transmissions == 1 && !last->sacked) {
+			io_reliable_socket_sample_rtt (this,now.ns - last->sent.ns);
+		}
+
+		while (this->send_base != ack) {
+			io_reliable_segment_t *segment = this->segment + (
+				this->send_base % IO_RELIABLE_WINDOW
+			);
+			unreference_io_encoding (segment->message);
+			*segment = (io_reliable_segment_t) {NULL};
+			this->send_base ++;
+		}
+		if (io_reliable_sequence_before (this->transmit_next,this->send_base)) {
+			this->transmit_next = this->send_base;
+		}
+		this->duplicates = 0;
+
+		if (this->in_recovery) {
+			if (io_reliable_sequence_before (ack,this->recover)) {
+				// partial acknowledgement, the next hole is lost too
+				if (this->send_base != this->transmit_next) {
+					io_reliable_socket_send_segment (this,this->send_base);
+				}
+			} else {
+				this->in_recovery = false;
+				this->congestion_window = this->slow_start_threshold;
+			}
+		} else if (this->congestion_window < this->slow_start_threshold) {
+			this->congestion_window += acknowledged;
+		} else {
+			this->congestion_count += acknowledged;
+			if (this->congestion_count >= this->congestion_window) {
+				this->congestion_count -= this->congestion_window;
+				this->congestion_window ++;
+			}
+		}
+		if (this->congestion_window > IO_RELIABLE_WINDOW) {
+			this->congestion_window = IO_RELIABLE_WINDOW;
+		}
+
+		if (this->send_base != this->transmit_next) {
+			io_reliable_socket_start_timer (this,now);
+		} else {
+			io_reliable_socket_stop_timer (this);
+		}
+
+		if (this->transmit_available != NULL) {
+			io_enqueue_event (io_socket_io (this),this->transmit_available);
+		}
+	} else if (
+			ack == this->send_base
+		&&	this->send_base != this->transmit_next
+		&&	!(layer->flags & IO_RELIABLE_DATA)
+		&&	!window_changed
+	) {
+		// only a pure acknowledgement is a duplicate, data carries the
+		// same acknowledgement without anything having been lost
+		this->duplicates ++;
+	}
+
+	if (
+			!this->in_recovery
+		&&	this->send_base != this->transmit_next
+		&&	!this->segment[this->send_base % IO_RELIABLE_WINDOW].sacked
+	) {
+		uint32_t above = 0;
+		for (uint32_t s = this->send_base; s != this->transmit_next; s++) {
+			if (this->segment[s % IO_RELIABLE_WINDOW].sacked) {
+				above ++;
+			}
+		}
+		if (
+				this->duplicates >= IO_RELIABLE_DUPLICATE_THRESHOLD
+			||	above >= IO_RELIABLE_DUPLICATE_THRESHOLD
+		) {
+			io_reliable_socket_lost (this);
+			this->congestion_window = this->slow_start_threshold;
+			this->congestion_count = 0;
+			this->recover = this->transmit_next;
+			this->in_recovery = true;
+			if (io_reliable_socket_send_segment (this,this->send_base)) {
+				this->statistics.fast_retransmissions ++;
+			}
+		}
+	}
+}
+
+//
+// buffer a data message in its place in the receive window
+//
+static void
+io_reliable_socket_process_data (
+	io_reliable_socket_t *this,io_encoding_t *message,io_reliable_layer_t *layer
+) {
+	uint32_t sequence = layer->sequence;
+
+	this->acknowledgement_pending = true;
+
+	if (
+			io_reliable_sequence_before (sequence,this->receive_next)
+		||	(sequence - this->receive_next) >= IO_RELIABLE_WINDOW
+	) {
+		this->statistics.duplicates_received ++;
+	} else if (this->reorder[sequence % IO_RELIABLE_WINDOW] != NULL) {
+		this->statistics.duplicates_received ++;
+	} else {
+		this->reorder[sequence % IO_RELIABLE_WINDOW] = reference_io_encoding (message);
+	}
+}
+
+//
+// pass the messages that are next in order to the inner socket
+//
+static void
+io_reliable_socket_deliver (io_reliable_socket_t *this) {
+	bool delivered = false;
+
+	while (this->receive_pipe != NULL) {
+		io_encoding_t **next = this->reorder + (this->receive_next % IO_RELIABLE_WINDOW);
+		if (
+				*next == NULL
+			||	!io_encoding_pipe_put_encoding (this->receive_pipe,*next)
+		) {
+			break;
+		}
+		unreference_io_encoding (*next);
+		*next = NULL;
+		this->receive_next ++;
+		this->statistics.delivered ++;
+		delivered = true;
+	}
+
+	if (delivered && this->receive_data_available != NULL) {
+		io_enqueue_event (io_socket_io (this),this->receive_data_available);
+	}
+}
+
+static void
+io_reliable_socket_outer_receive_event (io_event_t *ev) {
+	io_reliable_socket_t *this = ev->user_value;
+	io_time_t now = io_reliable_socket_now (this);
+	io_encoding_pipe_t *pipe;
+	io_encoding_t *next;
+
+	if (this->outer_socket == NULL) {
+		return;
+	}
+
+	pipe = cast_to_io_encoding_pipe (
+		io_socket_get_receive_pipe (this->outer_socket,io_socket_address (this))
+	);
+
+	while (pipe != NULL && io_encoding_pipe_peek (pipe,&next)) {
+		io_reliable_layer_t *layer = (io_reliable_layer_t*) push_io_reliable_receive_layer (next);
+		if (layer != NULL) {
+			if (layer->flags & IO_RELIABLE_ACK) {
+				io_reliable_socket_process_acknowledgement (this,layer,now);
+			}
+			if (layer->flags & IO_RELIABLE_DATA) {
+				io_reliable_socket_process_data (this,next,layer);
+			}
+		}
+		io_encoding_pipe_pop_encoding (pipe);
+	}
+
+	io_reliable_socket_deliver (this);
+	io_reliable_socket_transmit (this);
+}
+
+static void
+io_reliable_socket_outer_transmit_event (io_event_t *ev) {
+	io_reliable_socket_transmit (ev->user_value);
+}
+
+static void
+io_reliable_socket_timer_event (io_event_t *ev) {
+	io_reliable_socket_poll (ev->user_value);
+}
+
+void
+io_reliable_socket_set_clock (
+	io_socket_t *socket,io_reliable_clock_t clock,void *user_value
+) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+	this->clock = clock;
+	this->clock_user_value = user_value;
+}
+
+//
+// Retransmit after a timeout and deliver messages that were held for
+// room in the receive pipe.  Called by the socket's alarm, or directly
+// when the socket runs on a simulated clock.
+//
+void
+io_reliable_socket_poll (io_socket_t *socket) {
+	io_reliable_socket_t *this = (io_reliable_socket_t*) socket;
+	io_time_t now = io_reliable_socket_now (this);
+
+	io_reliable_socket_deliver (this);
+
+	if (this->timer_is_running && now.ns >= this->timer_due.ns) {
+		this->timer_is_running = false;
+		if (this->send_base != this->transmit_next) {
+			// everything not selectively acknowledged is sent again
+			this->statistics.timeouts ++;
+			io_reliable_socket_lost (this);
+			this->congestion_window = 1;
+			this->congestion_count = 0;
+			this->in_recovery = false;
+			this->duplicates = 0;
+			this->transmit_next = this->send_base;
+			this->rto *= 2;
+			if (this->rto > IO_RELIABLE_MAXIMUM_RTO.ns) {
+				this->rto = IO_RELIABLE_MAXIMUM_RTO.ns;
+			}
+		}
+	} else if (this->timer_is_running && !is_io_alarm_active (&this->timer)) {
+		// the alarm was early for this clock
+		io_time_t due = this->timer_due;
+		io_reliable_socket_start_timer (this,now);
+		this->timer_due = due;
+	}
+
+	if (this->acknowledgement_pending && this->outer_socket != NULL) {
+		io_reliable_socket_send_acknowledgement (this);
+	}
+	io_reliable_socket_transmit (this);
+}
+
+EVENT_DATA io_socket_implementation_t io_reliable_socket_implementation = {
+	SPECIALISE_IO_COUNTED_SOCKET_IMPLEMENTATION (
+		&io_counted_socket_implementation
+	)
+	.initialise = io_reliable_socket_initialise,
+	.free = io_reliable_socket_free,
+	.open = io_reliable_socket_open,
+	.is_closed = io_reliable_socket_is_closed,
+	.bind_inner = io_reliable_socket_bind_inner,
+	.unbind_inner = io_reliable_socket_unbind_inner,
+	.bind_to_outer_socket = io_reliable_socket_bind_to_outer,
+	.get_receive_pipe = io_reliable_socket_get_receive_pipe,
+	.new_message = io_reliable_socket_new_message,
+	.send_message = io_reliable_socket_send_message,
+	.mtu = io_reliable_socket_mtu,
+};
+
+io_socket_t*
+allocate_io_reliable_socket (io_t *io,io_address_t address) {
+	io_socket_t *socket = io_byte_memory_allocate (
+		io_get_byte_memory (io),sizeof(io_reliable_socket_t)
+	);
+	socket->implementation = &io_reliable_socket_implementation;
+	socket->address = duplicate_io_address (io_get_byte_memory (io),address);
+	return socket;
+}
+
 //
 //
 //
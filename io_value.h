@@ -38,7 +38,8 @@ enum {
 	io_value_t* (*initialise) (vref_t,vref_t); \
 	void (*free) (io_value_t*); \
 	bool (*encode) (vref_t,io_encoding_t*); \
-	vref_t (*decode[NUMBER_OF_IO_VALUE_ENCODING_FORMATS]) (io_value_memory_t *vm,uint8_t const**,const uint8_t*);\
+	vref_t (*decode[NUMBER_OF_IO_VALUE_ENCODING_FORMATS]) (io_value_memory_t *vm,io_x70_decode_context_t*,uint8_t const**,const uint8_t*);\
+	io_x70_framing_t x70_framing;\
 	vref_t (*receive) (io_t*,vref_t,uint32_t,vref_t const*); \
 	vref_t (*change) (io_t*,vref_t,vref_t,uint32_t,va_list);\
 	vref_t (*compare) (io_value_t const*,vref_t); \
@@ -82,8 +83,10 @@ io_value_t* io_value_initialise_nop (vref_t,vref_t);
 io_value_mode_t const* io_value_get_null_modes (io_value_t const*);
 vref_t io_value_compare_no_comparison(io_value_t const*,vref_t);
 vref_t io_value_send (io_t*,vref_t,uint32_t,...);
-vref_t io_decode_x70_to_invalid_value (io_value_memory_t*,uint8_t const**,const uint8_t*);
-vref_t decode_x70_to_io_value (io_value_memory_t*,uint8_t const**,const uint8_t*);
+vref_t io_decode_x70_to_invalid_value (io_value_memory_t*,io_x70_decode_context_t*,uint8_t const**,const uint8_t*);
+void io_encode_value_implementation_to_x70 (io_value_t const*,io_encoding_t*);
+void io_encode_implementation_name_to_x70 (io_value_implementation_t const*,io_encoding_t*);
+vref_t decode_x70_to_io_value (io_value_memory_t*,io_x70_decode_context_t*,uint8_t const**,const uint8_t*);
 bool io_value_encode_base (vref_t,io_encoding_t*);
 vref_t io_value_compare_with_value (io_value_t const*,vref_t);
 
@@ -92,6 +95,7 @@ vref_t io_value_compare_with_value (io_value_t const*,vref_t);
 	.initialise = io_value_initialise_nop,\
 	.free = io_value_free_nop, \
 	.decode = {decode_x70_to_io_value}, \
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_NONE,0), \
 	.encode = io_value_encode_base, \
 	.receive = default_io_value_receive, \
 	.change = NULL, \
@@ -358,22 +362,35 @@ decl_particular_value(cr_F64_NUMBER,io_float64_value_t,cr_f64_number_v)
 //
 // binary
 //
+#define IO_BINARY_VALUE_STRUCT_MEMBERS \
+	IO_VALUE_STRUCT_MEMBERS \
+	struct PACK_STRUCTURE {\
+		uint32_t binary_size:24;\
+		uint32_t inline_bytes:1;\
+		uint32_t const_bytes:1;\
+		uint32_t :6;\
+	} bit;\
+	union PACK_STRUCTURE {\
+		uint8_t *rw;\
+		uint8_t const *ro;\
+		char const *str;\
+	} bytes;\
+	/**/
+
 typedef struct PACK_STRUCTURE io_binary_value {
-	IO_VALUE_STRUCT_MEMBERS
-	struct PACK_STRUCTURE {
-		uint32_t binary_size:24;
-		uint32_t inline_bytes:1;
-		uint32_t const_bytes:1;
-		uint32_t :6;
-	} bit;
-	union PACK_STRUCTURE {
-		uint8_t *rw;
-		uint8_t const *ro;
-		char const *str;
-	} bytes;
+	IO_BINARY_VALUE_STRUCT_MEMBERS
 	uint8_t inline_bytes[];
 } io_binary_value_t;
 
+//
+// binary (and text) value whose bytes are in a referenced encoding,
+// made by io_x70_zero_copy_decoder
+//
+typedef struct PACK_STRUCTURE io_encoding_binary_value {
+	IO_BINARY_VALUE_STRUCT_MEMBERS
+	io_encoding_t *encoding;
+} io_encoding_binary_value_t;
+
 #define io_binary_value_size(b)				(b)->bit.binary_size
 #define io_binary_value_const_bytes(b)		(b)->bit.const_bytes
 #define io_binary_value_inline_bytes(b)	(b)->bit.inline_bytes
@@ -385,6 +402,7 @@ vref_t mk_io_binary_value_with_const_bytes (io_value_memory_t*,uint8_t const*,in
 vref_t mk_io_binary_value (io_value_memory_t*,uint8_t const*,int32_t);
 vref_t mk_io_text_value (io_value_memory_t*,uint8_t const*,int32_t);
 vref_t io_text_to_text_value_decoder (io_encoding_t*,io_value_memory_t*);
+bool is_io_encoding_binary_value (vref_t);
 
 decl_particular_value(cr_BINARY,				io_binary_value_t,cr_binary_v)
 decl_particular_value(cr_CONSTANT_BINARY,	io_binary_value_t,cr_const_binary_v)
@@ -397,6 +415,7 @@ decl_particular_value(cr_TEXT,				io_binary_value_t,cr_text_v)
 	.initialise = io_binary_value_initialise_nop, \
 	.encode = io_binary_value_encode, \
 	.decode = {io_binary_decode_x70_value}, \
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_SIZED,0), \
 	.compare = compare_binary_with_other, \
 	/**/
 
@@ -676,15 +695,20 @@ default_io_value_encode (vref_t r_value,io_encoding_t *encoding) {
 	return true;
 }
 
+void
+io_encode_implementation_name_to_x70 (
+	io_value_implementation_t const *I,io_encoding_t *encoding
+) {
+	uint32_t len = strlen(I->name);
+	io_x70_encoding_append_uint_value (encoding,len);
+	io_encoding_append_bytes (encoding,(uint8_t const*) I->name,len);
+}
+
 void
 io_encode_value_implementation_to_x70 (
 	io_value_t const *value,io_encoding_t *encoding
 ) {
-	uint32_t len = strlen(value->implementation->name);
-	io_x70_encoding_append_uint_value (encoding,len);
-	io_encoding_append_bytes (
-		encoding,(uint8_t const*) value->implementation->name,len
-	);
+	io_encode_implementation_name_to_x70 (value->implementation,encoding);
 } 
 
 vref_t
@@ -694,7 +718,7 @@ default_io_value_receive (io_t *io,vref_t r_value,uint32_t argc,vref_t const *ar
 
 vref_t
 io_decode_x70_to_invalid_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
 	return INVALID_VREF;
 }
@@ -727,7 +751,7 @@ io_value_encode_base (vref_t r_value,io_encoding_t *encoding) {
 
 vref_t
 decode_x70_to_io_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
 	return cr_VALUE;
 }
@@ -772,7 +796,7 @@ io_nil_value_encode (vref_t r_value,io_encoding_t *encoding) {
 
 static vref_t
 io_nil_decode_x70_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
 	return cr_NIL;
 }
@@ -1016,10 +1040,20 @@ io_int64_value_encode (vref_t r_value,io_encoding_t *encoding) {
 			io_encoding_printf (encoding,"%lld",this->value);
 			result = true;
 		} else if (is_io_x70_encoding (encoding)) {
-			io_encode_value_implementation_to_x70 ((io_value_t const*) this,encoding);
-			io_encoding_append_bytes (
-				encoding,(uint8_t const*) &this->value,sizeof(this->value)
-			);
+			if (io_x70_encoding_version (encoding) >= X70_ENCODING_VERSION_2) {
+				extern EVENT_DATA io_value_implementation_t i64_zigzag_number_value_implementation;
+				io_encode_implementation_name_to_x70 (
+					&i64_zigzag_number_value_implementation,encoding
+				);
+				io_x70_encoding_append_varint64 (
+					encoding,io_x70_zigzag_encode (this->value)
+				);
+			} else {
+				io_encode_value_implementation_to_x70 ((io_value_t const*) this,encoding);
+				io_encoding_append_bytes (
+					encoding,(uint8_t const*) &this->value,sizeof(this->value)
+				);
+			}
 			result = true;
 		} else if (encoding_is_io_value_int64 (encoding)) {
 			io_value_int64_encoding_t *enc = (io_value_int64_encoding_t*) encoding;
@@ -1033,7 +1067,7 @@ io_int64_value_encode (vref_t r_value,io_encoding_t *encoding) {
 
 static vref_t
 io_int64_decode_x70_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
 	if ((e - *b) >= sizeof(int64_t)) {
 		int64_t v = read_le_int64 (*b);
@@ -1044,6 +1078,23 @@ io_int64_decode_x70_value (
 	}
 }
 
+//
+// x70 version 2 int64 payload
+//
+static vref_t
+io_int64_decode_x70_zigzag_value (
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
+) {
+	uint64_t u;
+	int32_t c = io_x70_encoding_take_varint64 (*b,e,&u);
+	if (c > 0) {
+		*b += c;
+		return mk_io_int64_value (vm,io_x70_zigzag_decode (u));
+	} else {
+		return INVALID_VREF;
+	}
+}
+
 
 static vref_t
 compare_with_i64_number (io_value_t const *v,vref_t r_other) {
@@ -1068,9 +1119,23 @@ i64_number_value_implementation = {
 	.initialise = io_int64_value_initialise,
 	.encode = io_int64_value_encode,
 	.decode = {io_int64_decode_x70_value},
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_FIXED,sizeof(int64_t)),
 	.compare = compare_with_i64_number,
 };
 
+//
+// decode only, values are created as i64
+//
+EVENT_DATA io_value_implementation_t 
+i64_zigzag_number_value_implementation = {
+	SPECIALISE_IO_NUMBER_VALUE_IMPLEMENTATION (
+		&io_number_value_implementation
+	)
+	.name = "z64",
+	.decode = {io_int64_decode_x70_zigzag_value},
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_VARINT,0),
+};
+
 EVENT_DATA io_int64_value_t cr_i64_number_v = {
 	decl_io_value (
 		&i64_number_value_implementation,
@@ -1141,10 +1206,24 @@ io_float64_value_encode (vref_t r_value,io_encoding_t *encoding) {
 			io_encoding_printf (encoding,"%f",this->value);
 			result = true;
 		} else if (is_io_x70_encoding (encoding)) {
-			io_encode_value_implementation_to_x70 ((io_value_t*) this,encoding);
-			io_encoding_append_bytes (
-				encoding,(uint8_t const*) &this->value,sizeof(this->value)
-			);
+			float32_t narrow = (float32_t) this->value;
+			if (
+					io_x70_encoding_version (encoding) >= X70_ENCODING_VERSION_2
+				&&	(float64_t) narrow == this->value
+			) {
+				extern EVENT_DATA io_value_implementation_t f32_number_value_implementation;
+				io_encode_implementation_name_to_x70 (
+					&f32_number_value_implementation,encoding
+				);
+				io_encoding_append_bytes (
+					encoding,(uint8_t const*) &narrow,sizeof(narrow)
+				);
+			} else {
+				io_encode_value_implementation_to_x70 ((io_value_t*) this,encoding);
+				io_encoding_append_bytes (
+					encoding,(uint8_t const*) &this->value,sizeof(this->value)
+				);
+			}
 			result = true;
 		} else if (encoding_is_io_value_float64 (encoding)) {
 			io_value_float64_encoding_t *enc = (io_value_float64_encoding_t*) encoding;
@@ -1158,7 +1237,7 @@ io_float64_value_encode (vref_t r_value,io_encoding_t *encoding) {
 
 static vref_t
 io_float64_decode_x70_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
 	if ((e - *b) >= sizeof(float64_t)) {
 		float64_t v = read_le_float64 (*b);
@@ -1169,6 +1248,22 @@ io_float64_decode_x70_value (
 	}
 }
 
+//
+// x70 version 2 float64 payload when it fits in a float32
+//
+static vref_t
+io_float64_decode_x70_float32_value (
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
+) {
+	if ((e - *b) >= sizeof(float32_t)) {
+		float32_t v = read_le_float32 (*b);
+		*b += sizeof(float32_t);
+		return mk_io_float64_value (vm,v);
+	} else {
+		return INVALID_VREF;
+	}
+}
+
 static vref_t
 compare_with_f64_number (io_value_t const *v,vref_t r_other) {
 	io_value_t const *other = vref_cast_to_ro_pointer (r_other);
@@ -1196,11 +1291,24 @@ EVENT_DATA io_value_implementation_t f64_number_value_implementation = {
 	.name = "f64",
 	.initialise = io_float64_value_initialise,
 	.decode = {io_float64_decode_x70_value},
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_FIXED,sizeof(float64_t)),
 	.encode = io_float64_value_encode,
 	.compare = compare_with_f64_number,
 	.get_modes = io_value_get_null_modes,
 };
 
+//
+// decode only, values are created as f64
+//
+EVENT_DATA io_value_implementation_t f32_number_value_implementation = {
+	SPECIALISE_IO_NUMBER_VALUE_IMPLEMENTATION (
+		&io_number_value_implementation
+	)
+	.name = "f32",
+	.decode = {io_float64_decode_x70_float32_value},
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_FIXED,sizeof(float32_t)),
+};
+
 EVENT_DATA io_float64_value_t cr_f64_number_v = {
 	decl_io_value (&f64_number_value_implementation,sizeof(io_float64_value_t))
 	.value = 0,
@@ -1351,33 +1459,114 @@ io_binary_value_encode (vref_t r_value,io_encoding_t *encoding) {
 	return ok;
 }
 
+static vref_t
+mk_io_binary_value_for (
+	io_value_memory_t *vm,io_value_implementation_t const *I,uint8_t const *bytes,int32_t size
+) {
+	io_binary_value_t base = {
+		decl_io_value (I,sizeof(io_binary_value_t))
+		.bit = {
+			.binary_size = size,
+			.inline_bytes = false,
+			.const_bytes = 0,
+		},
+		.bytes.ro = bytes,
+	};
+	return io_value_memory_new_value (
+		vm,I,sizeof (io_binary_value_t) + size,def_vref (&reference_to_c_stack_value,&base)
+	);
+}
+
+static vref_t
+mk_io_encoding_binary_value_for (
+	io_value_memory_t *vm,
+	io_value_implementation_t const *I,
+	io_encoding_t *encoding,
+	uint8_t const *bytes,
+	int32_t size
+) {
+	io_encoding_binary_value_t base = {
+		decl_io_value (I,sizeof(io_encoding_binary_value_t))
+		.bit = {
+			.binary_size = size,
+			.inline_bytes = false,
+			.const_bytes = 0,
+		},
+		.bytes.ro = bytes,
+		.encoding = encoding,
+	};
+	return io_value_memory_new_value (
+		vm,I,sizeof (io_encoding_binary_value_t),def_vref (&reference_to_c_stack_value,&base)
+	);
+}
+
+//
+// copies the payload unless it is in the zero-copy decode source
+//
+static vref_t
+io_binary_value_decode_x70 (
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e,
+	io_value_implementation_t const *copy,
+	io_value_implementation_t const *in_place
+) {
+	vref_t r_value = INVALID_VREF;
+	uint32_t u;
+	
+	if (*b < e && **b == X70_UINT_VALUE_BYTE) {
+		int32_t c = io_x70_encoding_take_uint_value (*b + 1,e,&u);
+		*b += 1 + c;
+		
+		if (c > 0 && *b <= (e - u)) {
+			io_encoding_t *source = io_x70_decode_source_containing (context,*b,u);
+			if (source != NULL) {
+				r_value = mk_io_encoding_binary_value_for (vm,in_place,source,*b,u);
+			} else {
+				r_value = mk_io_binary_value_for (vm,copy,*b,u);
+			}
+			*b += u;
+		}
+	}
+
+	return r_value;
+}
+
 static vref_t
 io_binary_decode_x70_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
-	return INVALID_VREF;
+	extern EVENT_DATA io_value_implementation_t io_binary_value_implementation_with_dynamic_bytes;
+	extern EVENT_DATA io_value_implementation_t io_encoding_binary_value_implementation;
+	return io_binary_value_decode_x70 (
+		vm,context,b,e,
+		&io_binary_value_implementation_with_dynamic_bytes,
+		&io_encoding_binary_value_implementation
+	);
+}
+
+static vref_t
+compare_binary_bytes (io_binary_value_t const *this,io_binary_value_t const *o) {
+	if (io_binary_value_size(this) == io_binary_value_size(o)) {
+		return to_comparison_value (
+			memcmp (
+				io_binary_value_ro_bytes(this),
+				io_binary_value_ro_bytes(o),
+				io_binary_value_size(this)
+			)
+		);
+	} else if (io_binary_value_size(this) > io_binary_value_size(o)) {
+		return cr_COMPARE_MORE;
+	} else {
+		return cr_COMPARE_LESS;
+	}
 }
 
 static vref_t
 compare_binary_with_other (io_value_t const *v,vref_t r_other) {
 	io_value_t const *other = vref_cast_to_ro_pointer (r_other);
 	if (io_typesafe_ro_cast_to_type (other,v->implementation)) {
-		io_binary_value_t const *this = (io_binary_value_t const*) v;
-		io_binary_value_t const *o = (io_binary_value_t const*) other;
-		
-		if (io_binary_value_size(this) == io_binary_value_size(o)) {
-			return to_comparison_value (
-				memcmp (
-					io_binary_value_ro_bytes(this),
-					io_binary_value_ro_bytes(o),
-					io_binary_value_size(this)
-				)
-			);
-		} else if (io_binary_value_size(this) > io_binary_value_size(o)) {
-			return cr_COMPARE_MORE;
-		} else {
-			return cr_COMPARE_LESS;
-		}
+		return compare_binary_bytes (
+			(io_binary_value_t const*) v,(io_binary_value_t const*) other
+		);
 	} else {
 		return to_comparison_value (
 			strcmp (v->implementation->name,other->implementation->name)
@@ -1480,24 +1669,6 @@ io_binary_value_implementation_with_dynamic_bytes = {
 	.initialise = io_binary_value_initialise_with_dynamic_bytes,
 };
 
-static vref_t
-mk_io_binary_value_for (
-	io_value_memory_t *vm,io_value_implementation_t const *I,uint8_t const *bytes,int32_t size
-) {
-	io_binary_value_t base = {
-		decl_io_value (I,sizeof(io_binary_value_t))
-		.bit = {
-			.binary_size = size,
-			.inline_bytes = false,
-			.const_bytes = 0,
-		},
-		.bytes.ro = bytes,
-	};
-	return io_value_memory_new_value (
-		vm,I,sizeof (io_binary_value_t) + size,def_vref (&reference_to_c_stack_value,&base)
-	);
-}
-
 vref_t
 mk_io_binary_value (io_value_memory_t *vm,uint8_t const *bytes,int32_t size) {
 	return mk_io_binary_value_for (
@@ -1505,6 +1676,35 @@ mk_io_binary_value (io_value_memory_t *vm,uint8_t const *bytes,int32_t size) {
 	);
 }
 
+//
+// in dictionary mode repeated text is written as a ref
+//
+static bool
+io_text_value_encode_x70 (io_binary_value_t const *this,io_encoding_t *encoding) {
+	if (is_io_x70_dictionary_encoding (encoding)) {
+		uint32_t size = io_binary_value_size(this);
+		int32_t index = io_x70_dictionary_encoding_find (
+			encoding,io_binary_value_ro_bytes(this),size
+		);
+		if (index < 0) {
+			bool ok = io_binary_value_encode_x70 (this,encoding);
+			io_x70_dictionary_encoding_add (
+				encoding,io_encoding_length (encoding) - size,size
+			);
+			return ok;
+		} else {
+			extern EVENT_DATA io_value_implementation_t io_x70_reference_value_implementation;
+			io_encode_implementation_name_to_x70 (
+				&io_x70_reference_value_implementation,encoding
+			);
+			io_x70_encoding_append_varint64 (encoding,index);
+			return true;
+		}
+	} else {
+		return io_binary_value_encode_x70 (this,encoding);
+	}
+}
+
 static bool
 io_text_value_encode (vref_t r_value,io_encoding_t *encoding) {
 	io_binary_value_t const *this = vref_cast_to_ro_pointer(r_value);
@@ -1516,28 +1716,23 @@ io_text_value_encode (vref_t r_value,io_encoding_t *encoding) {
 		);
 		ok = true;
 	} else if (is_io_x70_encoding (encoding)) {
-		ok = io_binary_value_encode_x70 (this,encoding);
+		ok = io_text_value_encode_x70 (this,encoding);
 	}
 	return ok;
 }
 
 static vref_t
 io_text_decode_x70_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {
-	vref_t r_value = INVALID_VREF;
-	uint32_t u;
-	
-	if (**b == X70_UINT_VALUE_BYTE) {
-		*b += 1;
-		*b += io_x70_encoding_take_uint_value (*b,e,&u);
-		
-		if (*b <= (e - u)) {
-			r_value = mk_io_text_value (vm,*b,u);
-			*b += u;
-		}
+	extern EVENT_DATA io_value_implementation_t io_text_value_implementation;
+	extern EVENT_DATA io_value_implementation_t io_encoding_text_value_implementation;
+	vref_t r_value = io_binary_value_decode_x70 (
+		vm,context,b,e,&io_text_value_implementation,&io_encoding_text_value_implementation
+	);
+	if (vref_is_valid (r_value)) {
+		io_x70_decode_dictionary_add (context,r_value);
 	}
-
 	return r_value;
 }
 
@@ -1570,6 +1765,103 @@ mk_io_text_value (io_value_memory_t *vm,uint8_t const *bytes,int32_t size) {
 	return mk_io_binary_value_for (vm,&io_text_value_implementation,bytes,size);
 }
 
+//
+// zero-copy binary and text, these keep the name of the type they
+// specialise so they encode exactly like it
+//
+static io_value_t*
+io_encoding_binary_value_initialise (vref_t r_value,vref_t r_base) {
+	io_encoding_binary_value_t *this = vref_cast_to_rw_pointer(r_value);
+	io_encoding_binary_value_t const *base = io_typesafe_ro_cast(r_base,cr_CONSTANT_BINARY);
+
+	if (base != NULL) {
+		this->bit = base->bit;
+		io_binary_value_ro_bytes(this) = io_binary_value_ro_bytes(base);
+		this->encoding = reference_io_encoding (base->encoding);
+	} else {
+		this = NULL;
+	}
+
+	return (io_value_t*) this;
+}
+
+static void
+io_encoding_binary_value_free (io_value_t *value) {
+	io_encoding_binary_value_t *this = (io_encoding_binary_value_t*) value;
+	unreference_io_encoding (this->encoding);
+}
+
+static vref_t
+compare_encoding_binary_with_other (io_value_t const *v,vref_t r_other) {
+	io_value_t const *other = vref_cast_to_ro_pointer (r_other);
+	if (io_typesafe_ro_cast_to_type (other,v->implementation->specialisation_of)) {
+		return compare_binary_bytes (
+			(io_binary_value_t const*) v,(io_binary_value_t const*) other
+		);
+	} else {
+		return to_comparison_value (
+			strcmp (v->implementation->name,other->implementation->name)
+		);
+	}
+}
+
+EVENT_DATA io_value_implementation_t 
+io_encoding_binary_value_implementation = {
+	SPECIALISE_IO_BINARY_VALUE_IMPLEMENTATION (
+		&io_binary_value_implementation_with_dynamic_bytes
+	)
+	.name = "dynamic-binary",
+	.initialise = io_encoding_binary_value_initialise,
+	.free = io_encoding_binary_value_free,
+	.compare = compare_encoding_binary_with_other,
+};
+
+EVENT_DATA io_value_implementation_t 
+io_encoding_text_value_implementation = {
+	SPECIALISE_IO_BINARY_VALUE_IMPLEMENTATION (
+		&io_text_value_implementation
+	)
+	.name = "text",
+	.initialise = io_encoding_binary_value_initialise,
+	.free = io_encoding_binary_value_free,
+	.decode = {io_text_decode_x70_value},
+	.encode = io_text_value_encode,
+	.compare = compare_encoding_binary_with_other,
+};
+
+bool
+is_io_encoding_binary_value (vref_t r_value) {
+	io_value_t const *value = vref_cast_to_ro_pointer (r_value);
+	return (
+			io_typesafe_ro_cast_to_type (value,&io_encoding_binary_value_implementation)
+		||	io_typesafe_ro_cast_to_type (value,&io_encoding_text_value_implementation)
+	);
+}
+
+//
+// x70 dictionary ref, decode only
+//
+static vref_t
+io_x70_reference_decode_x70_value (
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
+) {
+	uint64_t index;
+	int32_t c = io_x70_encoding_take_varint64 (*b,e,&index);
+	if (c > 0 && index < IO_X70_DICTIONARY_LIMIT) {
+		*b += c;
+		return io_x70_decode_dictionary_entry (context,index);
+	} else {
+		return INVALID_VREF;
+	}
+}
+
+EVENT_DATA io_value_implementation_t io_x70_reference_value_implementation = {
+	SPECIALISE_IO_VALUE_IMPLEMENTATION (&io_value_implementation)
+	.name = "ref",
+	.decode = {io_x70_reference_decode_x70_value},
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_VARINT,0),
+};
+
 //
 // symbol
 //
@@ -1739,6 +2031,91 @@ io_vector_value_get_values (vref_t r_value,uint32_t *arity,vref_t const** values
 	}
 }
 
+//
+// x70 vector is the arity followed by the encoded values
+//
+static bool
+io_vector_value_encode (vref_t r_value,io_encoding_t *encoding) {
+	if (is_io_x70_encoding (encoding)) {
+		io_vector_value_t const *this = vref_cast_to_ro_pointer (r_value);
+		vref_t const *cursor = this->values;
+		vref_t const *end = cursor + this->arity;
+		bool ok = true;
+
+		io_encode_value_implementation_to_x70 ((io_value_t const*) this,encoding);
+		io_x70_encoding_append_uint_value (encoding,this->arity);
+		while (ok && cursor < end) {
+			ok = io_value_encode (*cursor++,encoding);
+		}
+		return ok;
+	} else {
+		return io_value_encode_base (r_value,encoding);
+	}
+}
+
+static vref_t
+io_vector_decode_x70_value (
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
+) {
+	extern EVENT_DATA io_value_implementation_t io_vector_value_implementation;
+	vref_t r_value = INVALID_VREF;
+	uint32_t arity;
+
+	if (*b < e && **b == X70_UINT_VALUE_BYTE) {
+		int32_t c = io_x70_encoding_take_uint_value (*b + 1,e,&arity);
+		*b += 1 + c;
+		//
+		// every element takes at least one byte, the elements are decoded
+		// into a vector in byte memory rather than on the stack and
+		// nesting is limited so a hostile message cannot exhaust the stack
+		//
+		if (
+				c > 0
+			&&	arity <= (e - *b)
+			&&	arity <= (UINT32_MAX - sizeof(io_vector_value_t)) / sizeof(vref_t)
+			&&	(arity == 0 || context->depth < IO_X70_STREAM_DECODER_STACK_DEPTH)
+		) {
+			io_byte_memory_t *bm = io_get_byte_memory (io_value_memory_get_io (vm));
+			uint32_t size = sizeof(io_vector_value_t) + (arity * sizeof (vref_t));
+			io_vector_value_t *base = io_byte_memory_allocate (bm,size);
+
+			if (base != NULL) {
+				vref_t *cursor = base->values;
+				vref_t *end = cursor + arity;
+
+				context->depth ++;
+				while (cursor < end) {
+					vref_t r_element = io_x70_decode_value (vm,context,b,e);
+					if (vref_is_valid (r_element)) {
+						*cursor++ = reference_value (r_element);
+					} else {
+						break;
+					}
+				}
+				context->depth --;
+
+				if (cursor == end) {
+					base->implementation = &io_vector_value_implementation;
+					base->tag_.reference_count_ = 0;
+					base->tag_.size_ = size;
+					base->arity = arity;
+					r_value = io_value_memory_new_value (
+						vm,&io_vector_value_implementation,size,
+						def_vref (&reference_to_c_stack_value,base)
+					);
+				}
+
+				while (cursor > base->values) {
+					unreference_value (*--cursor);
+				}
+				io_byte_memory_free (bm,base);
+			}
+		}
+	}
+
+	return r_value;
+}
+
 vref_t
 io_value_send (io_t *io,vref_t r_value,uint32_t argc,...) {
 	uint32_t count = argc;
@@ -1761,6 +2138,9 @@ EVENT_DATA io_value_implementation_t io_vector_value_implementation = {
 	.name = "vector",
 	.initialise = io_vector_value_initialise,
 	.free = io_vector_value_free,
+	.encode = io_vector_value_encode,
+	.decode = {io_vector_decode_x70_value},
+	.x70_framing = def_io_x70_framing (IO_X70_FRAMING_VALUES,0),
 };
 
 EVENT_DATA io_vector_value_t cr_vector_v = {
@@ -1889,7 +2269,7 @@ io_cons_value_encode (vref_t r_value,io_encoding_t *encoding) {
 
 static vref_t
 io_cons_value_decode_x70_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
 	return cr_NIL;
 }
@@ -2177,7 +2557,7 @@ io_map_slot_value_encode (vref_t r_value,io_encoding_t *encoding) {
 
 static vref_t
 io_map_slot_value_decode_x70_value (
-	io_value_memory_t *vm,uint8_t const**b,const uint8_t *e
+	io_value_memory_t *vm,io_x70_decode_context_t *context,uint8_t const**b,const uint8_t *e
 ) {	
 	return cr_NIL;
 }
@@ -2539,9 +2919,13 @@ add_core_value_implementations_to_hash (string_hash_table_t *hash) {
 		IO_VALUE_IMPLEMENTATION(&io_number_value_implementation),
 		IO_VALUE_IMPLEMENTATION(&i64_number_value_implementation),
 		IO_VALUE_IMPLEMENTATION(&f64_number_value_implementation),
+		IO_VALUE_IMPLEMENTATION(&i64_zigzag_number_value_implementation),
+		IO_VALUE_IMPLEMENTATION(&f32_number_value_implementation),
 		IO_VALUE_IMPLEMENTATION(&io_binary_value_implementation),
 		IO_VALUE_IMPLEMENTATION(&io_binary_value_implementation_with_const_bytes),
+		IO_VALUE_IMPLEMENTATION(&io_binary_value_implementation_with_dynamic_bytes),
 		IO_VALUE_IMPLEMENTATION(&io_text_value_implementation),
+		IO_VALUE_IMPLEMENTATION(&io_x70_reference_value_implementation),
 		IO_VALUE_IMPLEMENTATION(&io_symbol_value_implementation_with_const_bytes),
 		IO_VALUE_IMPLEMENTATION(&io_vector_value_implementation),
 		IO_VALUE_IMPLEMENTATION(&io_result_value_implementation),
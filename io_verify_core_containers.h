@@ -770,6 +770,200 @@ TEST_BEGIN(test_io_byte_pipe_1) {
 }
 TEST_END
 
+static void
+test_io_software_dma_count_event (io_event_t *ev) {
+	uint32_t *count = ev->user_value;
+	(*count) ++;
+}
+
+TEST_BEGIN(test_io_software_dma_1) {
+	io_software_dma_controller_t dmac;
+	io_software_dma_channel_t ch[3];
+	uint8_t source[1000],a[1000],b[300];
+	uint8_t volatile reg = 0;
+	uint32_t completed[3] = {0},errors = 0;
+
+	for (int i = 0; i < SIZEOF(source); i++) {
+		source[i] = (uint8_t) (i * 13);
+	}
+	memset (a,0,sizeof(a));
+	memset (b,0,sizeof(b));
+
+	initialise_io_software_dma_controller (&dmac,TEST_IO,64);
+	for (int i = 0; i < SIZEOF(ch); i++) {
+		initialise_io_software_dma_channel (ch + i,(io_dma_controller_t*) &dmac,&reg);
+		initialise_io_event (&ch[i].complete,test_io_software_dma_count_event,completed + i);
+		initialise_io_event (&ch[i].error,test_io_software_dma_count_event,&errors);
+	}
+
+	// a scatter-gather chain of three descriptors
+	VERIFY (io_software_dma_channel_load (ch + 1,IO_DMA_TRANSFER_MEMORY_TO_MEMORY,b,source + 100,300),NULL);
+	VERIFY (io_software_dma_channel_load (ch + 2,IO_DMA_TRANSFER_MEMORY_TO_PERIPHERAL,NULL,source,10),NULL);
+	ch[0].next_channel = (io_dma_channel_t*) (ch + 1);
+	ch[1].next_channel = (io_dma_channel_t*) (ch + 2);
+
+	VERIFY (io_dma_controller_start_controller ((io_dma_controller_t*) &dmac),NULL);
+	io_dma_transfer_memory_to_memory ((io_dma_channel_t*) ch,a,source,sizeof(a));
+	VERIFY (io_software_dma_channel_is_busy (ch),NULL);
+	VERIFY (!io_software_dma_channel_load (ch,IO_DMA_TRANSFER_MEMORY_TO_MEMORY,a,source,1),NULL);
+
+	io_wait_for_all_events (TEST_IO);
+
+	VERIFY (memcmp (a,source,sizeof(a)) == 0,NULL);
+	VERIFY (memcmp (b,source + 100,sizeof(b)) == 0,NULL);
+	VERIFY (reg == source[9],NULL);
+	VERIFY (completed[0] == 1 && completed[1] == 1 && completed[2] == 1,NULL);
+	VERIFY (errors == 0,NULL);
+	VERIFY (io_software_dma_controller_bytes_transferred (&dmac) == 1310,NULL);
+	VERIFY (io_software_dma_controller_descriptors_completed (&dmac) == 3,NULL);
+	VERIFY (!io_software_dma_channel_is_busy (ch + 2),NULL);
+
+	// an invalid descriptor ends its chain with an error
+	ch[0].next_channel = NULL;
+	VERIFY (io_software_dma_channel_load (ch + 1,IO_DMA_TRANSFER_PERIPHERAL_TO_MEMORY,NULL,NULL,4),NULL);
+	VERIFY (io_dma_controller_start_transfer ((io_dma_controller_t*) &dmac,(io_dma_channel_t*) (ch + 1)),NULL);
+	io_wait_for_all_events (TEST_IO);
+	VERIFY (errors == 1 && completed[1] == 1,NULL);
+	VERIFY (io_software_dma_controller_errors (&dmac) == 1,NULL);
+
+	// a stopped transfer raises no events
+	io_dma_transfer_memory_to_memory ((io_dma_channel_t*) ch,a,source,sizeof(a));
+	VERIFY (io_dma_controller_stop_transfer ((io_dma_controller_t*) &dmac,(io_dma_channel_t*) ch),NULL);
+	io_wait_for_all_events (TEST_IO);
+	VERIFY (completed[0] == 1 && !io_software_dma_channel_is_busy (ch),NULL);
+
+	io_dma_controller_stop_controller ((io_dma_controller_t*) &dmac);
+}
+TEST_END
+
+//
+// an emulated uart fifo feeds a byte pipe through a circular dma channel
+//
+TEST_BEGIN(test_io_byte_pipe_dma_receiver_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	io_software_dma_controller_t dmac;
+	io_software_dma_channel_t channel;
+	io_byte_pipe_dma_receiver_t receiver;
+	io_byte_pipe_t *pipe,*uart;
+	uint32_t data_available = 0;
+	io_event_t ev;
+
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	pipe = mk_io_byte_pipe (bm,64);
+	uart = mk_io_byte_pipe (bm,128);
+	if (VERIFY (pipe != NULL && uart != NULL,NULL)) {
+		uint8_t next = 0,expect = 0,byte;
+		uint32_t in_order = 0;
+
+		initialise_io_software_dma_controller (&dmac,TEST_IO,16);
+		initialise_io_software_dma_channel (&channel,(io_dma_controller_t*) &dmac,NULL);
+		io_software_dma_channel_set_peripheral_fifo (&channel,uart);
+		initialise_io_event (&ev,test_io_software_dma_count_event,&data_available);
+
+		VERIFY (
+			start_io_byte_pipe_dma_receiver (
+				&receiver,TEST_IO,(io_dma_controller_t*) &dmac,
+				(io_dma_channel_t*) &channel,pipe,&ev
+			),
+			NULL
+		);
+
+		// less than half the ring waits for an idle line
+		for (int i = 0; i < 20; i++) {
+			io_byte_pipe_put_byte (uart,next++);
+		}
+		io_software_dma_channel_request (&channel);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (!io_byte_pipe_is_readable (uart),NULL);
+		VERIFY (!io_byte_pipe_is_readable (pipe),NULL);
+
+		io_byte_pipe_dma_receiver_flush (&receiver);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (data_available == 1,NULL);
+		while (io_byte_pipe_get_byte (pipe,&byte)) {
+			if (byte == expect++) in_order ++;
+		}
+		VERIFY (in_order == 20,NULL);
+
+		// larger bursts are delivered on half and full transfer and wrap the ring
+		for (int round = 0; round < 4; round++) {
+			for (int i = 0; i < 40; i++) {
+				io_byte_pipe_put_byte (uart,next++);
+			}
+			io_software_dma_channel_request (&channel);
+			io_wait_for_all_events (TEST_IO);
+			VERIFY (io_byte_pipe_is_readable (pipe),NULL);
+			io_byte_pipe_dma_receiver_flush (&receiver);
+			while (io_byte_pipe_get_byte (pipe,&byte)) {
+				if (byte == expect++) in_order ++;
+			}
+		}
+		VERIFY (in_order == 180,NULL);
+		VERIFY (io_byte_pipe_dma_receiver_overrun (&receiver) == 0,NULL);
+
+		// an idle line flush after the ring wraps but before its events run
+		for (int i = 0; i < 20; i++) {
+			io_byte_pipe_put_byte (uart,next++);
+		}
+		while (io_software_dma_controller_run_burst (&dmac));
+		io_byte_pipe_dma_receiver_flush (&receiver);
+		while (io_byte_pipe_get_byte (pipe,&byte)) {
+			if (byte == expect++) in_order ++;
+		}
+		VERIFY (in_order == 200,NULL);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (!io_byte_pipe_is_readable (pipe),NULL);
+
+		// and after a whole lap
+		for (int i = 0; i < 64; i++) {
+			io_byte_pipe_put_byte (uart,next++);
+		}
+		while (io_software_dma_controller_run_burst (&dmac));
+		io_byte_pipe_dma_receiver_flush (&receiver);
+		VERIFY (io_byte_pipe_dma_receiver_overrun (&receiver) == 1,NULL);
+		VERIFY (io_byte_pipe_is_readable (pipe),NULL);
+		while (io_byte_pipe_get_byte (pipe,&byte));
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (!io_byte_pipe_is_readable (pipe),NULL);
+		VERIFY (io_byte_pipe_dma_receiver_overrun (&receiver) == 1,NULL);
+
+		// a whole lap of the ring before the events run is not empty
+		for (int i = 0; i < 64; i++) {
+			io_byte_pipe_put_byte (uart,next++);
+		}
+		while (io_software_dma_controller_run_burst (&dmac));
+		VERIFY (!io_byte_pipe_is_readable (uart),NULL);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (io_byte_pipe_dma_receiver_overrun (&receiver) == 2,NULL);
+		VERIFY (io_byte_pipe_is_readable (pipe),NULL);
+		while (io_byte_pipe_get_byte (pipe,&byte));
+
+		// without a reader the ring overruns
+		for (int i = 0; i < 100; i++) {
+			io_byte_pipe_put_byte (uart,next++);
+		}
+		io_software_dma_channel_request (&channel);
+		io_wait_for_all_events (TEST_IO);
+		io_byte_pipe_dma_receiver_flush (&receiver);
+		VERIFY (io_byte_pipe_dma_receiver_overrun (&receiver) > 0,NULL);
+		VERIFY (io_byte_pipe_dma_receiver_errors (&receiver) == 0,NULL);
+
+		stop_io_byte_pipe_dma_receiver (&receiver);
+		io_dma_controller_stop_controller ((io_dma_controller_t*) &dmac);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (!io_software_dma_channel_is_busy (&channel),NULL);
+	}
+
+	if (pipe) free_io_byte_pipe (pipe,bm);
+	if (uart) free_io_byte_pipe (uart,bm);
+
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
 TEST_BEGIN(test_io_encoding_pipe_1) {
 	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
 	memory_info_t bm_begin,bm_end;
@@ -846,6 +1040,98 @@ TEST_BEGIN(test_io_value_pipe_1) {
 }
 TEST_END
 
+typedef struct {
+	io_channel_t *channel;
+	io_channel_message_t messages[4];
+	uint32_t count;
+} test_io_channel_receiver_t;
+
+static void
+test_io_channel_receive_event (io_event_t *ev) {
+	test_io_channel_receiver_t *this = ev->user_value;
+	while (
+			this->count < SIZEOF(this->messages)
+		&&	io_channel_receive (this->channel,this->messages + this->count)
+	) {
+		this->count++;
+	}
+}
+
+TEST_BEGIN(test_io_channel_1) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	memory_info_t vm_begin,vm_end;
+	test_io_channel_receiver_t receiver = {0};
+	io_event_t receive;
+
+	io_value_memory_get_info (vm,&vm_begin);
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	initialise_io_event (&receive,test_io_channel_receive_event,&receiver);
+	receiver.channel = mk_io_channel (TEST_IO,TEST_IO,&receive,4);
+	if (VERIFY (receiver.channel != NULL,NULL)) {
+		io_channel_t *channel = receiver.channel;
+		io_encoding_t *encoding = reference_io_encoding (mk_io_text_encoding (bm));
+		vref_t values[] = {
+			mk_io_int64_value (vm,42),
+			mk_io_int64_value (vm,43),
+		};
+
+		// a channel of four slots lends at most three messages
+		VERIFY (io_channel_send_value (channel,values[0]),NULL);
+		VERIFY (io_channel_send_encoding (channel,encoding),NULL);
+		VERIFY (io_channel_send_value (channel,values[1]),NULL);
+		VERIFY (!io_channel_send_value (channel,values[0]),NULL);
+		VERIFY (io_channel_messages_lent (channel) == 3,NULL);
+		VERIFY (io_encoding_reference_count (encoding) == 2,NULL);
+
+		// only the send into an empty channel wakes the receiver
+		VERIFY (io_channel_signals (channel) == 1,NULL);
+
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (receiver.count == 3,NULL);
+		VERIFY (vref_is_equal_to (receiver.messages[0].value,values[0]),NULL);
+		VERIFY (receiver.messages[0].encoding == NULL,NULL);
+		VERIFY (vref_is_invalid (receiver.messages[1].value),NULL);
+		VERIFY (receiver.messages[1].encoding == encoding,NULL);
+		VERIFY (vref_is_equal_to (receiver.messages[2].value,values[1]),NULL);
+		VERIFY (!io_channel_is_readable (channel),NULL);
+
+		// received messages stay lent until released
+		VERIFY (!io_channel_send_value (channel,values[0]),NULL);
+		io_channel_release (channel,receiver.messages + 1);
+		io_channel_release (channel,receiver.messages + 0);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (io_channel_messages_lent (channel) == 1,NULL);
+		VERIFY (io_encoding_reference_count (encoding) == 1,NULL);
+
+		VERIFY (io_channel_send_value (channel,values[0]),NULL);
+		VERIFY (io_channel_signals (channel) == 2,NULL);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (receiver.count == 4,NULL);
+		io_channel_release (channel,receiver.messages + 2);
+		io_channel_release (channel,receiver.messages + 3);
+		io_wait_for_all_events (TEST_IO);
+		VERIFY (io_channel_messages_lent (channel) == 0,NULL);
+
+		// messages left in the channel are dropped when it is freed
+		VERIFY (io_channel_send_encoding (channel,encoding),NULL);
+		io_dequeue_event (TEST_IO,&receive);
+		free_io_channel (channel);
+		VERIFY (io_encoding_reference_count (encoding) == 1,NULL);
+		unreference_io_encoding (encoding);
+	}
+
+	io_do_gc (TEST_IO,-1);
+	io_value_memory_get_info (vm,&vm_end);
+	VERIFY (vm_end.used_bytes == vm_begin.used_bytes,NULL);
+
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
 TEST_BEGIN(test_io_tls_sha256_1) {
 	io_sha256_context_t ctx;
 	uint8_t output[32];
@@ -1391,8 +1677,11 @@ io_core_containers_unit_test (V_unit_test_t *unit) {
 		test_io_event_1,
 		test_io_event_list_1,
 		test_io_byte_pipe_1,
+		test_io_software_dma_1,
+		test_io_byte_pipe_dma_receiver_1,
 		test_io_encoding_pipe_1,
 		test_io_value_pipe_1,
+		test_io_channel_1,
 		test_io_tls_sha256_1,
 		test_io_tls_sha256_2,
 		test_vref_bucket_hash_table_1,
@@ -1417,11 +1706,687 @@ io_core_containers_unit_test (V_unit_test_t *unit) {
 	unit->teardown = teardown_io_core_containers_unit_test;
 }
 
+//
+// an emulated clock tree: an 8MHz oscillator drives a pll, the pll drives
+// usb directly and the bus through a prescaler, the bus drives uart and
+// spi prescalers
+//
+typedef struct PACK_STRUCTURE test_io_oscillator {
+	IO_CPU_CLOCK_SOURCE_STRUCT_MEMBERS
+	float64_t frequency;
+} test_io_oscillator_t;
+
+static float64_t
+test_io_oscillator_get_frequency (io_cpu_clock_pointer_t clock) {
+	return ((test_io_oscillator_t const*) io_cpu_clock_ro_pointer (clock))->frequency;
+}
+
+static EVENT_DATA io_cpu_clock_implementation_t test_io_oscillator_implementation = {
+	SPECIALISE_IO_CPU_CLOCK_SOURCE_IMPLEMENTATION (&io_cpu_clock_source_implementation)
+	.get_current_frequency = test_io_oscillator_get_frequency,
+	.get_expected_frequency = test_io_oscillator_get_frequency,
+};
+
+static const test_io_oscillator_t test_osc;
+static const io_cpu_clock_scaler_t test_pll;
+static const io_cpu_clock_scaler_t test_bus;
+static const io_cpu_clock_scaler_t test_uart;
+static const io_cpu_clock_scaler_t test_spi;
+static const io_cpu_clock_function_t test_usb;
+
+static io_cpu_clock_scaler_setting_t test_pll_setting = {1,1,0};
+static io_cpu_clock_scaler_setting_t test_bus_setting = {1,1,0};
+static io_cpu_clock_scaler_setting_t test_uart_setting = {1,1,0};
+static io_cpu_clock_scaler_setting_t test_spi_setting = {1,1,0};
+
+static const io_cpu_clock_pointer_t test_osc_outputs[] = {
+	decl_io_cpu_clock_pointer (&test_pll),
+	{NULL}
+};
+
+static const io_cpu_clock_pointer_t test_pll_outputs[] = {
+	decl_io_cpu_clock_pointer (&test_bus),
+	decl_io_cpu_clock_pointer (&test_usb),
+	{NULL}
+};
+
+static const io_cpu_clock_pointer_t test_bus_outputs[] = {
+	decl_io_cpu_clock_pointer (&test_uart),
+	decl_io_cpu_clock_pointer (&test_spi),
+	{NULL}
+};
+
+static const io_cpu_clock_pointer_t test_no_outputs[] = {
+	{NULL}
+};
+
+static const test_io_oscillator_t test_osc = {
+	.implementation = &test_io_oscillator_implementation,
+	.outputs = test_osc_outputs,
+	.frequency = 8000000.0,
+};
+
+static const io_cpu_clock_scaler_t test_pll = {
+	.implementation = &io_cpu_clock_scaler_implementation,
+	.input = decl_io_cpu_clock_pointer (&test_osc),
+	.outputs = test_pll_outputs,
+	.setting = &test_pll_setting,
+	.minimum_multiplier = 1,
+	.maximum_multiplier = 16,
+	.minimum_divider = 1,
+	.maximum_divider = 4,
+	.maximum_frequency = 100000000.0,
+};
+
+static const io_cpu_clock_scaler_t test_bus = {
+	.implementation = &io_cpu_clock_scaler_implementation,
+	.input = decl_io_cpu_clock_pointer (&test_pll),
+	.outputs = test_bus_outputs,
+	.setting = &test_bus_setting,
+	.minimum_multiplier = 1,
+	.maximum_multiplier = 1,
+	.minimum_divider = 1,
+	.maximum_divider = 16,
+	.maximum_frequency = 50000000.0,
+};
+
+static const io_cpu_clock_scaler_t test_uart = {
+	.implementation = &io_cpu_clock_scaler_implementation,
+	.input = decl_io_cpu_clock_pointer (&test_bus),
+	.outputs = test_no_outputs,
+	.setting = &test_uart_setting,
+	.minimum_multiplier = 1,
+	.maximum_multiplier = 1,
+	.minimum_divider = 1,
+	.maximum_divider = 8,
+};
+
+static const io_cpu_clock_scaler_t test_spi = {
+	.implementation = &io_cpu_clock_scaler_implementation,
+	.input = decl_io_cpu_clock_pointer (&test_bus),
+	.outputs = test_no_outputs,
+	.setting = &test_spi_setting,
+	.minimum_multiplier = 1,
+	.maximum_multiplier = 1,
+	.minimum_divider = 1,
+	.maximum_divider = 8,
+};
+
+static const io_cpu_clock_function_t test_usb = {
+	.implementation = &io_cpu_clock_function_implementation,
+	.input = decl_io_cpu_clock_pointer (&test_pll),
+	.outputs = test_no_outputs,
+};
+
+#define TEST_CLOCK_NEAR(c,f)	(\
+		io_cpu_clock_get_expected_frequency (IO_CPU_CLOCK (c)) > ((f) - 1.0)\
+	&&	io_cpu_clock_get_expected_frequency (IO_CPU_CLOCK (c)) < ((f) + 1.0)\
+)
+
+TEST_BEGIN(test_io_cpu_clock_plan_1) {
+	const io_cpu_clock_target_t targets[] = {
+		{decl_io_cpu_clock_pointer (&test_usb),47900000.0,48100000.0},
+		{decl_io_cpu_clock_pointer (&test_spi),23900000.0,24100000.0},
+		{decl_io_cpu_clock_pointer (&test_uart),11900000.0,12100000.0},
+	};
+	const io_cpu_clock_target_t impossible[] = {
+		{decl_io_cpu_clock_pointer (&test_usb),49900000.0,50100000.0},
+	};
+	const io_cpu_clock_target_t usb_only[] = {
+		{decl_io_cpu_clock_pointer (&test_usb),31900000.0,32100000.0},
+	};
+	io_cpu_clock_plan_t plan;
+
+	VERIFY (cast_to_io_cpu_clock_scaler (IO_CPU_CLOCK (&test_pll)) != NULL,NULL);
+	VERIFY (cast_to_io_cpu_clock_scaler (IO_CPU_CLOCK (&test_usb)) == NULL,NULL);
+	VERIFY (TEST_CLOCK_NEAR (&test_uart,8000000.0),NULL);
+
+	// the usb clock fixes the pll, the bus runs at the lowest frequency
+	// that still gives spi and uart their targets
+	if (VERIFY (plan_io_cpu_clocks (&plan,targets,SIZEOF(targets),NULL),NULL)) {
+		VERIFY (plan.number_of_scalers == 4 && plan.scaler[0] == &test_pll,NULL);
+		VERIFY (TEST_CLOCK_NEAR (&test_pll,48000000.0),NULL);
+		VERIFY (TEST_CLOCK_NEAR (&test_usb,48000000.0),NULL);
+		VERIFY (TEST_CLOCK_NEAR (&test_bus,24000000.0),NULL);
+		VERIFY (TEST_CLOCK_NEAR (&test_spi,24000000.0),NULL);
+		VERIFY (TEST_CLOCK_NEAR (&test_uart,12000000.0),NULL);
+		VERIFY (test_pll_setting.multiplier == 6 && test_pll_setting.divider == 1,NULL);
+		VERIFY (io_cpu_clock_plan_cost (&plan) < 108000001.0,NULL);
+		VERIFY (io_cpu_clock_plan_evaluations (&plan) > 0,NULL);
+	}
+
+	// frequencies are cached until a setting changes
+	VERIFY (test_uart_setting.frequency > 0,NULL);
+	VERIFY (io_cpu_clock_scaler_select (IO_CPU_CLOCK (&test_bus),1,1),NULL);
+	VERIFY (test_uart_setting.frequency == 0 && test_spi_setting.frequency == 0,NULL);
+	VERIFY (TEST_CLOCK_NEAR (&test_uart,24000000.0),NULL);
+	VERIFY (!io_cpu_clock_scaler_select (IO_CPU_CLOCK (&test_bus),2,1),NULL);
+
+	// without a solution the settings are unchanged
+	VERIFY (!plan_io_cpu_clocks (&plan,impossible,SIZEOF(impossible),NULL),NULL);
+	VERIFY (TEST_CLOCK_NEAR (&test_pll,48000000.0),NULL);
+	VERIFY (test_bus_setting.divider == 1,NULL);
+
+	// clocks driven by a planned scaler follow it when they are not targets
+	VERIFY (TEST_CLOCK_NEAR (&test_uart,24000000.0),NULL);
+	if (VERIFY (plan_io_cpu_clocks (&plan,usb_only,SIZEOF(usb_only),NULL),NULL)) {
+		VERIFY (TEST_CLOCK_NEAR (&test_pll,32000000.0),NULL);
+		VERIFY (TEST_CLOCK_NEAR (&test_bus,32000000.0),NULL);
+		VERIFY (TEST_CLOCK_NEAR (&test_uart,16000000.0),NULL);
+	}
+}
+TEST_END
+
+typedef struct PACK_STRUCTURE test_io_power_domain {
+	IO_CPU_POWER_DOMAIN_STRUCT_MEMBERS
+	bool on;
+} test_io_power_domain_t;
+
+static io_cpu_power_domain_t const*
+test_io_power_domain_ro (io_cpu_power_domain_pointer_t pd) {
+	return io_cpu_power_domain_pointer_ro (pd);
+}
+
+static io_cpu_power_domain_t*
+test_io_power_domain_rw (io_cpu_power_domain_pointer_t pd) {
+	return io_cpu_power_domain_pointer_rw (pd);
+}
+
+static EVENT_DATA io_cpu_power_domain_pointer_implementation_t
+test_io_power_domain_pointer_implementation = {
+	.get_as_read_only = test_io_power_domain_ro,
+	.get_as_read_write = test_io_power_domain_rw,
+};
+
+static void
+test_io_power_domain_turn_on (io_t *io,io_cpu_power_domain_pointer_t pd) {
+	((test_io_power_domain_t*) io_cpu_power_domain_rw_pointer (pd))->on = true;
+}
+
+static void
+test_io_power_domain_turn_off (io_t *io,io_cpu_power_domain_pointer_t pd) {
+	((test_io_power_domain_t*) io_cpu_power_domain_rw_pointer (pd))->on = false;
+}
+
+static EVENT_DATA io_cpu_power_domain_implementation_t test_io_power_domain_implementation = {
+	.specialisation_of = NULL,
+	.turn_off = test_io_power_domain_turn_off,
+	.turn_on = test_io_power_domain_turn_on,
+};
+
+static test_io_power_domain_t test_peripheral_domain = {
+	.implementation = &test_io_power_domain_implementation,
+	.reference_count = 0,
+	.on = false,
+};
+
+#define TEST_PERIPHERAL_DOMAIN ((io_cpu_power_domain_pointer_t) {\
+		.implementation = &test_io_power_domain_pointer_implementation,\
+		.ptr.rw = (io_cpu_power_domain_t*) &test_peripheral_domain,\
+	})
+
+static io_cpu_power_domain_pointer_t
+test_io_peripheral_clock_power_domain (io_cpu_clock_pointer_t clock) {
+	return TEST_PERIPHERAL_DOMAIN;
+}
+
+static EVENT_DATA io_cpu_clock_implementation_t test_io_peripheral_clock_implementation = {
+	SPECIALISE_DEPENDANT_IO_CPU_CLOCK_IMPLEMENTATION (&io_dependent_clock_implementation)
+	.get_power_domain = test_io_peripheral_clock_power_domain,
+};
+
+static const io_cpu_dependant_clock_t test_peripheral_clock = {
+	.implementation = &test_io_peripheral_clock_implementation,
+	.input = decl_io_cpu_clock_pointer (&test_osc),
+};
+
+static io_time_t
+test_io_power_manager_clock (void *user_value) {
+	return *(io_time_t*) user_value;
+}
+
+#define TEST_MS(t)	(t).ns / 1000000LL
+
+TEST_BEGIN(test_io_power_manager_1) {
+	io_power_manager_t pm;
+	io_managed_power_domain_t domain;
+	io_time_t now = time_zero();
+	int socket,channel;
+
+	initialise_io_power_manager (&pm,TEST_IO);
+	io_power_manager_set_clock (&pm,test_io_power_manager_clock,&now);
+	io_power_manager_add_domain (
+		&pm,&domain,TEST_PERIPHERAL_DOMAIN,millisecond_time (10),false
+	);
+	VERIFY (io_power_manager_find_domain (&pm,TEST_PERIPHERAL_DOMAIN) == &domain,NULL);
+
+	// the first holder turns the domain on
+	VERIFY (io_power_domain_hold (&domain,&socket),NULL);
+	VERIFY (test_peripheral_domain.on && io_power_domain_turned_on (&domain) == 1,NULL);
+	VERIFY (io_power_manager_hold_clock (&pm,IO_CPU_CLOCK (&test_peripheral_clock)),NULL);
+	VERIFY (io_power_domain_hold (&domain,&channel),NULL);
+	VERIFY (io_power_domain_holders (&domain) == 3,NULL);
+	VERIFY (test_peripheral_domain.reference_count == 3,NULL);
+	VERIFY (io_power_domain_is_held_by (&domain,&test_peripheral_clock),NULL);
+
+	VERIFY (io_power_domain_release (&domain,&socket),NULL);
+	VERIFY (!io_power_domain_release (&domain,&socket),NULL);
+	VERIFY (io_power_manager_release_clock (&pm,IO_CPU_CLOCK (&test_peripheral_clock)),NULL);
+	VERIFY (io_power_domain_state (&domain) == IO_POWER_DOMAIN_ON,NULL);
+
+	// the domain stays on for the hysteresis time after the last release
+	now = millisecond_time (5);
+	VERIFY (io_power_domain_release (&domain,&channel),NULL);
+	VERIFY (io_power_domain_state (&domain) == IO_POWER_DOMAIN_IDLE,NULL);
+	now = millisecond_time (10);
+	io_power_manager_poll (&pm);
+	VERIFY (test_peripheral_domain.on,NULL);
+
+	// a hold within the hysteresis does not switch the domain
+	now = millisecond_time (12);
+	VERIFY (io_power_domain_hold (&domain,&socket),NULL);
+	VERIFY (io_power_domain_turned_on (&domain) == 1,NULL);
+	now = millisecond_time (20);
+	VERIFY (io_power_domain_release (&domain,&socket),NULL);
+	now = millisecond_time (29);
+	io_power_manager_poll (&pm);
+	VERIFY (test_peripheral_domain.on,NULL);
+	now = millisecond_time (31);
+	io_power_manager_poll (&pm);
+	VERIFY (!test_peripheral_domain.on,NULL);
+	VERIFY (io_power_domain_state (&domain) == IO_POWER_DOMAIN_OFF,NULL);
+	VERIFY (io_power_domain_turned_off (&domain) == 1,NULL);
+	VERIFY (test_peripheral_domain.reference_count == 0,NULL);
+
+	// time in each state
+	now = millisecond_time (40);
+	VERIFY (TEST_MS (io_power_domain_time_in_state (&domain,IO_POWER_DOMAIN_ON)) == 13,NULL);
+	VERIFY (TEST_MS (io_power_domain_time_in_state (&domain,IO_POWER_DOMAIN_IDLE)) == 18,NULL);
+	VERIFY (TEST_MS (io_power_domain_time_in_state (&domain,IO_POWER_DOMAIN_OFF)) == 9,NULL);
+
+	io_power_manager_remove_domain (&pm,&domain);
+	VERIFY (io_power_manager_find_domain (&pm,TEST_PERIPHERAL_DOMAIN) == NULL,NULL);
+}
+TEST_END
+
+typedef struct PACK_STRUCTURE test_tickless_io {
+	IO_STRUCT_MEMBERS
+	io_time_t now;
+	io_time_t wakeup;
+	io_time_t interrupt;
+	io_time_t interrupted;
+	io_event_t *interrupt_event;
+	uint32_t wakeups;
+} test_tickless_io_t;
+
+static io_time_t
+test_tickless_io_get_time (io_t *io) {
+	return ((test_tickless_io_t*) io)->now;
+}
+
+static void
+test_tickless_io_set_wakeup_time (io_t *io,io_time_t t) {
+	((test_tickless_io_t*) io)->wakeup = t;
+}
+
+//
+// the emulated core sleeps until its wake up or the next interrupt
+//
+static void
+test_tickless_io_sleep (io_t *io) {
+	test_tickless_io_t *this = (test_tickless_io_t*) io;
+	io_time_t next = this->wakeup;
+
+	if (this->interrupt.ns < next.ns) {
+		next = this->interrupt;
+	}
+
+	if (next.ns != LLONG_MAX) {
+		if (next.ns > this->now.ns) {
+			this->now = next;
+		}
+		this->wakeups ++;
+		if (this->interrupt.ns <= this->now.ns) {
+			this->interrupt = (io_time_t) {LLONG_MAX};
+			io_enqueue_event (io,this->interrupt_event);
+		}
+	}
+}
+
+static EVENT_DATA io_implementation_t test_tickless_io_implementation = {
+	SPECIALISE_IO_IMPLEMENTATION(NULL)
+	.get_time = test_tickless_io_get_time,
+	.enqueue_alarm = enqueue_io_alarm,
+	.dequeue_alarm = dequeue_io_alarm,
+	.wait_for_event = tickless_wait_for_io_event,
+	.set_wakeup_time = test_tickless_io_set_wakeup_time,
+	.sleep = test_tickless_io_sleep,
+};
+
+typedef struct {
+	io_t *io;
+	io_alarm_t alarm;
+	io_event_t event;
+	io_time_t period;
+	uint32_t count;
+	bool on_time;
+} test_tickless_alarm_t;
+
+static void
+test_tickless_alarm_event (io_event_t *ev) {
+	test_tickless_alarm_t *this = ev->user_value;
+	io_time_t now = io_get_time (this->io);
+
+	this->count ++;
+	this->on_time = this->on_time && (now.ns == this->alarm.when.ns);
+	if (this->period.ns) {
+		this->alarm.when.ns += this->period.ns;
+		io_enqueue_alarm (this->io,&this->alarm);
+	}
+}
+
+static void
+test_tickless_interrupt_event (io_event_t *ev) {
+	test_tickless_io_t *this = ev->user_value;
+	this->interrupted = io_get_time ((io_t*) this);
+}
+
+TEST_BEGIN(test_io_tickless_alarms_1) {
+	test_tickless_io_t core;
+	io_t *io = (io_t*) &core;
+	test_tickless_alarm_t periodic = {.io = io,.period = millisecond_time (10),.on_time = true};
+	test_tickless_alarm_t once = {.io = io,.period = time_zero(),.on_time = true};
+	test_tickless_alarm_t cancelled = {.io = io,.period = time_zero(),.on_time = true};
+	io_event_t interrupt;
+
+	initialise_io (io,&test_tickless_io_implementation);
+	core.now = time_zero();
+	core.wakeup = (io_time_t) {LLONG_MAX};
+	core.interrupt = millisecond_time (33);
+	core.interrupted = time_zero();
+	core.interrupt_event = &interrupt;
+	core.wakeups = 0;
+	initialise_io_event (&interrupt,test_tickless_interrupt_event,&core);
+
+	initialise_io_event (&periodic.event,test_tickless_alarm_event,&periodic);
+	initialise_io_alarm (&periodic.alarm,&periodic.event,&periodic.event,millisecond_time (10));
+	initialise_io_event (&once.event,test_tickless_alarm_event,&once);
+	initialise_io_alarm (&once.alarm,&once.event,&once.event,millisecond_time (25));
+	initialise_io_event (&cancelled.event,test_tickless_alarm_event,&cancelled);
+	initialise_io_alarm (&cancelled.alarm,&cancelled.event,&cancelled.event,millisecond_time (5));
+
+	// the wake up always follows the head of the alarm list
+	io_enqueue_alarm (io,&cancelled.alarm);
+	VERIFY (core.wakeup.ns == millisecond_time (5).ns,NULL);
+	io_enqueue_alarm (io,&periodic.alarm);
+	io_enqueue_alarm (io,&once.alarm);
+	VERIFY (core.wakeup.ns == millisecond_time (5).ns,NULL);
+	io_dequeue_alarm (io,&cancelled.alarm);
+	VERIFY (!is_io_alarm_active (&cancelled.alarm),NULL);
+	VERIFY (core.wakeup.ns == millisecond_time (10).ns,NULL);
+
+	while (core.now.ns < millisecond_time (100).ns) {
+		while (io->events != &s_null_io_event) {
+			do_next_io_event (io);
+		}
+		io_wait_for_event (io);
+	}
+	while (io->events != &s_null_io_event) {
+		do_next_io_event (io);
+	}
+
+	// one wake up per deadline instead of one per millisecond tick
+	VERIFY (core.wakeups == 12,NULL);
+	VERIFY (periodic.count == 10 && periodic.on_time,NULL);
+	VERIFY (once.count == 1 && once.on_time,NULL);
+	VERIFY (cancelled.count == 0,NULL);
+	VERIFY (core.interrupted.ns == millisecond_time (33).ns,NULL);
+
+	io_dequeue_alarm (io,&periodic.alarm);
+	VERIFY (io->alarms == &s_null_io_alarm,NULL);
+	VERIFY (core.wakeup.ns == LLONG_MAX,NULL);
+}
+TEST_END
+
+#ifdef WITH_IO_EVENT_INSTRUMENTATION
+static void
+test_instrumented_event (io_event_t *ev) {
+	uint32_t *count = ev->user_value;
+	(*count) ++;
+}
+
+TEST_BEGIN(test_io_event_instrumentation_1) {
+	test_tickless_io_t core;
+	io_t *io = (io_t*) &core;
+	io_event_instrumentation_t instrumentation;
+	io_event_histogram_t h = {0};
+	io_event_handler_statistics_t const *stats;
+	io_event_t ev[3];
+	io_alarm_t alarm;
+	uint32_t count = 0;
+
+	for (int64_t v = 0; v < 1000; v++) {
+		io_event_histogram_record (&h,v);
+	}
+	VERIFY (io_event_histogram_count (&h) == 1000,NULL);
+	VERIFY (io_event_histogram_maximum (&h) == 999,NULL);
+	VERIFY (io_event_histogram_mean (&h) == 499,NULL);
+	VERIFY (io_event_histogram_percentile (&h,50) == 448,NULL);
+	VERIFY (io_event_histogram_percentile (&h,100) == 999,NULL);
+
+	initialise_io (io,&test_tickless_io_implementation);
+	core.now = time_zero();
+	core.wakeup = (io_time_t) {LLONG_MAX};
+	core.interrupt = (io_time_t) {LLONG_MAX};
+	core.interrupt_event = NULL;
+	core.wakeups = 0;
+	initialise_io_event_instrumentation (&instrumentation);
+	io_attach_event_instrumentation (io,&instrumentation);
+
+	for (int i = 0; i < 3; i++) {
+		initialise_io_event (ev + i,test_instrumented_event,&count);
+		io_enqueue_event (io,ev + i);
+		core.now.ns += 100;
+	}
+	io_dequeue_event (io,ev + 2);
+	VERIFY (instrumentation.queue_depth == 2,NULL);
+	VERIFY (instrumentation.maximum_queue_depth == 3,NULL);
+
+	while (do_next_io_event (io));
+	VERIFY (count == 2,NULL);
+	VERIFY (instrumentation.queue_depth == 0,NULL);
+	VERIFY (io_event_histogram_count (&instrumentation.wait_time) == 2,NULL);
+	VERIFY (io_event_histogram_maximum (&instrumentation.wait_time) == 300,NULL);
+	VERIFY (io_event_histogram_count (&instrumentation.critical_section_time) > 0,NULL);
+
+	stats = io_event_instrumentation_handler (&instrumentation,test_instrumented_event);
+	VERIFY (stats != NULL && io_event_histogram_count (&stats->run_time) == 2,NULL);
+	VERIFY (instrumentation.untracked_dispatches == 0,NULL);
+
+	// sleeping in the wait is not critical section time
+	initialise_io_alarm (&alarm,ev,ev,millisecond_time (10));
+	io_enqueue_alarm (io,&alarm);
+	io_wait_for_event (io);
+	while (do_next_io_event (io));
+	VERIFY (count == 3 && core.now.ns >= millisecond_time (10).ns,NULL);
+	VERIFY (
+		io_event_histogram_maximum (&instrumentation.critical_section_time)
+		< millisecond_time (1).ns,
+		NULL
+	);
+
+	io_attach_event_instrumentation (io,NULL);
+}
+TEST_END
+#endif /* WITH_IO_EVENT_INSTRUMENTATION */
+
+UNIT_SETUP(setup_io_power_unit_test) {
+	return VERIFY_UNIT_CONTINUE;
+}
+
+UNIT_TEARDOWN(teardown_io_power_unit_test) {
+}
+
+static void
+io_power_unit_test (V_unit_test_t *unit) {
+	static V_test_t const tests[] = {
+		test_io_cpu_clock_plan_1,
+		test_io_power_manager_1,
+		test_io_tickless_alarms_1,
+		#ifdef WITH_IO_EVENT_INSTRUMENTATION
+		test_io_event_instrumentation_1,
+		#endif
+		0
+	};
+	unit->name = "io power and clocks";
+	unit->description = "io power and clocks unit test";
+	unit->tests = tests;
+	unit->setup = setup_io_power_unit_test;
+	unit->teardown = teardown_io_power_unit_test;
+}
+
+typedef struct {
+	io_coroutine_t co;
+	io_byte_pipe_t *pipe;
+	uint8_t byte;
+	io_time_t waited,read,timed_out,finished;
+	bool timed_out_flag;
+} test_io_coroutine_t;
+
+//
+// a small protocol: wait, read a byte, wait for a second byte that
+// never arrives then wait for a final notification
+//
+static void
+test_io_coroutine_body (io_coroutine_t *co) {
+	test_io_coroutine_t *this = io_coroutine_user_value (co);
+
+	IO_COROUTINE_BEGIN(co);
+
+	IO_AWAIT_TIME(co,millisecond_time (10));
+	this->waited = io_get_time (co->io);
+
+	IO_AWAIT_UNTIL(co,io_byte_pipe_is_readable (this->pipe));
+	io_byte_pipe_get_byte (this->pipe,&this->byte);
+	this->read = io_get_time (co->io);
+
+	IO_AWAIT_UNTIL_OR_TIME(co,io_byte_pipe_is_readable (this->pipe),millisecond_time (20));
+	this->timed_out_flag = io_coroutine_timed_out (co);
+	this->timed_out = io_get_time (co->io);
+
+	IO_COROUTINE_YIELD(co);
+	IO_AWAIT_EVENT(co);
+	this->finished = io_get_time (co->io);
+
+	IO_COROUTINE_END(co);
+}
+
+typedef struct {
+	io_alarm_t alarm;
+	io_event_t event;
+	test_io_coroutine_t *target;
+	bool put_byte;
+} test_io_coroutine_poke_t;
+
+static void
+test_io_coroutine_poke_event (io_event_t *ev) {
+	test_io_coroutine_poke_t *this = ev->user_value;
+	if (this->put_byte) {
+		io_byte_pipe_put_byte (this->target->pipe,42);
+	}
+	io_enqueue_event (this->target->co.io,io_coroutine_event (&this->target->co));
+}
+
+TEST_BEGIN(test_io_coroutine_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	test_tickless_io_t core;
+	io_t *io = (io_t*) &core;
+	test_io_coroutine_t t = {0};
+	test_io_coroutine_poke_t pokes[] = {
+		{.target = &t,.put_byte = false},	// spurious resume while waiting
+		{.target = &t,.put_byte = true},
+		{.target = &t,.put_byte = false},
+	};
+	int32_t at[] = {5,25,60};
+
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	initialise_io (io,&test_tickless_io_implementation);
+	core.now = time_zero();
+	core.wakeup = (io_time_t) {LLONG_MAX};
+	core.interrupt = (io_time_t) {LLONG_MAX};
+	core.interrupted = time_zero();
+	core.interrupt_event = NULL;
+	core.wakeups = 0;
+
+	t.pipe = mk_io_byte_pipe (bm,4);
+	for (int i = 0; i < SIZEOF(pokes); i++) {
+		initialise_io_event (&pokes[i].event,test_io_coroutine_poke_event,pokes + i);
+		initialise_io_alarm (
+			&pokes[i].alarm,&pokes[i].event,&pokes[i].event,millisecond_time (at[i])
+		);
+		io_enqueue_alarm (io,&pokes[i].alarm);
+	}
+
+	initialise_io_coroutine (&t.co,io,test_io_coroutine_body,&t);
+	start_io_coroutine (&t.co);
+
+	while (!io_coroutine_is_finished (&t.co) && core.now.ns < millisecond_time (100).ns) {
+		while (io->events != &s_null_io_event) {
+			do_next_io_event (io);
+		}
+		if (!io_coroutine_is_finished (&t.co)) {
+			io_wait_for_event (io);
+		}
+	}
+
+	VERIFY (io_coroutine_is_finished (&t.co),NULL);
+	VERIFY (t.waited.ns == millisecond_time (10).ns,NULL);
+	VERIFY (t.read.ns == millisecond_time (25).ns && t.byte == 42,NULL);
+	VERIFY (t.timed_out_flag && t.timed_out.ns == millisecond_time (45).ns,NULL);
+	VERIFY (t.finished.ns == millisecond_time (60).ns,NULL);
+	VERIFY (io->alarms == &s_null_io_alarm,NULL);
+
+	// a stopped coroutine ignores its resume event
+	start_io_coroutine (&t.co);
+	stop_io_coroutine (&t.co);
+	VERIFY (io->events == &s_null_io_event,NULL);
+	VERIFY (io_coroutine_is_finished (&t.co),NULL);
+
+	free_io_byte_pipe (t.pipe,bm);
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+UNIT_SETUP(setup_io_coroutine_unit_test) {
+	return VERIFY_UNIT_CONTINUE;
+}
+
+UNIT_TEARDOWN(teardown_io_coroutine_unit_test) {
+}
+
+static void
+io_coroutine_unit_test (V_unit_test_t *unit) {
+	static V_test_t const tests[] = {
+		test_io_coroutine_1,
+		0
+	};
+	unit->name = "io coroutines";
+	unit->description = "io coroutines unit test";
+	unit->tests = tests;
+	unit->setup = setup_io_coroutine_unit_test;
+	unit->teardown = teardown_io_coroutine_unit_test;
+}
+
 void
 run_ut_io_core_containers (V_runner_t *runner) {
 	static const unit_test_t test_set[] = {
 		io_byte_memory_unit_test,
 		io_core_containers_unit_test,
+		io_power_unit_test,
+		io_coroutine_unit_test,
 		0
 	};
 	V_run_unit_tests(runner,test_set);
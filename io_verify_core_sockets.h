@@ -224,6 +224,191 @@ TEST_BEGIN(test_io_address_3) {
 }
 TEST_END
 
+TEST_BEGIN(test_io_address_4) {
+	static const uint8_t two[] = {2,0,0,0,0,0,0,0};
+	static const uint8_t low[] = {0,0,0,0,0,1};
+	static const uint8_t long_a[] = {1,2,3,4,5,6,7,8,9,10};
+	static const uint8_t long_b[] = {1,2,3,4,5,6,7,8,9,11};
+	static const uint8_t long_c[] = {2,2,3,4,5,6,7,8,9,10};
+	io_address_t sizes[] = {
+		def_io_u8_address (2),
+		def_io_u16_address (2),
+		def_io_u32_address (2),
+		def_io_const_address (sizeof(two),two),
+	};
+
+	// the same value at every size
+	for (int i = 0; i < SIZEOF(sizes); i++) {
+		for (int j = 0; j < SIZEOF(sizes); j++) {
+			VERIFY (compare_io_addresses (sizes[i],sizes[j]) == 0,NULL);
+			VERIFY (io_address_hash (sizes[i]) == io_address_hash (sizes[j]),NULL);
+		}
+	}
+
+	VERIFY (compare_io_addresses (def_io_u8_address (255),def_io_u16_address (256)) < 0,NULL);
+	VERIFY (compare_io_addresses (def_io_u32_address (0x10000),def_io_u16_address (0xffff)) > 0,NULL);
+	VERIFY (compare_io_addresses (def_io_u8_address (5),def_io_const_address (sizeof(low),low)) < 0,NULL);
+	VERIFY (compare_io_addresses (def_io_const_address (sizeof(low),low),def_io_u32_address (5)) > 0,NULL);
+
+	// word-wise and byte-wise differences in long addresses
+	VERIFY (
+		compare_io_addresses (
+			def_io_const_address (sizeof(long_a),long_a),
+			def_io_const_address (sizeof(long_b),long_b)
+		) < 0,
+		NULL
+	);
+	VERIFY (
+		compare_io_addresses (
+			def_io_const_address (sizeof(long_c),long_c),
+			def_io_const_address (sizeof(long_a),long_a)
+		) > 0,
+		NULL
+	);
+	VERIFY (
+		io_address_hash (def_io_const_address (sizeof(long_a),long_a))
+		!= io_address_hash (def_io_const_address (sizeof(long_b),long_b)),
+		NULL
+	);
+
+	VERIFY (compare_io_addresses (io_invalid_address(),io_invalid_address()) == 0,NULL);
+	VERIFY (compare_io_addresses (def_io_u8_address (0),io_invalid_address()) < 0,NULL);
+	VERIFY (compare_io_addresses (io_invalid_address(),def_io_u8_address (0)) > 0,NULL);
+	VERIFY (io_address_hash (def_io_u8_address (1)) != io_address_hash (def_io_u8_address (2)),NULL);
+}
+TEST_END
+
+static io_encoding_t*
+test_io_link_layer_1_message (
+	io_byte_memory_t *bm,io_address_t const *address
+) {
+	io_encoding_t *message = reference_io_encoding (mk_io_packet_encoding (bm));
+	if (message) {
+		io_layer_t *layer = push_io_link_transmit_layer (message);
+		io_layer_set_source_address (layer,message,address[0]);
+		io_layer_set_destination_address (layer,message,address[1]);
+		io_layer_set_inner_address (layer,message,address[2]);
+		io_encoding_append_string (message,"abc",3);
+	}
+	return message;
+}
+
+static bool
+test_io_link_layer_1_same_bytes (io_encoding_t *a,io_encoding_t *b) {
+	return (
+			io_encoding_length (a) == io_encoding_length (b)
+		&&	memcmp (
+				io_encoding_get_byte_stream (a),
+				io_encoding_get_byte_stream (b),
+				io_encoding_length (a)
+			) == 0
+	);
+}
+
+//
+// link headers loaded from a template are the same as encoded headers and
+// received link headers are read without allocating long addresses
+//
+TEST_BEGIN(test_io_link_layer_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	static const uint8_t long_source[] = {1,2,3,4,5,6};
+	static const uint8_t long_inner[] = {9,8,7,6,5};
+	const io_address_t cases[][3] = {
+		{def_io_u8_address (1),def_io_u8_address (2),def_io_u8_address (3)},
+		{def_io_u8_address (1),def_io_u16_address (2),def_io_u8_address (3)},
+		{def_io_u16_address (0x102),def_io_u32_address (5),def_io_u8_address (7)},
+		{def_io_const_address (sizeof(long_source),long_source),def_io_u8_address (2),def_io_u8_address (9)},
+		{def_io_u8_address (4),io_invalid_address(),def_io_const_address (sizeof(long_inner),long_inner)},
+	};
+	io_link_header_template_t template;
+	uint32_t parse_bytes[SIZEOF(cases)];
+
+	io_byte_memory_get_info (bm,&bmbegin);
+	initialise_io_link_header_template (&template);
+
+	for (int c = 0; c < SIZEOF(cases); c++) {
+		io_encoding_t *encoded = test_io_link_layer_1_message (bm,cases[c]);
+		io_encoding_t *copied = test_io_link_layer_1_message (bm,cases[c]);
+
+		if (VERIFY (encoded != NULL && copied != NULL,NULL)) {
+			io_layer_t *layer = get_io_link_layer (copied);
+			io_encoding_t *received;
+
+			VERIFY (io_layer_load_header (get_io_link_layer (encoded),encoded),NULL);
+
+			// the first load encodes the template, later loads copy it
+			VERIFY (io_link_layer_load_header_from_template (layer,copied,&template),NULL);
+			VERIFY (io_link_layer_load_header_from_template (layer,copied,&template),NULL);
+			VERIFY (test_io_link_layer_1_same_bytes (encoded,copied),NULL);
+			VERIFY (compare_io_addresses (template.source_address,cases[c][0]) == 0,NULL);
+			VERIFY (io_address_size (template.destination_address) == io_address_size (cases[c][1]),NULL);
+
+			received = reference_io_encoding (mk_io_packet_encoding (bm));
+			if (VERIFY (received != NULL,NULL)) {
+				uint8_t const *begin = io_encoding_get_byte_stream (encoded);
+				memory_info_t before,after;
+				io_layer_t *link;
+
+				io_encoding_append_bytes (received,begin,io_encoding_length (encoded));
+				begin = io_encoding_get_byte_stream (received);
+
+				io_byte_memory_get_info (bm,&before);
+				link = push_io_link_receive_layer (received);
+				io_byte_memory_get_info (bm,&after);
+				parse_bytes[c] = after.used_bytes - before.used_bytes;
+
+				if (VERIFY (link != NULL,NULL)) {
+					io_address_t src = io_layer_get_source_address (link,received);
+					io_address_t inner = io_layer_get_inner_address (link,received);
+					const uint8_t *b,*e;
+
+					VERIFY (compare_io_addresses (src,cases[c][0]) == 0,NULL);
+					VERIFY (io_address_size (src) == io_address_size (cases[c][0]),NULL);
+					VERIFY (compare_io_addresses (io_layer_get_destination_address (link,received),cases[c][1]) == 0,NULL);
+					VERIFY (compare_io_addresses (inner,cases[c][2]) == 0,NULL);
+
+					io_encoding_get_content (received,&b,&e);
+					VERIFY ((e - b) == 3 && memcmp (b,"abc",3) == 0,NULL);
+
+					// long addresses refer to the frame and are copied when kept
+					if (!io_address_is_inline (inner) && io_address_is_valid (inner)) {
+						io_address_t kept = duplicate_io_address (bm,inner);
+						VERIFY (io_address_is_view (inner) && !io_address_is_volatile (inner),NULL);
+						VERIFY (io_address_is_volatile (kept) && !io_address_is_view (kept),NULL);
+						VERIFY (
+								io_address_ro_bytes (inner) > begin
+							&&	io_address_ro_bytes (inner) < begin + io_encoding_length (received),
+							NULL
+						);
+						VERIFY (io_address_ro_bytes (kept) != io_address_ro_bytes (inner),NULL);
+						VERIFY (compare_io_addresses (kept,inner) == 0,NULL);
+						free_io_address (bm,kept);
+					}
+
+					// an address that replaces a view is owned by the layer
+					io_layer_set_source_address (link,received,cases[c][2]);
+					VERIFY (compare_io_addresses (io_layer_get_source_address (link,received),cases[c][2]) == 0,NULL);
+				}
+				unreference_io_encoding (received);
+			}
+		}
+
+		unreference_io_encoding (encoded);
+		unreference_io_encoding (copied);
+	}
+
+	// parsing uses the same memory whatever the size of the addresses
+	for (int c = 1; c < SIZEOF(cases); c++) {
+		VERIFY (parse_bytes[c] == parse_bytes[0],NULL);
+	}
+
+	free_io_link_header_template (bm,&template);
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
 TEST_BEGIN(test_io_adapter_socket_1) {
 	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
 	memory_info_t bmbegin,bmend;
@@ -411,6 +596,87 @@ TEST_BEGIN(test_io_multiplex_socket_2) {
 }
 TEST_END
 
+static bool
+test_io_multiplex_socket_3_demux (io_socket_t *mux,uint32_t number_of_bindings) {
+	io_multiplex_socket_t *this = (io_multiplex_socket_t*) mux;
+	bool ok = true;
+
+	// bind out of address order
+	for (uint32_t i = 0; i < number_of_bindings && ok; i++) {
+		io_address_t a = def_io_u16_address ((i * 7919) % number_of_bindings + 1);
+		ok &= io_socket_bind_inner (mux,a,NULL,NULL);
+	}
+
+	ok &= (this->number_of_slots == number_of_bindings);
+	
+	for (uint32_t i = 1; i <= number_of_bindings && ok; i++) {
+		io_inner_binding_t *inner = io_multiplex_socket_find_inner_binding (
+			this,def_io_u16_address (i)
+		);
+		ok &= (
+				inner != NULL
+			&&	compare_io_addresses (inner->address,def_io_u16_address (i)) == 0
+		);
+	}
+	ok &= io_multiplex_socket_find_inner_binding (
+		this,def_io_u16_address (number_of_bindings + 1)
+	) == NULL;
+	ok &= io_multiplex_socket_find_inner_binding (
+		this,def_io_u32_address (number_of_bindings + 2)
+	) == NULL;
+
+	// addresses compare by value so a u8 1 finds the u16 1 binding
+	ok &= (
+			io_multiplex_socket_find_inner_binding (this,def_io_u8_address (1))
+		==	io_multiplex_socket_find_inner_binding (this,def_io_u16_address (1))
+	);
+
+	// unbind the odd addresses and rebind them to new addresses
+	for (uint32_t i = 1; i <= number_of_bindings && ok; i += 2) {
+		io_socket_unbind_inner (mux,def_io_u16_address (i));
+		ok &= io_multiplex_socket_find_inner_binding (this,def_io_u16_address (i)) == NULL;
+	}
+	for (uint32_t i = 1; i <= number_of_bindings && ok; i += 2) {
+		ok &= io_socket_bind_inner (mux,def_io_u32_address (i),NULL,NULL);
+	}
+
+	ok &= (this->number_of_slots == number_of_bindings);
+
+	for (uint32_t i = 1; i <= number_of_bindings && ok; i++) {
+		io_address_t a = (i & 1) ? def_io_u32_address (i) : def_io_u16_address (i);
+		io_inner_binding_t *inner = io_multiplex_socket_find_inner_binding (this,a);
+		ok &= (inner != NULL && compare_io_addresses (inner->address,a) == 0);
+	}
+
+	return ok;
+}
+
+TEST_BEGIN(test_io_multiplex_socket_3) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	io_settings_t settings = {
+		.transmit_pipe_length = 1,
+		.receive_pipe_length = 1,
+	};
+	const socket_builder_t net[] = {
+		{0,allocate_io_multiplex_socket,io_invalid_address(),&settings,false,NULL},
+	};
+	uint32_t sizes[] = {8,64,256};
+	io_socket_t* mux[1];
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	for (int i = 0; i < SIZEOF(sizes); i++) {
+		build_io_sockets(TEST_IO,mux,net,1);
+		VERIFY (test_io_multiplex_socket_3_demux (mux[0],sizes[i]),NULL);
+		io_socket_free(mux[0]);
+	}
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
 TEST_BEGIN(test_io_multiplexer_socket_1) {
 	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
 	memory_info_t bmbegin,bmend;
@@ -433,6 +699,1205 @@ TEST_BEGIN(test_io_multiplexer_socket_1) {
 }
 TEST_END
 
+//
+// an outer socket that takes a limited number of messages each time
+// it signals transmit available
+//
+typedef struct PACK_STRUCTURE {
+	IO_SOCKET_STRUCT_MEMBERS
+	io_event_t *transmit_available;
+	uint32_t budget;
+	uint32_t received[4];
+	uint32_t received_bytes[4];
+	uint32_t longest_message;
+} test_io_rate_limited_socket_t;
+
+static bool
+test_io_rate_limited_socket_bind_inner (
+	io_socket_t *socket,io_address_t address,io_event_t *tx,io_event_t *rx
+) {
+	test_io_rate_limited_socket_t *this = (test_io_rate_limited_socket_t*) socket;
+	this->transmit_available = tx;
+	return true;
+}
+
+static bool
+test_io_rate_limited_socket_send_message (io_socket_t *socket,io_encoding_t *encoding) {
+	test_io_rate_limited_socket_t *this = (test_io_rate_limited_socket_t*) socket;
+	if (this->budget > 0) {
+		// the last byte of the message identifies the sender
+		uint8_t const *bytes = io_encoding_get_byte_stream (encoding);
+		uint8_t id = bytes[io_encoding_length (encoding) - 1];
+		if (id < SIZEOF(this->received)) {
+			this->received[id]++;
+			this->received_bytes[id] += io_encoding_length (encoding);
+		}
+		if (io_encoding_length (encoding) > this->longest_message) {
+			this->longest_message = io_encoding_length (encoding);
+		}
+		this->budget--;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+static size_t
+test_io_rate_limited_socket_mtu (io_socket_t const *socket) {
+	return IO_SOCKET_MINIMUM_MTU;
+}
+
+static EVENT_DATA io_socket_implementation_t test_io_rate_limited_socket_implementation = {
+	SPECIALISE_IO_SOCKET_IMPLEMENTATION (&io_socket_implementation_base)
+	.bind_inner = test_io_rate_limited_socket_bind_inner,
+	.send_message = test_io_rate_limited_socket_send_message,
+	.mtu = test_io_rate_limited_socket_mtu,
+};
+
+typedef struct {
+	io_socket_t *socket;
+	uint8_t id;
+	uint32_t remaining;
+	uint32_t dropped;
+	uint32_t length;
+} test_io_multiplexer_sender_t;
+
+//
+// send while there is transmit credit
+//
+static void
+test_io_multiplexer_socket_2_transmit_available (io_event_t *ev) {
+	test_io_multiplexer_sender_t *this = ev->user_value;
+	io_address_t a = def_io_u8_address (this->id + 1);
+
+	while (
+			this->remaining > 0
+		&&	io_multiplexer_socket_transmit_credit (this->socket,a) > 0
+	) {
+		io_encoding_t *message = io_socket_new_message (this->socket);
+		io_layer_set_destination_address (
+			get_io_binary_layer (message),message,a
+		);
+		for (uint32_t i = 0; i < this->length; i++) {
+			io_encoding_append_byte (message,this->id);
+		}
+		if (!io_socket_send_message (this->socket,message)) {
+			this->dropped++;
+		}
+		this->remaining--;
+	}
+}
+
+TEST_BEGIN(test_io_multiplexer_socket_2) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const io_settings_t settings = {
+		.transmit_pipe_length = 4,
+		.receive_pipe_length = 4,
+	};
+	const socket_builder_t net[] = {
+		{0,allocate_io_socket_binary_emulator,def_io_u8_address(11),&settings,false,NULL},
+	};
+	test_io_rate_limited_socket_t link = {
+		.implementation = &test_io_rate_limited_socket_implementation,
+		.io = TEST_IO,
+		.transmit_available = NULL,
+		.budget = 0,
+		.received = {0},
+		.received_bytes = {0},
+		.longest_message = 0,
+	};
+	const uint32_t number_of_messages = 64;
+	test_io_multiplexer_sender_t sender[4];
+	io_event_t tx[SIZEOF(sender)];
+	io_socket_t* emu[1];
+	uint32_t ticks = 0;
+	bool fair = true;
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	build_io_sockets (TEST_IO,emu,net,1);
+	io_socket_bind_to_outer_socket (emu[0],(io_socket_t*) &link);
+
+	for (uint8_t i = 0; i < SIZEOF(sender); i++) {
+		sender[i] = (test_io_multiplexer_sender_t) {emu[0],i,number_of_messages,0,1};
+		initialise_io_event (
+			tx + i,test_io_multiplexer_socket_2_transmit_available,sender + i
+		);
+		io_socket_bind_inner (emu[0],def_io_u8_address (i + 1),tx + i,NULL);
+		io_enqueue_event (TEST_IO,tx + i);
+	}
+	io_wait_for_all_events (TEST_IO);
+
+	// the link takes two messages each time it is available
+	while (ticks++ < 1000) {
+		uint32_t least = link.received[0],most = link.received[0],total = 0;
+
+		link.budget = 2;
+		io_enqueue_event (TEST_IO,link.transmit_available);
+		io_wait_for_all_events (TEST_IO);
+
+		for (int i = 0; i < SIZEOF(sender); i++) {
+			if (link.received[i] < least) least = link.received[i];
+			if (link.received[i] > most) most = link.received[i];
+			total += link.received[i];
+		}
+		fair &= (most - least) <= 1;
+		
+		if (total == SIZEOF(sender) * number_of_messages) {
+			break;
+		}
+	}
+	for (int i = 0; i < SIZEOF(sender); i++) {
+		VERIFY (sender[i].dropped == 0,NULL);
+		VERIFY (link.received[i] == number_of_messages,NULL);
+	}
+	VERIFY (fair,NULL);
+
+	free_io_sockets (emu,emu + 1);
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+TEST_BEGIN(test_io_multiplexer_socket_3) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const io_settings_t settings = {
+		.transmit_pipe_length = 4,
+		.receive_pipe_length = 4,
+	};
+	const socket_builder_t net[] = {
+		{0,allocate_io_socket_binary_emulator,def_io_u8_address(11),&settings,false,NULL},
+	};
+	test_io_rate_limited_socket_t link = {
+		.implementation = &test_io_rate_limited_socket_implementation,
+		.io = TEST_IO,
+		.transmit_available = NULL,
+		.budget = 0,
+		.received = {0},
+		.received_bytes = {0},
+		.longest_message = 0,
+	};
+	const uint16_t weight[] = {1,1,2,4};
+	test_io_multiplexer_sender_t sender[SIZEOF(weight)];
+	io_event_t tx[SIZEOF(weight)];
+	io_socket_t* emu[1];
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	build_io_sockets (TEST_IO,emu,net,1);
+	io_socket_bind_to_outer_socket (emu[0],(io_socket_t*) &link);
+
+	// message lengths differ so the split is of bytes not messages
+	for (uint8_t i = 0; i < SIZEOF(sender); i++) {
+		sender[i] = (test_io_multiplexer_sender_t) {emu[0],i,1000,0,1 + 8 * i};
+		initialise_io_event (
+			tx + i,test_io_multiplexer_socket_2_transmit_available,sender + i
+		);
+		VERIFY (
+			io_multiplex_socket_bind_inner_with_weight (
+				emu[0],def_io_u8_address (i + 1),tx + i,NULL,weight[i]
+			),
+			NULL
+		);
+		io_enqueue_event (TEST_IO,tx + i);
+	}
+	VERIFY (
+		!io_multiplex_socket_bind_inner_with_weight (
+			emu[0],def_io_u8_address (100),NULL,NULL,0
+		),
+		NULL
+	);
+	io_wait_for_all_events (TEST_IO);
+
+	for (int tick = 0; tick < 200; tick++) {
+		link.budget = 2;
+		io_enqueue_event (TEST_IO,link.transmit_available);
+		io_wait_for_all_events (TEST_IO);
+	}
+
+	for (int i = 0; i < SIZEOF(sender); i++) {
+		io_inner_binding_t *inner = io_multiplex_socket_find_inner_binding (
+			(io_multiplex_socket_t*) emu[0],def_io_u8_address (i + 1)
+		);
+		VERIFY (sender[i].dropped == 0,NULL);
+		if (VERIFY (inner != NULL,NULL)) {
+			VERIFY (io_inner_binding_weight (inner) == weight[i],NULL);
+			VERIFY (io_inner_binding_transmit_packets (inner) == link.received[i],NULL);
+			VERIFY (io_inner_binding_transmit_bytes (inner) == link.received_bytes[i],NULL);
+		}
+	}
+
+	//
+	// the bytes sent per unit of weight by any two bindings differ by
+	// no more than two of the longest messages
+	//
+	for (int i = 0; i < SIZEOF(sender); i++) {
+		for (int j = 0; j < SIZEOF(sender); j++) {
+			int32_t d = (
+					(int32_t) (link.received_bytes[i] / weight[i])
+				-	(int32_t) (link.received_bytes[j] / weight[j])
+			);
+			VERIFY (d <= 2 * (int32_t) link.longest_message,NULL);
+		}
+	}
+	VERIFY (link.received_bytes[3] > 3 * link.received_bytes[0],NULL);
+
+	free_io_sockets (emu,emu + 1);
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+typedef struct {
+	io_socket_t *socket;
+	void const *expect;
+	uint32_t received;
+	uint32_t shared;
+} test_io_shared_media_receiver_t;
+
+static void
+test_io_shared_media_1_receive (io_event_t *ev) {
+	test_io_shared_media_receiver_t *this = ev->user_value;
+	io_encoding_pipe_t *pipe = cast_to_io_encoding_pipe (
+		io_socket_get_receive_pipe (this->socket,def_io_u8_address (1))
+	);
+	io_encoding_t *next;
+
+	while (pipe != NULL && io_encoding_pipe_peek (pipe,&next)) {
+		const uint8_t *b,*e;
+		io_encoding_get_content (next,&b,&e);
+		this->received ++;
+		if (
+				io_encoding_get_byte_stream (next) == this->expect
+			&&	(e - b) == 4 && memcmp (b,"gook",4) == 0
+		) {
+			this->shared ++;
+		}
+		io_encoding_pipe_pop_encoding (pipe);
+	}
+}
+
+//
+// one message broadcast to 2 to 64 sockets is received by all of them
+// without copying the message
+//
+TEST_BEGIN(test_io_shared_media_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const io_settings_t bus = {
+		.transmit_pipe_length = 3,
+		.receive_pipe_length = 3,
+		.mtu = 256,
+	};
+	const io_settings_t narrow = {
+		.transmit_pipe_length = 3,
+		.receive_pipe_length = 3,
+		.mtu = 200,
+	};
+	const uint32_t sizes[] = {2,8,64};
+	io_socket_t *node[64];
+	io_event_t rx[SIZEOF(node)];
+	test_io_shared_media_receiver_t receiver[SIZEOF(node)];
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	for (int s = 0; s < SIZEOF(sizes); s++) {
+		uint32_t n = sizes[s];
+		io_socket_t *media = reference_io_socket (
+			io_socket_initialise (
+				allocate_io_shared_media (TEST_IO,io_invalid_address()),TEST_IO,&bus
+			)
+		);
+
+		VERIFY (io_socket_mtu (media) == 0,NULL);
+
+		for (uint32_t i = 0; i < n; i++) {
+			node[i] = reference_io_socket (
+				io_socket_initialise (
+					allocate_io_socket_binary_emulator (TEST_IO,def_io_u8_address (i + 1)),
+					TEST_IO,
+					(i == n - 1) ? &narrow : &bus
+				)
+			);
+			io_socket_bind_to_outer_socket (node[i],media);
+			receiver[i] = (test_io_shared_media_receiver_t) {node[i],NULL,0,0};
+			initialise_io_event (rx + i,test_io_shared_media_1_receive,receiver + i);
+			if (i > 0) {
+				io_socket_bind_inner (node[i],def_io_u8_address (1),NULL,rx + i);
+			}
+		}
+
+		VERIFY (io_socket_mtu (media) == 200,NULL);
+
+		{
+			io_encoding_t *msg = io_socket_new_message (node[0]);
+			if (VERIFY (msg != NULL,NULL)) {
+				uint32_t received = 0,shared = 0;
+				void const *expect;
+
+				io_encoding_append_string (msg,"gook",4);
+				expect = io_encoding_get_byte_stream (msg);
+				for (uint32_t i = 0; i < n; i++) {
+					receiver[i].expect = expect;
+				}
+
+				VERIFY (io_socket_send_message (node[0],msg),NULL);
+				io_wait_for_all_events (TEST_IO);
+
+				for (uint32_t i = 0; i < n; i++) {
+					received += receiver[i].received;
+					shared += receiver[i].shared;
+				}
+				VERIFY (receiver[0].received == 0,NULL);
+				VERIFY (received == n - 1,NULL);
+				VERIFY (shared == n - 1,NULL);
+			}
+		}
+
+		free_io_sockets (node,node + n);
+		unreference_io_socket (media);
+	}
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+//
+// a viewed encoding is read only until its last view is freed
+//
+TEST_BEGIN(test_io_shared_media_2) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	io_encoding_t *msg;
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	msg = reference_io_encoding (mk_io_packet_encoding (bm));
+	if (VERIFY (msg != NULL,NULL)) {
+		io_encoding_t *view;
+		void const *bytes;
+
+		io_encoding_fill (msg,'g',128);
+		bytes = io_encoding_get_byte_stream (msg);
+
+		view = reference_io_encoding (mk_io_packet_view_encoding (msg));
+		if (VERIFY (view != NULL,NULL)) {
+			uint8_t byte;
+
+			VERIFY (io_encoding_is_read_only (msg),NULL);
+			VERIFY (!io_encoding_append_byte (msg,'x'),NULL);
+			VERIFY (!io_encoding_grow (msg,256),NULL);
+			VERIFY (!io_encoding_pop_last_byte (msg,&byte),NULL);
+			io_encoding_reset (msg);
+			VERIFY (io_encoding_length (msg) == 128,NULL);
+			VERIFY (io_encoding_get_byte_stream (msg) == bytes,NULL);
+			VERIFY (io_encoding_get_byte_stream (view) == bytes,NULL);
+			VERIFY (io_encoding_length (view) == 128,NULL);
+
+			unreference_io_encoding (view);
+		}
+
+		//
+		// writable again once the last view is freed
+		//
+		{
+			io_encoding_t *first = reference_io_encoding (mk_io_packet_view_encoding (msg));
+			io_encoding_t *second = reference_io_encoding (mk_io_packet_view_encoding (msg));
+			uint8_t byte;
+			if (VERIFY (first != NULL && second != NULL,NULL)) {
+				unreference_io_encoding (first);
+				VERIFY (io_encoding_is_read_only (msg),NULL);
+				VERIFY (!io_encoding_append_byte (msg,'x'),NULL);
+				unreference_io_encoding (second);
+				VERIFY (!io_encoding_is_read_only (msg),NULL);
+				VERIFY (io_encoding_append_byte (msg,'x'),NULL);
+				VERIFY (io_encoding_length (msg) == 129,NULL);
+				VERIFY (io_encoding_pop_last_byte (msg,&byte) && byte == 'x',NULL);
+			}
+		}
+
+		//
+		// a copy of the source is an ordinary packet encoding
+		//
+		{
+			io_encoding_t *copy = reference_io_encoding (io_packet_encoding_copy (msg));
+			if (VERIFY (copy != NULL,NULL)) {
+				VERIFY (io_encoding_length (copy) == 128,NULL);
+				VERIFY (io_encoding_get_byte_stream (copy) != bytes,NULL);
+				unreference_io_encoding (copy);
+			}
+		}
+
+		unreference_io_encoding (msg);
+	}
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+typedef struct {
+	io_socket_t *socket;
+	uint32_t received;
+	uint32_t reordered;
+	int32_t last;
+} test_io_simulated_receiver_t;
+
+static void
+test_io_simulated_media_receive (io_event_t *ev) {
+	test_io_simulated_receiver_t *this = ev->user_value;
+	io_encoding_pipe_t *pipe = cast_to_io_encoding_pipe (
+		io_socket_get_receive_pipe (this->socket,def_io_u8_address (1))
+	);
+	io_encoding_t *next;
+
+	while (pipe != NULL && io_encoding_pipe_peek (pipe,&next)) {
+		const uint8_t *b,*e;
+		io_encoding_get_content (next,&b,&e);
+		if (e > b) {
+			if (*b < this->last) {
+				this->reordered ++;
+			}
+			this->last = *b;
+		}
+		this->received ++;
+		io_encoding_pipe_pop_encoding (pipe);
+	}
+}
+
+//
+// node 1 sends a burst of messages to seven receivers over a simulated media
+//
+static bool
+test_io_simulated_media_run (
+	io_t *io,
+	io_simulated_link_t const *link,
+	uint32_t number_of_messages,
+	io_simulated_media_statistics_t *stats,
+	uint32_t *reordered,
+	io_time_t *end
+) {
+	const io_settings_t bus = {
+		.transmit_pipe_length = 4,
+		.receive_pipe_length = 4,
+	};
+	const socket_builder_t net[] = {
+		{0,allocate_io_simulated_media,io_invalid_address(),&bus,false,NULL},
+		{1,allocate_io_socket_binary_emulator,def_io_u8_address(1),&bus,false,BINDINGS({1,0})},
+		{2,allocate_io_socket_binary_emulator,def_io_u8_address(2),&bus,false,BINDINGS({2,0})},
+		{3,allocate_io_socket_binary_emulator,def_io_u8_address(3),&bus,false,BINDINGS({3,0})},
+		{4,allocate_io_socket_binary_emulator,def_io_u8_address(4),&bus,false,BINDINGS({4,0})},
+		{5,allocate_io_socket_binary_emulator,def_io_u8_address(5),&bus,false,BINDINGS({5,0})},
+		{6,allocate_io_socket_binary_emulator,def_io_u8_address(6),&bus,false,BINDINGS({6,0})},
+		{7,allocate_io_socket_binary_emulator,def_io_u8_address(7),&bus,false,BINDINGS({7,0})},
+		{8,allocate_io_socket_binary_emulator,def_io_u8_address(8),&bus,false,BINDINGS({8,0})},
+	};
+	io_socket_t *node[SIZEOF(net)];
+	test_io_simulated_receiver_t receiver[SIZEOF(net)];
+	io_event_t rx[SIZEOF(net)];
+	uint32_t received = 0;
+	bool ok = true;
+
+	build_io_sockets (io,node,net,SIZEOF(net));
+	ok &= cast_to_io_simulated_media (node[0]) != NULL;
+	io_simulated_media_set_link (node[0],link);
+
+	for (int i = 2; i < SIZEOF(net); i++) {
+		receiver[i] = (test_io_simulated_receiver_t) {node[i],0,0,-1};
+		initialise_io_event (rx + i,test_io_simulated_media_receive,receiver + i);
+		ok &= io_socket_bind_inner (node[i],def_io_u8_address (1),NULL,rx + i);
+	}
+
+	for (uint32_t m = 0; m < number_of_messages && ok; m++) {
+		io_encoding_t *msg = io_socket_new_message (node[1]);
+		ok &= (msg != NULL);
+		if (msg) {
+			io_encoding_append_byte (msg,m);
+			ok &= io_socket_send_message (node[1],msg);
+		}
+	}
+
+	io_simulated_media_run (node[0]);
+
+	*stats = *io_simulated_media_statistics ((io_simulated_media_t*) node[0]);
+	*end = io_simulated_media_time ((io_simulated_media_t*) node[0]);
+	*reordered = 0;
+	for (int i = 2; i < SIZEOF(net); i++) {
+		*reordered += receiver[i].reordered;
+		received += receiver[i].received;
+	}
+	ok &= (received == stats->delivered);
+	ok &= (io_simulated_media_pending_count ((io_simulated_media_t*) node[0]) == 0);
+
+	free_io_sockets (node,node + SIZEOF(net));
+	return ok;
+}
+
+TEST_BEGIN(test_io_simulated_media_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const uint32_t number_of_messages = 200;
+	const uint32_t number_of_receivers = 7;
+	const uint32_t expected = number_of_messages * number_of_receivers;
+	io_simulated_link_t lossy = {
+		.latency = millisecond_time (1),
+		.jitter = microsecond_time (500),
+		.bytes_per_second = 50000,
+		.loss_per_million = 100000,
+		.seed = 7,
+	};
+	io_simulated_link_t clean = {
+		.latency = millisecond_time (1),
+		.jitter = time_zero(),
+		.bytes_per_second = 50000,
+		.loss_per_million = 0,
+		.seed = 7,
+	};
+	io_simulated_media_statistics_t a,b,c;
+	uint32_t reordered_a,reordered_b,reordered_c;
+	io_time_t end_a,end_b,end_c;
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	VERIFY (test_io_simulated_media_run (TEST_IO,&lossy,number_of_messages,&a,&reordered_a,&end_a),NULL);
+	VERIFY (test_io_simulated_media_run (TEST_IO,&lossy,number_of_messages,&b,&reordered_b,&end_b),NULL);
+	VERIFY (test_io_simulated_media_run (TEST_IO,&clean,number_of_messages,&c,&reordered_c,&end_c),NULL);
+
+	// every run with the same link is the same
+	VERIFY (memcmp (&a,&b,sizeof(a)) == 0,NULL);
+	VERIFY (reordered_a == reordered_b && end_a.ns == end_b.ns,NULL);
+
+	// about one in ten deliveries is lost and jitter reorders messages
+	VERIFY (a.messages_sent == number_of_messages,NULL);
+	VERIFY (a.delivered + a.lost + a.overrun == expected,NULL);
+	VERIFY (a.overrun == 0,NULL);
+	VERIFY (a.lost > expected / 20 && a.lost < (expected * 3) / 20,NULL);
+	VERIFY (reordered_a > 0,NULL);
+	VERIFY (a.latency_min >= lossy.latency.ns,NULL);
+
+	// without jitter or loss everything arrives in order
+	VERIFY (c.delivered == expected && c.lost == 0,NULL);
+	VERIFY (reordered_c == 0,NULL);
+	VERIFY (c.latency_min >= clean.latency.ns,NULL);
+
+	{
+		uint32_t total = 0;
+		int64_t per_receiver;
+		for (int i = 0; i < IO_SIMULATED_MEDIA_LATENCY_BUCKETS; i++) {
+			total += c.latency[i];
+		}
+		VERIFY (total == c.delivered,NULL);
+
+		// a burst is limited by the link rate
+		per_receiver = (
+			((int64_t) (c.bytes_delivered / number_of_receivers) * 1000000000LL) / end_c.ns
+		);
+		VERIFY (per_receiver <= clean.bytes_per_second,NULL);
+		VERIFY (per_receiver > (clean.bytes_per_second * 4) / 5,NULL);
+	}
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+typedef struct {
+	io_socket_t *socket;
+	io_fragment_reassembler_t *reassembler;
+	io_time_t now;
+	uint8_t const *expect;
+	uint32_t expect_length;
+	uint32_t fragments;
+	uint32_t skip;
+	uint32_t complete;
+	uint32_t matched;
+} test_io_fragment_receiver_t;
+
+static void
+test_io_fragment_1_receive (io_event_t *ev) {
+	test_io_fragment_receiver_t *this = ev->user_value;
+	io_encoding_pipe_t *pipe = cast_to_io_encoding_pipe (
+		io_socket_get_receive_pipe (this->socket,def_io_u8_address (1))
+	);
+	io_encoding_t *next;
+
+	while (pipe != NULL && io_encoding_pipe_peek (pipe,&next)) {
+		if (++this->fragments != this->skip) {
+			io_encoding_t *message = io_fragment_reassembler_receive (
+				this->reassembler,next,this->now
+			);
+			if (message != NULL) {
+				const uint8_t *b,*e;
+				io_encoding_get_content (message,&b,&e);
+				this->complete ++;
+				if (
+						(e - b) == this->expect_length
+					&&	memcmp (b,this->expect,this->expect_length) == 0
+				) {
+					this->matched ++;
+				}
+				unreference_io_encoding (message);
+			}
+		}
+		io_encoding_pipe_pop_encoding (pipe);
+	}
+}
+
+static bool
+test_io_fragment_1_send (
+	io_t *io,io_fragment_encoder_t *encoder,io_socket_t *socket,
+	uint8_t const *bytes,uint32_t length
+) {
+	io_encoding_t *message = reference_io_encoding (
+		mk_io_packet_encoding (io_get_byte_memory (io))
+	);
+	bool ok = (message != NULL);
+
+	if (ok) {
+		io_encoding_append_bytes (message,bytes,length);
+		ok = io_fragment_encoder_begin (encoder,message);
+		unreference_io_encoding (message);
+		while (ok && !io_fragment_encoder_send (encoder,socket)) {
+			ok = !io_fragment_encoder_has_error (encoder);
+			io_wait_for_all_events (io);
+		}
+		io_wait_for_all_events (io);
+	}
+
+	return ok;
+}
+
+//
+// messages of up to 24 mtus are sent in fragments and reassembled,
+// incomplete messages are dropped by timeout or to free memory
+//
+TEST_BEGIN(test_io_fragment_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const io_settings_t bus = {
+		.transmit_pipe_length = 3,
+		.receive_pipe_length = 32,
+		.mtu = 256,
+	};
+	const uint32_t sizes[] = {0,1,200,237,238,239,1000,3000,5000};
+	const uint32_t memory_limit = 6000;
+	const io_time_t timeout = millisecond_time (10);
+	static uint8_t payload[5000];
+	io_socket_t *media,*node[2];
+	io_event_t rx;
+	test_io_fragment_receiver_t receiver;
+	io_fragment_encoder_t *encoder;
+
+	for (int i = 0; i < SIZEOF(payload); i++) {
+		payload[i] = (uint8_t) (i * 7 + (i >> 8));
+	}
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	media = reference_io_socket (
+		io_socket_initialise (
+			allocate_io_shared_media (TEST_IO,io_invalid_address()),TEST_IO,&bus
+		)
+	);
+	for (int i = 0; i < SIZEOF(node); i++) {
+		node[i] = reference_io_socket (
+			io_socket_initialise (
+				allocate_io_socket_binary_emulator (TEST_IO,def_io_u8_address (i + 1)),
+				TEST_IO,&bus
+			)
+		);
+		io_socket_bind_to_outer_socket (node[i],media);
+	}
+
+	encoder = mk_io_fragment_encoder (bm);
+	receiver = (test_io_fragment_receiver_t) {
+		.socket = node[1],
+		.reassembler = mk_io_fragment_reassembler (bm,memory_limit,timeout),
+		.now = time_zero(),
+	};
+	initialise_io_event (&rx,test_io_fragment_1_receive,&receiver);
+	io_socket_bind_inner (node[1],def_io_u8_address (1),NULL,&rx);
+
+	if (VERIFY (encoder != NULL && receiver.reassembler != NULL,NULL)) {
+		// each message arrives in the fewest fragments that fit the mtu
+		for (int s = 0; s < SIZEOF(sizes); s++) {
+			uint32_t before = receiver.fragments;
+			uint32_t chunk;
+
+			receiver.expect = payload;
+			receiver.expect_length = sizes[s];
+			VERIFY (test_io_fragment_1_send (TEST_IO,encoder,node[0],payload,sizes[s]),NULL);
+			VERIFY (io_fragment_encoder_is_complete (encoder),NULL);
+
+			chunk = io_fragment_encoder_chunk_size (encoder);
+			VERIFY (chunk > 0 && chunk < io_socket_mtu (node[0]),NULL);
+			VERIFY (
+				io_fragment_encoder_count (encoder) == (
+					sizes[s] ? (sizes[s] + chunk - 1) / chunk : 1
+				),
+				NULL
+			);
+			VERIFY (receiver.fragments - before == io_fragment_encoder_count (encoder),NULL);
+			VERIFY (receiver.complete == s + 1 && receiver.matched == s + 1,NULL);
+			VERIFY (io_fragment_reassembler_memory_used (receiver.reassembler) == 0,NULL);
+		}
+
+		// a lost fragment leaves the message incomplete until it times out
+		receiver.skip = receiver.fragments + 2;
+		VERIFY (test_io_fragment_1_send (TEST_IO,encoder,node[0],payload,3000),NULL);
+		VERIFY (receiver.complete == SIZEOF(sizes),NULL);
+		VERIFY (io_fragment_reassembler_memory_used (receiver.reassembler) == 3000,NULL);
+		VERIFY (io_fragment_reassembler_expire (receiver.reassembler,millisecond_time (5)) == 0,NULL);
+		VERIFY (io_fragment_reassembler_expire (receiver.reassembler,timeout) == 1,NULL);
+		VERIFY (io_fragment_reassembler_memory_used (receiver.reassembler) == 0,NULL);
+		VERIFY (io_fragment_reassembler_dropped (receiver.reassembler) == 1,NULL);
+
+		// the oldest incomplete message is dropped to make room
+		receiver.skip = receiver.fragments + 1;
+		VERIFY (test_io_fragment_1_send (TEST_IO,encoder,node[0],payload,3000),NULL);
+		receiver.now = millisecond_time (1);
+		receiver.expect_length = 5000;
+		VERIFY (test_io_fragment_1_send (TEST_IO,encoder,node[0],payload,5000),NULL);
+		VERIFY (io_fragment_reassembler_dropped (receiver.reassembler) == 2,NULL);
+		VERIFY (receiver.complete == SIZEOF(sizes) + 1,NULL);
+		VERIFY (receiver.matched == SIZEOF(sizes) + 1,NULL);
+		VERIFY (io_fragment_reassembler_memory_used (receiver.reassembler) == 0,NULL);
+	}
+
+	if (encoder) free_io_fragment_encoder (encoder);
+	if (receiver.reassembler) free_io_fragment_reassembler (receiver.reassembler);
+	free_io_sockets (node,node + SIZEOF(node));
+	unreference_io_socket (media);
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+typedef struct {
+	io_socket_t *socket;
+	uint32_t packets;
+	uint32_t bytes;
+	uint32_t records;
+	uint32_t matched;
+	bool aggregated;
+} test_io_aggregate_receiver_t;
+
+static void
+test_io_aggregate_1_receive (io_event_t *ev) {
+	test_io_aggregate_receiver_t *this = ev->user_value;
+	io_encoding_pipe_t *pipe = cast_to_io_encoding_pipe (
+		io_socket_get_receive_pipe (this->socket,def_io_u8_address (1))
+	);
+	io_encoding_t *next;
+
+	while (pipe != NULL && io_encoding_pipe_peek (pipe,&next)) {
+		uint8_t const *cursor,*end,*record;
+		uint32_t size;
+
+		this->packets ++;
+		this->bytes += io_encoding_length (next);
+		if (this->aggregated) {
+			io_layer_t *layer = push_io_aggregate_receive_layer (next);
+			io_layer_get_content (layer,next,&cursor,&end);
+			while ((cursor = io_aggregate_next_record (cursor,end,&record,&size)) != NULL) {
+				if (size == 8 && record[0] == (uint8_t) this->records) {
+					this->matched ++;
+				}
+				this->records ++;
+			}
+		} else {
+			io_encoding_get_content (next,&cursor,&end);
+			if ((end - cursor) == 8 && cursor[0] == (uint8_t) this->records) {
+				this->matched ++;
+			}
+			this->records ++;
+		}
+		io_encoding_pipe_pop_encoding (pipe);
+	}
+}
+
+//
+// small messages aggregated into mtu sized frames need far fewer packets
+// and fewer bytes on the media than one packet per message
+//
+TEST_BEGIN(test_io_aggregate_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const io_settings_t bus = {
+		.transmit_pipe_length = 3,
+		.receive_pipe_length = 64,
+		.mtu = 256,
+	};
+	const uint32_t number_of_messages = 60;
+	test_io_aggregate_receiver_t direct,aggregated;
+	io_socket_t *media,*node[2];
+	io_event_t rx;
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	media = reference_io_socket (
+		io_socket_initialise (
+			allocate_io_shared_media (TEST_IO,io_invalid_address()),TEST_IO,&bus
+		)
+	);
+	for (int i = 0; i < SIZEOF(node); i++) {
+		node[i] = reference_io_socket (
+			io_socket_initialise (
+				allocate_io_socket_binary_emulator (TEST_IO,def_io_u8_address (i + 1)),
+				TEST_IO,&bus
+			)
+		);
+		io_socket_bind_to_outer_socket (node[i],media);
+	}
+
+	// one packet per message
+	direct = (test_io_aggregate_receiver_t) {.socket = node[1],.aggregated = false};
+	initialise_io_event (&rx,test_io_aggregate_1_receive,&direct);
+	io_socket_bind_inner (node[1],def_io_u8_address (1),NULL,&rx);
+
+	for (uint32_t m = 0; m < number_of_messages; m++) {
+		io_encoding_t *msg = io_socket_new_message (node[0]);
+		if (msg) {
+			uint8_t line[8] = {m,'l','o','g',' ','.','.','\n'};
+			io_encoding_append_bytes (msg,line,sizeof(line));
+			VERIFY (io_socket_send_message (node[0],msg),NULL);
+		}
+		io_wait_for_all_events (TEST_IO);
+	}
+
+	VERIFY (direct.packets == number_of_messages,NULL);
+	VERIFY (direct.matched == number_of_messages,NULL);
+
+	// the same messages aggregated
+	aggregated = (test_io_aggregate_receiver_t) {.socket = node[1],.aggregated = true};
+	initialise_io_event (&rx,test_io_aggregate_1_receive,&aggregated);
+
+	{
+		io_aggregator_t *aggregator = mk_io_aggregator (node[0],millisecond_time (2));
+		if (VERIFY (aggregator != NULL,NULL)) {
+			uint32_t per_frame;
+
+			for (uint32_t m = 0; m < number_of_messages; m++) {
+				uint8_t line[8] = {m,'l','o','g',' ','.','.','\n'};
+				VERIFY (io_aggregator_append (aggregator,line,sizeof(line)),NULL);
+				io_wait_for_all_events (TEST_IO);
+			}
+
+			// full frames have been sent, the remainder waits for the flush
+			per_frame = aggregated.records / aggregated.packets;
+			VERIFY (aggregated.packets == number_of_messages / per_frame,NULL);
+			VERIFY (io_aggregator_flush (aggregator),NULL);
+			io_wait_for_all_events (TEST_IO);
+
+			VERIFY (aggregated.records == number_of_messages,NULL);
+			VERIFY (aggregated.matched == number_of_messages,NULL);
+			VERIFY (io_aggregator_records_sent (aggregator) == number_of_messages,NULL);
+			VERIFY (io_aggregator_frames_sent (aggregator) == aggregated.packets,NULL);
+			VERIFY (io_aggregator_records_dropped (aggregator) == 0,NULL);
+
+			// a record that does not fit in a frame is refused
+			{
+				uint8_t big[256] = {0};
+				VERIFY (!io_aggregator_append (aggregator,big,sizeof(big)),NULL);
+			}
+
+			free_io_aggregator (aggregator);
+		}
+	}
+
+	VERIFY (aggregated.packets * 10 <= direct.packets,NULL);
+	VERIFY (aggregated.bytes < direct.bytes,NULL);
+
+	// a record length is two bytes little endian
+	{
+		io_encoding_t *frame = reference_io_encoding (mk_io_packet_encoding (bm));
+		io_layer_t *layer = (frame != NULL) ? push_io_aggregate_transmit_layer (frame) : NULL;
+		if (VERIFY (layer != NULL,NULL)) {
+			uint8_t line[0x102] = {0};
+			uint8_t const *cursor,*end,*record;
+			uint32_t size;
+
+			VERIFY (!io_aggregate_layer_append_record (layer,frame,line,0x10000),NULL);
+			VERIFY (io_aggregate_layer_append_record (layer,frame,line,sizeof(line)),NULL);
+			io_layer_get_content (layer,frame,&cursor,&end);
+			VERIFY (cursor[0] == 0x02 && cursor[1] == 0x01,NULL);
+			VERIFY (
+					io_aggregate_next_record (cursor,end,&record,&size) == end
+				&&	size == sizeof(line),
+				NULL
+			);
+		}
+		if (frame) unreference_io_encoding (frame);
+	}
+
+	free_io_sockets (node,node + SIZEOF(node));
+	unreference_io_socket (media);
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+typedef struct {
+	io_socket_t *socket;
+	uint32_t received;
+	uint32_t in_order;
+	uint32_t bytes;
+} test_io_reliable_receiver_t;
+
+static void
+test_io_reliable_socket_receive (io_event_t *ev) {
+	test_io_reliable_receiver_t *this = ev->user_value;
+	io_encoding_pipe_t *pipe = cast_to_io_encoding_pipe (
+		io_socket_get_receive_pipe (this->socket,io_invalid_address())
+	);
+	io_encoding_t *next;
+
+	while (pipe != NULL && io_encoding_pipe_peek (pipe,&next)) {
+		const uint8_t *b,*e;
+		io_encoding_get_content (next,&b,&e);
+		if (e > b && *b == (uint8_t) this->received) {
+			this->in_order ++;
+		}
+		this->bytes += (e - b);
+		this->received ++;
+		io_encoding_pipe_pop_encoding (pipe);
+	}
+}
+
+static io_time_t
+test_io_reliable_socket_clock (void *media) {
+	return io_simulated_media_time ((io_simulated_media_t*) media);
+}
+
+static bool
+test_io_reliable_socket_send_messages (
+	io_socket_t *socket,uint32_t number_of_messages,uint32_t message_length,uint32_t *sent
+) {
+	while (
+			*sent < number_of_messages
+		&&	io_reliable_socket_unacknowledged ((io_reliable_socket_t*) socket) < IO_RELIABLE_WINDOW
+	) {
+		io_encoding_t *msg = io_socket_new_message (socket);
+		if (msg) {
+			uint8_t data[256] = {*sent};
+			io_encoding_append_bytes (msg,data,message_length);
+			if (!io_socket_send_message (socket,msg)) {
+				return false;
+			}
+			(*sent) ++;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+//
+// node 1 sends messages to node 2 through a reliable socket on a
+// simulated media, the media clock is stepped and both sockets polled,
+// with a reverse receiver node 2 sends as many messages back to node 1
+//
+static bool
+test_io_reliable_socket_run (
+	io_t *io,
+	io_simulated_link_t const *link,
+	uint32_t number_of_messages,
+	uint32_t message_length,
+	io_reliable_statistics_t *stats,
+	test_io_reliable_receiver_t *receiver,
+	io_reliable_statistics_t *reverse_stats,
+	test_io_reliable_receiver_t *reverse,
+	io_time_t *end
+) {
+	const io_settings_t bus = {
+		.transmit_pipe_length = IO_RELIABLE_WINDOW + 2,
+		.receive_pipe_length = IO_RELIABLE_WINDOW + 2,
+		.mtu = 256,
+	};
+	const socket_builder_t net[] = {
+		{0,allocate_io_simulated_media,io_invalid_address(),&bus,false,NULL},
+		{1,allocate_io_socket_binary_emulator,def_io_u8_address(1),&bus,false,BINDINGS({1,0})},
+		{2,allocate_io_socket_binary_emulator,def_io_u8_address(2),&bus,false,BINDINGS({2,0})},
+	};
+	const io_settings_t reliable = {
+		.receive_pipe_length = 8,
+	};
+	io_socket_t *node[SIZEOF(net)];
+	io_socket_t *sender,*recipient;
+	io_event_t rx,reverse_rx;
+	uint32_t sent = 0,reverse_sent = number_of_messages;
+	bool ok = true;
+
+	build_io_sockets (io,node,net,SIZEOF(net));
+	io_simulated_media_set_link (node[0],link);
+
+	// each reliable socket is addressed by its peer
+	sender = reference_io_socket (
+		io_socket_initialise (
+			allocate_io_reliable_socket (io,def_io_u8_address (2)),io,&reliable
+		)
+	);
+	recipient = reference_io_socket (
+		io_socket_initialise (
+			allocate_io_reliable_socket (io,def_io_u8_address (1)),io,&reliable
+		)
+	);
+	ok &= io_socket_bind_to_outer_socket (sender,node[1]);
+	ok &= io_socket_bind_to_outer_socket (recipient,node[2]);
+	io_reliable_socket_set_clock (sender,test_io_reliable_socket_clock,node[0]);
+	io_reliable_socket_set_clock (recipient,test_io_reliable_socket_clock,node[0]);
+
+	*receiver = (test_io_reliable_receiver_t) {.socket = recipient};
+	initialise_io_event (&rx,test_io_reliable_socket_receive,receiver);
+	ok &= io_socket_bind_inner (recipient,io_invalid_address(),NULL,&rx);
+
+	if (reverse != NULL) {
+		*reverse = (test_io_reliable_receiver_t) {.socket = sender};
+		initialise_io_event (&reverse_rx,test_io_reliable_socket_receive,reverse);
+		ok &= io_socket_bind_inner (sender,io_invalid_address(),NULL,&reverse_rx);
+		reverse_sent = 0;
+	}
+
+	for (int tick = 0; tick < 20000 && ok; tick++) {
+		io_time_t now = io_simulated_media_time ((io_simulated_media_t*) node[0]);
+
+		ok &= test_io_reliable_socket_send_messages (
+			sender,number_of_messages,message_length,&sent
+		);
+		ok &= test_io_reliable_socket_send_messages (
+			recipient,number_of_messages,message_length,&reverse_sent
+		);
+
+		io_simulated_media_run_until (node[0],(io_time_t) {now.ns + millisecond_time (1).ns});
+		io_reliable_socket_poll (sender);
+		io_reliable_socket_poll (recipient);
+		io_wait_for_all_events (io);
+
+		if (
+				receiver->received == number_of_messages
+			&&	(reverse == NULL || reverse->received == number_of_messages)
+			&&	io_reliable_socket_unacknowledged ((io_reliable_socket_t*) sender) == 0
+			&&	io_reliable_socket_unacknowledged ((io_reliable_socket_t*) recipient) == 0
+		) {
+			break;
+		}
+	}
+
+	*stats = *io_reliable_socket_statistics ((io_reliable_socket_t*) sender);
+	if (reverse_stats != NULL) {
+		*reverse_stats = *io_reliable_socket_statistics ((io_reliable_socket_t*) recipient);
+	}
+	*end = io_simulated_media_time ((io_simulated_media_t*) node[0]);
+
+	unreference_io_socket (sender);
+	unreference_io_socket (recipient);
+	io_simulated_media_run (node[0]);
+	free_io_sockets (node,node + SIZEOF(net));
+	return ok;
+}
+
+TEST_BEGIN(test_io_reliable_socket_1) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const uint32_t number_of_messages = 200;
+	const uint32_t message_length = 64;
+	io_simulated_link_t clean = {
+		.latency = millisecond_time (1),
+		.jitter = time_zero(),
+		.bytes_per_second = 100000,
+		.loss_per_million = 0,
+		.seed = 11,
+	};
+	io_simulated_link_t lossy = {
+		.latency = millisecond_time (1),
+		.jitter = time_zero(),
+		.bytes_per_second = 100000,
+		.loss_per_million = 50000,
+		.seed = 11,
+	};
+	io_reliable_statistics_t a,b;
+	test_io_reliable_receiver_t ra,rb;
+	io_time_t end_a,end_b;
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	VERIFY (
+		test_io_reliable_socket_run (
+			TEST_IO,&clean,number_of_messages,message_length,&a,&ra,NULL,NULL,&end_a
+		),
+		NULL
+	);
+	VERIFY (
+		test_io_reliable_socket_run (
+			TEST_IO,&lossy,number_of_messages,message_length,&b,&rb,NULL,NULL,&end_b
+		),
+		NULL
+	);
+
+	// everything arrives once and in order
+	VERIFY (ra.received == number_of_messages && ra.in_order == number_of_messages,NULL);
+	VERIFY (a.segments_sent == number_of_messages,NULL);
+	VERIFY (rb.received == number_of_messages && rb.in_order == number_of_messages,NULL);
+	VERIFY (b.segments_sent == number_of_messages,NULL);
+
+	// losses are repaired by retransmission
+	VERIFY (b.retransmissions > 0,NULL);
+
+	{
+		// goodput in bytes per second
+		int64_t clean_rate = ((int64_t) ra.bytes * 1000000000LL) / end_a.ns;
+		int64_t lossy_rate = ((int64_t) rb.bytes * 1000000000LL) / end_b.ns;
+		VERIFY (clean_rate > clean.bytes_per_second / 5,NULL);
+		VERIFY (lossy_rate > clean_rate / 4,NULL);
+	}
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
+//
+// data in both directions carries acknowledgements that do not advance,
+// none of them are duplicates so nothing is retransmitted
+//
+TEST_BEGIN(test_io_reliable_socket_2) {
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bmbegin,bmend;
+	const uint32_t number_of_messages = 200;
+	io_simulated_link_t clean = {
+		.latency = millisecond_time (1),
+		.jitter = time_zero(),
+		.bytes_per_second = 10000000,
+		.loss_per_million = 0,
+		.seed = 11,
+	};
+	io_reliable_statistics_t forward,backward;
+	test_io_reliable_receiver_t rf,rb;
+	io_time_t end;
+
+	io_byte_memory_get_info (bm,&bmbegin);
+
+	VERIFY (
+		test_io_reliable_socket_run (
+			TEST_IO,&clean,number_of_messages,64,&forward,&rf,&backward,&rb,&end
+		),
+		NULL
+	);
+	VERIFY (rf.received == number_of_messages && rf.in_order == number_of_messages,NULL);
+	VERIFY (rb.received == number_of_messages && rb.in_order == number_of_messages,NULL);
+	VERIFY (forward.retransmissions == 0 && forward.fast_retransmissions == 0,NULL);
+	VERIFY (backward.retransmissions == 0 && backward.fast_retransmissions == 0,NULL);
+
+	io_byte_memory_get_info (bm,&bmend);
+	VERIFY (bmend.used_bytes == bmbegin.used_bytes,NULL);
+}
+TEST_END
+
 UNIT_SETUP(setup_io_core_sockets_unit_test) {
 	return VERIFY_UNIT_CONTINUE;
 }
@@ -449,11 +1914,23 @@ io_core_sockets_unit_test (V_unit_test_t *unit) {
 		test_io_address_1,
 		test_io_address_2,
 		test_io_address_3,
+		test_io_address_4,
+		test_io_link_layer_1,
 		test_io_adapter_socket_1,
 		test_io_adapter_socket_2,
+		test_io_shared_media_1,
+		test_io_shared_media_2,
+		test_io_simulated_media_1,
+		test_io_fragment_1,
+		test_io_aggregate_1,
+		test_io_reliable_socket_1,
+		test_io_reliable_socket_2,
 		test_io_multiplex_socket_1,
 		test_io_multiplex_socket_2,
+		test_io_multiplex_socket_3,
 		test_io_multiplexer_socket_1,
+		test_io_multiplexer_socket_2,
+		test_io_multiplexer_socket_3,
 		0
 	};
 	unit->name = "io sockets";
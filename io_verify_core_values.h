@@ -767,6 +767,959 @@ TEST_BEGIN(test_vector_value_2) {
 }
 TEST_END
 
+TEST_BEGIN(test_vector_value_3) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end,vm_begin,vm_end;
+	io_encoding_t *encoding;
+	uint8_t long_text[200];
+	vref_t r_value;
+
+	io_value_memory_get_info (vm,&vm_begin);
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	memset (long_text,'t',sizeof(long_text));
+	{
+		vref_t args[] = {
+			mk_io_int64_value (vm,42),
+			mk_io_text_value (vm,long_text,sizeof(long_text)),
+			cr_NIL,
+		};
+		r_value = reference_value (mk_io_vector_value (vm,SIZEOF(args),args));
+	}
+
+	encoding = mk_io_x70_encoding (bm);
+	if (VERIFY (encoding != NULL,NULL)) {
+		if (VERIFY (io_value_encode (r_value,encoding),NULL)) {
+			vref_t r_decoded = io_encoding_decode_to_io_value (
+				encoding,io_x70_decoder,vm
+			);
+			uint32_t arity;
+			vref_t const *values;
+
+			if (
+				VERIFY (
+						vref_is_valid (r_decoded)
+					&&	io_vector_value_get_values (r_decoded,&arity,&values)
+					&&	arity == 3,
+					NULL
+				)
+			) {
+				int64_t i64_value;
+				VERIFY (io_value_get_as_int64 (values[0],&i64_value) && i64_value == 42,NULL);
+				VERIFY (io_typesafe_ro_cast (values[1],cr_TEXT) != NULL,NULL);
+				VERIFY (vref_is_nil (values[2]),NULL);
+			}
+		}
+		io_encoding_free (encoding);
+	}
+	
+	unreference_value (r_value);
+	
+	io_value_memory_do_gc (vm,-1);
+	io_value_memory_get_info (vm,&vm_end);
+	VERIFY (vm_end.used_bytes == vm_begin.used_bytes,NULL);
+
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+typedef struct {
+	vref_t values[4];
+	uint32_t count;
+} x70_stream_decoder_test_t;
+
+static void
+x70_stream_decoder_test_emit (vref_t r_value,void *user_value) {
+	x70_stream_decoder_test_t *this = user_value;
+	if (this->count < SIZEOF(this->values)) {
+		this->values[this->count++] = reference_value (r_value);
+	}
+}
+
+TEST_BEGIN(test_io_x70_stream_decoder_1) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end,vm_begin,vm_end;
+	x70_stream_decoder_test_t result = {.count = 0};
+	io_x70_stream_decoder_t *decoder;
+	io_encoding_t *encoding;
+
+	io_value_memory_get_info (vm,&vm_begin);
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	encoding = mk_io_x70_encoding (bm);
+	decoder = mk_io_x70_stream_decoder (bm,vm,x70_stream_decoder_test_emit,&result);
+
+	if (VERIFY (encoding != NULL && decoder != NULL,NULL)) {
+		vref_t r_inner = mk_io_vector_value (vm,1,(vref_t[]) {mk_io_float64_value (vm,1.5)});
+		vref_t args[] = {
+			mk_io_int64_value (vm,-7),
+			r_inner,
+			mk_io_text_value (vm,(uint8_t const*) "abc",3),
+		};
+		vref_t r_outer = reference_value (mk_io_vector_value (vm,SIZEOF(args),args));
+		const uint8_t *b,*e;
+
+		VERIFY (io_value_encode (r_outer,encoding),NULL);
+		VERIFY (io_value_encode (cr_NIL,encoding),NULL);
+		unreference_value (r_outer);
+
+		//
+		// one byte at a time, values emitted as they complete
+		//
+		io_encoding_get_content (encoding,&b,&e);
+		while (b < e - 4) {
+			VERIFY (io_x70_stream_decoder_push (decoder,b++,1),NULL);
+		}
+		VERIFY (result.count == 1,NULL);
+		VERIFY (!io_x70_stream_decoder_is_idle (decoder),NULL);
+		VERIFY (io_x70_stream_decoder_push (decoder,b,e - b),NULL);
+		VERIFY (io_x70_stream_decoder_is_idle (decoder),NULL);
+
+		if (VERIFY (result.count == 2,NULL)) {
+			uint32_t arity;
+			vref_t const *values;
+			if (
+				VERIFY (
+						io_vector_value_get_values (result.values[0],&arity,&values)
+					&&	arity == 3,
+					NULL
+				)
+			) {
+				int64_t i64_value;
+				vref_t const *inner;
+				float64_t f64_value;
+				VERIFY (io_value_get_as_int64 (values[0],&i64_value) && i64_value == -7,NULL);
+				VERIFY (
+						io_vector_value_get_values (values[1],&arity,&inner)
+					&&	arity == 1
+					&&	io_value_get_as_float64 (inner[0],&f64_value)
+					&&	f64_value == 1.5,
+					NULL
+				);
+				VERIFY (io_typesafe_ro_cast (values[2],cr_TEXT) != NULL,NULL);
+			}
+			VERIFY (vref_is_nil (result.values[1]),NULL);
+		}
+
+		//
+		// corrupt input
+		//
+		VERIFY (!io_x70_stream_decoder_push (decoder,(uint8_t const*) "?",1),NULL);
+		VERIFY (io_x70_stream_decoder_has_error (decoder),NULL);
+		io_x70_stream_decoder_reset (decoder);
+		VERIFY (io_x70_stream_decoder_is_idle (decoder),NULL);
+
+		while (result.count > 0) {
+			unreference_value (result.values[--result.count]);
+		}
+	}
+
+	if (decoder) free_io_x70_stream_decoder (decoder);
+	if (encoding) io_encoding_free (encoding);
+	
+	io_value_memory_do_gc (vm,-1);
+	io_value_memory_get_info (vm,&vm_end);
+	VERIFY (vm_end.used_bytes == vm_begin.used_bytes,NULL);
+
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+TEST_BEGIN(test_io_x70_stream_decoder_2) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	x70_stream_decoder_test_t result = {.count = 0};
+	io_x70_stream_decoder_t *decoder;
+	io_byte_pipe_t *pipe;
+
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	decoder = mk_io_x70_stream_decoder (bm,vm,x70_stream_decoder_test_emit,&result);
+	pipe = mk_io_byte_pipe (bm,8);
+	
+	if (VERIFY (decoder != NULL && pipe != NULL,NULL)) {
+		uint8_t vector[] = {
+			X70_UINT_VALUE_BYTE,6,'v','e','c','t','o','r',X70_UINT_VALUE_BYTE,1
+		};
+		uint8_t nested[(IO_X70_STREAM_DECODER_STACK_DEPTH + 1) * sizeof(vector)];
+		uint8_t *cursor = nested;
+		uint8_t bytes[] = {
+			X70_UINT_VALUE_BYTE,3,'i','6','4',
+			1,0,0,0,0,0,0,0
+		};
+		uint8_t const *b = bytes,*e = bytes + sizeof(bytes);
+		
+		//
+		// through a small pipe so the ring wraps
+		//
+		while (b < e) {
+			b += io_byte_pipe_put_bytes (pipe,b,e - b);
+			VERIFY (io_x70_stream_decoder_push_pipe (decoder,pipe),NULL);
+		}
+		VERIFY (result.count == 1,NULL);
+
+		//
+		// nesting deeper than the stack fails
+		//
+		while (cursor < nested + sizeof(nested)) {
+			memcpy (cursor,vector,sizeof(vector));
+			cursor += sizeof(vector);
+		}
+		VERIFY (!io_x70_stream_decoder_push (decoder,nested,sizeof(nested)),NULL);
+		VERIFY (io_x70_stream_decoder_has_error (decoder),NULL);
+
+		//
+		// and so it does when decoding a whole encoding
+		//
+		{
+			io_encoding_t *encoding = mk_io_x70_encoding (bm);
+			if (VERIFY (encoding != NULL,NULL)) {
+				io_encoding_append_bytes (
+					encoding,nested + sizeof(vector),sizeof(nested) - sizeof(vector)
+				);
+				io_encoding_append_bytes (encoding,bytes,sizeof(bytes));
+				VERIFY (vref_is_valid (io_x70_decoder (encoding,vm)),NULL);
+
+				io_encoding_reset (encoding);
+				io_encoding_append_bytes (encoding,nested,sizeof(nested));
+				io_encoding_append_bytes (encoding,bytes,sizeof(bytes));
+				VERIFY (vref_is_invalid (io_x70_decoder (encoding,vm)),NULL);
+
+				io_encoding_free (encoding);
+			}
+		}
+
+		//
+		// a uint longer than 32 bits is rejected
+		//
+		{
+			io_encoding_t *encoding = mk_io_x70_encoding (bm);
+			uint8_t const longest[] = {
+				X70_UINT_VALUE_BYTE,0x81,0x80,0x80,0x80,0x0f
+			};
+			uint8_t const too_long[] = {
+				X70_UINT_VALUE_BYTE,0x81,0x80,0x80,0x80,0x10
+			};
+			uint32_t value;
+			VERIFY (
+					io_x70_encoding_take_uint_value (longest + 1,longest + sizeof(longest),&value) == 5
+				&&	value == 0xf0000001,
+				NULL
+			);
+			VERIFY (
+				io_x70_encoding_take_uint_value (too_long + 1,too_long + sizeof(too_long),&value) == 0,
+				NULL
+			);
+			if (VERIFY (encoding != NULL,NULL)) {
+				io_encoding_append_bytes (encoding,vector,sizeof(vector) - 2);
+				io_encoding_append_bytes (encoding,too_long,sizeof(too_long));
+				VERIFY (vref_is_invalid (io_x70_decoder (encoding,vm)),NULL);
+				io_encoding_free (encoding);
+			}
+		}
+
+		//
+		// an arity from the wire is bounded before it is allocated
+		//
+		{
+			uint8_t wide[] = {
+				X70_UINT_VALUE_BYTE,6,'v','e','c','t','o','r',
+				X70_UINT_VALUE_BYTE,0x81,0x80,0x80,0x80,0x02
+			};
+			io_x70_stream_decoder_reset (decoder);
+			VERIFY (!io_x70_stream_decoder_push (decoder,wide,sizeof(wide)),NULL);
+			VERIFY (io_x70_stream_decoder_has_error (decoder),NULL);
+		}
+
+		while (result.count > 0) {
+			unreference_value (result.values[--result.count]);
+		}
+	}
+
+	if (pipe) free_io_byte_pipe (pipe,bm);
+	if (decoder) free_io_x70_stream_decoder (decoder);
+
+	io_do_gc (TEST_IO,-1);
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+static vref_t
+mk_x70_stream_encoder_test_value (io_value_memory_t *vm,uint8_t *text,uint32_t size) {
+	memset (text,'x',size);
+	vref_t inner[] = {
+		mk_io_float64_value (vm,2.5),
+		mk_io_text_value (vm,text,size),
+	};
+	vref_t outer[] = {
+		mk_io_int64_value (vm,1),
+		mk_io_vector_value (vm,SIZEOF(inner),inner),
+		cr_NIL,
+	};
+	return mk_io_vector_value (vm,SIZEOF(outer),outer);
+}
+
+TEST_BEGIN(test_io_x70_stream_encoder_1) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	io_x70_stream_encoder_t *encoder;
+	io_encoding_t *expect,*streamed;
+	uint8_t text[600];
+	vref_t r_value;
+
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	r_value = reference_value (mk_x70_stream_encoder_test_value (vm,text,sizeof(text)));
+	expect = mk_io_x70_encoding (bm);
+	streamed = mk_io_x70_encoding (bm);
+	encoder = mk_io_x70_stream_encoder (bm);
+
+	if (VERIFY (expect && streamed && encoder,NULL)) {
+		const uint8_t *b1,*e1,*b2,*e2;
+		uint8_t chunk[7];
+		uint32_t count;
+		
+		VERIFY (io_value_encode (r_value,expect),NULL);
+		VERIFY (io_x70_stream_encoder_begin (encoder,r_value),NULL);
+		VERIFY (!io_x70_stream_encoder_begin (encoder,r_value),NULL);
+
+		while ((count = io_x70_stream_encoder_read (encoder,chunk,sizeof(chunk))) > 0) {
+			io_encoding_append_bytes (streamed,chunk,count);
+		}
+		VERIFY (io_x70_stream_encoder_is_complete (encoder),NULL);
+		VERIFY (!io_x70_stream_encoder_has_error (encoder),NULL);
+
+		io_encoding_get_content (expect,&b1,&e1);
+		io_encoding_get_content (streamed,&b2,&e2);
+		VERIFY ((e1 - b1) == (e2 - b2) && memcmp (b1,b2,e1 - b1) == 0,NULL);
+	}
+
+	if (encoder) free_io_x70_stream_encoder (encoder);
+	if (expect) io_encoding_free (expect);
+	if (streamed) io_encoding_free (streamed);
+	unreference_value (r_value);
+	
+	io_do_gc (TEST_IO,-1);
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+//
+// a socket that refuses every other message
+//
+typedef struct PACK_STRUCTURE {
+	IO_SOCKET_STRUCT_MEMBERS
+	io_encoding_t *received;
+	uint32_t number_of_messages;
+	uint32_t longest_message;
+} x70_stream_test_socket_t;
+
+static io_encoding_t*
+x70_stream_test_socket_new_message (io_socket_t *socket) {
+	return reference_io_encoding (mk_io_x70_encoding (io_socket_byte_memory (socket)));
+}
+
+static bool
+x70_stream_test_socket_send_message (io_socket_t *socket,io_encoding_t *message) {
+	x70_stream_test_socket_t *this = (x70_stream_test_socket_t*) socket;
+	bool ok = (this->number_of_messages++ & 1) == 0;
+
+	if (ok) {
+		const uint8_t *b,*e;
+		io_encoding_get_content (message,&b,&e);
+		io_encoding_append_bytes (this->received,b,e - b);
+		if ((e - b) > this->longest_message) {
+			this->longest_message = e - b;
+		}
+	}
+
+	unreference_io_encoding (message);
+	return ok;
+}
+
+static size_t
+x70_stream_test_socket_mtu (io_socket_t const *socket) {
+	return IO_SOCKET_MINIMUM_MTU;
+}
+
+static EVENT_DATA io_socket_implementation_t x70_stream_test_socket_implementation = {
+	SPECIALISE_IO_SOCKET_IMPLEMENTATION (&io_socket_implementation_base)
+	.new_message = x70_stream_test_socket_new_message,
+	.send_message = x70_stream_test_socket_send_message,
+	.mtu = x70_stream_test_socket_mtu,
+};
+
+TEST_BEGIN(test_io_x70_stream_encoder_2) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	io_x70_stream_encoder_t *encoder;
+	x70_stream_test_socket_t socket = {
+		.implementation = &x70_stream_test_socket_implementation,
+		.io = TEST_IO,
+		.number_of_messages = 0,
+		.longest_message = 0,
+	};
+	io_encoding_t *expect;
+	uint8_t text[1000];
+	vref_t r_value;
+
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	r_value = reference_value (mk_x70_stream_encoder_test_value (vm,text,sizeof(text)));
+	expect = mk_io_x70_encoding (bm);
+	socket.received = mk_io_x70_encoding (bm);
+	encoder = mk_io_x70_stream_encoder (bm);
+
+	if (VERIFY (expect && socket.received && encoder,NULL)) {
+		const uint8_t *b1,*e1,*b2,*e2;
+		uint32_t attempts = 0;
+
+		VERIFY (io_value_encode (r_value,expect),NULL);
+		VERIFY (io_x70_stream_encoder_begin (encoder,r_value),NULL);
+		
+		while (
+				!io_x70_stream_encoder_send (encoder,(io_socket_t*) &socket)
+			&&	attempts++ < 100
+		);
+
+		VERIFY (io_x70_stream_encoder_is_complete (encoder),NULL);
+		VERIFY (socket.longest_message <= IO_SOCKET_MINIMUM_MTU,NULL);
+		VERIFY (socket.number_of_messages > 2 * (sizeof(text) / IO_SOCKET_MINIMUM_MTU),NULL);
+
+		io_encoding_get_content (expect,&b1,&e1);
+		io_encoding_get_content (socket.received,&b2,&e2);
+		VERIFY ((e1 - b1) == (e2 - b2) && memcmp (b1,b2,e1 - b1) == 0,NULL);
+
+		//
+		// a stream that fails part way is not reported as sent
+		//
+		{
+			vref_t r_nested = mk_io_vector_value (vm,0,NULL);
+			for (int i = 0; i < IO_X70_STREAM_ENCODER_STACK_DEPTH + 1; i++) {
+				r_nested = mk_io_vector_value (vm,1,&r_nested);
+			}
+			r_nested = reference_value (r_nested);
+			VERIFY (io_x70_stream_encoder_begin (encoder,r_nested),NULL);
+			attempts = 0;
+			while (
+					!io_x70_stream_encoder_send (encoder,(io_socket_t*) &socket)
+				&&	!io_x70_stream_encoder_has_error (encoder)
+				&&	attempts++ < 100
+			);
+			VERIFY (io_x70_stream_encoder_has_error (encoder),NULL);
+			VERIFY (!io_x70_stream_encoder_send (encoder,(io_socket_t*) &socket),NULL);
+			unreference_value (r_nested);
+		}
+	}
+
+	if (encoder) free_io_x70_stream_encoder (encoder);
+	if (expect) io_encoding_free (expect);
+	if (socket.received) io_encoding_free (socket.received);
+	unreference_value (r_value);
+	
+	io_do_gc (TEST_IO,-1);
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+TEST_BEGIN(test_io_x70_compact_encoding_1) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	io_encoding_t *compact,*full;
+
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	compact = mk_io_x70_compact_encoding (bm);
+	full = mk_io_x70_encoding (bm);
+
+	if (VERIFY (compact != NULL && full != NULL,NULL)) {
+		int64_t cases[] = {
+			0,-1,1,63,-64,64,300,-1000000,
+			(int64_t) 0x7fffffffffffffffLL,-(int64_t) 0x7fffffffffffffffLL - 1
+		};
+		uint8_t expect[] = {
+			X70_UINT_VALUE_BYTE,3,
+			'z','6','4',
+			84
+		};
+		const uint8_t *b,*e;
+		vref_t r_value;
+		int64_t i64_value;
+
+		VERIFY (is_io_x70_encoding (compact),NULL);
+		VERIFY (io_x70_encoding_version (compact) == X70_ENCODING_VERSION_2,NULL);
+		VERIFY (io_x70_encoding_version (full) == X70_ENCODING_VERSION_1,NULL);
+
+		VERIFY (io_value_encode (mk_io_int64_value (vm,42),compact),NULL);
+		io_encoding_get_content (compact,&b,&e);
+		VERIFY (
+				(e - b) == sizeof(expect)
+			&&	memcmp (expect,b,sizeof(expect)) == 0,
+			NULL
+		);
+
+		for (int i = 0; i < SIZEOF(cases); i++) {
+			io_encoding_reset (compact);
+			io_encoding_reset (full);
+			VERIFY (io_value_encode (mk_io_int64_value (vm,cases[i]),compact),NULL);
+			VERIFY (io_value_encode (mk_io_int64_value (vm,cases[i]),full),NULL);
+
+			r_value = io_encoding_decode_to_io_value (compact,io_x70_decoder,vm);
+			VERIFY (
+					io_typesafe_ro_cast (r_value,cr_I64_NUMBER) != NULL
+				&&	io_value_get_as_int64 (r_value,&i64_value)
+				&&	i64_value == cases[i],
+				NULL
+			);
+
+			if (cases[i] >= -64 && cases[i] < 64) {
+				VERIFY (io_encoding_length (compact) == sizeof(expect),NULL);
+				VERIFY (io_encoding_length (full) == sizeof(expect) + 7,NULL);
+			}
+		}
+	}
+
+	if (compact) io_encoding_free (compact);
+	if (full) io_encoding_free (full);
+
+	io_do_gc (TEST_IO,-1);
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+TEST_BEGIN(test_io_x70_compact_encoding_2) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end,vm_begin,vm_end;
+	x70_stream_decoder_test_t result = {.count = 0};
+	io_x70_stream_decoder_t *decoder;
+	io_encoding_t *compact;
+
+	io_value_memory_get_info (vm,&vm_begin);
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	compact = mk_io_x70_compact_encoding (bm);
+	decoder = mk_io_x70_stream_decoder (bm,vm,x70_stream_decoder_test_emit,&result);
+
+	if (VERIFY (compact != NULL && decoder != NULL,NULL)) {
+		const uint8_t *b,*e;
+		float64_t f64_value;
+		int64_t i64_value;
+		vref_t r_value;
+
+		//
+		// lossless float32
+		//
+		VERIFY (io_value_encode (mk_io_float64_value (vm,1.5),compact),NULL);
+		io_encoding_get_content (compact,&b,&e);
+		VERIFY (
+				(e - b) == 5 + sizeof(float)
+			&&	memcmp (b + 2,"f32",3) == 0,
+			NULL
+		);
+		r_value = io_encoding_decode_to_io_value (compact,io_x70_decoder,vm);
+		VERIFY (
+				io_typesafe_ro_cast (r_value,cr_F64_NUMBER) != NULL
+			&&	io_value_get_as_float64 (r_value,&f64_value)
+			&&	f64_value == 1.5,
+			NULL
+		);
+
+		//
+		// not representable as a float32
+		//
+		io_encoding_reset (compact);
+		VERIFY (io_value_encode (mk_io_float64_value (vm,0.1),compact),NULL);
+		io_encoding_get_content (compact,&b,&e);
+		VERIFY (
+				(e - b) == 5 + sizeof(float64_t)
+			&&	memcmp (b + 2,"f64",3) == 0,
+			NULL
+		);
+		r_value = io_encoding_decode_to_io_value (compact,io_x70_decoder,vm);
+		VERIFY (
+				io_value_get_as_float64 (r_value,&f64_value)
+			&&	f64_value == 0.1,
+			NULL
+		);
+
+		//
+		// streaming decoder
+		//
+		io_encoding_reset (compact);
+		VERIFY (
+			io_value_encode (
+				mk_io_vector_value (
+					vm,3,(vref_t[]) {
+						mk_io_int64_value (vm,-300),
+						mk_io_float64_value (vm,-2.25),
+						mk_io_float64_value (vm,0.1),
+					}
+				),
+				compact
+			),
+			NULL
+		);
+		io_encoding_get_content (compact,&b,&e);
+		while (b < e) {
+			VERIFY (io_x70_stream_decoder_push (decoder,b++,1),NULL);
+		}
+
+		if (VERIFY (result.count == 1,NULL)) {
+			vref_t const *values;
+			uint32_t arity;
+			if (
+				VERIFY (
+						io_vector_value_get_values (result.values[0],&arity,&values)
+					&&	arity == 3,
+					NULL
+				)
+			) {
+				VERIFY (io_value_get_as_int64 (values[0],&i64_value) && i64_value == -300,NULL);
+				VERIFY (io_value_get_as_float64 (values[1],&f64_value) && f64_value == -2.25,NULL);
+				VERIFY (io_value_get_as_float64 (values[2],&f64_value) && f64_value == 0.1,NULL);
+			}
+		}
+
+		while (result.count > 0) {
+			unreference_value (result.values[--result.count]);
+		}
+	}
+
+	if (decoder) free_io_x70_stream_decoder (decoder);
+	if (compact) io_encoding_free (compact);
+
+	io_value_memory_do_gc (vm,-1);
+	io_value_memory_get_info (vm,&vm_end);
+	VERIFY (vm_end.used_bytes == vm_begin.used_bytes,NULL);
+
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+//
+// encode and decode the same value, returns the encoded length or zero
+//
+static uint32_t
+test_x70_round_trip_length (
+	io_t *io,io_encoding_t* (*make) (io_byte_memory_t*),vref_t r_value
+) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (io);
+	io_encoding_t *encoding = make (io_get_byte_memory (io));
+	uint32_t length = 0;
+
+	if (encoding != NULL) {
+		if (
+				io_value_encode (r_value,encoding)
+			&&	vref_is_valid (io_encoding_decode_to_io_value (encoding,io_x70_decoder,vm))
+		) {
+			length = io_encoding_length (encoding);
+		}
+		io_encoding_free (encoding);
+	}
+
+	io_value_memory_do_gc (vm,-1);
+	return length;
+}
+
+TEST_BEGIN(test_io_x70_compact_encoding_3) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end;
+	vref_t values[32];
+	vref_t r_value;
+
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	for (int i = 0; i < SIZEOF(values); i += 2) {
+		values[i] = mk_io_int64_value (vm,(i * 37) - 500);
+		values[i + 1] = mk_io_float64_value (vm,i * 0.25);
+	}
+	r_value = reference_value (mk_io_vector_value (vm,SIZEOF(values),values));
+
+	{
+		uint32_t v1 = test_x70_round_trip_length (TEST_IO,mk_io_x70_encoding,r_value);
+		uint32_t v2 = test_x70_round_trip_length (TEST_IO,mk_io_x70_compact_encoding,r_value);
+
+		VERIFY (v1 > 0 && v2 > 0,NULL);
+		VERIFY (v2 < v1,NULL);
+	}
+
+	unreference_value (r_value);
+
+	io_do_gc (TEST_IO,-1);
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+TEST_BEGIN(test_io_x70_dictionary_encoding_1) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end,vm_begin,vm_end;
+	x70_stream_decoder_test_t result = {.count = 0};
+	io_x70_stream_decoder_t *decoder;
+	io_encoding_t *dictionary,*compact;
+	vref_t r_value;
+
+	io_value_memory_get_info (vm,&vm_begin);
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	dictionary = mk_io_x70_dictionary_encoding (bm);
+	compact = mk_io_x70_compact_encoding (bm);
+	decoder = mk_io_x70_stream_decoder (bm,vm,x70_stream_decoder_test_emit,&result);
+
+	{
+		vref_t r_temperature = mk_io_text_value (vm,(uint8_t const*) "temperature",11);
+		vref_t r_humidity = mk_io_text_value (vm,(uint8_t const*) "humidity",8);
+		vref_t args[] = {
+			r_temperature,mk_io_int64_value (vm,21),
+			r_humidity,mk_io_int64_value (vm,40),
+			r_temperature,mk_io_int64_value (vm,22),
+			r_humidity,mk_io_int64_value (vm,41),
+			mk_io_text_value (vm,(uint8_t const*) "temperature",11),
+		};
+		r_value = reference_value (mk_io_vector_value (vm,SIZEOF(args),args));
+	}
+
+	if (VERIFY (dictionary && compact && decoder,NULL)) {
+		vref_t const *values;
+		uint32_t arity;
+		const uint8_t *b,*e;
+
+		VERIFY (is_io_x70_compact_encoding (dictionary),NULL);
+		VERIFY (io_value_encode (r_value,dictionary),NULL);
+		VERIFY (io_value_encode (r_value,compact),NULL);
+		// two refs to "temperature" save 13 bytes each, one to "humidity" 10
+		VERIFY (
+			io_encoding_length (dictionary) + 2 * 13 + 10 == io_encoding_length (compact),
+			NULL
+		);
+
+		vref_t r_decoded = io_encoding_decode_to_io_value (
+			dictionary,io_x70_decoder,vm
+		);
+		if (
+			VERIFY (
+					io_vector_value_get_values (r_decoded,&arity,&values)
+				&&	arity == 9,
+				NULL
+			)
+		) {
+			VERIFY (io_typesafe_ro_cast (values[0],cr_TEXT) != NULL,NULL);
+			VERIFY (vref_is_equal_to (values[0],values[4]),NULL);
+			VERIFY (vref_is_equal_to (values[0],values[8]),NULL);
+			VERIFY (vref_is_equal_to (values[2],values[6]),NULL);
+			VERIFY (vref_not_equal_to (values[0],values[2]),NULL);
+		}
+
+		//
+		// the streaming decoder resolves refs against its own table
+		//
+		io_encoding_get_content (dictionary,&b,&e);
+		VERIFY (io_x70_stream_decoder_push (decoder,b,e - b),NULL);
+		if (
+			VERIFY (
+					result.count == 1
+				&&	io_vector_value_get_values (result.values[0],&arity,&values)
+				&&	arity == 9,
+				NULL
+			)
+		) {
+			VERIFY (vref_is_equal_to (values[2],values[6]),NULL);
+			VERIFY (
+				io_value_is_equal (
+					values[8],mk_io_text_value (vm,(uint8_t const*) "temperature",11)
+				),
+				NULL
+			);
+		}
+
+		//
+		// each message on the stream starts a new table
+		//
+		{
+			vref_t r_humidity = mk_io_text_value (vm,(uint8_t const*) "humidity",8);
+			vref_t args[] = {
+				r_humidity,
+				mk_io_text_value (vm,(uint8_t const*) "pressure",8),
+				r_humidity,
+			};
+			vref_t r_next = reference_value (mk_io_vector_value (vm,SIZEOF(args),args));
+
+			io_encoding_reset (dictionary);
+			VERIFY (io_value_encode (r_next,dictionary),NULL);
+			io_encoding_get_content (dictionary,&b,&e);
+			VERIFY (io_x70_stream_decoder_push (decoder,b,e - b),NULL);
+			VERIFY (io_x70_stream_decoder_push (decoder,b,e - b),NULL);
+			if (VERIFY (result.count == 3,NULL)) {
+				for (uint32_t i = 1; i < 3; i++) {
+					VERIFY (
+							io_vector_value_get_values (result.values[i],&arity,&values)
+						&&	arity == 3
+						&&	io_value_is_equal (values[0],r_humidity)
+						&&	vref_is_equal_to (values[2],values[0]),
+						NULL
+					);
+				}
+			}
+			unreference_value (r_next);
+		}
+
+		//
+		// a ref is meaningless after the table is cleared
+		//
+		io_x70_stream_decoder_reset (decoder);
+		{
+			uint8_t const ref[] = {X70_UINT_VALUE_BYTE,3,'r','e','f',0};
+			VERIFY (!io_x70_stream_decoder_push (decoder,ref,sizeof(ref)),NULL);
+			io_x70_stream_decoder_reset (decoder);
+		}
+
+		io_encoding_reset (dictionary);
+		VERIFY (io_value_encode (r_value,dictionary),NULL);
+		VERIFY (io_encoding_length (dictionary) < io_encoding_length (compact),NULL);
+
+		while (result.count > 0) {
+			unreference_value (result.values[--result.count]);
+		}
+	}
+
+	unreference_value (r_value);
+	if (decoder) free_io_x70_stream_decoder (decoder);
+	if (dictionary) io_encoding_free (dictionary);
+	if (compact) io_encoding_free (compact);
+
+	io_value_memory_do_gc (vm,-1);
+	io_value_memory_get_info (vm,&vm_end);
+	VERIFY (vm_end.used_bytes == vm_begin.used_bytes,NULL);
+
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
+TEST_BEGIN(test_io_x70_zero_copy_decode_1) {
+	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
+	io_byte_memory_t *bm = io_get_byte_memory (TEST_IO);
+	memory_info_t bm_begin,bm_end,vm_begin,vm_end;
+	io_encoding_t *encoding;
+	uint8_t blob[1000];
+
+	io_value_memory_get_info (vm,&vm_begin);
+	io_byte_memory_get_info (bm,&bm_begin);
+
+	for (int i = 0; i < sizeof(blob); i++) {
+		blob[i] = i;
+	}
+
+	encoding = reference_io_encoding (mk_io_x70_encoding (bm));
+
+	if (VERIFY (encoding != NULL,NULL)) {
+		vref_t args[] = {
+			mk_io_binary_value (vm,blob,sizeof(blob)),
+			mk_io_text_value (vm,(uint8_t const*) "abc",3),
+			mk_io_int64_value (vm,7),
+		};
+		const uint8_t *b,*e;
+		vref_t const *values;
+		uint32_t arity;
+		vref_t r_value;
+
+		VERIFY (io_value_encode (mk_io_vector_value (vm,SIZEOF(args),args),encoding),NULL);
+		io_encoding_get_content (encoding,&b,&e);
+
+		//
+		// the default decoder copies
+		//
+		r_value = io_encoding_decode_to_io_value (encoding,io_x70_decoder,vm);
+		if (
+			VERIFY (
+					io_vector_value_get_values (r_value,&arity,&values)
+				&&	arity == 3,
+				NULL
+			)
+		) {
+			io_binary_value_t const *binary = io_typesafe_ro_cast (values[0],cr_BINARY);
+			VERIFY (
+					binary != NULL
+				&&	!is_io_encoding_binary_value (values[0])
+				&&	io_binary_value_size (binary) == sizeof(blob)
+				&&	memcmp (io_binary_value_ro_bytes (binary),blob,sizeof(blob)) == 0,
+				NULL
+			);
+		}
+		VERIFY (io_encoding_reference_count (encoding) == 1,NULL);
+
+		//
+		// zero-copy values point into the encoding and keep it alive
+		//
+		r_value = reference_value (
+			io_encoding_decode_to_io_value (encoding,io_x70_zero_copy_decoder,vm)
+		);
+		if (
+			VERIFY (
+					io_vector_value_get_values (r_value,&arity,&values)
+				&&	arity == 3,
+				NULL
+			)
+		) {
+			io_binary_value_t const *binary = io_typesafe_ro_cast (values[0],cr_BINARY);
+			io_binary_value_t const *text = io_typesafe_ro_cast (values[1],cr_TEXT);
+			int64_t i64_value;
+
+			VERIFY (
+					binary != NULL
+				&&	is_io_encoding_binary_value (values[0])
+				&&	io_binary_value_ro_bytes (binary) > b
+				&&	io_binary_value_ro_bytes (binary) + sizeof(blob) <= e,
+				NULL
+			);
+			VERIFY (
+					text != NULL
+				&&	is_io_encoding_binary_value (values[1])
+				&&	io_value_is_equal (values[1],mk_io_text_value (vm,(uint8_t const*) "abc",3))
+				&&	io_value_is_equal (mk_io_text_value (vm,(uint8_t const*) "abc",3),values[1]),
+				NULL
+			);
+			VERIFY (io_value_get_as_int64 (values[2],&i64_value) && i64_value == 7,NULL);
+			VERIFY (io_encoding_reference_count (encoding) == 3,NULL);
+
+			unreference_io_encoding (encoding);
+			VERIFY (
+				memcmp (io_binary_value_ro_bytes (binary),blob,sizeof(blob)) == 0,
+				NULL
+			);
+		} else {
+			unreference_io_encoding (encoding);
+		}
+
+		// the last value freed releases the encoding
+		unreference_value (r_value);
+	}
+
+	io_value_memory_do_gc (vm,-1);
+	io_value_memory_get_info (vm,&vm_end);
+	VERIFY (vm_end.used_bytes == vm_begin.used_bytes,NULL);
+
+	io_byte_memory_get_info (bm,&bm_end);
+	VERIFY (bm_end.used_bytes == bm_begin.used_bytes,NULL);
+}
+TEST_END
+
 TEST_BEGIN(test_cons_value_1) {
 	io_value_memory_t *vm = io_get_short_term_value_memory (TEST_IO);
 	memory_info_t vm_begin,vm_end;
@@ -1046,6 +1999,16 @@ io_core_values_unit_test (V_unit_test_t *unit) {
 		test_stack_vector_value_1,
 		test_vector_value_1,
 		test_vector_value_2,
+		test_vector_value_3,
+		test_io_x70_stream_decoder_1,
+		test_io_x70_stream_decoder_2,
+		test_io_x70_stream_encoder_1,
+		test_io_x70_stream_encoder_2,
+		test_io_x70_compact_encoding_1,
+		test_io_x70_compact_encoding_2,
+		test_io_x70_compact_encoding_3,
+		test_io_x70_dictionary_encoding_1,
+		test_io_x70_zero_copy_decode_1,
 		test_cons_value_1,
 		test_list_value_1,
 		test_list_value_2,